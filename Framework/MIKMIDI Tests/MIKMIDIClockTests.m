@@ -0,0 +1,95 @@
+//
+//  MIKMIDIClockTests.m
+//  MIKMIDI
+//
+//  Created by Mixed In Key on 10/18/26.
+//  Copyright (c) 2026 Mixed In Key. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import <MIKMIDI/MIKMIDI.h>
+
+#define kNumberOfTimeStamps	100003	// deliberately not a multiple of 4
+
+@interface MIKMIDIClockTests : XCTestCase
+
+@property (nonatomic, strong) MIKMIDIClock *clock;
+
+@end
+
+@implementation MIKMIDIClockTests
+
+- (void)setUp
+{
+	[super setUp];
+
+	self.clock = [MIKMIDIClock clock];
+	MIDITimeStamp now = MIKMIDIGetCurrentTimeStamp();
+	[self.clock syncMusicTimeStamp:0 withMIDITimeStamp:now tempo:120];
+	[self.clock syncMusicTimeStamp:8 withMIDITimeStamp:[self.clock midiTimeStampForMusicTimeStamp:8] tempo:93.5];
+}
+
+- (void)testBatchMIDITimeStampConversionMatchesSingleConversion
+{
+	NSUInteger count = kNumberOfTimeStamps;
+	MusicTimeStamp *musicTimeStamps = malloc(count * sizeof(MusicTimeStamp));
+	MIDITimeStamp *midiTimeStamps = malloc(count * sizeof(MIDITimeStamp));
+	for (NSUInteger i = 0; i < count; i++) musicTimeStamps[i] = i * 0.0137;
+
+	[self.clock getMIDITimeStamps:midiTimeStamps forMusicTimeStamps:musicTimeStamps count:count];
+	for (NSUInteger i = 0; i < count; i++) {
+		XCTAssertEqual(midiTimeStamps[i], [self.clock midiTimeStampForMusicTimeStamp:musicTimeStamps[i]], @"Batch conversion of %f differs from single conversion", musicTimeStamps[i]);
+	}
+
+	MIKMIDIClock *syncedClock = [self.clock syncedClock];
+	MIDITimeStamp *syncedMIDITimeStamps = malloc(count * sizeof(MIDITimeStamp));
+	[syncedClock getMIDITimeStamps:syncedMIDITimeStamps forMusicTimeStamps:musicTimeStamps count:count];
+	XCTAssertEqual(memcmp(midiTimeStamps, syncedMIDITimeStamps, count * sizeof(MIDITimeStamp)), 0, @"Synced clock batch conversion differs from its master clock");
+
+	free(musicTimeStamps);
+	free(midiTimeStamps);
+	free(syncedMIDITimeStamps);
+}
+
+- (void)testBatchMusicTimeStampConversionMatchesSingleConversion
+{
+	NSUInteger count = kNumberOfTimeStamps;
+	MIDITimeStamp startTimeStamp = [self.clock midiTimeStampForMusicTimeStamp:0];
+	MIDITimeStamp *midiTimeStamps = malloc(count * sizeof(MIDITimeStamp));
+	MusicTimeStamp *musicTimeStamps = malloc(count * sizeof(MusicTimeStamp));
+	for (NSUInteger i = 0; i < count; i++) midiTimeStamps[i] = startTimeStamp + (i * 1013);
+
+	[self.clock getMusicTimeStamps:musicTimeStamps forMIDITimeStamps:midiTimeStamps count:count];
+	for (NSUInteger i = 0; i < count; i++) {
+		XCTAssertEqual(musicTimeStamps[i], [self.clock musicTimeStampForMIDITimeStamp:midiTimeStamps[i]], @"Batch conversion of %llu differs from single conversion", midiTimeStamps[i]);
+	}
+
+	free(midiTimeStamps);
+	free(musicTimeStamps);
+}
+
+- (void)testBatchConversionWithUnreadyClock
+{
+	MIKMIDIClock *clock = [MIKMIDIClock clock];
+	MusicTimeStamp musicTimeStamps[5] = {0, 1, 2, 3, 4};
+	MIDITimeStamp midiTimeStamps[5] = {1, 2, 3, 4, 5};
+	[clock getMIDITimeStamps:midiTimeStamps forMusicTimeStamps:musicTimeStamps count:5];
+	for (NSUInteger i = 0; i < 5; i++) XCTAssertEqual(midiTimeStamps[i], 0);
+}
+
+- (void)testBatchConversionPerformance
+{
+	NSUInteger count = kNumberOfTimeStamps;
+	MusicTimeStamp *musicTimeStamps = malloc(count * sizeof(MusicTimeStamp));
+	MIDITimeStamp *midiTimeStamps = malloc(count * sizeof(MIDITimeStamp));
+	for (NSUInteger i = 0; i < count; i++) musicTimeStamps[i] = 8 + (i * 0.25);
+
+	[self measureBlock:^{
+		[self.clock getMIDITimeStamps:midiTimeStamps forMusicTimeStamps:musicTimeStamps count:count];
+	}];
+
+	free(musicTimeStamps);
+	free(midiTimeStamps);
+}
+
+@end
@@ -0,0 +1,156 @@
+//
+//  MIKMIDIFileIndexerTests.m
+//  MIKMIDI
+//
+//  Created by Mixed In Key on 10/18/26.
+//  Copyright (c) 2026 Mixed In Key. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import <XCTest/XCTest.h>
+#import <MIKMIDI/MIKMIDI.h>
+
+// A format 1 file with a tempo track and a piano track, 4 beats at 120 bpm and 4 beats at 100 bpm long
+static NSData *MIKMIDIFileIndexerTestsFileData(UInt8 program)
+{
+	UInt8 bytes[] = { 'M', 'T', 'h', 'd', 0, 0, 0, 6, 0, 1, 0, 2, 0x01, 0xE0,
+		'M', 'T', 'r', 'k', 0, 0, 0, 41,
+		0x00, 0xFF, 0x03, 0x04, 'S', 'o', 'n', 'g',		// Track name
+		0x00, 0xFF, 0x51, 0x03, 0x07, 0xA1, 0x20,		// 120 bpm
+		0x00, 0xFF, 0x58, 0x04, 0x03, 0x02, 0x18, 0x08,	// 3/4
+		0x00, 0xFF, 0x59, 0x02, 0xFE, 0x00,				// B flat major
+		0x8F, 0x00, 0xFF, 0x51, 0x03, 0x09, 0x27, 0xC0,	// 100 bpm, 4 beats later
+		0x00, 0xFF, 0x2F, 0x00,
+		'M', 'T', 'r', 'k', 0, 0, 0, 31,
+		0x00, 0xFF, 0x03, 0x05, 'P', 'i', 'a', 'n', 'o',
+		0x00, 0xC0, program,
+		0x00, 0x90, 0x3C, 0x64,
+		0x8F, 0x00, 0x3C, 0x00,
+		0x00, 0x48, 0x64,
+		0x8F, 0x00, 0x48, 0x00,
+		0x00, 0xFF, 0x2F, 0x00 };
+	return [NSData dataWithBytes:bytes length:sizeof(bytes)];
+}
+
+@interface MIKMIDIFileIndexerTests : XCTestCase
+
+@property (nonatomic, strong) NSURL *directoryURL;
+
+@end
+
+@implementation MIKMIDIFileIndexerTests
+
+- (void)setUp
+{
+	[super setUp];
+	self.directoryURL = [[NSURL fileURLWithPath:NSTemporaryDirectory()] URLByAppendingPathComponent:[[NSUUID UUID] UUIDString]];
+	[[NSFileManager defaultManager] createDirectoryAtURL:self.directoryURL withIntermediateDirectories:YES attributes:nil error:NULL];
+}
+
+- (void)tearDown
+{
+	[[NSFileManager defaultManager] removeItemAtURL:self.directoryURL error:NULL];
+	[super tearDown];
+}
+
+- (void)testIndexingFiles
+{
+	NSURL *songsURL = [self.directoryURL URLByAppendingPathComponent:@"Songs"];
+	[[NSFileManager defaultManager] createDirectoryAtURL:songsURL withIntermediateDirectories:YES attributes:nil error:NULL];
+	NSURL *fileURL = [songsURL URLByAppendingPathComponent:@"song.mid"];
+	NSURL *otherFileURL = [songsURL URLByAppendingPathComponent:@"other song.MID"];
+	XCTAssertTrue([MIKMIDIFileIndexerTestsFileData(5) writeToURL:fileURL atomically:NO]);
+	XCTAssertTrue([MIKMIDIFileIndexerTestsFileData(40) writeToURL:otherFileURL atomically:NO]);
+	XCTAssertTrue([[NSData dataWithBytes:"Not MIDI" length:8] writeToURL:[songsURL URLByAppendingPathComponent:@"broken.mid"] atomically:NO]);
+
+	NSURL *indexURL = [self.directoryURL URLByAppendingPathComponent:@"index"];
+	NSError *error = nil;
+	MIKMIDIFileIndexer *indexer = [MIKMIDIFileIndexer indexerWithIndexFileAtURL:indexURL error:&error];
+	XCTAssertNotNil(indexer, @"Creating an indexer failed with error %@", error);
+	XCTAssertEqual([indexer updateEntriesForFilesInDirectoryAtURL:songsURL], 2);
+	XCTAssertTrue([indexer saveWithError:&error], @"Saving the index failed with error %@", error);
+
+	indexer = [MIKMIDIFileIndexer indexerWithIndexFileAtURL:indexURL error:&error];
+	XCTAssertNotNil(indexer, @"Reading the index failed with error %@", error);
+	XCTAssertEqual(indexer.numberOfEntries, 2);
+	MIKMIDIFileIndexEntry *entry = [indexer entryForFileAtURL:fileURL];
+	XCTAssertEqual(entry.format, MIKMIDIFileFormatMultipleTracks);
+	XCTAssertEqual(entry.numberOfTracks, 2);
+	XCTAssertEqual(entry.ticksPerQuarterNote, 480);
+	XCTAssertEqualObjects(entry.trackNames, (@[@"Song", @"Piano"]));
+	XCTAssertEqualObjects(entry.programs, [NSIndexSet indexSetWithIndex:5]);
+	XCTAssertEqualObjects(entry.channels, [NSIndexSet indexSetWithIndex:0]);
+	XCTAssertEqual(entry.numberOfNotes, 2);
+	XCTAssertEqual(entry.lowestNote, 60);
+	XCTAssertEqual(entry.highestNote, 72);
+	XCTAssertEqualWithAccuracy(entry.length, 8, 0.0001);
+	XCTAssertEqualWithAccuracy(entry.durationInSeconds, 4.4, 0.0001);
+	XCTAssertEqual([entry.tempoEvents count], 2);
+	XCTAssertEqualWithAccuracy([(MIKMIDITempoEvent *)[entry.tempoEvents lastObject] bpm], 100, 0.001);
+	XCTAssertEqual([(MIKMIDIMetaTimeSignatureEvent *)[entry.timeSignatureEvents firstObject] numerator], 3);
+	XCTAssertEqual([(MIKMIDIMetaKeySignatureEvent *)[entry.keySignatureEvents firstObject] numberOfFlatsAndSharps], -2);
+
+	NSArray *entries = [indexer entriesPassingTest:^BOOL(MIKMIDIFileIndexEntry *candidate, BOOL *stop) {
+		return [candidate.programs containsIndex:40];
+	}];
+	XCTAssertEqual([entries count], 1);
+	XCTAssertEqualObjects([[entries firstObject] fileURL], [indexer entryForFileAtURL:otherFileURL].fileURL);
+
+	// Only changed files are scanned again, and deleted files are removed
+	XCTAssertEqual([indexer updateEntriesForFilesInDirectoryAtURL:songsURL], 0);
+	NSDate *modificationDate = [NSDate dateWithTimeIntervalSinceNow:60];
+	XCTAssertTrue([MIKMIDIFileIndexerTestsFileData(6) writeToURL:fileURL atomically:NO]);
+	XCTAssertTrue([[NSFileManager defaultManager] setAttributes:@{NSFileModificationDate : modificationDate} ofItemAtPath:[fileURL path] error:NULL]);
+	XCTAssertTrue([[NSFileManager defaultManager] removeItemAtURL:otherFileURL error:NULL]);
+	XCTAssertEqual([indexer updateEntriesForFilesInDirectoryAtURL:songsURL], 1);
+	XCTAssertEqual(indexer.numberOfEntries, 1);
+	XCTAssertEqualObjects([indexer entryForFileAtURL:fileURL].programs, [NSIndexSet indexSetWithIndex:6]);
+	XCTAssertNil([indexer entryForFileAtURL:otherFileURL]);
+}
+
+- (void)testReadingMalformedIndex
+{
+	NSURL *indexURL = [self.directoryURL URLByAppendingPathComponent:@"index"];
+	XCTAssertTrue([[NSData dataWithBytes:"MIKI\x01\0\0\0\x05\0\0\0\0\0\0\0" length:16] writeToURL:indexURL atomically:NO]);
+	NSError *error = nil;
+	XCTAssertNil([MIKMIDIFileIndexer indexerWithIndexFileAtURL:indexURL error:&error], @"Reading a truncated index should fail.");
+	XCTAssertEqualObjects(error.domain, MIKMIDIErrorDomain);
+	XCTAssertEqual(error.code, MIKMIDIFileIndexReadingFailedErrorCode);
+}
+
+- (void)testIndexingThroughput
+{
+	NSBundle *bundle = [NSBundle bundleForClass:[self class]];
+	NSArray *sourceURLs = @[[bundle URLForResource:@"bach" withExtension:@"mid"], [bundle URLForResource:@"Parallax-Loader" withExtension:@"mid"]];
+	NSUInteger numberOfFiles = 2000;
+	for (NSUInteger i = 0; i < numberOfFiles; i++) {
+		NSURL *fileURL = [self.directoryURL URLByAppendingPathComponent:[NSString stringWithFormat:@"%lu.mid", (unsigned long)i]];
+		[[NSFileManager defaultManager] copyItemAtURL:sourceURLs[i % [sourceURLs count]] toURL:fileURL error:NULL];
+	}
+
+	NSURL *indexURL = [[NSURL fileURLWithPath:NSTemporaryDirectory()] URLByAppendingPathComponent:[[NSUUID UUID] UUIDString]];
+	for (NSUInteger numberOfThreads = 1; numberOfThreads <= 8; numberOfThreads *= 2) {
+		MIKMIDIFileIndexer *indexer = [MIKMIDIFileIndexer indexerWithIndexFileAtURL:indexURL error:NULL];
+		indexer.maximumConcurrentFileScans = numberOfThreads;
+		CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+		XCTAssertEqual([indexer updateEntriesForFilesInDirectoryAtURL:self.directoryURL], numberOfFiles);
+		CFAbsoluteTime indexingTime = CFAbsoluteTimeGetCurrent() - start;
+
+		start = CFAbsoluteTimeGetCurrent();
+		XCTAssertEqual([indexer updateEntriesForFilesInDirectoryAtURL:self.directoryURL], 0);
+		CFAbsoluteTime updatingTime = CFAbsoluteTimeGetCurrent() - start;
+		NSLog(@"Indexing with %lu thread(s): %.0f files/s. Checking for changes: %.0f files/s.", (unsigned long)numberOfThreads,
+			  numberOfFiles / indexingTime, numberOfFiles / updatingTime);
+	}
+
+	MIKMIDIFileIndexer *indexer = [MIKMIDIFileIndexer indexerWithIndexFileAtURL:indexURL error:NULL];
+	[indexer updateEntriesForFilesInDirectoryAtURL:self.directoryURL];
+	XCTAssertTrue([indexer saveWithError:NULL]);
+	CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+	indexer = [MIKMIDIFileIndexer indexerWithIndexFileAtURL:indexURL error:NULL];
+	NSLog(@"Opening an index of %lu files: %.1f ms.", (unsigned long)indexer.numberOfEntries, (CFAbsoluteTimeGetCurrent() - start) * 1000);
+	XCTAssertEqual(indexer.numberOfEntries, numberOfFiles);
+	[[NSFileManager defaultManager] removeItemAtURL:indexURL error:NULL];
+}
+
+@end
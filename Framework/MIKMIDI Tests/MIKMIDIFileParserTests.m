@@ -0,0 +1,502 @@
+//
+//  MIKMIDIFileParserTests.m
+//  MIKMIDI
+//
+//  Created by Mixed In Key on 10/18/26.
+//  Copyright (c) 2026 Mixed In Key. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import <XCTest/XCTest.h>
+#import <MIKMIDI/MIKMIDI.h>
+
+// Builds a format 1 file with a tempo track and numberOfTracks tracks of notes, with controller changes in between
+static NSData *MIKMIDIFileParserTestsSyntheticFileData(NSUInteger numberOfTracks, NSUInteger numberOfNotesPerTrack)
+{
+	NSMutableData *data = [NSMutableData data];
+	UInt8 header[] = { 'M', 'T', 'h', 'd', 0, 0, 0, 6, 0, 1, (UInt8)((numberOfTracks + 1) >> 8), (UInt8)(numberOfTracks + 1), 0x01, 0xE0 };
+	[data appendBytes:header length:sizeof(header)];
+
+	UInt8 tempoTrack[] = { 'M', 'T', 'r', 'k', 0, 0, 0, 19,
+		0x00, 0xFF, 0x51, 0x03, 0x07, 0xA1, 0x20,
+		0x00, 0xFF, 0x58, 0x04, 0x04, 0x02, 0x18, 0x08,
+		0x00, 0xFF, 0x2F, 0x00 };
+	[data appendBytes:tempoTrack length:sizeof(tempoTrack)];
+
+	for (NSUInteger track = 0; track < numberOfTracks; track++) {
+		NSMutableData *events = [NSMutableData data];
+		UInt8 channel = track % 16;
+		for (NSUInteger i = 0; i < numberOfNotesPerTrack; i++) {
+			UInt8 note = 36 + (i * 7 + track) % 60;
+			UInt8 noteOn[] = { 0x00, 0x90 | channel, note, 64 + i % 63 };
+			UInt8 noteOff[] = { 0x83, 0x60, note, 0x00 }; // Running status, 480 ticks later
+			[events appendBytes:noteOn length:sizeof(noteOn)];
+			[events appendBytes:noteOff length:sizeof(noteOff)];
+			if (i % 8 == 0) {
+				UInt8 controlChange[] = { 0x00, 0xB0 | channel, 7, i % 128 };
+				[events appendBytes:controlChange length:sizeof(controlChange)];
+			}
+		}
+		UInt8 endOfTrack[] = { 0x00, 0xFF, 0x2F, 0x00 };
+		[events appendBytes:endOfTrack length:sizeof(endOfTrack)];
+
+		UInt32 length = (UInt32)[events length];
+		UInt8 chunkHeader[] = { 'M', 'T', 'r', 'k', length >> 24, length >> 16, length >> 8, length };
+		[data appendBytes:chunkHeader length:sizeof(chunkHeader)];
+		[data appendData:events];
+	}
+	return data;
+}
+
+// Builds a format 0 file with a single track of notes, cycling through numberOfChannels channels, with a track name and controller changes
+static NSData *MIKMIDIFileParserTestsSyntheticFormat0FileData(NSUInteger numberOfChannels, NSUInteger numberOfNotes)
+{
+	NSMutableData *events = [NSMutableData data];
+	UInt8 trackStart[] = { 0x00, 0xFF, 0x03, 0x04, 'S', 'o', 'n', 'g',
+		0x00, 0xFF, 0x51, 0x03, 0x07, 0xA1, 0x20 };
+	[events appendBytes:trackStart length:sizeof(trackStart)];
+	for (NSUInteger i = 0; i < numberOfNotes; i++) {
+		UInt8 channel = i % numberOfChannels;
+		UInt8 note = 36 + (i * 7) % 60;
+		UInt8 noteOn[] = { 0x00, 0x90 | channel, note, 64 + i % 63 };
+		UInt8 noteOff[] = { 0x78, 0x80 | channel, note, 0x40 }; // 120 ticks later
+		[events appendBytes:noteOn length:sizeof(noteOn)];
+		[events appendBytes:noteOff length:sizeof(noteOff)];
+		if (i % 8 == 0) {
+			UInt8 controlChange[] = { 0x00, 0xB0 | channel, 7, i % 128 };
+			[events appendBytes:controlChange length:sizeof(controlChange)];
+		}
+	}
+	UInt8 endOfTrack[] = { 0x00, 0xFF, 0x2F, 0x00 };
+	[events appendBytes:endOfTrack length:sizeof(endOfTrack)];
+
+	UInt32 length = (UInt32)[events length];
+	UInt8 header[] = { 'M', 'T', 'h', 'd', 0, 0, 0, 6, 0, 0, 0, 1, 0x01, 0xE0,
+		'M', 'T', 'r', 'k', length >> 24, length >> 16, length >> 8, length };
+	NSMutableData *data = [NSMutableData dataWithBytes:header length:sizeof(header)];
+	[data appendData:events];
+	return data;
+}
+
+static MIKMIDISequence *MIKMIDIFileParserTestsSequenceLoadedByAudioToolboxWithFlags(NSData *data, MusicSequenceLoadFlags flags)
+{
+	MusicSequence musicSequence;
+	if (NewMusicSequence(&musicSequence)) return nil;
+	if (MusicSequenceFileLoadData(musicSequence, (__bridge CFDataRef)data, kMusicSequenceFile_MIDIType, flags)) return nil;
+	return [MIKMIDISequence sequenceWithMusicSequence:musicSequence error:NULL];
+}
+
+static MIKMIDISequence *MIKMIDIFileParserTestsSequenceLoadedByAudioToolbox(NSData *data)
+{
+	return MIKMIDIFileParserTestsSequenceLoadedByAudioToolboxWithFlags(data, 0);
+}
+
+@interface MIKMIDIFileParserTests : XCTestCase
+
+@end
+
+@implementation MIKMIDIFileParserTests
+
+- (void)testParsingEvents
+{
+	UInt8 bytes[] = { 'M', 'T', 'h', 'd', 0, 0, 0, 6, 0, 0, 0, 1, 0, 96,
+		'M', 'T', 'r', 'k', 0, 0, 0, 45,
+		0x00, 0xFF, 0x03, 0x04, 'T', 'e', 's', 't',	// Track name
+		0x00, 0xFF, 0x51, 0x03, 0x07, 0xA1, 0x20,	// 120 bpm
+		0x00, 0x90, 0x3C, 0x64,						// Note on
+		0x60, 0x3C, 0x00,							// Running status note off, a beat later
+		0x00, 0xB0, 0x07, 0x7F,						// Control change
+		0x00, 0xF0, 0x03, 0x7E, 0x7F, 0xF7,			// System exclusive
+		0x30, 0x80, 0x3E, 0x40,						// Note off without a note on
+		0x00, 0x90, 0x40, 0x50,						// Note on that's never turned off
+		0x81, 0x40, 0xFF, 0x2F, 0x00 };				// End of track, two beats later
+	NSError *error = nil;
+	MIKMIDIFileParser *parser = [MIKMIDIFileParser parserWithData:[NSData dataWithBytes:bytes length:sizeof(bytes)] error:&error];
+	XCTAssertNotNil(parser, @"Creating a parser failed with error %@", error);
+	XCTAssertEqual(parser.format, MIKMIDIFileFormatSingleTrack);
+	XCTAssertEqual(parser.ticksPerQuarterNote, 96);
+	XCTAssertEqual(parser.numberOfTracks, 1);
+
+	NSMutableArray *events = [NSMutableArray array];
+	BOOL success = [parser enumerateEventsInTrackAtIndex:0 usingBlock:^(MusicTimeStamp timeStamp, MusicEventType eventType, const void *data, UInt32 dataSize, BOOL *stop) {
+		[events addObject:[MIKMIDIEvent midiEventWithTimeStamp:timeStamp eventType:eventType data:[NSData dataWithBytes:data length:dataSize]]];
+	} error:&error];
+	XCTAssertTrue(success, @"Parsing a track failed with error %@", error);
+	XCTAssertEqual([events count], 6, @"Unexpected number of events parsed.");
+	if ([events count] != 6) return;
+
+	XCTAssertEqualObjects([(MIKMIDIMetaTrackSequenceNameEvent *)events[0] name], @"Test");
+	XCTAssertEqualWithAccuracy([(MIKMIDITempoEvent *)events[1] bpm], 120, 0.0001);
+
+	MIKMIDINoteEvent *firstNote = events[2];
+	XCTAssertEqual(firstNote.timeStamp, 0);
+	XCTAssertEqual(firstNote.note, 60);
+	XCTAssertEqual(firstNote.velocity, 100);
+	XCTAssertEqual(firstNote.duration, 1);
+
+	MIKMIDIControlChangeEvent *controlChange = events[3];
+	XCTAssertEqual(controlChange.timeStamp, 1);
+	XCTAssertEqual(controlChange.controllerNumber, 7);
+	XCTAssertEqual(controlChange.controllerValue, 127);
+
+	MIKMIDIEvent *systemExclusive = events[4];
+	XCTAssertEqual(systemExclusive.eventType, MIKMIDIEventTypeMIDIRawData);
+	UInt8 expectedRawData[] = { 4, 0, 0, 0, 0xF0, 0x7E, 0x7F, 0xF7 };
+	XCTAssertEqualObjects([systemExclusive.data subdataWithRange:NSMakeRange(0, sizeof(expectedRawData))], [NSData dataWithBytes:expectedRawData length:sizeof(expectedRawData)]);
+
+	MIKMIDINoteEvent *secondNote = events[5];
+	XCTAssertEqual(secondNote.timeStamp, 1.5);
+	XCTAssertEqual(secondNote.note, 64);
+	XCTAssertEqual(secondNote.duration, 2, @"A note that's never turned off should last until the end of the track.");
+}
+
+- (void)testParsingMalformedData
+{
+	NSError *error = nil;
+	XCTAssertNil([MIKMIDIFileParser parserWithData:[@"Not a MIDI file" dataUsingEncoding:NSUTF8StringEncoding] error:&error]);
+	XCTAssertEqualObjects(error.domain, MIKMIDIErrorDomain);
+	XCTAssertEqual(error.code, MIKMIDIFileParsingFailedErrorCode);
+
+	UInt8 smpteBytes[] = { 'M', 'T', 'h', 'd', 0, 0, 0, 6, 0, 0, 0, 1, 0xE7, 0x28 };
+	XCTAssertNil([MIKMIDIFileParser parserWithData:[NSData dataWithBytes:smpteBytes length:sizeof(smpteBytes)] error:NULL], @"SMPTE time division should be rejected.");
+
+	// A data byte with no status byte before it
+	UInt8 bytes[] = { 'M', 'T', 'h', 'd', 0, 0, 0, 6, 0, 0, 0, 1, 0, 96,
+		'M', 'T', 'r', 'k', 0, 0, 0, 7,
+		0x00, 0x3C, 0x64,
+		0x00, 0xFF, 0x2F, 0x00 };
+	MIKMIDIFileParser *parser = [MIKMIDIFileParser parserWithData:[NSData dataWithBytes:bytes length:sizeof(bytes)] error:NULL];
+	XCTAssertNotNil(parser);
+	__block BOOL calledBlock = NO;
+	error = nil;
+	BOOL success = [parser enumerateEventsInTrackAtIndex:0 usingBlock:^(MusicTimeStamp timeStamp, MusicEventType eventType, const void *data, UInt32 dataSize, BOOL *stop) {
+		calledBlock = YES;
+	} error:&error];
+	XCTAssertFalse(success, @"Parsing a malformed track should fail.");
+	XCTAssertFalse(calledBlock, @"No events should be reported for a malformed track.");
+	XCTAssertEqual(error.code, MIKMIDIFileParsingFailedErrorCode);
+}
+
+- (void)testLoadedSequenceMatchesAudioToolbox
+{
+	NSBundle *bundle = [NSBundle bundleForClass:[self class]];
+	NSData *data = [NSData dataWithContentsOfURL:[bundle URLForResource:@"bach" withExtension:@"mid"]];
+	NSError *error = nil;
+	MIKMIDISequence *sequence = [MIKMIDISequence sequenceWithData:data error:&error];
+	MIKMIDISequence *audioToolboxSequence = MIKMIDIFileParserTestsSequenceLoadedByAudioToolbox(data);
+	XCTAssertNotNil(sequence, @"Loading sequence failed with error %@", error);
+	XCTAssertNotNil(audioToolboxSequence);
+
+	XCTAssertEqual([sequence.tracks count], [audioToolboxSequence.tracks count]);
+	for (NSUInteger i = 0; i < MIN([sequence.tracks count], [audioToolboxSequence.tracks count]); i++) {
+		XCTAssertEqualObjects([sequence.tracks[i] events], [audioToolboxSequence.tracks[i] events], @"Events of track %lu differ.", (unsigned long)i);
+	}
+
+	NSArray *tempoEvents = sequence.tempoEvents;
+	NSArray *audioToolboxTempoEvents = audioToolboxSequence.tempoEvents;
+	XCTAssertEqual([tempoEvents count], [audioToolboxTempoEvents count]);
+	for (NSUInteger i = 0; i < MIN([tempoEvents count], [audioToolboxTempoEvents count]); i++) {
+		XCTAssertEqual([tempoEvents[i] timeStamp], [audioToolboxTempoEvents[i] timeStamp]);
+		XCTAssertEqualWithAccuracy([tempoEvents[i] bpm], [audioToolboxTempoEvents[i] bpm], 0.0001);
+	}
+	XCTAssertEqualObjects(sequence.timeSignatureEvents, audioToolboxSequence.timeSignatureEvents);
+	XCTAssertEqualWithAccuracy(sequence.durationInSeconds, audioToolboxSequence.durationInSeconds, 0.0001);
+
+	// The events are written to the MusicSequence when it's needed
+	MIKMIDISequence *reloadedSequence = MIKMIDIFileParserTestsSequenceLoadedByAudioToolbox(sequence.dataValue);
+	XCTAssertEqualObjects([[reloadedSequence.tracks lastObject] notes], [[sequence.tracks lastObject] notes]);
+}
+
+- (void)testParsingThroughput
+{
+	NSBundle *bundle = [NSBundle bundleForClass:[self class]];
+	NSDictionary *files = @{@"bach.mid" : [NSData dataWithContentsOfURL:[bundle URLForResource:@"bach" withExtension:@"mid"]],
+							@"synthetic (32 tracks x 20000 notes)" : MIKMIDIFileParserTestsSyntheticFileData(32, 20000)};
+
+	for (NSString *name in files) {
+		NSData *data = files[name];
+		NSUInteger iterations = MAX(1, (NSUInteger)(4000000 / [data length]));
+
+		__block NSUInteger numberOfEvents = 0;
+		CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+		for (NSUInteger i = 0; i < iterations; i++) {
+			@autoreleasepool {
+				MIKMIDIFileParser *parser = [MIKMIDIFileParser parserWithData:data error:NULL];
+				for (NSUInteger track = 0; track < parser.numberOfTracks; track++) {
+					[parser enumerateEventsInTrackAtIndex:track usingBlock:^(MusicTimeStamp timeStamp, MusicEventType eventType, const void *eventData, UInt32 dataSize, BOOL *stop) {
+						numberOfEvents++;
+					} error:NULL];
+				}
+			}
+		}
+		CFAbsoluteTime parsingTime = CFAbsoluteTimeGetCurrent() - start;
+
+		start = CFAbsoluteTimeGetCurrent();
+		for (NSUInteger i = 0; i < iterations; i++) {
+			@autoreleasepool {
+				[MIKMIDISequence sequenceWithData:data error:NULL];
+			}
+		}
+		CFAbsoluteTime loadingTime = CFAbsoluteTimeGetCurrent() - start;
+
+		start = CFAbsoluteTimeGetCurrent();
+		for (NSUInteger i = 0; i < iterations; i++) {
+			@autoreleasepool {
+				MIKMIDIFileParserTestsSequenceLoadedByAudioToolbox(data);
+			}
+		}
+		CFAbsoluteTime audioToolboxLoadingTime = CFAbsoluteTimeGetCurrent() - start;
+
+		double megabytes = (double)[data length] * iterations / 1000000.0;
+		NSLog(@"%@: MIKMIDIFileParser: %.1f MB/s, %.0f events/s. MIKMIDISequence: %.1f MB/s, %.0f events/s. AudioToolbox: %.1f MB/s, %.0f events/s.", name,
+			  megabytes / parsingTime, numberOfEvents / parsingTime,
+			  megabytes / loadingTime, numberOfEvents / loadingTime,
+			  megabytes / audioToolboxLoadingTime, numberOfEvents / audioToolboxLoadingTime);
+		XCTAssertGreaterThan(numberOfEvents, 0);
+	}
+}
+
+- (void)testConcurrentLoadingMatchesSequentialLoading
+{
+	NSData *data = MIKMIDIFileParserTestsSyntheticFileData(24, 500);
+	MIKMIDIFileParser *sequentialParser = [MIKMIDIFileParser parserWithData:data error:NULL];
+	sequentialParser.maximumConcurrentTrackDecodes = 1;
+	MIKMIDIFileParser *concurrentParser = [MIKMIDIFileParser parserWithData:data error:NULL];
+	concurrentParser.maximumConcurrentTrackDecodes = 8;
+
+	NSError *error = nil;
+	MIKMIDISequence *sequence = [MIKMIDISequence sequenceWithFileParser:sequentialParser error:&error];
+	XCTAssertNotNil(sequence, @"Loading sequence failed with error %@", error);
+	MIKMIDISequence *concurrentlyLoadedSequence = [MIKMIDISequence sequenceWithFileParser:concurrentParser error:&error];
+	XCTAssertNotNil(concurrentlyLoadedSequence, @"Loading sequence concurrently failed with error %@", error);
+
+	XCTAssertEqual([concurrentlyLoadedSequence.tracks count], 24);
+	XCTAssertEqual([concurrentlyLoadedSequence.tracks count], [sequence.tracks count]);
+	for (NSUInteger i = 0; i < MIN([sequence.tracks count], [concurrentlyLoadedSequence.tracks count]); i++) {
+		XCTAssertEqualObjects([concurrentlyLoadedSequence.tracks[i] events], [sequence.tracks[i] events], @"Events of track %lu differ.", (unsigned long)i);
+	}
+	XCTAssertEqualObjects(concurrentlyLoadedSequence.tempoTrack.events, sequence.tempoTrack.events);
+}
+
+- (void)testConcurrentLoadingScaling
+{
+	// Roughly the size of a long orchestral score
+	NSData *data = MIKMIDIFileParserTestsSyntheticFileData(64, 20000);
+	CFAbsoluteTime sequentialLoadingTime = 0;
+	for (NSUInteger numberOfThreads = 1; numberOfThreads <= 16; numberOfThreads *= 2) {
+		CFAbsoluteTime loadingTime = DBL_MAX;
+		for (NSUInteger i = 0; i < 3; i++) {
+			@autoreleasepool {
+				CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+				MIKMIDIFileParser *parser = [MIKMIDIFileParser parserWithData:data error:NULL];
+				parser.maximumConcurrentTrackDecodes = numberOfThreads;
+				XCTAssertNotNil([MIKMIDISequence sequenceWithFileParser:parser error:NULL]);
+				loadingTime = MIN(loadingTime, CFAbsoluteTimeGetCurrent() - start);
+			}
+		}
+		if (numberOfThreads == 1) sequentialLoadingTime = loadingTime;
+		NSLog(@"Loading %.1f MB with %lu thread(s): %.1f ms, %.2fx speedup (%lu active cores).", [data length] / 1000000.0, (unsigned long)numberOfThreads,
+			  loadingTime * 1000, sequentialLoadingTime / loadingTime, (unsigned long)[[NSProcessInfo processInfo] activeProcessorCount]);
+	}
+}
+
+- (void)testLazyLoadingMatchesLoading
+{
+	NSData *data = MIKMIDIFileParserTestsSyntheticFileData(4, 300);
+	NSError *error = nil;
+	MIKMIDISequence *sequence = [MIKMIDISequence sequenceWithFileParser:[MIKMIDIFileParser parserWithData:data error:NULL] error:&error];
+	XCTAssertNotNil(sequence, @"Loading sequence failed with error %@", error);
+	MIKMIDIFileParser *parser = [MIKMIDIFileParser parserWithData:data error:NULL];
+	MIKMIDISequence *lazySequence = [MIKMIDISequence sequenceWithFileParser:parser loadingTracksLazily:YES error:&error];
+	XCTAssertNotNil(lazySequence, @"Loading sequence lazily failed with error %@", error);
+
+	XCTAssertEqual([lazySequence.tracks count], [sequence.tracks count]);
+	XCTAssertEqualWithAccuracy(lazySequence.length, sequence.length, 0.0001);
+	XCTAssertEqualObjects(lazySequence.tempoEvents, sequence.tempoEvents);
+	for (NSUInteger i = 0; i < MIN([sequence.tracks count], [lazySequence.tracks count]); i++) {
+		MIKMIDITrack *track = sequence.tracks[i];
+		MIKMIDITrack *lazyTrack = lazySequence.tracks[i];
+		XCTAssertFalse(lazyTrack.areEventsLoaded);
+		XCTAssertEqualObjects(lazyTrack.channels, track.channels);
+		XCTAssertEqual(lazyTrack.numberOfEvents, track.numberOfEvents);
+		XCTAssertEqualWithAccuracy(lazyTrack.length, track.length, 0.0001);
+		XCTAssertFalse(lazyTrack.areEventsLoaded, @"Reading a track's summary shouldn't load its events.");
+
+		MIKMIDIFileTrackSummary *summary = [parser summaryOfTrackAtIndex:i + 1 error:&error];
+		XCTAssertNotNil(summary, @"Summarizing track failed with error %@", error);
+		NSArray *pitches = [track.notes valueForKey:@"note"];
+		XCTAssertEqual(summary.numberOfNotes, [track.notes count]);
+		XCTAssertEqual(summary.lowestNote, [[pitches valueForKeyPath:@"@min.unsignedCharValue"] unsignedCharValue]);
+		XCTAssertEqual(summary.highestNote, [[pitches valueForKeyPath:@"@max.unsignedCharValue"] unsignedCharValue]);
+
+		XCTAssertEqualObjects(lazyTrack.events, track.events, @"Events of track %lu differ.", (unsigned long)i);
+		XCTAssertTrue(lazyTrack.areEventsLoaded);
+	}
+}
+
+- (void)testStreamingMatchesLoading
+{
+	NSData *data = MIKMIDIFileParserTestsSyntheticFileData(3, 100);
+	NSURL *fileURL = [[NSURL fileURLWithPath:NSTemporaryDirectory()] URLByAppendingPathComponent:[[NSUUID UUID] UUIDString]];
+	XCTAssertTrue([data writeToURL:fileURL atomically:NO]);
+	NSError *error = nil;
+	MIKMIDISequence *sequence = [MIKMIDISequence sequenceWithFileParser:[MIKMIDIFileParser parserWithData:data error:NULL] error:&error];
+	XCTAssertNotNil(sequence, @"Loading sequence failed with error %@", error);
+	MIKMIDIFileStreamer *streamer = [[MIKMIDIFileStreamer alloc] initWithFileAtURL:fileURL windowLength:8 error:&error];
+	XCTAssertNotNil(streamer, @"Creating streamer failed with error %@", error);
+
+	XCTAssertEqual([streamer.sequence.tracks count], [sequence.tracks count]);
+	XCTAssertEqualWithAccuracy(streamer.sequence.length, sequence.length, 0.0001);
+	XCTAssertEqualObjects(streamer.sequence.tempoEvents, sequence.tempoEvents);
+	for (NSNumber *timeStamp in @[@0, @20, @95, @0]) {
+		XCTAssertTrue([streamer moveWindowToTimeStamp:[timeStamp doubleValue] error:&error], @"Moving window failed with error %@", error);
+		MusicTimeStamp windowStart = floor([timeStamp doubleValue] / 8) * 8;
+		for (NSUInteger i = 0; i < [sequence.tracks count]; i++) {
+			NSArray *expectedEvents = [sequence.tracks[i] eventsFromTimeStamp:windowStart toTimeStamp:windowStart + 15.999];
+			XCTAssertEqualObjects([streamer.sequence.tracks[i] events], expectedEvents, @"Events of track %lu around %@ differ.", (unsigned long)i, timeStamp);
+		}
+	}
+	[[NSFileManager defaultManager] removeItemAtURL:fileURL error:NULL];
+}
+
+- (void)testStreamingAcrossLongGaps
+{
+	// Two notes, with the longest delta time a file can have between them
+	UInt8 bytes[] = { 'M', 'T', 'h', 'd', 0, 0, 0, 6, 0, 1, 0, 2, 0x01, 0xE0,
+		'M', 'T', 'r', 'k', 0, 0, 0, 11,
+		0x00, 0xFF, 0x51, 0x03, 0x07, 0xA1, 0x20,
+		0x00, 0xFF, 0x2F, 0x00,
+		'M', 'T', 'r', 'k', 0, 0, 0, 22,
+		0x00, 0x90, 0x3C, 0x64,
+		0x83, 0x60, 0x3C, 0x00,
+		0xFF, 0xFF, 0xFF, 0x7F, 0x3E, 0x64,
+		0x83, 0x60, 0x3E, 0x00,
+		0x00, 0xFF, 0x2F, 0x00 };
+	NSData *data = [NSData dataWithBytes:bytes length:sizeof(bytes)];
+	NSURL *fileURL = [[NSURL fileURLWithPath:NSTemporaryDirectory()] URLByAppendingPathComponent:[[NSUUID UUID] UUIDString]];
+	XCTAssertTrue([data writeToURL:fileURL atomically:NO]);
+	NSError *error = nil;
+	MIKMIDISequence *sequence = [MIKMIDISequence sequenceWithFileParser:[MIKMIDIFileParser parserWithData:data error:NULL] error:&error];
+	XCTAssertNotNil(sequence, @"Loading sequence failed with error %@", error);
+	MIKMIDIFileStreamer *streamer = [[MIKMIDIFileStreamer alloc] initWithFileAtURL:fileURL windowLength:1 error:&error];
+	XCTAssertNotNil(streamer, @"Creating streamer failed with error %@", error);
+
+	MusicTimeStamp lastNoteTimeStamp = (480.0 + 0x0FFFFFFF) / 480.0;
+	for (NSNumber *timeStamp in @[@0, @100, @(lastNoteTimeStamp), @0]) {
+		XCTAssertTrue([streamer moveWindowToTimeStamp:[timeStamp doubleValue] error:&error], @"Moving window failed with error %@", error);
+		MusicTimeStamp windowStart = floor([timeStamp doubleValue]);
+		for (NSUInteger i = 0; i < [sequence.tracks count]; i++) {
+			NSArray *expectedEvents = [sequence.tracks[i] eventsFromTimeStamp:windowStart toTimeStamp:windowStart + 1.999];
+			XCTAssertEqualObjects([streamer.sequence.tracks[i] events], expectedEvents, @"Events of track %lu around %@ differ.", (unsigned long)i, timeStamp);
+		}
+	}
+	XCTAssertEqual([[streamer.sequence.tracks[0] events] count], 1, @"The window at the start should only hold the first note.");
+	[[NSFileManager defaultManager] removeItemAtURL:fileURL error:NULL];
+}
+
+- (void)testStreamingOverlappingNotesAcrossSeekPoints
+{
+	// Two notes on the same key, the second starting at beat 2 while the first still sounds, so the first note off
+	// ends the first note even when reading starts from the seek point at the second
+	UInt8 bytes[] = { 'M', 'T', 'h', 'd', 0, 0, 0, 6, 0, 1, 0, 2, 0x01, 0xE0,
+		'M', 'T', 'r', 'k', 0, 0, 0, 11,
+		0x00, 0xFF, 0x51, 0x03, 0x07, 0xA1, 0x20,
+		0x00, 0xFF, 0x2F, 0x00,
+		'M', 'T', 'r', 'k', 0, 0, 0, 23,
+		0x00, 0x90, 0x3C, 0x64,
+		0x87, 0x40, 0x90, 0x3C, 0x64,
+		0x81, 0x70, 0x80, 0x3C, 0x40,
+		0x81, 0x70, 0x80, 0x3C, 0x40,
+		0x00, 0xFF, 0x2F, 0x00 };
+	NSData *data = [NSData dataWithBytes:bytes length:sizeof(bytes)];
+	NSURL *fileURL = [[NSURL fileURLWithPath:NSTemporaryDirectory()] URLByAppendingPathComponent:[[NSUUID UUID] UUIDString]];
+	XCTAssertTrue([data writeToURL:fileURL atomically:NO]);
+	NSError *error = nil;
+	MIKMIDISequence *sequence = [MIKMIDISequence sequenceWithFileParser:[MIKMIDIFileParser parserWithData:data error:NULL] error:&error];
+	XCTAssertNotNil(sequence, @"Loading sequence failed with error %@", error);
+	MIKMIDIFileStreamer *streamer = [[MIKMIDIFileStreamer alloc] initWithFileAtURL:fileURL windowLength:1 error:&error];
+	XCTAssertNotNil(streamer, @"Creating streamer failed with error %@", error);
+
+	for (NSNumber *timeStamp in @[@0, @2, @1, @3, @0]) {
+		XCTAssertTrue([streamer moveWindowToTimeStamp:[timeStamp doubleValue] error:&error], @"Moving window failed with error %@", error);
+		MusicTimeStamp windowStart = floor([timeStamp doubleValue]);
+		for (NSUInteger i = 0; i < [sequence.tracks count]; i++) {
+			NSArray *expectedEvents = [sequence.tracks[i] eventsFromTimeStamp:windowStart toTimeStamp:windowStart + 1.999];
+			XCTAssertEqualObjects([streamer.sequence.tracks[i] events], expectedEvents, @"Events of track %lu around %@ differ.", (unsigned long)i, timeStamp);
+		}
+	}
+
+	XCTAssertTrue([streamer moveWindowToTimeStamp:2 error:&error], @"Moving window failed with error %@", error);
+	MIKMIDINoteEvent *secondNote = [[streamer.sequence.tracks[0] events] firstObject];
+	XCTAssertEqualWithAccuracy(secondNote.duration, 1.0, 0.001, @"The second note should end at the second note off.");
+	[[NSFileManager defaultManager] removeItemAtURL:fileURL error:NULL];
+}
+
+- (void)testChannelSplittingMatchesAudioToolbox
+{
+	NSData *data = MIKMIDIFileParserTestsSyntheticFormat0FileData(6, 600);
+	NSError *error = nil;
+	MIKMIDISequence *sequence = [MIKMIDISequence sequenceWithData:data convertMIDIChannelsToTracks:YES error:&error];
+	XCTAssertNotNil(sequence, @"Loading sequence failed with error %@", error);
+	MIKMIDISequence *audioToolboxSequence = MIKMIDIFileParserTestsSequenceLoadedByAudioToolboxWithFlags(data, kMusicSequenceLoadSMF_ChannelsToTracks);
+	XCTAssertNotNil(audioToolboxSequence);
+
+	// A track for each channel, and one for the track name
+	XCTAssertEqual([sequence.tracks count], 7);
+	XCTAssertEqual([sequence.tracks count], [audioToolboxSequence.tracks count]);
+	for (NSUInteger i = 0; i < MIN([sequence.tracks count], [audioToolboxSequence.tracks count]) - 1; i++) {
+		XCTAssertEqualObjects([sequence.tracks[i] channels], [NSIndexSet indexSetWithIndex:i]);
+		XCTAssertEqualObjects([sequence.tracks[i] events], [audioToolboxSequence.tracks[i] events], @"Events of track %lu differ.", (unsigned long)i);
+	}
+	XCTAssertEqualObjects([[sequence.tracks lastObject] name], @"Song");
+	XCTAssertEqual([sequence.tempoEvents count], 1);
+
+	// Splitting an already loaded sequence gives the same tracks
+	MIKMIDISequence *loadedSequence = [MIKMIDISequence sequenceWithData:data error:NULL];
+	XCTAssertEqual([loadedSequence.tracks count], 1);
+	XCTAssertTrue([loadedSequence convertMIDIChannelsToTracksWithError:&error], @"Splitting channels failed with error %@", error);
+	XCTAssertEqual([loadedSequence.tracks count], [sequence.tracks count]);
+	for (NSUInteger i = 0; i < MIN([sequence.tracks count], [loadedSequence.tracks count]); i++) {
+		XCTAssertEqualObjects([loadedSequence.tracks[i] events], [sequence.tracks[i] events], @"Events of track %lu differ.", (unsigned long)i);
+	}
+}
+
+- (void)testChannelSplittingPerformance
+{
+	NSData *data = MIKMIDIFileParserTestsSyntheticFormat0FileData(16, 200000);
+	NSUInteger iterations = 5;
+	CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+	for (NSUInteger i = 0; i < iterations; i++) {
+		@autoreleasepool {
+			XCTAssertNotNil([MIKMIDISequence sequenceWithData:data convertMIDIChannelsToTracks:YES error:NULL]);
+		}
+	}
+	CFAbsoluteTime loadingTime = (CFAbsoluteTimeGetCurrent() - start) / iterations;
+
+	start = CFAbsoluteTimeGetCurrent();
+	for (NSUInteger i = 0; i < iterations; i++) {
+		@autoreleasepool {
+			MIKMIDISequence *sequence = MIKMIDIFileParserTestsSequenceLoadedByAudioToolboxWithFlags(data, kMusicSequenceLoadSMF_ChannelsToTracks);
+			for (MIKMIDITrack *track in sequence.tracks) [track events];
+		}
+	}
+	CFAbsoluteTime audioToolboxLoadingTime = (CFAbsoluteTimeGetCurrent() - start) / iterations;
+
+	MIKMIDISequence *sequence = [MIKMIDISequence sequenceWithData:data error:NULL];
+	start = CFAbsoluteTimeGetCurrent();
+	XCTAssertTrue([sequence convertMIDIChannelsToTracksWithError:NULL]);
+	CFAbsoluteTime splittingTime = CFAbsoluteTimeGetCurrent() - start;
+
+	NSLog(@"Splitting a %.1f MB format 0 file into 16 channels: MIKMIDISequence: %.1f ms. AudioToolbox: %.1f ms. Splitting a loaded sequence: %.1f ms.",
+		  [data length] / 1000000.0, loadingTime * 1000, audioToolboxLoadingTime * 1000, splittingTime * 1000);
+}
+
+- (void)testLoadingPerformance
+{
+	NSData *data = MIKMIDIFileParserTestsSyntheticFileData(16, 20000);
+	[self measureBlock:^{
+		[MIKMIDISequence sequenceWithData:data error:NULL];
+	}];
+}
+
+@end
@@ -0,0 +1,116 @@
+//
+//  MIKMIDIFileWriterTests.m
+//  MIKMIDI
+//
+//  Created by Mixed In Key on 10/18/26.
+//  Copyright (c) 2026 Mixed In Key. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import <XCTest/XCTest.h>
+#import <MIKMIDI/MIKMIDI.h>
+
+@interface MIKMIDIFileWriterTests : XCTestCase
+
+@end
+
+@implementation MIKMIDIFileWriterTests
+
+- (void)testWritingParsedEvents
+{
+	// Written the way MIKMIDIFileWriter writes files, so writing its events back out must give the same bytes
+	UInt8 bytes[] = { 'M', 'T', 'h', 'd', 0, 0, 0, 6, 0, 0, 0, 1, 0, 96,
+		'M', 'T', 'r', 'k', 0, 0, 0, 54,
+		0x00, 0xFF, 0x03, 0x04, 'T', 'e', 's', 't',	// Track name
+		0x00, 0xFF, 0x51, 0x03, 0x07, 0xA1, 0x20,	// 120 bpm
+		0x00, 0x90, 0x3C, 0x64,						// Note on
+		0x00, 0x3E, 0x50,							// Running status note on
+		0x60, 0x3C, 0x00,							// Running status note off, a beat later
+		0x00, 0x80, 0x3E, 0x40,						// Note off with a release velocity
+		0x00, 0xB0, 0x07, 0x7F,						// Control change
+		0x00, 0xC0, 0x05,							// Program change
+		0x00, 0xF0, 0x03, 0x7E, 0x7F, 0xF7,			// System exclusive, which cancels running status
+		0x00, 0x90, 0x40, 0x50,						// Note on
+		0x81, 0x40, 0x40, 0x00,						// Running status note off, two beats later
+		0x00, 0xFF, 0x2F, 0x00 };					// End of track
+	NSData *data = [NSData dataWithBytes:bytes length:sizeof(bytes)];
+	NSError *error = nil;
+	MIKMIDIFileParser *parser = [MIKMIDIFileParser parserWithData:data error:&error];
+	XCTAssertNotNil(parser, @"Creating a parser failed with error %@", error);
+
+	NSMutableData *writtenData = [NSMutableData data];
+	MIKMIDIFileWriter *writer = [[MIKMIDIFileWriter alloc] initWithMutableData:writtenData format:parser.format ticksPerQuarterNote:parser.ticksPerQuarterNote];
+	XCTAssertTrue([writer beginTrackWithError:&error], @"Beginning a track failed with error %@", error);
+	BOOL success = [parser enumerateEventsInTrackAtIndex:0 usingBlock:^(MusicTimeStamp timeStamp, MusicEventType eventType, const void *eventData, UInt32 dataSize, BOOL *stop) {
+		XCTAssertTrue([writer writeEventWithTimeStamp:timeStamp eventType:eventType data:eventData dataSize:dataSize error:NULL]);
+	} error:&error];
+	XCTAssertTrue(success, @"Parsing failed with error %@", error);
+	XCTAssertTrue([writer endTrackWithError:&error], @"Ending a track failed with error %@", error);
+	XCTAssertTrue([writer finishWithError:&error], @"Finishing the file failed with error %@", error);
+
+	XCTAssertEqual(writer.numberOfTracks, 1);
+	XCTAssertEqualObjects(writtenData, data, @"Writing parsed events didn't reproduce the file.");
+}
+
+- (void)testWritingEventsOutOfOrder
+{
+	MIKMIDIFileWriter *writer = [[MIKMIDIFileWriter alloc] initWithMutableData:[NSMutableData data] format:MIKMIDIFileFormatSingleTrack ticksPerQuarterNote:480];
+	MIDIChannelMessage message = { .status = 0xB0, .data1 = 7, .data2 = 100 };
+	NSError *error = nil;
+	XCTAssertFalse([writer writeEventWithTimeStamp:0 eventType:kMusicEventType_MIDIChannelMessage data:&message dataSize:sizeof(message) error:&error], @"Writing an event outside of a track should fail.");
+	XCTAssertTrue([writer beginTrackWithError:NULL]);
+	XCTAssertTrue([writer writeEventWithTimeStamp:2 eventType:kMusicEventType_MIDIChannelMessage data:&message dataSize:sizeof(message) error:NULL]);
+	XCTAssertFalse([writer writeEventWithTimeStamp:1 eventType:kMusicEventType_MIDIChannelMessage data:&message dataSize:sizeof(message) error:&error], @"Writing events out of order should fail.");
+	XCTAssertNotNil(error);
+}
+
+- (void)testSequenceRoundTrip
+{
+	NSBundle *bundle = [NSBundle bundleForClass:[self class]];
+	NSData *data = [NSData dataWithContentsOfURL:[bundle URLForResource:@"bach" withExtension:@"mid"]];
+	NSError *error = nil;
+	MIKMIDISequence *sequence = [MIKMIDISequence sequenceWithData:data error:&error];
+	XCTAssertNotNil(sequence, @"Loading sequence failed with error %@", error);
+
+	NSData *writtenData = sequence.dataValue;
+	MIKMIDISequence *reloadedSequence = [MIKMIDISequence sequenceWithData:writtenData error:&error];
+	XCTAssertNotNil(reloadedSequence, @"Reloading sequence failed with error %@", error);
+	XCTAssertEqual([reloadedSequence.tracks count], [sequence.tracks count]);
+	for (NSUInteger i = 0; i < MIN([sequence.tracks count], [reloadedSequence.tracks count]); i++) {
+		XCTAssertEqualObjects([reloadedSequence.tracks[i] events], [sequence.tracks[i] events], @"Events of track %lu differ.", (unsigned long)i);
+	}
+	XCTAssertEqualObjects(reloadedSequence.timeSignatureEvents, sequence.timeSignatureEvents);
+	XCTAssertEqual([reloadedSequence.tempoEvents count], [sequence.tempoEvents count]);
+	XCTAssertEqualObjects(reloadedSequence.dataValue, writtenData, @"Writing a sequence read from a written file didn't reproduce the file.");
+
+	// AudioToolbox reads the written file the same way
+	MusicSequence musicSequence;
+	XCTAssertEqual(NewMusicSequence(&musicSequence), noErr);
+	XCTAssertEqual(MusicSequenceFileLoadData(musicSequence, (__bridge CFDataRef)writtenData, kMusicSequenceFile_MIDIType, 0), noErr);
+	MIKMIDISequence *audioToolboxSequence = [MIKMIDISequence sequenceWithMusicSequence:musicSequence error:NULL];
+	XCTAssertEqualObjects([[audioToolboxSequence.tracks lastObject] notes], [[sequence.tracks lastObject] notes]);
+}
+
+- (void)testWritingToURL
+{
+	MIKMIDISequence *sequence = [MIKMIDISequence sequence];
+	MIKMIDITrack *track = [sequence addTrackWithError:NULL];
+	for (NSUInteger i = 0; i < 1000; i++) {
+		[track addEvent:[MIKMIDINoteEvent noteEventWithTimeStamp:i * 0.25 note:(60 + i % 12) velocity:100 duration:1 channel:(i % 4)]];
+	}
+	[sequence setOverallTempo:132];
+
+	NSURL *fileURL = [[NSURL fileURLWithPath:NSTemporaryDirectory()] URLByAppendingPathComponent:[[NSUUID UUID] UUIDString]];
+	fileURL = [fileURL URLByAppendingPathExtension:@"mid"];
+	NSError *error = nil;
+	XCTAssertTrue([sequence writeToURL:fileURL error:&error], @"Writing sequence failed with error %@", error);
+	XCTAssertEqualObjects([NSData dataWithContentsOfURL:fileURL], sequence.dataValue);
+
+	MIKMIDISequence *savedSequence = [MIKMIDISequence sequenceWithFileAtURL:fileURL error:&error];
+	XCTAssertNotNil(savedSequence, @"Reading the written file failed with error %@", error);
+	XCTAssertEqualObjects([[savedSequence.tracks firstObject] notes], track.notes);
+	XCTAssertEqualWithAccuracy([(MIKMIDITempoEvent *)[savedSequence.tempoEvents firstObject] bpm], 132, 0.001);
+	[[NSFileManager defaultManager] removeItemAtURL:fileURL error:NULL];
+}
+
+@end
@@ -139,11 +139,120 @@ static void *MIKMIDISequenceTestsKVOContext = &MIKMIDISequenceTestsKVOContext;
 	XCTAssertTrue([self.receivedNotificationKeyPaths containsObject:@"durationInSeconds"], @"KVO notification for durationInSeconds failed after removing longest child track.");
 }
 
+- (void)testLengthFollowsLongestTrack
+{
+	MIKMIDITrack *firstTrack = [self.sequence addTrackWithError:NULL];
+	MIKMIDITrack *secondTrack = [self.sequence addTrackWithError:NULL];
+	self.sequence.length = MIKMIDISequenceLongestTrackLength;
+
+	MIKMIDINoteEvent *longNote = [MIKMIDINoteEvent noteEventWithTimeStamp:10 note:60 velocity:127 duration:20 channel:0];
+	MIKMIDINoteEvent *lateNote = [MIKMIDINoteEvent noteEventWithTimeStamp:25 note:60 velocity:127 duration:1 channel:0];
+	[firstTrack addEvent:longNote];
+	[firstTrack addEvent:lateNote];
+	[secondTrack addEvent:[MIKMIDINoteEvent noteEventWithTimeStamp:12 note:60 velocity:127 duration:4 channel:0]];
+	XCTAssertEqual(firstTrack.length, 30, @"Track length should be the end of its longest note, not its last note.");
+	XCTAssertEqual(self.sequence.length, 30);
+
+	[firstTrack removeEvent:longNote];
+	XCTAssertEqual(firstTrack.length, 26, @"Track length was not updated after removing the event that ended last.");
+	XCTAssertEqual(self.sequence.length, 26);
+
+	secondTrack.offset = 20;
+	XCTAssertEqual(self.sequence.length, 36, @"Sequence length was not updated after changing a track's offset.");
+
+	[self.sequence removeTrack:secondTrack];
+	XCTAssertEqual(self.sequence.length, 26, @"Sequence length was not updated after removing the longest track.");
+}
+
 - (void)testSetTimeSignature
 {
 	[self.sequence setTimeSignature:MIKMIDITimeSignatureMake(2, 4) atTimeStamp:0];
 }
 
+- (void)testLazilySynchronizedMusicSequence
+{
+	self.sequence.synchronizesMusicSequenceLazily = YES;
+	MIKMIDITrack *track = [self.sequence addTrackWithError:NULL];
+	XCTAssertNotNil(track, @"Creating an MIKMIDITrack failed.");
+
+	NSMutableArray *events = [NSMutableArray array];
+	for (NSUInteger i = 0; i < 100; i++) {
+		[events addObject:[MIKMIDINoteEvent noteEventWithTimeStamp:i * 0.5 note:(60 + i % 12) velocity:100 duration:0.5 channel:0]];
+	}
+	[track addEvents:events];
+	[track removeEvents:[events subarrayWithRange:NSMakeRange(10, 10)]];
+	XCTAssertTrue([track moveEventsFromStartingTimeStamp:40 toEndingTimeStamp:kMusicTimeStamp_EndOfTrack byAmount:4]);
+	XCTAssertEqual([track.notes count], 90);
+
+	// Round trip through a MIDI file, which is written from the MusicSequence
+	MIKMIDISequence *savedSequence = [MIKMIDISequence sequenceWithData:self.sequence.dataValue error:NULL];
+	XCTAssertNotNil(savedSequence);
+	NSArray *savedNotes = [[savedSequence.tracks firstObject] notes];
+	XCTAssertEqualObjects([savedNotes valueForKey:@"timeStamp"], [track.notes valueForKey:@"timeStamp"], @"MusicSequence was not brought up to date before saving.");
+	XCTAssertEqualObjects([savedNotes valueForKey:@"note"], [track.notes valueForKey:@"note"], @"MusicSequence was not brought up to date before saving.");
+}
+
+- (void)testCacheRoundTrip
+{
+	NSBundle *bundle = [NSBundle bundleForClass:[self class]];
+	MIKMIDISequence *sequence = [MIKMIDISequence sequenceWithFileAtURL:[bundle URLForResource:@"bach" withExtension:@"mid"] error:NULL];
+	MIKMIDITrack *track = sequence.tracks[1];
+	track.offset = 2;
+	track.muted = YES;
+	sequence.length = 100;
+
+	NSURL *cacheURL = [[NSURL fileURLWithPath:NSTemporaryDirectory()] URLByAppendingPathComponent:[[NSUUID UUID] UUIDString]];
+	NSError *error = nil;
+	XCTAssertTrue([sequence writeCacheToURL:cacheURL error:&error], @"Writing the cache failed with error %@", error);
+	MIKMIDISequence *cachedSequence = [MIKMIDISequence sequenceWithCacheAtURL:cacheURL error:&error];
+	XCTAssertNotNil(cachedSequence, @"Reading the cache failed with error %@", error);
+
+	XCTAssertEqual([cachedSequence.tracks count], [sequence.tracks count]);
+	XCTAssertEqualObjects(cachedSequence.tempoTrack.events, sequence.tempoTrack.events);
+	[sequence.tracks enumerateObjectsUsingBlock:^(MIKMIDITrack *originalTrack, NSUInteger idx, BOOL *stop) {
+		XCTAssertEqualObjects([cachedSequence.tracks[idx] events], originalTrack.events);
+	}];
+	XCTAssertEqual([cachedSequence.tracks[1] offset], 2);
+	XCTAssertTrue([cachedSequence.tracks[1] isMuted]);
+	XCTAssertEqual(cachedSequence.length, 100);
+	XCTAssertEqual([cachedSequence.tracks[1] timeResolution], [track timeResolution]);
+
+	// Editing a cached track copies the edited events out of the cache
+	MIKMIDITrack *cachedTrack = cachedSequence.tracks[1];
+	NSUInteger numberOfEvents = [cachedTrack.events count];
+	[cachedTrack addEvent:[MIKMIDINoteEvent noteEventWithTimeStamp:0.25 note:60 velocity:100 duration:1 channel:0]];
+	XCTAssertEqual([cachedTrack.events count], numberOfEvents + 1);
+	XCTAssertEqual([[cachedSequence.tracks[2] events] count], [[sequence.tracks[2] events] count]);
+
+	XCTAssertTrue([[NSData dataWithBytes:"MIKC" length:4] writeToURL:cacheURL atomically:NO]);
+	XCTAssertNil([MIKMIDISequence sequenceWithCacheAtURL:cacheURL error:&error], @"Reading a truncated cache should fail.");
+	XCTAssertEqual(error.code, MIKMIDISequenceCacheReadingFailedErrorCode);
+	[[NSFileManager defaultManager] removeItemAtURL:cacheURL error:NULL];
+}
+
+- (void)testCacheLoadingPerformance
+{
+	NSBundle *bundle = [NSBundle bundleForClass:[self class]];
+	NSURL *fileURL = [bundle URLForResource:@"Parallax-Loader" withExtension:@"mid"];
+	NSURL *cacheURL = [[NSURL fileURLWithPath:NSTemporaryDirectory()] URLByAppendingPathComponent:[[NSUUID UUID] UUIDString]];
+	XCTAssertTrue([[MIKMIDISequence sequenceWithFileAtURL:fileURL error:NULL] writeCacheToURL:cacheURL error:NULL]);
+
+	NSUInteger numberOfLoads = 100;
+	CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+	for (NSUInteger i = 0; i < numberOfLoads; i++) {
+		[MIKMIDISequence sequenceWithFileAtURL:fileURL error:NULL];
+	}
+	CFAbsoluteTime fileLoadingTime = (CFAbsoluteTimeGetCurrent() - start) / numberOfLoads;
+
+	start = CFAbsoluteTimeGetCurrent();
+	for (NSUInteger i = 0; i < numberOfLoads; i++) {
+		XCTAssertNotNil([MIKMIDISequence sequenceWithCacheAtURL:cacheURL error:NULL]);
+	}
+	CFAbsoluteTime cacheLoadingTime = (CFAbsoluteTimeGetCurrent() - start) / numberOfLoads;
+	NSLog(@"Loading from the MIDI file: %.2f ms. Loading from the cache: %.2f ms.", fileLoadingTime * 1000, cacheLoadingTime * 1000);
+	[[NSFileManager defaultManager] removeItemAtURL:cacheURL error:NULL];
+}
+
 #pragma mark - KVO
 
 - (void)observeValueForKeyPath:(NSString *)keyPath ofObject:(id)object change:(NSDictionary *)change context:(void *)context
@@ -157,4 +266,110 @@ static void *MIKMIDISequenceTestsKVOContext = &MIKMIDISequenceTestsKVOContext;
 	}
 }
 
+- (void)testConcatenatingSequences
+{
+	MIKMIDISequence *first = [MIKMIDISequence sequence];
+	[first setTempo:90 atTimeStamp:0];
+	MIKMIDITrack *firstTrack = [first addTrackWithError:NULL];
+	[firstTrack addEvent:[MIKMIDINoteEvent noteEventWithTimeStamp:0 note:60 velocity:100 duration:1 channel:0]];
+	[firstTrack addEvent:[MIKMIDINoteEvent noteEventWithTimeStamp:3 note:62 velocity:100 duration:1 channel:0]];
+	first.length = 6;
+
+	MIKMIDISequence *second = [MIKMIDISequence sequence];
+	[[second addTrackWithError:NULL] addEvent:[MIKMIDINoteEvent noteEventWithTimeStamp:0.5 note:64 velocity:100 duration:1 channel:0]];
+	[[second addTrackWithError:NULL] addEvent:[MIKMIDINoteEvent noteEventWithTimeStamp:1 note:36 velocity:100 duration:2 channel:9]];
+
+	NSError *error = nil;
+	MIKMIDISequence *medley = [MIKMIDISequence sequenceByConcatenatingSequences:@[first, second] matchingTracksBy:MIKMIDISequenceTrackMatchingIndex error:&error];
+	XCTAssertNotNil(medley, @"Concatenating failed with error %@", error);
+	XCTAssertEqual([medley.tracks count], 2);
+	XCTAssertEqualObjects([[medley.tracks[0] notes] valueForKey:@"timeStamp"], (@[@0, @3, @6.5]));
+	XCTAssertEqualObjects([[medley.tracks[1] notes] valueForKey:@"timeStamp"], (@[@7]));
+	XCTAssertEqual(medley.length, 9);
+
+	// The second sequence doesn't set a tempo, so it goes back to the default instead of carrying on at 90 bpm
+	XCTAssertEqualWithAccuracy([medley tempoAtTimeStamp:5], 90, 0.001);
+	XCTAssertEqualWithAccuracy([medley tempoAtTimeStamp:7], 120, 0.001);
+	XCTAssertEqual([medley timeSignatureAtTimeStamp:7].numerator, 4);
+
+	medley = [MIKMIDISequence sequenceByConcatenatingSequences:@[first, second] matchingTracksBy:MIKMIDISequenceTrackMatchingNone error:&error];
+	XCTAssertEqual([medley.tracks count], 3);
+}
+
+- (void)testOverlayingSequences
+{
+	MIKMIDISequence *first = [MIKMIDISequence sequence];
+	[first setTempo:100 atTimeStamp:0];
+	MIKMIDITrack *firstTrack = [first addTrackWithError:NULL];
+	[firstTrack addEvent:[MIKMIDINoteEvent noteEventWithTimeStamp:0 note:60 velocity:100 duration:1 channel:0]];
+	[firstTrack addEvent:[MIKMIDINoteEvent noteEventWithTimeStamp:1 note:62 velocity:100 duration:1 channel:0]];
+
+	MIKMIDISequence *second = [MIKMIDISequence sequence];
+	[second setTempo:140 atTimeStamp:0];
+	[[second addTrackWithError:NULL] addEvent:[MIKMIDINoteEvent noteEventWithTimeStamp:1 note:36 velocity:100 duration:1 channel:9]];
+	MIKMIDITrack *secondTrack = [second addTrackWithError:NULL];
+	[secondTrack addEvent:[MIKMIDINoteEvent noteEventWithTimeStamp:0 note:60 velocity:100 duration:1 channel:0]];
+	[secondTrack addEvent:[MIKMIDINoteEvent noteEventWithTimeStamp:0.5 note:67 velocity:100 duration:3 channel:0]];
+
+	NSError *error = nil;
+	MIKMIDISequence *stems = [MIKMIDISequence sequenceByOverlayingSequences:@[first, second] matchingTracksBy:MIKMIDISequenceTrackMatchingChannels error:&error];
+	XCTAssertNotNil(stems, @"Overlaying failed with error %@", error);
+	XCTAssertEqual([stems.tracks count], 2);
+
+	// The note both sequences have on channel 0 is only included once
+	XCTAssertEqualObjects([[stems.tracks[0] notes] valueForKey:@"note"], (@[@60, @67, @62]));
+	XCTAssertEqualObjects([[stems.tracks[1] notes] valueForKey:@"note"], (@[@36]));
+	XCTAssertEqualWithAccuracy([stems tempoAtTimeStamp:0], 100, 0.001);
+	XCTAssertEqual(stems.length, 3.5);
+}
+
+- (void)testMergingTracksWithOffsets
+{
+	MIKMIDISequence *first = [MIKMIDISequence sequence];
+	[[first addTrackWithError:NULL] addEvent:[MIKMIDINoteEvent noteEventWithTimeStamp:0 note:60 velocity:100 duration:1 channel:0]];
+
+	MIKMIDISequence *second = [MIKMIDISequence sequence];
+	MIKMIDITrack *secondTrack = [second addTrackWithError:NULL];
+	[secondTrack addEvent:[MIKMIDINoteEvent noteEventWithTimeStamp:0 note:62 velocity:100 duration:1 channel:0]];
+	secondTrack.offset = 2;
+
+	NSError *error = nil;
+	MIKMIDISequence *stems = [MIKMIDISequence sequenceByOverlayingSequences:@[first, second] matchingTracksBy:MIKMIDISequenceTrackMatchingChannels error:&error];
+	XCTAssertNotNil(stems, @"Overlaying failed with error %@", error);
+	XCTAssertEqual([stems.tracks count], 1);
+
+	// Each source track's offset is applied to its own events, rather than the first track's to all of them
+	MIKMIDITrack *track = stems.tracks[0];
+	XCTAssertEqualObjects([[track notes] valueForKey:@"timeStamp"], (@[@0, @2]));
+	XCTAssertEqual(track.offset, 0);
+}
+
+- (void)testMergingPerformance
+{
+	NSBundle *bundle = [NSBundle bundleForClass:[self class]];
+	MIKMIDISequence *sequence = [MIKMIDISequence sequenceWithFileAtURL:[bundle URLForResource:@"Parallax-Loader" withExtension:@"mid"] error:NULL];
+	NSMutableArray *sequences = [NSMutableArray array];
+	for (NSUInteger i = 0; i < 50; i++) {
+		[sequences addObject:sequence];
+	}
+	NSUInteger numberOfEvents = 0;
+	for (MIKMIDITrack *track in sequence.tracks) {
+		numberOfEvents += track.numberOfEvents;
+	}
+
+	CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+	MIKMIDISequence *medley = [MIKMIDISequence sequenceByConcatenatingSequences:sequences matchingTracksBy:MIKMIDISequenceTrackMatchingIndex error:NULL];
+	CFAbsoluteTime concatenatingTime = CFAbsoluteTimeGetCurrent() - start;
+	XCTAssertEqual([medley.tracks count], [sequence.tracks count]);
+	XCTAssertEqualWithAccuracy(medley.length, sequence.length * [sequences count], 0.001);
+
+	start = CFAbsoluteTimeGetCurrent();
+	MIKMIDISequence *stems = [MIKMIDISequence sequenceByOverlayingSequences:sequences matchingTracksBy:MIKMIDISequenceTrackMatchingNone error:NULL];
+	CFAbsoluteTime overlayingTime = CFAbsoluteTimeGetCurrent() - start;
+	XCTAssertEqual([stems.tracks count], [sequence.tracks count] * [sequences count]);
+
+	NSLog(@"Merging %lu copies of a sequence with %lu events: concatenating %.1f ms, overlaying %.1f ms.", (unsigned long)[sequences count],
+		  (unsigned long)numberOfEvents, concatenatingTime * 1000, overlayingTime * 1000);
+}
+
 @end
@@ -10,6 +10,40 @@
 #import <XCTest/XCTest.h>
 #import <MIKMIDI/MIKMIDI.h>
 
+// Generates a note on every beat, and records the commands scheduled for it
+@interface MIKMIDISequencerTestsEventSource : NSObject <MIKMIDIEventSource, MIKMIDICommandScheduler>
+@property (nonatomic, strong) NSMutableArray *requestedRanges;
+@property (nonatomic, strong) NSMutableArray *scheduledCommands;
+@end
+
+@implementation MIKMIDISequencerTestsEventSource
+
+- (instancetype)init
+{
+	if (self = [super init]) {
+		_requestedRanges = [NSMutableArray array];
+		_scheduledCommands = [NSMutableArray array];
+	}
+	return self;
+}
+
+- (NSArray *)eventsFromTimeStamp:(MusicTimeStamp)fromTimeStamp toTimeStamp:(MusicTimeStamp)toTimeStamp
+{
+	@synchronized(self) { [self.requestedRanges addObject:@[@(fromTimeStamp), @(toTimeStamp)]]; }
+	NSMutableArray *events = [NSMutableArray array];
+	for (MusicTimeStamp timeStamp = ceil(fromTimeStamp); timeStamp < toTimeStamp; timeStamp++) {
+		[events addObject:[MIKMIDINoteEvent noteEventWithTimeStamp:timeStamp note:60 velocity:100 duration:0.5 channel:0]];
+	}
+	return events;
+}
+
+- (void)scheduleMIDICommands:(NSArray *)commands
+{
+	@synchronized(self) { [self.scheduledCommands addObjectsFromArray:commands]; }
+}
+
+@end
+
 @interface MIKMIDISequencerTests : XCTestCase
 
 @property (nonatomic, strong) MIKMIDISequencer *sequencer;
@@ -45,4 +79,130 @@
 	}
 }
 
+- (void)testEventSources
+{
+	MIKMIDISequencerTestsEventSource *eventSource = [[MIKMIDISequencerTestsEventSource alloc] init];
+	MIKMIDIAcceleratedTimeSource *timeSource = [[MIKMIDIAcceleratedTimeSource alloc] initWithRate:10];
+	self.sequencer.timeSource = timeSource;
+	self.sequencer.overriddenSequenceLength = 8;
+	self.sequencer.maximumLookAheadInterval = 1.0;
+	[self.sequencer setCommandScheduler:eventSource forEventSource:eventSource];
+	XCTAssertEqualObjects(self.sequencer.eventSources, @[eventSource]);
+	XCTAssertEqual([self.sequencer commandSchedulerForEventSource:eventSource], eventSource);
+
+	// 8 beats at 120 bpm take 4 seconds, or 0.4 seconds at 10 times real time
+	[self.sequencer startPlayback];
+	[[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:1.0]];
+	XCTAssertFalse(self.sequencer.isPlaying);
+
+	@synchronized(eventSource) {
+		NSArray *noteOns = [eventSource.scheduledCommands filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"self isKindOfClass: %@", [MIKMIDINoteOnCommand class]]];
+		XCTAssertEqual([noteOns count], 8, @"Every beat's note should be played once.");
+		MusicTimeStamp timeStamp = 0;
+		for (NSArray *range in eventSource.requestedRanges) {
+			XCTAssertEqualWithAccuracy([range[0] doubleValue], timeStamp, 0.000001, @"Requested ranges should follow on from each other.");
+			timeStamp = [range[1] doubleValue];
+		}
+		XCTAssertEqualWithAccuracy(timeStamp, 8, 0.000001);
+	}
+
+	[self.sequencer setCommandScheduler:nil forEventSource:eventSource];
+	XCTAssertEqual([self.sequencer.eventSources count], 0);
+	XCTAssertNil([self.sequencer commandSchedulerForEventSource:eventSource]);
+}
+
+- (void)testGaplessNextSequence
+{
+	MIKMIDISequencerTestsEventSource *scheduler = [[MIKMIDISequencerTestsEventSource alloc] init];
+	NSMutableArray *sequences = [NSMutableArray array];
+	for (NSUInteger i = 0; i < 2; i++) {
+		MIKMIDISequence *sequence = [MIKMIDISequence sequence];
+		MIKMIDITrack *track = [sequence addTrackWithError:NULL];
+		[track addEvent:[MIKMIDINoteEvent noteEventWithTimeStamp:0 note:60 + i velocity:100 duration:0.5 channel:0]];
+		sequence.length = 4;
+		[sequences addObject:sequence];
+	}
+	self.sequencer.createSynthsIfNeeded = NO;
+	self.sequencer.sequence = sequences[0];
+	self.sequencer.nextSequence = sequences[1];
+	for (MIKMIDISequence *sequence in sequences) {
+		[self.sequencer setCommandScheduler:scheduler forTrack:sequence.tracks[0]];
+	}
+	self.sequencer.timeSource = [[MIKMIDIAcceleratedTimeSource alloc] initWithRate:10];
+	self.sequencer.maximumLookAheadInterval = 1.0;
+	XCTAssertEqual([self.sequencer commandSchedulerForTrack:[sequences[1] tracks][0]], scheduler, @"The next sequence's command schedulers should be kept.");
+
+	[self expectationForNotification:MIKMIDISequencerWillStartNextSequenceNotification object:self.sequencer handler:nil];
+	[self.sequencer startPlayback];
+	[self waitForExpectationsWithTimeout:2.0 handler:nil];
+	[[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:1.0]];
+	XCTAssertFalse(self.sequencer.isPlaying);
+	XCTAssertEqual(self.sequencer.sequence, sequences[1]);
+	XCTAssertNil(self.sequencer.nextSequence);
+
+	// The second sequence starts exactly 4 beats at 120 bpm, or 2 seconds, after the first
+	@synchronized(scheduler) {
+		NSArray *noteOns = [scheduler.scheduledCommands filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"self isKindOfClass: %@", [MIKMIDINoteOnCommand class]]];
+		XCTAssertEqual([noteOns count], 2);
+		if ([noteOns count] == 2) {
+			Float64 interval = (Float64)[noteOns[1] midiTimestamp] - (Float64)[noteOns[0] midiTimestamp];
+			XCTAssertEqualWithAccuracy(interval, MIKMIDIClockMIDITimeStampsPerTimeInterval(2.0), MIKMIDIClockMIDITimeStampsPerTimeInterval(0.0001));
+		}
+	}
+}
+
+- (void)testChasingNotes
+{
+	MIKMIDISequencerTestsEventSource *scheduler = [[MIKMIDISequencerTestsEventSource alloc] init];
+	MIKMIDISequence *sequence = [MIKMIDISequence sequence];
+	MIKMIDITrack *track = [sequence addTrackWithError:NULL];
+	[track addEvent:[MIKMIDINoteEvent noteEventWithTimeStamp:0 note:60 velocity:100 duration:4 channel:0]];
+	[track addEvent:[MIKMIDINoteEvent noteEventWithTimeStamp:1 note:62 velocity:100 duration:0.5 channel:0]]; // Over before playback starts
+	sequence.length = 8;
+
+	MIKMIDIManualTimeSource *timeSource = [[MIKMIDIManualTimeSource alloc] init];
+	self.sequencer.createSynthsIfNeeded = NO;
+	self.sequencer.sequence = sequence;
+	[self.sequencer setCommandScheduler:scheduler forTrack:track];
+	self.sequencer.timeSource = timeSource;
+	self.sequencer.maximumLookAheadInterval = 0.1;
+	self.sequencer.chaseNotes = YES;
+
+	// Start at beat 2, in the middle of the held note, then play on past its end at beat 4 (one second later at 120 bpm)
+	MIDITimeStamp startMIDITimeStamp = timeSource.currentMIDITimeStamp;
+	[self.sequencer startPlaybackAtTimeStamp:2 MIDITimeStamp:startMIDITimeStamp];
+	for (NSUInteger i = 0; i < 30; i++) {
+		[timeSource advanceByTimeInterval:0.05];
+		[[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.06]];
+	}
+	[self.sequencer stop];
+
+	MIDITimeStamp accuracy = MIKMIDIClockMIDITimeStampsPerTimeInterval(0.0001);
+	@synchronized(scheduler) {
+		NSArray *noteOns = [scheduler.scheduledCommands filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"self isKindOfClass: %@", [MIKMIDINoteOnCommand class]]];
+		NSArray *noteOffs = [scheduler.scheduledCommands filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"self isKindOfClass: %@", [MIKMIDINoteOffCommand class]]];
+		XCTAssertEqual([noteOns count], 1, @"Only the held note should be chased.");
+		XCTAssertEqual([noteOffs count], 1);
+		if ([noteOns count] == 1 && [noteOffs count] == 1) {
+			XCTAssertEqual([noteOns[0] note], 60);
+			XCTAssertEqualWithAccuracy((Float64)[noteOns[0] midiTimestamp], (Float64)startMIDITimeStamp, accuracy, @"The chased note should start when playback starts.");
+			XCTAssertEqual([noteOffs[0] note], 60);
+			XCTAssertEqualWithAccuracy((Float64)[noteOffs[0] midiTimestamp], (Float64)(startMIDITimeStamp + MIKMIDIClockMIDITimeStampsPerTimeInterval(1.0)), accuracy, @"The chased note should end when it would have without chasing.");
+		}
+		[scheduler.scheduledCommands removeAllObjects];
+	}
+
+	// Without chasing, nothing is played until the next note on
+	self.sequencer.chaseNotes = NO;
+	[self.sequencer startPlaybackAtTimeStamp:2 MIDITimeStamp:timeSource.currentMIDITimeStamp];
+	for (NSUInteger i = 0; i < 10; i++) {
+		[timeSource advanceByTimeInterval:0.05];
+		[[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.06]];
+	}
+	[self.sequencer stop];
+	@synchronized(scheduler) {
+		XCTAssertEqual([scheduler.scheduledCommands count], 0, @"No notes should be chased when chaseNotes is NO.");
+	}
+}
+
 @end
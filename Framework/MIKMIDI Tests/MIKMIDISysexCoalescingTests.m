@@ -124,4 +124,36 @@
 	}];
 }
 
+- (void)testNonTerminatedSysexTimeoutUsesTimeSource
+{
+	XCTestExpectation *expectation = [self expectationWithDescription:@"Non 0xF7 terminated sysex message is received once the time source passes the time-out."];
+	
+	MIKMIDIManualTimeSource *timeSource = [[MIKMIDIManualTimeSource alloc] init];
+	_debugInputPort.timeSource = timeSource;
+	
+	NSRange rangeBeforeEOT = NSMakeRange(0, _validSysexData.length - 1);
+	MIDIPacket testPacket = [self packetWithData:[_validSysexData subdataWithRange:rangeBeforeEOT]];
+	
+	MIDIPacketList pktList = {0};
+	pktList.numPackets = 1;
+	pktList.packet[0] = testPacket;
+	
+	__block BOOL receivedCommands = NO;
+	[_debugInputPort interpretPacketList:&pktList handleResultingCommands:^(NSArray<MIKMIDICommand *> *commands) {
+		receivedCommands = YES;
+		XCTAssert([self->_validSysexData isEqualToData:commands.firstObject.data], @"Coalescing of non-terminated sysex message should have ended after time-out");
+		[expectation fulfill];
+	}];
+	
+	[timeSource advanceByTimeInterval:_debugInputPort.sysexTimeOut / 2.0];
+	[[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.05]];
+	XCTAssertFalse(receivedCommands, @"Sysex should not time out before the time source passes the time-out");
+	
+	[timeSource advanceByTimeInterval:_debugInputPort.sysexTimeOut];
+	
+	// Much shorter than the time-out itself, since the manual time source doesn't wait on the host clock
+	[self waitForExpectationsWithTimeout:0.5 handler:nil];
+	_debugInputPort.timeSource = nil;
+}
+
 @end
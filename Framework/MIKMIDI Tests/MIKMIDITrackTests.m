@@ -10,10 +10,18 @@
 #import <XCTest/XCTest.h>
 #import <MIKMIDI/MIKMIDI.h>
 
+#define kNumberOfBenchmarkEvents	1000000
+#define kNumberOfClearBenchmarkEvents	500000
+#define kNumberOfEventsToClear	10000
+#define kShiftBenchmarkLengthInBeats	3600 // 30 minutes at 120 BPM
+#define kShiftBenchmarkEventsPerBeat	32
+#define kNumberOfBatchEditBenchmarkEvents	100000
+
 @interface MIKMIDITrackTests : XCTestCase
 
 @property BOOL eventsChangeNotificationReceived;
 @property BOOL notesChangeNotificationReceived;
+@property NSUInteger numberOfEventsChangeNotifications;
 
 @property (nonatomic, strong) MIKMIDISequence *defaultSequence;
 @property (nonatomic, strong) MIKMIDITrack *defaultTrack;
@@ -24,6 +32,11 @@
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wdeprecated-declarations"
 
+static void MIKMIDITrackTestsCountNotes(MusicTimeStamp timeStamp, MIKMIDIEventType eventType, const void *data, UInt32 length, void *context, BOOL *stop)
+{
+	if (eventType == MIKMIDIEventTypeMIDINoteMessage) (*(NSUInteger *)context)++;
+}
+
 @implementation MIKMIDITrackTests
 
 - (void)setUp
@@ -42,6 +55,7 @@
 	self.receivedKVONotificationKeyPath = nil;
 	self.eventsChangeNotificationReceived = NO;
 	self.notesChangeNotificationReceived = NO;
+	self.numberOfEventsChangeNotifications = 0;
 	
 	[self.defaultTrack removeObserver:self forKeyPath:@"events"];
 	[self.defaultTrack removeObserver:self forKeyPath:@"notes"];
@@ -124,6 +138,99 @@
 	XCTAssertEqual(onlyNotes.count, firstNotesTrack.events.count-2);
 }
 
+- (void)testGettingEventsByTypeAndControllerNumber
+{
+	NSMutableArray *modulationEvents = [NSMutableArray array];
+	for (NSUInteger i = 0; i < 100; i++) {
+		[self.defaultTrack addEvent:[MIKMIDINoteEvent noteEventWithTimeStamp:i note:60 velocity:100 duration:0.5 channel:0]];
+
+		MIKMutableMIDIControlChangeEvent *modulation = [[MIKMutableMIDIControlChangeEvent alloc] init];
+		modulation.timeStamp = i + 0.25;
+		modulation.controllerNumber = 1;
+		modulation.controllerValue = i;
+		[self.defaultTrack addEvent:modulation];
+		[modulationEvents addObject:modulation];
+
+		MIKMutableMIDIControlChangeEvent *volume = [[MIKMutableMIDIControlChangeEvent alloc] init];
+		volume.timeStamp = i + 0.5;
+		volume.controllerNumber = 7;
+		volume.controllerValue = 100;
+		[self.defaultTrack addEvent:volume];
+	}
+	[self.defaultTrack addEvent:[MIKMIDITempoEvent tempoEventWithTimeStamp:0 tempo:120]];
+
+	XCTAssertEqual([self.defaultTrack.notes count], 100);
+	XCTAssertEqual([[self.defaultTrack notesFromTimeStamp:10 toTimeStamp:19] count], 10);
+	XCTAssertEqual([[self.defaultTrack eventsOfClass:[MIKMIDITempoEvent class] fromTimeStamp:0 toTimeStamp:kMusicTimeStamp_EndOfTrack] count], 1);
+	XCTAssertEqual([[self.defaultTrack eventsOfType:MIKMIDIEventTypeMIDIControlChangeMessage fromTimeStamp:0 toTimeStamp:kMusicTimeStamp_EndOfTrack] count], 200);
+	XCTAssertEqual([[self.defaultTrack eventsOfType:MIKMIDIEventTypeMetaTimeSignature fromTimeStamp:0 toTimeStamp:kMusicTimeStamp_EndOfTrack] count], 0);
+
+	NSArray *modulationLane = [self.defaultTrack controlChangeEventsForControllerNumber:1 fromTimeStamp:0 toTimeStamp:kMusicTimeStamp_EndOfTrack];
+	XCTAssertEqualObjects(modulationLane, modulationEvents, @"Controller number query returned unexpected events.");
+
+	[self.defaultTrack removeEvent:modulationEvents[50]];
+	modulationLane = [self.defaultTrack controlChangeEventsForControllerNumber:1 fromTimeStamp:50 toTimeStamp:51];
+	XCTAssertEqual([modulationLane count], 0, @"Removed event is still returned by controller number query.");
+}
+
+- (void)testGettingSoundingNotes
+{
+	// Enough notes to fill several chunks, so sounding notes have to be found across them
+	NSMutableArray *shortNotes = [NSMutableArray array];
+	for (NSUInteger i = 0; i < 5000; i++) {
+		MIKMIDINoteEvent *note = [MIKMIDINoteEvent noteEventWithTimeStamp:i * 0.25 note:60 velocity:100 duration:0.125 channel:0];
+		[shortNotes addObject:note];
+	}
+	[self.defaultTrack addEvents:shortNotes];
+	MIKMIDINoteEvent *pedalNote = [MIKMIDINoteEvent noteEventWithTimeStamp:10 note:36 velocity:100 duration:1000 channel:0];
+	[self.defaultTrack addEvent:pedalNote];
+	[self.defaultTrack addEvent:[MIKMIDITempoEvent tempoEventWithTimeStamp:0 tempo:120]];
+
+	NSArray *soundingNotes = [self.defaultTrack notesSoundingAtTimeStamp:500.1];
+	XCTAssertEqualObjects(soundingNotes, (@[pedalNote, shortNotes[2000]]), @"Unexpected notes sounding at time stamp.");
+	soundingNotes = [self.defaultTrack notesSoundingAtTimeStamp:500.2];
+	XCTAssertEqualObjects(soundingNotes, @[pedalNote], @"Note that already ended is returned as sounding.");
+
+	soundingNotes = [self.defaultTrack notesSoundingFromTimeStamp:500.1 toTimeStamp:500.5];
+	XCTAssertEqualObjects(soundingNotes, (@[pedalNote, shortNotes[2000], shortNotes[2001], shortNotes[2002]]), @"Unexpected notes sounding in range.");
+
+	[self.defaultTrack removeEvent:pedalNote];
+	XCTAssertEqualObjects([self.defaultTrack notesSoundingAtTimeStamp:500.2], @[], @"Removed note is still returned as sounding.");
+	MIKMIDINoteEvent *longNote = [MIKMIDINoteEvent noteEventWithTimeStamp:100 note:48 velocity:100 duration:401 channel:0];
+	[self.defaultTrack addEvent:longNote];
+	XCTAssertEqualObjects([self.defaultTrack notesSoundingAtTimeStamp:500.2], @[longNote], @"Added note isn't returned as sounding.");
+}
+
+- (void)testEventsAreStoredByValue
+{
+	MIKMutableMIDINoteEvent *note = [[MIKMutableMIDINoteEvent alloc] init];
+	note.timeStamp = 1;
+	note.note = 60;
+	note.velocity = 100;
+	note.duration = 2;
+	[self.defaultTrack addEvent:note];
+	MIKMIDINoteEvent *storedNote = [note copy];
+	note.note = 72;
+	XCTAssertEqualObjects(self.defaultTrack.events, @[storedNote], @"Changing an event after adding it changed the track.");
+
+	// Notes with a release velocity, and meta events, don't fit in a compact record
+	MIKMutableMIDINoteEvent *releasedNote = [storedNote mutableCopy];
+	releasedNote.timeStamp = 2;
+	releasedNote.releaseVelocity = 64;
+	releasedNote.duration = 4;
+	MIKMIDIMetaTextEvent *text = [[MIKMIDIMetaTextEvent alloc] initWithString:@"Verse" timeStamp:2];
+	[self.defaultTrack addEvent:releasedNote];
+	[self.defaultTrack addEvent:text];
+	NSArray *expectedEvents = @[storedNote, releasedNote, text];
+	XCTAssertEqualObjects(self.defaultTrack.events, expectedEvents, @"Track didn't return the events that were added.");
+	XCTAssertEqual([self.defaultTrack.events[1] class], [MIKMIDINoteEvent class]);
+	XCTAssertEqualObjects([(MIKMIDIMetaTextEvent *)self.defaultTrack.events[2] string], @"Verse");
+	XCTAssertEqual(self.defaultTrack.length, 6, @"Track length didn't include the note with a release velocity.");
+
+	[self.defaultTrack removeEvent:releasedNote];
+	XCTAssertEqualObjects(self.defaultTrack.events, (@[storedNote, text]), @"Removing an event by value failed.");
+}
+
 #pragma mark - Moving Events
 
 - (void)testMovingSingleEvent
@@ -261,7 +368,28 @@
 	NSArray *expectedNewEvents = @[event1, expectedEvent3AfterMove, expectedEvent4AfterMove, event2, event5];
 	NSArray *eventsAfterMoving = self.defaultTrack.events;
 	XCTAssertEqualObjects(eventsAfterMoving, expectedNewEvents, @"Moving an event in MIKMIDITrack failed.");
-	
+
+}
+
+- (void)testMovingEventOntoEqualEvent
+{
+	MIKMIDIEvent *event1 = [MIKMIDINoteEvent noteEventWithTimeStamp:1 note:60 velocity:127 duration:1 channel:0];
+	MIKMIDIEvent *event2 = [MIKMIDINoteEvent noteEventWithTimeStamp:2 note:62 velocity:127 duration:1 channel:0];
+	MIKMIDIEvent *event3 = [MIKMIDINoteEvent noteEventWithTimeStamp:3 note:60 velocity:127 duration:1 channel:0];
+	MIKMIDIEvent *event4 = [MIKMIDINoteEvent noteEventWithTimeStamp:5 note:62 velocity:127 duration:1 channel:0];
+	[self.defaultTrack addEvents:@[event1, event2, event3, event4]];
+
+	// Move event 3 past event 2, onto event 1, then event 4 onto event 2 without passing any other events
+	[self.defaultTrack moveEventsFromStartingTimeStamp:3 toEndingTimeStamp:3 byAmount:-2];
+	XCTAssertEqualObjects(self.defaultTrack.events, (@[event1, event2, event4]), @"Moving an event onto an equal event should leave only one of them.");
+	[self.defaultTrack moveEventsFromStartingTimeStamp:5 toEndingTimeStamp:5 byAmount:-3];
+	XCTAssertEqualObjects(self.defaultTrack.events, (@[event1, event2]), @"Moving an event onto an equal event should leave only one of them.");
+	XCTAssertEqual(self.defaultTrack.numberOfEvents, 2);
+
+	[self.defaultTrack removeEvent:event1];
+	[self.defaultTrack removeEvent:event2];
+	XCTAssertEqual([self.defaultTrack.events count], 0, @"Removing events that were moved onto equal events left copies behind.");
+	XCTAssertEqual(self.defaultTrack.numberOfEvents, 0);
 }
 
 #pragma mark - Clearing Events
@@ -888,6 +1016,288 @@
 	[self.defaultTrack removeObserver:self forKeyPath:@"doesLoop"];
 }
 
+#pragma mark - Ordering and Performance
+
+- (void)testEventsAreSortedByTimeStamp
+{
+	NSMutableArray *events = [NSMutableArray array];
+	for (NSUInteger i = 0; i < 2000; i++) {
+		MusicTimeStamp timeStamp = (i * 7919) % 1000 * 0.5;
+		[events addObject:[MIKMIDINoteEvent noteEventWithTimeStamp:timeStamp note:(i % 128) velocity:100 duration:1 channel:0]];
+	}
+	for (MIKMIDIEvent *event in events) {
+		[self.defaultTrack addEvent:event];
+	}
+
+	NSArray *trackEvents = self.defaultTrack.events;
+	XCTAssertEqual([trackEvents count], [events count]);
+	for (NSUInteger i = 1; i < [trackEvents count]; i++) {
+		XCTAssertLessThanOrEqual([trackEvents[i-1] timeStamp], [trackEvents[i] timeStamp], @"Track events are not sorted by time stamp.");
+	}
+
+	NSArray *eventsInRange = [self.defaultTrack eventsFromTimeStamp:100 toTimeStamp:200];
+	NSPredicate *inRange = [NSPredicate predicateWithFormat:@"timeStamp >= 100 AND timeStamp <= 200"];
+	XCTAssertEqualObjects(eventsInRange, [trackEvents filteredArrayUsingPredicate:inRange], @"Range query returned unexpected events.");
+}
+
+- (void)testEditingAndQueryingLargeTrackPerformance
+{
+	NSMutableArray *events = [NSMutableArray arrayWithCapacity:kNumberOfBenchmarkEvents];
+	for (NSUInteger i = 0; i < kNumberOfBenchmarkEvents; i++) {
+		[events addObject:[MIKMIDINoteEvent noteEventWithTimeStamp:i * 0.25 note:(i % 128) velocity:100 duration:0.25 channel:0]];
+	}
+	[self.defaultTrack addEvents:events];
+	XCTAssertEqual([self.defaultTrack.events count], kNumberOfBenchmarkEvents);
+
+	__block NSUInteger iteration = 0;
+	[self measureBlock:^{
+		for (NSUInteger i = 0; i < 1000; i++) {
+			NSUInteger index = 1000 + (iteration * 1000 + i) * 7919 % (kNumberOfBenchmarkEvents - 2000);
+			MusicTimeStamp timeStamp = index * 0.25 + 0.125;
+			[self.defaultTrack addEvent:[MIKMIDINoteEvent noteEventWithTimeStamp:timeStamp note:60 velocity:100 duration:0.25 channel:0]];
+			XCTAssertGreaterThanOrEqual([[self.defaultTrack eventsFromTimeStamp:timeStamp - 1 toTimeStamp:timeStamp + 1] count], 9);
+		}
+		iteration++;
+	}];
+}
+
+- (void)testClearingEventsFromLargeTrackPerformance
+{
+	NSMutableArray *events = [NSMutableArray arrayWithCapacity:kNumberOfClearBenchmarkEvents];
+	for (NSUInteger i = 0; i < kNumberOfClearBenchmarkEvents; i++) {
+		[events addObject:[MIKMIDINoteEvent noteEventWithTimeStamp:i * 0.25 note:(i % 128) velocity:100 duration:0.25 channel:0]];
+	}
+	[self.defaultTrack addEvents:events];
+
+	__block NSUInteger iteration = 0;
+	[self measureBlock:^{
+		MusicTimeStamp startTimeStamp = (1 + iteration * 2) * kNumberOfEventsToClear * 0.25;
+		MusicTimeStamp endTimeStamp = startTimeStamp + (kNumberOfEventsToClear - 1) * 0.25;
+		XCTAssertTrue([self.defaultTrack clearEventsFromStartingTimeStamp:startTimeStamp toEndingTimeStamp:endTimeStamp]);
+		iteration++;
+	}];
+
+	XCTAssertEqual([self.defaultTrack.events count], kNumberOfClearBenchmarkEvents - iteration * kNumberOfEventsToClear);
+	XCTAssertEqual([self numberOfEventsInMusicTrack:self.defaultTrack.musicTrack], [self.defaultTrack.events count], @"MusicTrack and MIKMIDITrack events are out of sync after clearing.");
+}
+
+- (void)testInsertingBarsAtStartOfLongTrackPerformance
+{
+	NSUInteger numberOfEvents = kShiftBenchmarkLengthInBeats * kShiftBenchmarkEventsPerBeat;
+	NSMutableArray *events = [NSMutableArray arrayWithCapacity:numberOfEvents];
+	for (NSUInteger i = 0; i < numberOfEvents; i++) {
+		MusicTimeStamp timeStamp = (MusicTimeStamp)i / kShiftBenchmarkEventsPerBeat;
+		[events addObject:[MIKMIDINoteEvent noteEventWithTimeStamp:timeStamp note:(i % 128) velocity:100 duration:0.25 channel:0]];
+	}
+	[self.defaultTrack addEvents:events];
+
+	__block NSUInteger iteration = 0;
+	[self measureBlock:^{
+		// Make room for 4 bars of 4/4 at the start of the track
+		XCTAssertTrue([self.defaultTrack moveEventsFromStartingTimeStamp:0 toEndingTimeStamp:kMusicTimeStamp_EndOfTrack byAmount:16]);
+		iteration++;
+	}];
+
+	NSArray *eventsAfterMoving = self.defaultTrack.events;
+	XCTAssertEqual([eventsAfterMoving count], numberOfEvents);
+	XCTAssertEqual([[eventsAfterMoving firstObject] timeStamp], iteration * 16);
+	XCTAssertEqual([[self.defaultTrack eventsFromTimeStamp:0 toTimeStamp:iteration * 16 - 0.001] count], 0);
+}
+
+#pragma mark - Batch Editing
+
+- (void)testBatchEditsCoalesceNotifications
+{
+	MIKMIDINoteEvent *event1 = [MIKMIDINoteEvent noteEventWithTimeStamp:1 note:60 velocity:127 duration:1 channel:0];
+	MIKMIDINoteEvent *event2 = [MIKMIDINoteEvent noteEventWithTimeStamp:2 note:62 velocity:127 duration:1 channel:0];
+	MIKMIDINoteEvent *event3 = [MIKMIDINoteEvent noteEventWithTimeStamp:8 note:64 velocity:127 duration:1 channel:0];
+	[self.defaultTrack addEvents:@[event1, event2]];
+	self.numberOfEventsChangeNotifications = 0;
+
+	[self.defaultTrack performBatchEdits:^{
+		[self.defaultTrack removeEvent:event1];
+		[self.defaultTrack addEvent:event3];
+		XCTAssertTrue([self.defaultTrack moveEventsFromStartingTimeStamp:2 toEndingTimeStamp:2 byAmount:2]);
+		XCTAssertEqual([self.defaultTrack.events count], 2, @"Edits made during a batch are not visible inside the batch.");
+		XCTAssertEqual(self.numberOfEventsChangeNotifications, 0, @"KVO notification was sent before the batch was committed.");
+	}];
+
+	XCTAssertEqual(self.numberOfEventsChangeNotifications, 1, @"Batch edits did not produce exactly one KVO notification.");
+	NSArray *timeStamps = [self.defaultTrack.events valueForKey:@"timeStamp"];
+	XCTAssertEqualObjects(timeStamps, (@[@4, @8]), @"Batch edits produced unexpected events.");
+	XCTAssertEqual(self.defaultTrack.length, 9);
+	XCTAssertEqual([self numberOfEventsInMusicTrack:self.defaultTrack.musicTrack], 2, @"MusicTrack and MIKMIDITrack events are out of sync after batch edits.");
+}
+
+- (void)testBatchEditsUpdateSequenceLength
+{
+	MIKMIDITrack *otherTrack = [self.defaultSequence addTrack];
+	[self.defaultSequence performBatchEdits:^{
+		[self.defaultTrack addEvent:[MIKMIDINoteEvent noteEventWithTimeStamp:4 note:60 velocity:127 duration:1 channel:0]];
+		[otherTrack addEvent:[MIKMIDINoteEvent noteEventWithTimeStamp:10 note:60 velocity:127 duration:2 channel:0]];
+	}];
+	XCTAssertEqual(self.defaultSequence.length, 12, @"Sequence length was not updated after batch edits.");
+}
+
+- (void)testTransposingLargeTrackInBatchPerformance
+{
+	NSMutableArray *events = [NSMutableArray arrayWithCapacity:kNumberOfBatchEditBenchmarkEvents];
+	for (NSUInteger i = 0; i < kNumberOfBatchEditBenchmarkEvents; i++) {
+		[events addObject:[MIKMIDINoteEvent noteEventWithTimeStamp:i * 0.25 note:(i % 96) velocity:100 duration:0.25 channel:0]];
+	}
+	[self.defaultTrack addEvents:events];
+
+	[self measureBlock:^{
+		// Transpose up an octave and back down again, so each iteration starts with the same track
+		for (NSNumber *interval in @[@12, @-12]) {
+			[self.defaultTrack performBatchEdits:^{
+				for (MIKMIDINoteEvent *note in self.defaultTrack.notes) {
+					MIKMutableMIDINoteEvent *transposedNote = [note mutableCopy];
+					transposedNote.note = (UInt8)(note.note + [interval integerValue]);
+					[self.defaultTrack removeEvent:note];
+					[self.defaultTrack addEvent:transposedNote];
+				}
+			}];
+		}
+	}];
+
+	XCTAssertEqual([self.defaultTrack.notes count], kNumberOfBatchEditBenchmarkEvents);
+	XCTAssertEqual([self numberOfEventsInMusicTrack:self.defaultTrack.musicTrack], kNumberOfBatchEditBenchmarkEvents, @"MusicTrack and MIKMIDITrack events are out of sync after batch edits.");
+}
+
+- (void)testEnumeratingRawEvents
+{
+	[self.defaultTrack addEvent:[MIKMIDINoteEvent noteEventWithTimeStamp:1 note:60 velocity:100 duration:1 channel:0]];
+	[self.defaultTrack addEvent:[MIKMIDIControlChangeEvent controlChangeEventWithTimeStamp:2 controllerNumber:7 controllerValue:100 channel:0]];
+	[self.defaultTrack addEvent:[MIKMIDITempoEvent tempoEventWithTimeStamp:3 tempo:120]];
+	[self.defaultTrack addEvent:[MIKMIDINoteEvent noteEventWithTimeStamp:4 note:62 velocity:100 duration:1 channel:0]];
+
+	NSMutableArray *events = [NSMutableArray array];
+	[self.defaultTrack enumerateRawEventsFromTimeStamp:0 toTimeStamp:kMusicTimeStamp_EndOfTrack usingBlock:^(MusicTimeStamp timeStamp, MIKMIDIEventType eventType, const void *data, UInt32 length, BOOL *stop) {
+		[events addObject:[[MIKMIDIEvent alloc] initWithTimeStamp:timeStamp midiEventType:eventType data:[NSData dataWithBytes:data length:length]]];
+	}];
+	XCTAssertEqualObjects(events, self.defaultTrack.events, @"Raw event data doesn't match the track's events.");
+
+	__block NSUInteger numberOfEnumeratedEvents = 0;
+	[self.defaultTrack enumerateRawEventsFromTimeStamp:2 toTimeStamp:kMusicTimeStamp_EndOfTrack usingBlock:^(MusicTimeStamp timeStamp, MIKMIDIEventType eventType, const void *data, UInt32 length, BOOL *stop) {
+		numberOfEnumeratedEvents++;
+		*stop = (timeStamp >= 3);
+	}];
+	XCTAssertEqual(numberOfEnumeratedEvents, 2, @"Enumeration didn't start at the start time stamp or didn't stop early.");
+
+	NSUInteger numberOfNotes = 0;
+	[self.defaultTrack enumerateRawEventsFromTimeStamp:0 toTimeStamp:3 usingFunction:MIKMIDITrackTestsCountNotes context:&numberOfNotes];
+	XCTAssertEqual(numberOfNotes, 1, @"Enumerating with a function gave unexpected events.");
+}
+
+- (void)testApplyingNoteTransforms
+{
+	MIKMIDIControlChangeEvent *controlChange = [MIKMIDIControlChangeEvent controlChangeEventWithTimeStamp:1 controllerNumber:7 controllerValue:100 channel:0];
+	[self.defaultTrack addEvent:[MIKMIDINoteEvent noteEventWithTimeStamp:0.9 note:60 velocity:64 duration:0.5 channel:0]];
+	[self.defaultTrack addEvent:controlChange];
+	[self.defaultTrack addEvent:[MIKMIDINoteEvent noteEventWithTimeStamp:2.1 note:126 velocity:100 duration:1 channel:0]];
+	self.numberOfEventsChangeNotifications = 0;
+
+	MIKMIDINoteTransform *transform = [MIKMIDINoteTransform transformWithTransforms:@[[MIKMIDINoteTransform quantizeTransformWithGridInterval:1 strength:1 swing:0],
+																					  [MIKMIDINoteTransform transposeTransformWithInterval:12 lowestNote:0 highestNote:127],
+																					  [MIKMIDINoteTransform velocityCurveTransformWithBlock:^UInt8(UInt8 velocity) { return velocity / 2; }]]];
+	[self.defaultTrack applyNoteTransform:transform];
+
+	XCTAssertEqual(self.numberOfEventsChangeNotifications, 1, @"Applying a transform did not produce exactly one KVO notification.");
+	NSArray *expectedNotes = @[[MIKMIDINoteEvent noteEventWithTimeStamp:1 note:72 velocity:32 duration:0.5 channel:0],
+							   [MIKMIDINoteEvent noteEventWithTimeStamp:2 note:127 velocity:50 duration:1 channel:0]];
+	XCTAssertEqualObjects(self.defaultTrack.notes, expectedNotes, @"Transform produced unexpected notes.");
+	XCTAssertEqualObjects([self.defaultTrack eventsOfClass:[MIKMIDIControlChangeEvent class] fromTimeStamp:0 toTimeStamp:kMusicTimeStamp_EndOfTrack], @[controlChange], @"Transform changed an event that isn't a note.");
+	XCTAssertEqual([self numberOfEventsInMusicTrack:self.defaultTrack.musicTrack], 3, @"MusicTrack and MIKMIDITrack events are out of sync after applying a transform.");
+
+	// Quantizing notes onto the same grid line can make them equal, in which case only one is kept
+	[self.defaultTrack addEvent:[MIKMIDINoteEvent noteEventWithTimeStamp:2.2 note:127 velocity:50 duration:1 channel:0]];
+	[self.defaultTrack applyNoteTransform:[MIKMIDINoteTransform quantizeTransformWithGridInterval:1 strength:1 swing:0]];
+	XCTAssertEqualObjects(self.defaultTrack.notes, expectedNotes, @"Transform left duplicate notes in the track.");
+	XCTAssertEqual([self numberOfEventsInMusicTrack:self.defaultTrack.musicTrack], 3, @"MusicTrack and MIKMIDITrack events are out of sync after applying a transform.");
+}
+
+- (void)testApplyingNoteTransformToSequence
+{
+	// Two sequences with the same doubled part on two tracks each
+	MIKMIDISequence *otherSequence = [MIKMIDISequence sequence];
+	[otherSequence addTrack];
+	NSArray *sequences = @[self.defaultSequence, otherSequence];
+	for (MIKMIDISequence *sequence in sequences) {
+		[sequence addTrack];
+		for (MIKMIDITrack *track in sequence.tracks) {
+			for (NSUInteger i = 0; i < 1000; i++) {
+				[track addEvent:[MIKMIDINoteEvent noteEventWithTimeStamp:i * 0.5 note:(i % 96) velocity:100 duration:0.25 channel:0]];
+			}
+		}
+		XCTAssertEqual([sequence.tracks count], 2);
+	}
+
+	MIKMIDINoteTransform *transform = [MIKMIDINoteTransform humanizeTransformWithTimingRange:0.05 velocityRange:10 seed:42];
+	for (MIKMIDISequence *sequence in sequences) {
+		[sequence applyNoteTransform:transform];
+	}
+
+	NSArray *notes = [self.defaultSequence.tracks[0] notes];
+	XCTAssertEqual([notes count], 1000);
+	XCTAssertEqualObjects([otherSequence.tracks[0] notes], notes, @"The same transform applied to the same track gave different results.");
+	XCTAssertEqualObjects([otherSequence.tracks[1] notes], [self.defaultSequence.tracks[1] notes], @"The same transform applied to the same track gave different results.");
+	XCTAssertNotEqualObjects([self.defaultSequence.tracks[1] notes], notes, @"Doubled parts on different tracks were humanized in lockstep.");
+	NSUInteger numberOfMovedNotes = 0;
+	for (MIKMIDINoteEvent *note in notes) {
+		XCTAssertGreaterThanOrEqual(note.velocity, 90);
+		XCTAssertLessThanOrEqual(note.velocity, 110);
+		MusicTimeStamp offset = fabs(note.timeStamp - round(note.timeStamp * 2) / 2);
+		XCTAssertLessThanOrEqual(offset, 0.05);
+		if (offset > 0) numberOfMovedNotes++;
+	}
+	XCTAssertGreaterThan(numberOfMovedNotes, 0, @"Humanizing didn't move any notes.");
+}
+
+- (void)testSnapshotsAndRestoring
+{
+	NSMutableArray *events = [NSMutableArray array];
+	for (NSUInteger i = 0; i < 2000; i++) {
+		[events addObject:[MIKMIDINoteEvent noteEventWithTimeStamp:i * 0.25 note:60 velocity:100 duration:0.25 channel:0]];
+	}
+	[self.defaultTrack addEvents:events];
+
+	MIKMIDITrackSnapshot *snapshot = self.defaultTrack.snapshot;
+	NSArray *originalEvents = self.defaultTrack.events;
+	XCTAssertEqual(snapshot.numberOfEvents, [events count]);
+	XCTAssertEqualObjects(snapshot.events, originalEvents, @"Snapshot events don't match track events.");
+
+	MIKMIDINoteEvent *addedNote = [MIKMIDINoteEvent noteEventWithTimeStamp:100.1 note:72 velocity:100 duration:1 channel:0];
+	[self.defaultTrack addEvent:addedNote];
+	[self.defaultTrack removeEvent:events[10]];
+	XCTAssertEqualObjects(snapshot.events, originalEvents, @"Editing the track changed an earlier snapshot.");
+	XCTAssertNotEqual(self.defaultTrack.snapshot, snapshot, @"A new snapshot was not published after editing the track.");
+	XCTAssertEqualObjects(self.defaultTrack.snapshot.events, self.defaultTrack.events, @"Latest snapshot doesn't match track events.");
+	XCTAssertEqualObjects([self.defaultTrack.snapshot notesSoundingFromTimeStamp:100.5 toTimeStamp:100.5], (@[addedNote, events[402]]));
+
+	self.numberOfEventsChangeNotifications = 0;
+	[self.defaultTrack restoreSnapshot:snapshot];
+	XCTAssertEqual(self.numberOfEventsChangeNotifications, 1, @"Restoring a snapshot did not produce exactly one KVO notification.");
+	XCTAssertEqualObjects(self.defaultTrack.events, originalEvents, @"Restoring a snapshot didn't restore the track's events.");
+	XCTAssertEqual([self numberOfEventsInMusicTrack:self.defaultTrack.musicTrack], [events count], @"MusicTrack and MIKMIDITrack events are out of sync after restoring a snapshot.");
+}
+
+#pragma mark - (MusicTrack Test Helper)
+
+- (NSUInteger)numberOfEventsInMusicTrack:(MusicTrack)musicTrack
+{
+	MusicEventIterator iterator = NULL;
+	XCTAssertEqual(NewMusicEventIterator(musicTrack, &iterator), noErr);
+	NSUInteger numberOfEvents = 0;
+	Boolean hasCurrentEvent = false;
+	while (MusicEventIteratorHasCurrentEvent(iterator, &hasCurrentEvent) == noErr && hasCurrentEvent) {
+		numberOfEvents++;
+		MusicEventIteratorNextEvent(iterator);
+	}
+	DisposeMusicEventIterator(iterator);
+	return numberOfEvents;
+}
+
 #pragma mark - (KVO Test Helper)
 
 - (void)observeValueForKeyPath:(NSString *)keyPath ofObject:(id)object change:(NSDictionary *)change context:(void *)context
@@ -896,6 +1306,7 @@
 	
 	if ([keyPath isEqualToString:@"events"]) {
 		self.eventsChangeNotificationReceived = YES;
+		self.numberOfEventsChangeNotifications++;
 		return;
 	}
 	
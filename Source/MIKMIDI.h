@@ -48,6 +48,12 @@
 // MIDI Sequence/File support
 #import "MIKMIDISequence.h"
 #import "MIKMIDITrack.h"
+#import "MIKMIDITrackSnapshot.h"
+#import "MIKMIDINoteTransform.h"
+#import "MIKMIDIFileParser.h"
+#import "MIKMIDIFileWriter.h"
+#import "MIKMIDIFileIndexer.h"
+#import "MIKMIDIFileStreamer.h"
 
 // MIDI Events
 #import "MIKMIDIEvent.h"
@@ -77,8 +83,10 @@
 
 // Sequencing and Synthesis
 #import "MIKMIDISequencer.h"
+#import "MIKMIDIEventSource.h"
 #import "MIKMIDIMetronome.h"
 #import "MIKMIDIClock.h"
+#import "MIKMIDITimeSource.h"
 #import "MIKMIDIPlayer.h"
 #import "MIKMIDIEndpointSynthesizer.h"
 
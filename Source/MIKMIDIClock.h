@@ -9,6 +9,7 @@
 #import <Foundation/Foundation.h>
 #import <AudioToolbox/AudioToolbox.h>
 #import "MIKMIDICompilerCompatibility.h"
+#import "MIKMIDITimeSource.h"
 
 /**
  *  Returns the number of MIDITimeStamps that would occur during a specified time interval.
@@ -111,6 +112,47 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (MIDITimeStamp)midiTimeStampsPerMusicTimeStamp:(MusicTimeStamp)musicTimeStamp;
 
+/**
+ *  Converts an array of MusicTimeStamps into the corresponding MIDITimeStamps.
+ *
+ *  All of the time stamps are converted against a single snapshot of the clock's
+ *  tempo and timing information, so the results are consistent with each other even
+ *  if the clock is synced from another thread during the call. Time stamps that fall
+ *  within the current tempo segment are converted several at a time using SIMD
+ *  instructions, which makes this considerably faster than calling
+ *  -midiTimeStampForMusicTimeStamp: repeatedly when converting large numbers of
+ *  time stamps.
+ *
+ *  @param midiTimeStamps A buffer with room for at least count MIDITimeStamps that will be
+ *  filled with the converted time stamps.
+ *  @param musicTimeStamps A C array of count MusicTimeStamps to convert.
+ *  @param count The number of time stamps to convert.
+ *
+ *  @note If the clock is not ready every element of midiTimeStamps will be set to 0.
+ *
+ *  @see -midiTimeStampForMusicTimeStamp:
+ *  @see -isReady
+ */
+- (void)getMIDITimeStamps:(MIDITimeStamp *)midiTimeStamps forMusicTimeStamps:(const MusicTimeStamp *)musicTimeStamps count:(NSUInteger)count;
+
+/**
+ *  Converts an array of MIDITimeStamps into the corresponding MusicTimeStamps.
+ *
+ *  This is the inverse of -getMIDITimeStamps:forMusicTimeStamps:count:, and has the same
+ *  consistency and performance characteristics.
+ *
+ *  @param musicTimeStamps A buffer with room for at least count MusicTimeStamps that will be
+ *  filled with the converted time stamps.
+ *  @param midiTimeStamps A C array of count MIDITimeStamps to convert.
+ *  @param count The number of time stamps to convert.
+ *
+ *  @note If the clock is not ready every element of musicTimeStamps will be set to 0.
+ *
+ *  @see -musicTimeStampForMIDITimeStamp:
+ *  @see -isReady
+ */
+- (void)getMusicTimeStamps:(MusicTimeStamp *)musicTimeStamps forMIDITimeStamps:(const MIDITimeStamp *)midiTimeStamps count:(NSUInteger)count;
+
 
 /**
  *  A readonly copy of the clock that remains synced with this instance.
@@ -170,6 +212,17 @@ NS_ASSUME_NONNULL_BEGIN
  */
 @property (readonly, nonatomic) Float64 currentTempo;
 
+/**
+ *  The time source the clock uses to determine the current time when pruning
+ *  historical tempo and timing information.
+ *
+ *  Defaults to the value of MIKMIDIDefaultTimeSource() at the time the clock was created.
+ *  Setting this to nil restores that default. Setting this on a synced clock has no effect.
+ *
+ *  @see MIKMIDITimeSource
+ */
+@property (nonatomic, strong, null_resettable) id<MIKMIDITimeSource> timeSource;
+
 #pragma mark - Deprecated Methods
 
 /**
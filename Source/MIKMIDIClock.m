@@ -10,6 +10,13 @@
 #import "MIKMIDIUtilities.h"
 #import <mach/mach_time.h>
 
+#if __has_include(<simd/simd.h>)
+#import <simd/simd.h>
+#define MIKMIDI_CLOCK_USE_SIMD 1
+#else
+#define MIKMIDI_CLOCK_USE_SIMD 0
+#endif
+
 #if !__has_feature(objc_arc)
 #error MIKMIDIClock.m must be compiled with ARC. Either turn on ARC for the project or set the -fobjc-arc flag for MIKMIDIClock.m in the Build Phases for this target
 #endif
@@ -67,6 +74,7 @@
 {
     if (self = [super init]) {
         if (createQueue) {
+            _timeSource = MIKMIDIDefaultTimeSource();
             NSString *queueLabel = [[[NSBundle mainBundle] bundleIdentifier] stringByAppendingFormat:@".%@.%p", [self class], self];
             dispatch_queue_attr_t attr = DISPATCH_QUEUE_SERIAL;
             
@@ -119,7 +127,7 @@ static void dispatchToClockQueue(MIKMIDIClock *self, void(^block)(void))
                 self->_historicalClockMIDITimeStampsArray = CFArrayCreateMutable(NULL, 0, &kCFTypeArrayCallBacks);
             } else {
                 // Remove clocks old enough to not be needed anymore
-                MIDITimeStamp oldTimeStamp = MIKMIDIGetCurrentTimeStamp() - MIKMIDIClockMIDITimeStampsPerTimeInterval(kDurationToKeepHistoricalClocks);
+                MIDITimeStamp oldTimeStamp = [self->_timeSource currentMIDITimeStamp] - MIKMIDIClockMIDITimeStampsPerTimeInterval(kDurationToKeepHistoricalClocks);
                 
                 CFIndex count = CFArrayGetCount(self->_historicalClockMIDITimeStampsArray);
                 CFMutableArrayRef timeStampsToRemove = CFArrayCreateMutable(NULL, 0, &kCFTypeArrayCallBacks);
@@ -207,18 +215,22 @@ static MusicTimeStamp musicTimeStampForMIDITimeStamp(MIKMIDIClock *self, MIDITim
     
     dispatchToClockQueue(self, ^{
         if (!self->_ready) return;
-        
-        MIDITimeStamp lastSyncedMIDITimeStamp = self->_lastSyncedMIDITimeStamp;
-        if (midiTimeStamp >= lastSyncedMIDITimeStamp) {
-            musicTimeStamp = musicTimeStampForMIDITimeStampWithHistoricalClock(midiTimeStamp, self);
-        } else {
-            musicTimeStamp = musicTimeStampForMIDITimeStampWithHistoricalClock(midiTimeStamp, clockForMIDITimeStamp(self, midiTimeStamp));
-        }
+        musicTimeStamp = musicTimeStampForMIDITimeStampOnClockQueue(self, midiTimeStamp);
     });
     
     return musicTimeStamp;
 }
 
+static MusicTimeStamp musicTimeStampForMIDITimeStampOnClockQueue(MIKMIDIClock *self, MIDITimeStamp midiTimeStamp)
+{
+    MIDITimeStamp lastSyncedMIDITimeStamp = self->_lastSyncedMIDITimeStamp;
+    if (midiTimeStamp >= lastSyncedMIDITimeStamp) {
+        return musicTimeStampForMIDITimeStampWithHistoricalClock(midiTimeStamp, self);
+    } else {
+        return musicTimeStampForMIDITimeStampWithHistoricalClock(midiTimeStamp, clockForMIDITimeStamp(self, midiTimeStamp));
+    }
+}
+
 - (MusicTimeStamp)musicTimeStampForMIDITimeStamp:(MIDITimeStamp)midiTimeStamp
 {
     return musicTimeStampForMIDITimeStamp(self, midiTimeStamp);
@@ -241,24 +253,32 @@ static MIDITimeStamp midiTimeStampForMusicTimeStamp(MIKMIDIClock *self, MusicTim
         
         midiTimeStamp = round(musicTimeStamp * self->_midiTimeStampsPerMusicTimeStamp) + self->_timeStampZero;
         
-        if (midiTimeStamp < self->_lastSyncedMIDITimeStamp && self->_historicalClockMIDITimeStampsArray) {
-            CFIndex historicalClockMIDITimeStampsCount = CFArrayGetCount(self->_historicalClockMIDITimeStampsArray);
-            for (CFIndex i = (historicalClockMIDITimeStampsCount - 1); i >= 0; i--) {
-                const void *midiTimeStampValue = CFArrayGetValueAtIndex(self->_historicalClockMIDITimeStampsArray, i);
-                
-                MIKMIDIClock *clock = (__bridge MIKMIDIClock *)CFDictionaryGetValue(self->_historicalClocks, midiTimeStampValue);
-                MIDITimeStamp historicalMIDITimeStamp = round(musicTimeStamp * clock->_midiTimeStampsPerMusicTimeStamp) + clock->_timeStampZero;
-                if (historicalMIDITimeStamp >= clock->_lastSyncedMIDITimeStamp) {
-                    midiTimeStamp = historicalMIDITimeStamp;
-                    break;
-                }
-            }
+        if (midiTimeStamp < self->_lastSyncedMIDITimeStamp) {
+            midiTimeStamp = midiTimeStampForMusicTimeStampWithHistoricalClocks(self, musicTimeStamp, midiTimeStamp);
         }
     });
     
     return midiTimeStamp;
 }
 
+static MIDITimeStamp midiTimeStampForMusicTimeStampWithHistoricalClocks(MIKMIDIClock *self, MusicTimeStamp musicTimeStamp, MIDITimeStamp midiTimeStamp)
+{
+    if (!self->_historicalClockMIDITimeStampsArray) return midiTimeStamp;
+    
+    CFIndex historicalClockMIDITimeStampsCount = CFArrayGetCount(self->_historicalClockMIDITimeStampsArray);
+    for (CFIndex i = (historicalClockMIDITimeStampsCount - 1); i >= 0; i--) {
+        const void *midiTimeStampValue = CFArrayGetValueAtIndex(self->_historicalClockMIDITimeStampsArray, i);
+        
+        MIKMIDIClock *clock = (__bridge MIKMIDIClock *)CFDictionaryGetValue(self->_historicalClocks, midiTimeStampValue);
+        MIDITimeStamp historicalMIDITimeStamp = round(musicTimeStamp * clock->_midiTimeStampsPerMusicTimeStamp) + clock->_timeStampZero;
+        if (historicalMIDITimeStamp >= clock->_lastSyncedMIDITimeStamp) {
+            return historicalMIDITimeStamp;
+        }
+    }
+    
+    return midiTimeStamp;
+}
+
 - (MIDITimeStamp)midiTimeStampForMusicTimeStamp:(MusicTimeStamp)musicTimeStamp
 {
     return midiTimeStampForMusicTimeStamp(self, musicTimeStamp);
@@ -280,6 +300,97 @@ static MIDITimeStamp midiTimeStampsPerMusicTimeStamp(MIKMIDIClock *self, MusicTi
     return midiTimeStampsPerMusicTimeStamp(self, musicTimeStamp);
 }
 
+#pragma mark - Batch Conversion
+
+static void getMIDITimeStampsForMusicTimeStamps(MIKMIDIClock *self, MIDITimeStamp *midiTimeStamps, const MusicTimeStamp *musicTimeStamps, NSUInteger count)
+{
+    if (!midiTimeStamps || !musicTimeStamps || !count) return;
+    
+    dispatchToClockQueue(self, ^{
+        if (!self->_ready) {
+            memset(midiTimeStamps, 0, count * sizeof(MIDITimeStamp));
+            return;
+        }
+        
+        MusicTimeStamp lastSyncedMusicTimeStamp = self->_lastSyncedMusicTimeStamp;
+        MIDITimeStamp lastSyncedMIDITimeStamp = self->_lastSyncedMIDITimeStamp;
+        Float64 midiTimeStampsPerMusicTimeStamp = self->_midiTimeStampsPerMusicTimeStamp;
+        Float64 timeStampZero = self->_timeStampZero;
+        NSUInteger i = 0;
+        
+        // Convert everything using the current tempo first, four at a time where possible...
+#if MIKMIDI_CLOCK_USE_SIMD
+        for (; i + 4 <= count; i += 4) {
+            simd_double4 musicTimeStampVector;
+            memcpy(&musicTimeStampVector, musicTimeStamps + i, sizeof(musicTimeStampVector));
+            simd_ulong4 midiTimeStampVector = simd_ulong(simd_round(musicTimeStampVector * midiTimeStampsPerMusicTimeStamp) + timeStampZero);
+            memcpy(midiTimeStamps + i, &midiTimeStampVector, sizeof(midiTimeStampVector));
+        }
+#endif
+        for (; i < count; i++) {
+            midiTimeStamps[i] = round(musicTimeStamps[i] * midiTimeStampsPerMusicTimeStamp) + timeStampZero;
+        }
+        
+        // ...then fix up the ones that land on the sync point or belong to an earlier tempo.
+        for (i = 0; i < count; i++) {
+            if (musicTimeStamps[i] == lastSyncedMusicTimeStamp) {
+                midiTimeStamps[i] = lastSyncedMIDITimeStamp;
+            } else if (midiTimeStamps[i] < lastSyncedMIDITimeStamp) {
+                midiTimeStamps[i] = midiTimeStampForMusicTimeStampWithHistoricalClocks(self, musicTimeStamps[i], midiTimeStamps[i]);
+            }
+        }
+    });
+}
+
+- (void)getMIDITimeStamps:(MIDITimeStamp *)midiTimeStamps forMusicTimeStamps:(const MusicTimeStamp *)musicTimeStamps count:(NSUInteger)count
+{
+    getMIDITimeStampsForMusicTimeStamps(self, midiTimeStamps, musicTimeStamps, count);
+}
+
+static void getMusicTimeStampsForMIDITimeStamps(MIKMIDIClock *self, MusicTimeStamp *musicTimeStamps, const MIDITimeStamp *midiTimeStamps, NSUInteger count)
+{
+    if (!musicTimeStamps || !midiTimeStamps || !count) return;
+    
+    dispatchToClockQueue(self, ^{
+        if (!self->_ready) {
+            memset(musicTimeStamps, 0, count * sizeof(MusicTimeStamp));
+            return;
+        }
+        
+        MIDITimeStamp lastSyncedMIDITimeStamp = self->_lastSyncedMIDITimeStamp;
+        MIDITimeStamp timeStampZero = self->_timeStampZero;
+        Float64 musicTimeStampsPerMIDITimeStamp = self->_musicTimeStampsPerMIDITimeStamp;
+        NSUInteger i = 0;
+        
+#if MIKMIDI_CLOCK_USE_SIMD
+        for (; i + 4 <= count; i += 4) {
+            simd_ulong4 midiTimeStampVector;
+            memcpy(&midiTimeStampVector, midiTimeStamps + i, sizeof(midiTimeStampVector));
+            simd_long4 isAtOrAfterZero = (midiTimeStampVector >= timeStampZero);
+            simd_double4 afterZero = simd_double(midiTimeStampVector - timeStampZero) * musicTimeStampsPerMIDITimeStamp;
+            simd_double4 beforeZero = -(simd_double(timeStampZero - midiTimeStampVector) * musicTimeStampsPerMIDITimeStamp);
+            simd_double4 musicTimeStampVector = simd_select(beforeZero, afterZero, isAtOrAfterZero);
+            memcpy(musicTimeStamps + i, &musicTimeStampVector, sizeof(musicTimeStampVector));
+        }
+#endif
+        for (; i < count; i++) {
+            MIDITimeStamp midiTimeStamp = midiTimeStamps[i];
+            musicTimeStamps[i] = (midiTimeStamp >= timeStampZero) ? ((midiTimeStamp - timeStampZero) * musicTimeStampsPerMIDITimeStamp) : -((timeStampZero - midiTimeStamp) * musicTimeStampsPerMIDITimeStamp);
+        }
+        
+        for (i = 0; i < count; i++) {
+            if (midiTimeStamps[i] <= lastSyncedMIDITimeStamp) {
+                musicTimeStamps[i] = musicTimeStampForMIDITimeStampOnClockQueue(self, midiTimeStamps[i]);
+            }
+        }
+    });
+}
+
+- (void)getMusicTimeStamps:(MusicTimeStamp *)musicTimeStamps forMIDITimeStamps:(const MIDITimeStamp *)midiTimeStamps count:(NSUInteger)count
+{
+    getMusicTimeStampsForMIDITimeStamps(self, musicTimeStamps, midiTimeStamps, count);
+}
+
 #pragma mark - Tempo
 
 static Float64 tempoAtMIDITimeStamp(MIKMIDIClock *self, MIDITimeStamp midiTimeStamp)
@@ -351,6 +462,16 @@ static void releaseHistoricalClocks(MIKMIDIClock *self)
     }
 }
 
+#pragma mark - Properties
+
+- (void)setTimeSource:(id<MIKMIDITimeSource>)timeSource
+{
+    if (!timeSource) timeSource = MIKMIDIDefaultTimeSource();
+    dispatchToClockQueue(self, ^{
+        self->_timeSource = timeSource;
+    });
+}
+
 #pragma mark - Synced Clock
 
 - (MIKMIDIClock *)syncedClock
@@ -445,6 +566,24 @@ Float64 MIKMIDIClockMIDITimeStampsPerTimeInterval(NSTimeInterval timeInterval)
         
         MIDITimeStamp midiTimeStamps = midiTimeStampsPerMusicTimeStamp(_masterClock, musicTimeStamp);
         return [invocation setReturnValue:&midiTimeStamps];
+    } else if (selector == @selector(getMIDITimeStamps:forMusicTimeStamps:count:)) {
+        MIDITimeStamp *midiTimeStamps;
+        const MusicTimeStamp *musicTimeStamps;
+        NSUInteger count;
+        [invocation getArgument:&midiTimeStamps atIndex:2];
+        [invocation getArgument:&musicTimeStamps atIndex:3];
+        [invocation getArgument:&count atIndex:4];
+        
+        return getMIDITimeStampsForMusicTimeStamps(_masterClock, midiTimeStamps, musicTimeStamps, count);
+    } else if (selector == @selector(getMusicTimeStamps:forMIDITimeStamps:count:)) {
+        MusicTimeStamp *musicTimeStamps;
+        const MIDITimeStamp *midiTimeStamps;
+        NSUInteger count;
+        [invocation getArgument:&musicTimeStamps atIndex:2];
+        [invocation getArgument:&midiTimeStamps atIndex:3];
+        [invocation getArgument:&count atIndex:4];
+        
+        return getMusicTimeStampsForMIDITimeStamps(_masterClock, musicTimeStamps, midiTimeStamps, count);
     } else if (selector == @selector(syncedClock)) {
         MIKMIDISyncedClockProxy *syncedClock = self;
         return [invocation setReturnValue:&syncedClock];
@@ -453,6 +592,7 @@ Float64 MIKMIDIClockMIDITimeStampsPerTimeInterval(NSTimeInterval timeInterval)
     // Ignored selectors
     if (selector == @selector(syncMusicTimeStamp:withMIDITimeStamp:tempo:)) return;
     if (selector == @selector(unsyncMusicTimeStampsAndTemposFromMIDITimeStamps)) return;
+    if (selector == @selector(setTimeSource:)) return;
     if (selector == @selector(setMusicTimeStamp:withTempo:atMIDITimeStamp:)) return;	// deprecated
     
     // Pass through remaining selectors
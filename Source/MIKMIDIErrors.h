@@ -65,6 +65,24 @@ typedef NS_ENUM(NSInteger, MIKMIDIErrorCode) {
 	 *  instruments.
 	 */
 	MIKMIDISynthesizerDoesNotSupportInstrumentSelectionError,
+	
+	/**
+	 *  A MIDI file could not be read because it is malformed, or uses
+	 *  features MIKMIDIFileParser doesn't support, such as SMPTE time division.
+	 */
+	MIKMIDIFileParsingFailedErrorCode,
+	
+	/**
+	 *  A MIDI file index written by MIKMIDIFileIndexer could not be read
+	 *  because it is malformed, or was written by an incompatible version.
+	 */
+	MIKMIDIFileIndexReadingFailedErrorCode,
+	
+	/**
+	 *  A sequence cache written by -[MIKMIDISequence writeCacheToURL:error:] could not be read
+	 *  because it is malformed, or was written by an incompatible version or platform.
+	 */
+	MIKMIDISequenceCacheReadingFailedErrorCode,
 };
 
 NSString *MIKMIDIDefaultLocalizedErrorDescriptionForErrorCode(MIKMIDIErrorCode code);
@@ -18,6 +18,9 @@ NSString *MIKMIDIDefaultLocalizedErrorDescriptionForErrorCode(MIKMIDIErrorCode c
 {
 	NSDictionary *descriptions =
 	@{@(MIKMIDIDeviceHasNoSourcesErrorCode) : NSLocalizedString(@"MIDI Device has no sources.", @"MIDI Device has no sources."),
+	  @(MIKMIDIFileParsingFailedErrorCode) : NSLocalizedString(@"The MIDI file could not be read.", @"The MIDI file could not be read."),
+	  @(MIKMIDIFileIndexReadingFailedErrorCode) : NSLocalizedString(@"The MIDI file index could not be read.", @"The MIDI file index could not be read."),
+	  @(MIKMIDISequenceCacheReadingFailedErrorCode) : NSLocalizedString(@"The MIDI sequence cache could not be read.", @"The MIDI sequence cache could not be read."),
 	  @(MIKMIDIUnknownErrorCode) : NSLocalizedString(@"An unknown MIDI error occurred.", @"An unknown MIDI error occurred.")};
 	return descriptions[@(code)] ?: NSLocalizedString(@"A MIDI error occurred.", @"Generic error description");
 }
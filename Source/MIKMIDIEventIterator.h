@@ -15,6 +15,12 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
+/**
+ *  A function called for each event by -[MIKMIDIEventIterator enumerateRawEventsFromTimeStamp:toTimeStamp:usingFunction:context:].
+ *  data points into the MusicTrack and is only valid for the duration of the call. Set *stop to YES to end the enumeration early.
+ */
+typedef void (*MIKMIDIEventIteratorEnumerationFunction)(MusicTimeStamp timeStamp, MusicEventType eventType, const void *data, UInt32 dataSize, void *_Nullable context, BOOL *stop);
+
 /**
  *  MIKMIDIEventIterator is an Objective-C wrapper for CoreMIDI's MusicEventIterator. It is not intended for use by clients/users of
  *  of MIKMIDI. Rather, it should be thought of as an MIKMIDI private class.
@@ -27,6 +33,7 @@ NS_ASSUME_NONNULL_BEGIN
 @property (nonatomic, readonly, nullable) MIKMIDIEvent *currentEvent;
 
 - (nullable instancetype)initWithTrack:(MIKMIDITrack *)track;
+- (nullable instancetype)initWithMusicTrack:(MusicTrack)musicTrack;
 + (nullable instancetype)iteratorForTrack:(MIKMIDITrack *)track;
 
 - (BOOL)seek:(MusicTimeStamp)timeStamp;
@@ -35,6 +42,35 @@ NS_ASSUME_NONNULL_BEGIN
 - (BOOL)deleteCurrentEventWithError:(NSError **)error;
 - (BOOL)moveCurrentEventTo:(MusicTimeStamp)timestamp error:(NSError **)error;
 
+/**
+ *  Gets the current event without copying its data or creating an MIKMIDIEvent. Any of the arguments may be NULL.
+ *  *data points into the MusicTrack, and is only valid until the iterator is moved or the track is changed.
+ *
+ *  @return YES if there is a current event, NO otherwise.
+ */
+- (BOOL)getCurrentEventTimeStamp:(nullable MusicTimeStamp *)timeStamp eventType:(nullable MusicEventType *)eventType data:(const void *_Nullable *_Nullable)data dataSize:(nullable UInt32 *)dataSize;
+
+/**
+ *  Seeks to startTimeStamp and calls block with the data of each event up to and including endTimeStamp,
+ *  without copying the data or creating MIKMIDIEvents. The track must not be changed from the block.
+ */
+- (void)enumerateRawEventsFromTimeStamp:(MusicTimeStamp)startTimeStamp toTimeStamp:(MusicTimeStamp)endTimeStamp usingBlock:(void (^)(MusicTimeStamp timeStamp, MusicEventType eventType, const void *data, UInt32 dataSize, BOOL *stop))block;
+
+/**
+ *  Like -enumerateRawEventsFromTimeStamp:toTimeStamp:usingBlock:, but calls a function with the specified context.
+ */
+- (void)enumerateRawEventsFromTimeStamp:(MusicTimeStamp)startTimeStamp toTimeStamp:(MusicTimeStamp)endTimeStamp usingFunction:(MIKMIDIEventIteratorEnumerationFunction)function context:(nullable void *)context;
+
+/**
+ *  Seeks to startTimeStamp and deletes each event up to and including endTimeStamp for which test returns YES,
+ *  or every event in the range if test is nil. test is passed the event's data without it being copied.
+ */
+- (BOOL)deleteEventsFromTimeStamp:(MusicTimeStamp)startTimeStamp
+					  toTimeStamp:(MusicTimeStamp)endTimeStamp
+					  passingTest:(nullable BOOL (^)(MusicTimeStamp timeStamp, MusicEventType eventType, const void *data, UInt32 dataSize))test
+			numberOfDeletedEvents:(nullable NSUInteger *)numberOfDeletedEvents
+							error:(NSError **)error;
+
 @end
 
 NS_ASSUME_NONNULL_END
\ No newline at end of file
@@ -26,9 +26,14 @@
 #pragma mark - Lifecycle
 
 - (instancetype)initWithTrack:(MIKMIDITrack *)track
+{
+    return [self initWithMusicTrack:track.musicTrack];
+}
+
+- (instancetype)initWithMusicTrack:(MusicTrack)musicTrack
 {
     if (self = [super init]) {
-        OSStatus err = NewMusicEventIterator(track.musicTrack, &_iterator);
+        OSStatus err = NewMusicEventIterator(musicTrack, &_iterator);
         if (err) {
             NSLog(@"NewMusicEventIterator() failed with error %@ in %s.", @(err), __PRETTY_FUNCTION__);
             return nil;
@@ -103,8 +108,95 @@
 	return YES;
 }
 
+- (BOOL)deleteEventsFromTimeStamp:(MusicTimeStamp)startTimeStamp
+					  toTimeStamp:(MusicTimeStamp)endTimeStamp
+					  passingTest:(BOOL (^)(MusicTimeStamp, MusicEventType, const void *, UInt32))test
+			numberOfDeletedEvents:(NSUInteger *)numberOfDeletedEvents
+							error:(NSError **)error
+{
+	error = error ? error : &(NSError *__autoreleasing){ nil };
+	numberOfDeletedEvents = numberOfDeletedEvents ? numberOfDeletedEvents : &(NSUInteger){ 0 };
+	*numberOfDeletedEvents = 0;
+
+	OSStatus err = MusicEventIteratorSeek(self.iterator, startTimeStamp);
+	while (!err) {
+		Boolean hasCurrentEvent = false;
+		err = MusicEventIteratorHasCurrentEvent(self.iterator, &hasCurrentEvent);
+		if (err || !hasCurrentEvent) break;
+
+		MusicTimeStamp timeStamp = 0;
+		MusicEventType eventType = kMusicEventType_NULL;
+		const void *data = NULL;
+		UInt32 dataSize = 0;
+		err = MusicEventIteratorGetEventInfo(self.iterator, &timeStamp, &eventType, &data, &dataSize);
+		if (err || timeStamp > endTimeStamp) break;
+
+		if (!test || test(timeStamp, eventType, data, dataSize)) {
+			err = MusicEventIteratorDeleteEvent(self.iterator); // Moves to the next event
+			if (!err) (*numberOfDeletedEvents)++;
+		} else {
+			err = MusicEventIteratorNextEvent(self.iterator);
+		}
+	}
+
+	if (err) {
+		NSLog(@"Deleting events from MusicTrack failed with error %@ in %s.", @(err), __PRETTY_FUNCTION__);
+		*error = [NSError errorWithDomain:NSOSStatusErrorDomain code:err userInfo:nil];
+		return NO;
+	}
+	return YES;
+}
+
+#pragma mark - Enumerating
+
+- (void)enumerateRawEventsFromTimeStamp:(MusicTimeStamp)startTimeStamp toTimeStamp:(MusicTimeStamp)endTimeStamp usingBlock:(void (^)(MusicTimeStamp, MusicEventType, const void *, UInt32, BOOL *))block
+{
+	if (!block || ![self seek:startTimeStamp]) return;
+
+	BOOL stop = NO;
+	MusicTimeStamp timeStamp = 0;
+	MusicEventType eventType = kMusicEventType_NULL;
+	const void *data = NULL;
+	UInt32 dataSize = 0;
+	while (!stop && [self getCurrentEventTimeStamp:&timeStamp eventType:&eventType data:&data dataSize:&dataSize] && timeStamp <= endTimeStamp) {
+		block(timeStamp, eventType, data, dataSize, &stop);
+		if (MusicEventIteratorNextEvent(self.iterator)) break;
+	}
+}
+
+- (void)enumerateRawEventsFromTimeStamp:(MusicTimeStamp)startTimeStamp toTimeStamp:(MusicTimeStamp)endTimeStamp usingFunction:(MIKMIDIEventIteratorEnumerationFunction)function context:(void *)context
+{
+	if (!function) return;
+
+	[self enumerateRawEventsFromTimeStamp:startTimeStamp toTimeStamp:endTimeStamp usingBlock:^(MusicTimeStamp timeStamp, MusicEventType eventType, const void *data, UInt32 dataSize, BOOL *stop) {
+		function(timeStamp, eventType, data, dataSize, context, stop);
+	}];
+}
+
 #pragma mark - Current Event
 
+- (BOOL)getCurrentEventTimeStamp:(MusicTimeStamp *)timeStamp eventType:(MusicEventType *)eventType data:(const void **)data dataSize:(UInt32 *)dataSize
+{
+	Boolean hasCurrentEvent = false;
+	if (MusicEventIteratorHasCurrentEvent(self.iterator, &hasCurrentEvent) || !hasCurrentEvent) return NO;
+
+	MusicTimeStamp currentTimeStamp = 0;
+	MusicEventType currentEventType = kMusicEventType_NULL;
+	const void *currentData = NULL;
+	UInt32 currentDataSize = 0;
+	OSStatus err = MusicEventIteratorGetEventInfo(self.iterator, &currentTimeStamp, &currentEventType, &currentData, &currentDataSize);
+	if (err) {
+		NSLog(@"MusicEventIteratorGetEventInfo() failed with error %@ in %s.", @(err), __PRETTY_FUNCTION__);
+		return NO;
+	}
+
+	if (timeStamp) *timeStamp = currentTimeStamp;
+	if (eventType) *eventType = currentEventType;
+	if (data) *data = currentData;
+	if (dataSize) *dataSize = currentDataSize;
+	return YES;
+}
+
 - (MIKMIDIEvent *)currentEvent
 {
     MusicTimeStamp timeStamp;
@@ -112,12 +204,7 @@
     const void *data;
     UInt32 dataSize;
 
-    OSStatus err = MusicEventIteratorGetEventInfo(self.iterator, &timeStamp, &type, &data , &dataSize);
-    if (err) {
-        NSLog(@"MusicEventIteratorGetEventInfo() failed with error %@ in %s.", @(err), __PRETTY_FUNCTION__);
-        return nil;
-    }
-    
+    if (![self getCurrentEventTimeStamp:&timeStamp eventType:&type data:&data dataSize:&dataSize]) return nil;
     return [MIKMIDIEvent midiEventWithTimeStamp:timeStamp eventType:type data:[NSData dataWithBytes:data length:dataSize]];
 }
 
@@ -0,0 +1,47 @@
+//
+//  MIKMIDIEventSource.h
+//  MIKMIDI
+//
+//  Created by Mixed In Key on 10/18/26.
+//  Copyright (c) 2026 Mixed In Key. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import <AudioToolbox/AudioToolbox.h>
+#import "MIKMIDICompilerCompatibility.h"
+
+@class MIKMIDIEvent;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Objects that conform to this protocol generate events for MIKMIDISequencer to play as it goes,
+ *  instead of the events being stored in an MIKMIDITrack ahead of time.
+ *
+ *  While it plays, the sequencer asks each of its event sources for the events in the stretch of time
+ *  it is about to schedule, and schedules the returned events with the source's command scheduler,
+ *  in the same way as events read from its sequence's tracks.
+ *
+ *  @see -[MIKMIDISequencer setCommandScheduler:forEventSource:]
+ */
+@protocol MIKMIDIEventSource <NSObject>
+
+/**
+ *  Returns the events to play from fromTimeStamp up to, but not including, toTimeStamp.
+ *
+ *  The sequencer calls this method on its processing queue, several times a second while it plays,
+ *  with ranges that follow on from each other without overlapping. After the sequencer starts, loops or
+ *  moves on to its next sequence, the next range starts at the starting time stamp, the loop start time
+ *  stamp or 0. The method should return quickly, as it holds up scheduling until it returns.
+ *
+ *  @param fromTimeStamp The start of the range, in beats of the sequencer's sequence.
+ *  @param toTimeStamp The end of the range, in beats of the sequencer's sequence.
+ *
+ *  @return An array of MIKMIDIEvent instances with time stamps in the range. Note events are followed by
+ *  a note off at their end, and channel events are sent as they are. Other kinds of events are ignored.
+ */
+- (MIKArrayOf(MIKMIDIEvent *) *)eventsFromTimeStamp:(MusicTimeStamp)fromTimeStamp toTimeStamp:(MusicTimeStamp)toTimeStamp;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,340 @@
+//
+//  MIKMIDIEventStore.h
+//  MIKMIDI
+//
+//  Created by Mixed In Key on 10/18/26.
+//  Copyright (c) 2026 Mixed In Key. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import <AudioToolbox/AudioToolbox.h>
+#import "MIKMIDIEvent.h"
+#import "MIKMIDICompilerCompatibility.h"
+
+@class MIKMIDINoteTransform;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  A function called for each event by -[MIKMIDIEventStore enumerateRawEventsFromTimeStamp:toTimeStamp:usingFunction:context:].
+ *  data is only valid for the duration of the call. Set *stop to YES to end the enumeration early.
+ */
+typedef void (*MIKMIDIEventStoreEnumerationFunction)(MusicTimeStamp timeStamp, MIKMIDIEventType eventType, const void *data, UInt32 length, void *_Nullable context, BOOL *stop);
+
+/**
+ *  MIKMIDIEventStore is an ordered container of MIKMIDIEvents used internally by MIKMIDITrack.
+ *
+ *  Events are kept sorted by time stamp. Events with equal time stamps are kept in the
+ *  order they were added, so iteration is stable. Internally, events are stored in a list of
+ *  fixed size, sorted chunks, which keeps insertion and removal at O(log n) plus a small
+ *  constant amount of copying, and allows range queries to binary search to their
+ *  first result instead of scanning the whole track.
+ *
+ *  The store doesn't keep the MIKMIDIEvent instances added to it. Each event is stored as a 16 byte
+ *  record holding its time stamp and type. Notes and channel messages are packed entirely into their
+ *  record, while the data for other events is kept in a side array that the record refers to. Events
+ *  are created from their records as they are asked for, so each query returns new instances, equal
+ *  to, but not the same as, the events that were added.
+ *
+ *  Like NSMutableSet, the store never contains two events for which -isEqual: returns YES.
+ *
+ *  By default, the store also keeps secondary indexes of its events by event type, and of
+ *  control change events by controller number, so that queries for a single type of event
+ *  only need to look at events of that type.
+ *
+ *  Copying a store is cheap, as the copy shares the original's storage, which is only copied, a chunk at
+ *  a time, as either store is changed. So a store can be copied after every edit, and the copies take up
+ *  memory in proportion to the edits made in between them.
+ *
+ *  MIKMIDIEventStore is not thread safe. However, a copy that is never changed may be read from any number
+ *  of threads, even while the store it was copied from (or copies of the copy) continue to be changed.
+ *
+ *  @note You should not use this class directly. It is for internal MIKMIDI use only.
+ */
+@interface MIKMIDIEventStore : NSObject <NSCopying>
+
+/**
+ *  Creates and initializes an empty event store.
+ *
+ *  @param maintainsTypeIndexes Whether the store should keep secondary indexes by event type and controller number.
+ *  -init passes YES.
+ *
+ *  @return An initialized MIKMIDIEventStore.
+ */
+- (instancetype)initWithTypeIndexes:(BOOL)maintainsTypeIndexes NS_DESIGNATED_INITIALIZER;
+
+/**
+ *  Initializes a store from a cache representation written by -appendCacheRepresentationToData:.
+ *
+ *  The store's records aren't decoded or copied. Its chunks are used in place in data, which the store
+ *  keeps, and are only copied, like shared chunks, when the store is changed. So data may be memory-mapped.
+ *  The records are read once, to check that they're in time stamp order and only refer to payloads in the
+ *  representation, so a corrupt or stale cache is rejected rather than read from.
+ *
+ *  @param data The data containing the cache representation. Its bytes must be 8 byte aligned.
+ *  @param position The offset of the representation in data, which must be a multiple of 8. On return,
+ *  the offset of the first byte after it.
+ *
+ *  @return An initialized MIKMIDIEventStore, or nil if the representation is malformed or its records are
+ *  invalid, or it was written on a platform with a different memory layout.
+ */
+- (nullable instancetype)initWithCacheData:(NSData *)data position:(NSUInteger *)position;
+
+/**
+ *  Appends a representation of the store, including its type indexes, that can be read back by
+ *  -initWithCacheData:position:. The representation is in native layout, and is a multiple of 8 bytes long.
+ *
+ *  @param data The data to append to. Its length must be a multiple of 8.
+ */
+- (void)appendCacheRepresentationToData:(NSMutableData *)data;
+
+/**
+ *  Adds an event to the store. Only the event's time stamp, type and data are stored, so later
+ *  changes to a mutable event don't affect the store.
+ *
+ *  @param event The event to add.
+ *
+ *  @return YES if the event was added, NO if an equal event was already in the store.
+ */
+- (BOOL)addEvent:(MIKMIDIEvent *)event;
+
+/**
+ *  Adds an event, given as the raw data of a MusicTrack event, to the store, e.g. as returned by MusicEventIteratorGetEventInfo().
+ *
+ *  Notes and channel messages are stored without creating an MIKMIDIEvent or NSData for them.
+ *
+ *  @param timeStamp The time stamp of the event.
+ *  @param eventType The MusicEventType of the event.
+ *  @param data The event's data.
+ *  @param length The length of data, in bytes.
+ *
+ *  @return YES if the event was added, NO if an equal event was already in the store.
+ */
+- (BOOL)addEventWithTimeStamp:(MusicTimeStamp)timeStamp musicEventType:(MusicEventType)eventType data:(const void *)data length:(NSUInteger)length;
+
+/**
+ *  Removes the event equal to the specified event from the store.
+ *
+ *  @param event The event to remove.
+ *
+ *  @return YES if an event was removed, NO if no equal event was in the store.
+ */
+- (BOOL)removeEvent:(MIKMIDIEvent *)event;
+
+/**
+ *  Removes all events that fall between two time stamps, inclusive.
+ *
+ *  This is considerably faster than removing the same events one at a time, as entries
+ *  are only moved once, and chunks that fall entirely inside the range are simply freed.
+ *
+ *  @param startTimeStamp The earliest time stamp to remove.
+ *  @param endTimeStamp The latest time stamp to remove.
+ *
+ *  @return The number of events that were removed.
+ */
+- (NSUInteger)removeEventsFromTimeStamp:(MusicTimeStamp)startTimeStamp toTimeStamp:(MusicTimeStamp)endTimeStamp;
+
+/**
+ *  Moves all events that fall between two time stamps, inclusive, by the specified amount.
+ *
+ *  When no other events lie between the old and new positions of the moved events, as when
+ *  shifting everything after a point in the track, their records are updated where they are.
+ *  Otherwise the moved records are merged back into the store in a single pass. A moved event that
+ *  lands on an equal event is only kept once, as if it had been added.
+ *
+ *  @param startTimeStamp The earliest time stamp to move.
+ *  @param endTimeStamp The latest time stamp to move.
+ *  @param offset The amount to add to the time stamps of the moved events.
+ *
+ *  @return An array of the moved events, with their new time stamps, sorted by time stamp.
+ */
+- (NSArray *)shiftEventsFromTimeStamp:(MusicTimeStamp)startTimeStamp toTimeStamp:(MusicTimeStamp)endTimeStamp byAmount:(MusicTimeStamp)offset;
+
+/**
+ *  Applies a transform to all of the notes in the store.
+ *
+ *  The store's records are transformed in a single pass and then re-sorted and repacked into chunks
+ *  once, rather than each changed note being removed and re-added. Notes that become equal to another
+ *  event are dropped, so the store still contains no equal events.
+ *
+ *  The store only touches its own storage, so separate stores can be transformed on separate threads at once.
+ *
+ *  @param transform The transform to apply.
+ *  @param trackNumber The number of the track the store holds the events of, which humanizing mixes into its random amounts.
+ *  @param startTimeStamp On return, the earliest time stamp at which a note was changed, moved from or moved to.
+ *  @param endTimeStamp On return, the latest time stamp at which a note was changed, moved from or moved to.
+ *
+ *  @return YES if any note was changed, NO otherwise.
+ */
+- (BOOL)applyNoteTransform:(MIKMIDINoteTransform *)transform trackNumber:(NSInteger)trackNumber startTimeStamp:(nullable MusicTimeStamp *)startTimeStamp endTimeStamp:(nullable MusicTimeStamp *)endTimeStamp;
+
+/**
+ *  Adds each of the store's events to the store for its MIDI channel, without creating MIKMIDIEvents for them.
+ *  Events that are already in the store for their channel are skipped.
+ *
+ *  @param channelEventStores An array of 17 stores. Notes and channel messages on channel n are added to store n,
+ *  and all other events, like meta and system exclusive events, to the last store.
+ */
+- (void)addEventsToChannelEventStores:(MIKArrayOf(MIKMIDIEventStore *) *)channelEventStores;
+
+/**
+ *  Creates a store containing the events of several stores, each moved by an offset, without creating MIKMIDIEvents for them.
+ *
+ *  When each store's events start at or after the last event of the stores before it, as when stores are concatenated,
+ *  their records are copied across in order in a single pass. Otherwise they are merged by a stable merge sort, so events
+ *  with the same time stamp keep the order of the stores they came from. Events equal to one from an earlier store are dropped.
+ *
+ *  @param eventStores The stores to merge.
+ *  @param offsets An array of NSNumbers, one for each store in eventStores, holding the amount in beats to add to the time stamps of its events.
+ *
+ *  @return A new MIKMIDIEventStore, which maintains type indexes.
+ */
++ (instancetype)eventStoreByMergingEventStores:(MIKArrayOf(MIKMIDIEventStore *) *)eventStores offsets:(MIKArrayOf(NSNumber *) *)offsets;
+
+/**
+ *  Removes all events from the store.
+ */
+- (void)removeAllEvents;
+
+/**
+ *  Whether the store contains an event equal to the specified event.
+ *
+ *  @param event The event to look for.
+ *
+ *  @return YES if the store contains an equal event, NO otherwise.
+ */
+- (BOOL)containsEvent:(MIKMIDIEvent *)event;
+
+/**
+ *  Returns the events of the specified class that fall between two time stamps, inclusive,
+ *  sorted by time stamp.
+ *
+ *  @param eventClass The class of events to return, or Nil to return events of any class.
+ *  @param startTimeStamp The earliest time stamp to include.
+ *  @param endTimeStamp The latest time stamp to include.
+ *
+ *  @return An array of MIKMIDIEvents.
+ */
+- (NSArray *)eventsOfClass:(nullable Class)eventClass fromTimeStamp:(MusicTimeStamp)startTimeStamp toTimeStamp:(MusicTimeStamp)endTimeStamp;
+
+/**
+ *  Returns the events of the specified type that fall between two time stamps, inclusive,
+ *  sorted by time stamp.
+ *
+ *  @param eventType The type of events to return. Meta events are indexed by subtype, so
+ *  e.g. MIKMIDIEventTypeMetaTimeSignature only returns time signature events.
+ *  @param startTimeStamp The earliest time stamp to include.
+ *  @param endTimeStamp The latest time stamp to include.
+ *
+ *  @return An array of MIKMIDIEvents.
+ */
+- (NSArray *)eventsOfType:(MIKMIDIEventType)eventType fromTimeStamp:(MusicTimeStamp)startTimeStamp toTimeStamp:(MusicTimeStamp)endTimeStamp;
+
+/**
+ *  Returns the control change events for the specified controller number that fall between
+ *  two time stamps, inclusive, sorted by time stamp.
+ *
+ *  @param controllerNumber The controller number of the events to return.
+ *  @param startTimeStamp The earliest time stamp to include.
+ *  @param endTimeStamp The latest time stamp to include.
+ *
+ *  @return An array of MIKMIDIControlChangeEvents.
+ */
+- (NSArray *)controlChangeEventsForControllerNumber:(NSUInteger)controllerNumber fromTimeStamp:(MusicTimeStamp)startTimeStamp toTimeStamp:(MusicTimeStamp)endTimeStamp;
+
+/**
+ *  Gets the range of time stamps outside of which the store contains the same events as another store.
+ *
+ *  The storage the two stores share is known to be identical, so the cost of this method depends on the amount
+ *  of unshared storage, not the number of events. For stores that aren't copies of each other, the returned range
+ *  includes all of the events in both.
+ *
+ *  @param eventStore The store to compare with.
+ *  @param startTimeStamp On return, the earliest time stamp at which the stores may differ.
+ *  @param endTimeStamp On return, the latest time stamp at which the stores may differ.
+ *
+ *  @return YES if the stores may contain different events, NO if they share all of their storage.
+ */
+- (BOOL)getTimeStampRangeOfDifferencesFromEventStore:(MIKMIDIEventStore *)eventStore startTimeStamp:(nullable MusicTimeStamp *)startTimeStamp endTimeStamp:(nullable MusicTimeStamp *)endTimeStamp;
+
+/**
+ *  Returns the notes that sound at any time between two time stamps, inclusive, sorted by time stamp.
+ *  This includes every note that starts in the range, as well as notes that start before it and
+ *  end after startTimeStamp.
+ *
+ *  Each chunk of the store knows the latest end time stamp of its events, and the store keeps a tree of
+ *  those maximums, so notes that started before the range are found without scanning from the start of the
+ *  store. Only the chunks that actually contain such notes are visited.
+ *
+ *  @param startTimeStamp The earliest time stamp to include.
+ *  @param endTimeStamp The latest time stamp to include.
+ *
+ *  @return An array of MIKMIDINoteEvents.
+ */
+- (NSArray *)notesSoundingFromTimeStamp:(MusicTimeStamp)startTimeStamp toTimeStamp:(MusicTimeStamp)endTimeStamp;
+
+/**
+ *  Enumerates the events that fall between two time stamps, inclusive, in order.
+ *
+ *  The store must not be mutated during enumeration.
+ *
+ *  @param startTimeStamp The earliest time stamp to include.
+ *  @param endTimeStamp The latest time stamp to include.
+ *  @param block The block to call for each event. Set *stop to YES to end the enumeration early.
+ */
+- (void)enumerateEventsFromTimeStamp:(MusicTimeStamp)startTimeStamp toTimeStamp:(MusicTimeStamp)endTimeStamp usingBlock:(void (^)(MIKMIDIEvent *event, BOOL *stop))block;
+
+/**
+ *  Enumerates the raw data of the events that fall between two time stamps, inclusive, in order.
+ *
+ *  Unlike -enumerateEventsFromTimeStamp:toTimeStamp:usingBlock:, no MIKMIDIEvents are created. For notes and channel
+ *  messages, the data is written to a buffer on the stack, and for other events it points into the store's own storage.
+ *  Either way, the data is only valid for the duration of the call to the block. The store must not be mutated during
+ *  enumeration.
+ *
+ *  @param startTimeStamp The earliest time stamp to include.
+ *  @param endTimeStamp The latest time stamp to include.
+ *  @param block The block to call for each event. Set *stop to YES to end the enumeration early.
+ */
+- (void)enumerateRawEventsFromTimeStamp:(MusicTimeStamp)startTimeStamp toTimeStamp:(MusicTimeStamp)endTimeStamp usingBlock:(void (^)(MusicTimeStamp timeStamp, MIKMIDIEventType eventType, const void *data, UInt32 length, BOOL *stop))block;
+
+/**
+ *  Enumerates the raw data of the events that fall between two time stamps, inclusive, in order, calling a function
+ *  for each one. Otherwise identical to -enumerateRawEventsFromTimeStamp:toTimeStamp:usingBlock:.
+ *
+ *  @param startTimeStamp The earliest time stamp to include.
+ *  @param endTimeStamp The latest time stamp to include.
+ *  @param function The function to call for each event.
+ *  @param context A pointer passed to function as its context argument.
+ */
+- (void)enumerateRawEventsFromTimeStamp:(MusicTimeStamp)startTimeStamp toTimeStamp:(MusicTimeStamp)endTimeStamp usingFunction:(MIKMIDIEventStoreEnumerationFunction)function context:(nullable void *)context;
+
+/**
+ *  All of the events in the store, sorted by time stamp.
+ */
+@property (nonatomic, readonly) NSArray *allEvents;
+
+/**
+ *  The number of events in the store.
+ */
+@property (nonatomic, readonly) NSUInteger count;
+
+/**
+ *  The latest time at which any event in the store ends, or 0 if the store is empty.
+ *
+ *  For notes, this is the note's endTimeStamp. For all other events, it is the event's time stamp.
+ *  This is kept up to date incrementally. Each chunk of the store tracks the latest end time stamp
+ *  of its own events, in a tree of chunk maximums that is updated as single events are added and
+ *  removed, so reading this property costs O(1), from the root of that tree. After chunks are added
+ *  or removed, or many events change at once, the tree is rebuilt on the next read instead.
+ */
+@property (nonatomic, readonly) MusicTimeStamp maximumEndTimeStamp;
+
+/**
+ *  The earliest event in the store, or nil if the store is empty.
+ */
+@property (nonatomic, readonly, nullable) MIKMIDIEvent *firstEvent;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,1720 @@
+//
+//  MIKMIDIEventStore.m
+//  MIKMIDI
+//
+//  Created by Mixed In Key on 10/18/26.
+//  Copyright (c) 2026 Mixed In Key. All rights reserved.
+//
+
+#import "MIKMIDIEventStore.h"
+#import "MIKMIDIEvent.h"
+#import "MIKMIDINoteTransform+MIKMIDIPrivate.h"
+#import <stdatomic.h>
+
+#if !__has_feature(objc_arc)
+#error MIKMIDIEventStore.m must be compiled with ARC. Either turn on ARC for the project or set the -fobjc-arc flag for MIKMIDIEventStore.m in the Build Phases for this target
+#endif
+
+#define MIKMIDIEventStoreChunkCapacity	512
+
+// The reference count of chunks used in place in a cache's data. They're never retained, released or changed.
+#define MIKMIDIEventStoreChunkUnowned	NSUIntegerMax
+
+// Set in a record's eventType when the event's data is kept in the payload arena
+#define MIKMIDIEventStoreRecordHasPayload	0x80
+
+// Notes and channel messages, which make up nearly all of a typical track, are packed entirely into
+// their record. Everything else keeps its data in the store's payload arena, and its record holds the
+// index of the data there.
+typedef struct {
+	MusicTimeStamp timeStamp;
+	UInt8 eventType; // MIKMIDIEventType, possibly with MIKMIDIEventStoreRecordHasPayload set
+	UInt8 bytes[3]; // Notes: channel, note, velocity. Channel messages: status, data1, data2.
+	union {
+		Float32 duration; // Notes
+		UInt32 payloadIndex; // Records with MIKMIDIEventStoreRecordHasPayload set. 0 for channel messages.
+	};
+} MIKMIDIEventStoreRecord;
+
+_Static_assert(sizeof(MIKMIDIEventStoreRecord) == 16, "MIKMIDIEventStoreRecord should be 16 bytes");
+
+// Chunks are never left empty, so every chunk has a first and last time stamp to binary search against.
+// Copies of a store share its chunks, and a chunk is copied before it's changed if it is shared.
+typedef struct {
+	_Atomic(NSUInteger) referenceCount;
+	NSUInteger count;
+	MusicTimeStamp maximumEndTimeStamp;
+	MIKMIDIEventStoreRecord records[MIKMIDIEventStoreChunkCapacity];
+} MIKMIDIEventStoreChunk;
+
+// A chunk in a cache is stored as its header followed by only the records it holds
+#define MIKMIDIEventStoreChunkHeaderSize	offsetof(MIKMIDIEventStoreChunk, records)
+
+typedef struct {
+	NSUInteger chunk;
+	NSUInteger entry;
+} MIKMIDIEventStorePosition;
+
+static const MIKMIDIEventStorePosition MIKMIDIEventStorePositionNotFound = { NSNotFound, NSNotFound };
+
+#pragma mark - Payload Arena
+
+#define MIKMIDIEventStorePayloadPageCapacity	256
+
+// Holds the data of events that don't fit in a record, in pages of a fixed size. Like the chunks, pages are shared
+// with copies of the arena, and a page is copied before it's changed if it is shared, so changing a payload after
+// copying the arena copies one page rather than the whole arena.
+@interface MIKMIDIEventStorePayloadArena : NSObject <NSCopying>
+@property (nonatomic, readonly) NSUInteger count;
+- (id)objectAtIndexedSubscript:(NSUInteger)index;
+- (void)setObject:(id)payload atIndexedSubscript:(NSUInteger)index;
+- (void)addObject:(id)payload;
+@end
+
+@implementation MIKMIDIEventStorePayloadArena
+{
+	NSMutableArray *_pages;
+	NSMutableIndexSet *_ownedPageIndexes; // Pages that aren't shared with a copy of the arena
+}
+
+- (instancetype)init
+{
+	self = [super init];
+	if (self) {
+		_pages = [NSMutableArray array];
+		_ownedPageIndexes = [NSMutableIndexSet indexSet];
+	}
+	return self;
+}
+
+- (id)copyWithZone:(NSZone *)zone
+{
+	MIKMIDIEventStorePayloadArena *copy = [[[self class] allocWithZone:zone] init];
+	[copy->_pages setArray:_pages];
+	copy->_count = _count;
+	[_ownedPageIndexes removeAllIndexes];
+	return copy;
+}
+
+- (id)objectAtIndexedSubscript:(NSUInteger)index
+{
+	return _pages[index / MIKMIDIEventStorePayloadPageCapacity][index % MIKMIDIEventStorePayloadPageCapacity];
+}
+
+- (void)setObject:(id)payload atIndexedSubscript:(NSUInteger)index
+{
+	[self mutablePageAtIndex:index / MIKMIDIEventStorePayloadPageCapacity][index % MIKMIDIEventStorePayloadPageCapacity] = payload;
+}
+
+- (void)addObject:(id)payload
+{
+	if (_count % MIKMIDIEventStorePayloadPageCapacity) {
+		[[self mutablePageAtIndex:_count / MIKMIDIEventStorePayloadPageCapacity] addObject:payload];
+	} else {
+		NSMutableArray *page = [NSMutableArray arrayWithCapacity:MIKMIDIEventStorePayloadPageCapacity];
+		[page addObject:payload];
+		[_ownedPageIndexes addIndex:[_pages count]];
+		[_pages addObject:page];
+	}
+	_count++;
+}
+
+// Returns the page at pageIndex, first replacing it with a copy of its own if it's shared with a copy of the arena
+- (NSMutableArray *)mutablePageAtIndex:(NSUInteger)pageIndex
+{
+	if (![_ownedPageIndexes containsIndex:pageIndex]) {
+		_pages[pageIndex] = [_pages[pageIndex] mutableCopy];
+		[_ownedPageIndexes addIndex:pageIndex];
+	}
+	return _pages[pageIndex];
+}
+
+@end
+
+#pragma mark - Records and Chunks
+
+static BOOL MIKMIDIEventStoreIsChannelEventType(MIKMIDIEventType eventType)
+{
+	switch (eventType) {
+		case MIKMIDIEventTypeMIDIChannelMessage:
+		case MIKMIDIEventTypeMIDIPolyphonicKeyPressureMessage:
+		case MIKMIDIEventTypeMIDIControlChangeMessage:
+		case MIKMIDIEventTypeMIDIProgramChangeMessage:
+		case MIKMIDIEventTypeMIDIChannelPressureMessage:
+		case MIKMIDIEventTypeMIDIPitchBendChangeMessage:
+			return YES;
+		default:
+			return NO;
+	}
+}
+
+// Returns the event type for a MIDIChannelMessage with the specified status byte, or MIKMIDIEventTypeNULL if it isn't one
+// MIKMIDIEvent gives its own type. Matches +[MIKMIDIEvent midiEventWithTimeStamp:eventType:data:], without needing an NSData.
+static MIKMIDIEventType MIKMIDIEventStoreEventTypeForChannelStatus(UInt8 status)
+{
+	switch (status & 0xF0) {
+		case MIKMIDIChannelEventTypePolyphonicKeyPressure: return MIKMIDIEventTypeMIDIPolyphonicKeyPressureMessage;
+		case MIKMIDIChannelEventTypeControlChange: return MIKMIDIEventTypeMIDIControlChangeMessage;
+		case MIKMIDIChannelEventTypeProgramChange: return MIKMIDIEventTypeMIDIProgramChangeMessage;
+		case MIKMIDIChannelEventTypeChannelPressure: return MIKMIDIEventTypeMIDIChannelPressureMessage;
+		case MIKMIDIChannelEventTypePitchBendChange: return MIKMIDIEventTypeMIDIPitchBendChangeMessage;
+		default: return MIKMIDIEventTypeNULL;
+	}
+}
+
+// Returns a record for an event with the specified time stamp, type and data. If the returned record has
+// MIKMIDIEventStoreRecordHasPayload set, the data must be added to the payload arena and its index stored in the record.
+static MIKMIDIEventStoreRecord MIKMIDIEventStoreRecordMake(MusicTimeStamp timeStamp, MIKMIDIEventType eventType, const void *data, NSUInteger length)
+{
+	MIKMIDIEventStoreRecord record = { .timeStamp = timeStamp, .eventType = (UInt8)eventType };
+	if (eventType == MIKMIDIEventTypeMIDINoteMessage && length == sizeof(MIDINoteMessage)) {
+		const MIDINoteMessage *message = data;
+		if (!message->releaseVelocity) {
+			record.bytes[0] = message->channel;
+			record.bytes[1] = message->note;
+			record.bytes[2] = message->velocity;
+			record.duration = message->duration;
+			return record;
+		}
+	} else if (MIKMIDIEventStoreIsChannelEventType(eventType) && length == sizeof(MIDIChannelMessage)) {
+		const MIDIChannelMessage *message = data;
+		if (!message->reserved) {
+			record.bytes[0] = message->status;
+			record.bytes[1] = message->data1;
+			record.bytes[2] = message->data2;
+			return record;
+		}
+	}
+
+	record.eventType |= MIKMIDIEventStoreRecordHasPayload;
+	return record;
+}
+
+static MIKMIDIEventType MIKMIDIEventStoreRecordEventType(const MIKMIDIEventStoreRecord *record)
+{
+	return (MIKMIDIEventType)(record->eventType & ~MIKMIDIEventStoreRecordHasPayload);
+}
+
+static MusicTimeStamp MIKMIDIEventStoreRecordEndTimeStamp(const MIKMIDIEventStoreRecord *record, MIKMIDIEventStorePayloadArena *payloads)
+{
+	if (record->eventType == MIKMIDIEventTypeMIDINoteMessage) return record->timeStamp + record->duration;
+	if (record->eventType == (MIKMIDIEventTypeMIDINoteMessage | MIKMIDIEventStoreRecordHasPayload)) {
+		NSData *data = payloads[record->payloadIndex];
+		if ([data length] >= sizeof(MIDINoteMessage)) return record->timeStamp + ((const MIDINoteMessage *)[data bytes])->duration;
+	}
+	return record->timeStamp;
+}
+
+static NSUInteger MIKMIDIEventStoreRecordControllerNumber(const MIKMIDIEventStoreRecord *record, MIKMIDIEventStorePayloadArena *payloads)
+{
+	if (!(record->eventType & MIKMIDIEventStoreRecordHasPayload)) return record->bytes[1];
+	NSData *data = payloads[record->payloadIndex];
+	return ([data length] > 1) ? ((const UInt8 *)[data bytes])[1] : 0;
+}
+
+// Returns the channel of a note or channel message, or NSNotFound for events that don't have one. payload is the
+// record's payload, if it has one.
+static NSUInteger MIKMIDIEventStoreRecordChannel(const MIKMIDIEventStoreRecord *record, NSData *payload)
+{
+	MIKMIDIEventType eventType = MIKMIDIEventStoreRecordEventType(record);
+	if (eventType != MIKMIDIEventTypeMIDINoteMessage && !MIKMIDIEventStoreIsChannelEventType(eventType)) return NSNotFound;
+	if (payload && ![payload length]) return NSNotFound;
+	// The channel of a MIDINoteMessage, and the status of a MIDIChannelMessage, are their first byte
+	UInt8 firstByte = payload ? ((const UInt8 *)[payload bytes])[0] : record->bytes[0];
+	return firstByte & 0x0F;
+}
+
+// Whether storedRecord, from a store with the specified payloads, represents the same event as record and data
+static BOOL MIKMIDIEventStoreRecordMatches(const MIKMIDIEventStoreRecord *storedRecord, MIKMIDIEventStorePayloadArena *payloads, const MIKMIDIEventStoreRecord *record, NSData *data)
+{
+	if (storedRecord->eventType != record->eventType) return NO;
+	if (record->eventType & MIKMIDIEventStoreRecordHasPayload) return [payloads[storedRecord->payloadIndex] isEqualToData:data];
+	return !memcmp(storedRecord->bytes, record->bytes, sizeof(record->bytes)) && storedRecord->payloadIndex == record->payloadIndex;
+}
+
+// Hashes the event a record represents, consistently with MIKMIDIEventStoreRecordMatches(). data is the record's payload, if it has one.
+static NSUInteger MIKMIDIEventStoreRecordHash(const MIKMIDIEventStoreRecord *record, NSData *data)
+{
+	if (data) return [data hash] * 31 + record->eventType;
+
+	// The type, bytes, and duration or payload index are compared bit for bit, and make up the 8 bytes after the time stamp
+	UInt64 bits;
+	memcpy(&bits, &record->eventType, sizeof(bits));
+	bits = (bits ^ (bits >> 31)) * 0x9E3779B97F4A7C15ULL;
+	return (NSUInteger)(bits ^ (bits >> 32));
+}
+
+// Runs of records with equal time stamps up to this long are searched for duplicates record by record. A power of two,
+// as it is also the smallest capacity of the hash table used for longer runs.
+#define MIKMIDIEventStoreLinearDuplicateSearchLimit	16
+
+typedef struct {
+	NSUInteger hash;
+	NSUInteger keptRecordNumber; // The index of the kept record plus one, or 0 for an empty slot
+} MIKMIDIEventStoreDuplicateTableEntry;
+
+typedef union {
+	MIDINoteMessage noteMessage;
+	MIDIChannelMessage channelMessage;
+} MIKMIDIEventStoreRecordData;
+
+// Returns the raw data of the event a record represents, and sets *length to its length. For events packed into
+// their record, the data is written to buffer. Otherwise, the returned pointer is into the payload arena.
+static const void *MIKMIDIEventStoreRecordGetData(const MIKMIDIEventStoreRecord *record, MIKMIDIEventStorePayloadArena *payloads, MIKMIDIEventStoreRecordData *buffer, UInt32 *length)
+{
+	if (record->eventType & MIKMIDIEventStoreRecordHasPayload) {
+		NSData *data = payloads[record->payloadIndex];
+		*length = (UInt32)[data length];
+		return [data bytes];
+	}
+
+	if (record->eventType == MIKMIDIEventTypeMIDINoteMessage) {
+		buffer->noteMessage = (MIDINoteMessage){ record->bytes[0], record->bytes[1], record->bytes[2], 0, record->duration };
+		*length = sizeof(MIDINoteMessage);
+	} else {
+		buffer->channelMessage = (MIDIChannelMessage){ record->bytes[0], record->bytes[1], record->bytes[2], 0 };
+		*length = sizeof(MIDIChannelMessage);
+	}
+	return buffer;
+}
+
+// Creates a new event from a record. Events are only instantiated when they're asked for.
+static MIKMIDIEvent *MIKMIDIEventStoreEventForRecord(const MIKMIDIEventStoreRecord *record, MIKMIDIEventStorePayloadArena *payloads)
+{
+	MIKMIDIEventType eventType = MIKMIDIEventStoreRecordEventType(record);
+	if (record->eventType & MIKMIDIEventStoreRecordHasPayload) {
+		return [[MIKMIDIEvent alloc] initWithTimeStamp:record->timeStamp midiEventType:eventType data:payloads[record->payloadIndex]];
+	}
+
+	// The event copies the data, so it can point at the stack
+	MIKMIDIEventStoreRecordData buffer;
+	UInt32 length = 0;
+	const void *bytes = MIKMIDIEventStoreRecordGetData(record, payloads, &buffer, &length);
+	NSData *data = [[NSData alloc] initWithBytesNoCopy:(void *)bytes length:length freeWhenDone:NO];
+	return [[MIKMIDIEvent alloc] initWithTimeStamp:record->timeStamp midiEventType:eventType data:data];
+}
+
+static MIKMIDIEventStoreChunk *MIKMIDIEventStoreChunkCreate(void)
+{
+	MIKMIDIEventStoreChunk *chunk = malloc(sizeof(MIKMIDIEventStoreChunk));
+	atomic_init(&chunk->referenceCount, 1);
+	chunk->count = 0;
+	chunk->maximumEndTimeStamp = -DBL_MAX;
+	return chunk;
+}
+
+static MIKMIDIEventStoreChunk *MIKMIDIEventStoreChunkRetain(MIKMIDIEventStoreChunk *chunk)
+{
+	// A cache's data may be mapped read-only, so its chunks must not be written to at all
+	if (atomic_load_explicit(&chunk->referenceCount, memory_order_relaxed) == MIKMIDIEventStoreChunkUnowned) return chunk;
+	atomic_fetch_add_explicit(&chunk->referenceCount, 1, memory_order_relaxed);
+	return chunk;
+}
+
+// Copies of a store may be released on any thread, so the last reference to a chunk may be too
+static void MIKMIDIEventStoreChunkRelease(MIKMIDIEventStoreChunk *chunk)
+{
+	if (atomic_load_explicit(&chunk->referenceCount, memory_order_relaxed) == MIKMIDIEventStoreChunkUnowned) return;
+	if (atomic_fetch_sub_explicit(&chunk->referenceCount, 1, memory_order_acq_rel) == 1) free(chunk);
+}
+
+static void MIKMIDIEventStoreChunkUpdateMaximumEndTimeStamp(MIKMIDIEventStoreChunk *chunk, MIKMIDIEventStorePayloadArena *payloads)
+{
+	MusicTimeStamp maximumEndTimeStamp = -DBL_MAX;
+	for (NSUInteger i = 0; i < chunk->count; i++) {
+		MusicTimeStamp endTimeStamp = MIKMIDIEventStoreRecordEndTimeStamp(&chunk->records[i], payloads);
+		if (endTimeStamp > maximumEndTimeStamp) maximumEndTimeStamp = endTimeStamp;
+	}
+	chunk->maximumEndTimeStamp = maximumEndTimeStamp;
+}
+
+// Orders records by time stamp only. Used with mergesort(), which is stable, so events with equal time stamps keep their order.
+static int MIKMIDIEventStoreCompareRecordTimeStamps(const void *first, const void *second)
+{
+	MusicTimeStamp firstTimeStamp = ((const MIKMIDIEventStoreRecord *)first)->timeStamp;
+	MusicTimeStamp secondTimeStamp = ((const MIKMIDIEventStoreRecord *)second)->timeStamp;
+	return (firstTimeStamp > secondTimeStamp) - (firstTimeStamp < secondTimeStamp);
+}
+
+#pragma mark - Cache Representation
+
+// A store's cache representation is this header, followed by its chunks, its payloads, each a
+// MIKMIDIEventStoreCachePayloadHeader followed by the payload's bytes, and the stores of its type
+// indexes, each a UInt64 key followed by the store's own representation. Everything is in native
+// layout and 8 byte aligned, so the chunks can be used straight from a memory-mapped cache.
+typedef struct {
+	UInt32 recordSize;
+	UInt32 chunkHeaderSize;
+	UInt64 count;
+	UInt64 numberOfChunks;
+	UInt64 numberOfPayloads;
+	UInt32 numberOfEventTypeIndexes;
+	UInt32 numberOfControllerNumberIndexes;
+	UInt32 maintainsTypeIndexes;
+	UInt32 reserved;
+} MIKMIDIEventStoreCacheHeader;
+
+typedef struct {
+	UInt32 length;
+	UInt32 isFree;
+} MIKMIDIEventStoreCachePayloadHeader;
+
+static void MIKMIDIEventStoreAppendPadding(NSMutableData *data)
+{
+	static const UInt8 padding[8] = { 0 };
+	[data appendBytes:padding length:(8 - [data length] % 8) % 8];
+}
+
+#pragma mark - Binary Search
+
+// Returns the index of the first record in chunk with a time stamp >= timeStamp, or > timeStamp if upper is true.
+static NSUInteger MIKMIDIEventStoreRecordIndexForTimeStamp(const MIKMIDIEventStoreChunk *chunk, MusicTimeStamp timeStamp, BOOL upper)
+{
+	NSUInteger low = 0, high = chunk->count;
+	while (low < high) {
+		NSUInteger mid = low + (high - low) / 2;
+		MusicTimeStamp midTimeStamp = chunk->records[mid].timeStamp;
+		if (midTimeStamp < timeStamp || (upper && midTimeStamp == timeStamp)) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+	return low;
+}
+
+// Returns the position of the first record with a time stamp >= timeStamp (or > timeStamp if upper is true).
+// If there is no such record, the returned position's chunk is numberOfChunks.
+static MIKMIDIEventStorePosition MIKMIDIEventStorePositionForTimeStamp(MIKMIDIEventStoreChunk *const *chunks, NSUInteger numberOfChunks, MusicTimeStamp timeStamp, BOOL upper)
+{
+	NSUInteger low = 0, high = numberOfChunks;
+	while (low < high) {
+		NSUInteger mid = low + (high - low) / 2;
+		const MIKMIDIEventStoreChunk *chunk = chunks[mid];
+		MusicTimeStamp lastTimeStamp = chunk->records[chunk->count - 1].timeStamp;
+		if (lastTimeStamp < timeStamp || (upper && lastTimeStamp == timeStamp)) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+
+	if (low == numberOfChunks) return (MIKMIDIEventStorePosition){ numberOfChunks, 0 };
+	return (MIKMIDIEventStorePosition){ low, MIKMIDIEventStoreRecordIndexForTimeStamp(chunks[low], timeStamp, upper) };
+}
+
+// Copies the records from start up to, but not including, end into buffer, and returns how many there were.
+// Pass NULL for buffer to only count them.
+static NSUInteger MIKMIDIEventStoreCopyRecords(MIKMIDIEventStoreChunk *const *chunks, NSUInteger numberOfChunks, MIKMIDIEventStorePosition start, MIKMIDIEventStorePosition end, MIKMIDIEventStoreRecord *buffer)
+{
+	NSUInteger count = 0;
+	for (NSUInteger i = start.chunk; i < numberOfChunks && i <= end.chunk; i++) {
+		NSUInteger from = (i == start.chunk) ? start.entry : 0;
+		NSUInteger to = (i == end.chunk) ? end.entry : chunks[i]->count;
+		if (to <= from) continue;
+		if (buffer) memcpy(buffer + count, chunks[i]->records + from, (to - from) * sizeof(MIKMIDIEventStoreRecord));
+		count += to - from;
+	}
+	return count;
+}
+
+#pragma mark - Chunk Maximum Tree
+
+// The chunk maximum tree is a binary tree of the chunks' maximum end time stamps stored in an array, where node n's children
+// are nodes 2n and 2n + 1, and leaf i, for chunk i, is node leafCount + i. Each node holds the maximum of its children.
+
+// Appends the indexes of chunks up to lastChunk whose maximum end time stamp is after timeStamp to chunkIndexes, in order
+static void MIKMIDIEventStoreFindChunksEndingAfterTimeStamp(const MusicTimeStamp *tree, NSUInteger node, NSUInteger firstLeaf, NSUInteger lastLeaf, NSUInteger lastChunk, MusicTimeStamp timeStamp, NSUInteger *chunkIndexes, NSUInteger *count)
+{
+	if (firstLeaf > lastChunk || tree[node] <= timeStamp) return;
+	if (firstLeaf == lastLeaf) {
+		chunkIndexes[(*count)++] = firstLeaf;
+		return;
+	}
+
+	NSUInteger middleLeaf = firstLeaf + (lastLeaf - firstLeaf) / 2;
+	MIKMIDIEventStoreFindChunksEndingAfterTimeStamp(tree, 2 * node, firstLeaf, middleLeaf, lastChunk, timeStamp, chunkIndexes, count);
+	MIKMIDIEventStoreFindChunksEndingAfterTimeStamp(tree, 2 * node + 1, middleLeaf + 1, lastLeaf, lastChunk, timeStamp, chunkIndexes, count);
+}
+
+#pragma mark -
+
+static MIKMIDIEventStore *MIKMIDIEventStoreMutableIndex(NSMutableDictionary *indexes, id key);
+
+// Whether records read from a cache are in time stamp order and only refer to payloads that are in use,
+// so that a corrupt or stale cache is rejected rather than read from
+static BOOL MIKMIDIEventStoreCachedRecordsAreValid(MIKMIDIEventStoreChunk **chunks, NSUInteger numberOfChunks, NSUInteger numberOfPayloads, NSIndexSet *freePayloadIndexes)
+{
+	MusicTimeStamp previousTimeStamp = -DBL_MAX;
+	for (NSUInteger i = 0; i < numberOfChunks; i++) {
+		const MIKMIDIEventStoreChunk *chunk = chunks[i];
+		for (NSUInteger j = 0; j < chunk->count; j++) {
+			const MIKMIDIEventStoreRecord *record = &chunk->records[j];
+			if (!(record->timeStamp >= previousTimeStamp)) return NO; // Also rejects NaN
+			previousTimeStamp = record->timeStamp;
+
+			if (!(record->eventType & MIKMIDIEventStoreRecordHasPayload)) continue;
+			if (record->payloadIndex >= numberOfPayloads || [freePayloadIndexes containsIndex:record->payloadIndex]) return NO;
+		}
+	}
+	return YES;
+}
+
+static void MIKMIDIEventStoreRemoveEventsFromIndexes(NSMutableDictionary *indexes, MusicTimeStamp startTimeStamp, MusicTimeStamp endTimeStamp)
+{
+	for (id key in [indexes allKeys]) {
+		MIKMIDIEventStore *eventStore = MIKMIDIEventStoreMutableIndex(indexes, key);
+		[eventStore removeEventsFromTimeStamp:startTimeStamp toTimeStamp:endTimeStamp];
+		if (!eventStore.count) [indexes removeObjectForKey:key];
+	}
+}
+
+static void MIKMIDIEventStoreAppendRecordForKey(NSMutableDictionary *recordsByKey, id key, const MIKMIDIEventStoreRecord *record)
+{
+	NSMutableData *recordData = recordsByKey[key];
+	if (!recordData) {
+		recordData = [NSMutableData data];
+		recordsByKey[key] = recordData;
+	}
+	[recordData appendBytes:record length:sizeof(MIKMIDIEventStoreRecord)];
+}
+
+@interface MIKMIDIEventStore ()
+{
+	MIKMIDIEventStoreChunk **_chunks;
+	NSUInteger _numberOfChunks;
+	NSUInteger _chunksCapacity;
+	NSUInteger _count;
+
+	// Data for events that don't fit in a record. Freed slots hold NSNull until they're reused.
+	MIKMIDIEventStorePayloadArena *_payloads;
+	NSMutableIndexSet *_freePayloadIndexes;
+
+	// Only recalculated from the chunks' maximums when an event that may have defined it is removed
+	MusicTimeStamp _maximumEndTimeStamp;
+	BOOL _maximumEndTimeStampIsValid;
+
+	// Rebuilt on the next query for sounding notes after chunks are added, removed or rearranged. Kept up to date otherwise.
+	MusicTimeStamp *_chunkMaximumTree;
+	NSUInteger _chunkMaximumTreeLeafCount;
+	BOOL _chunkMaximumTreeIsValid;
+
+	BOOL _maintainsTypeIndexes;
+	NSMutableDictionary *_eventStoresByEventType;
+	NSMutableDictionary *_eventStoresByControllerNumber;
+
+	// Set on type indexes that are also held by a copy of the store they belong to, which are copied before they're changed
+	BOOL _isSharedIndex;
+
+	// The cache the store's unowned chunks point into, if it was read from one
+	NSData *_cacheData;
+}
+@end
+
+@implementation MIKMIDIEventStore
+
+- (instancetype)initWithTypeIndexes:(BOOL)maintainsTypeIndexes
+{
+	self = [super init];
+	if (self) {
+		_payloads = [[MIKMIDIEventStorePayloadArena alloc] init];
+		_freePayloadIndexes = [NSMutableIndexSet indexSet];
+		_maximumEndTimeStamp = -DBL_MAX;
+		_maximumEndTimeStampIsValid = YES;
+		_maintainsTypeIndexes = maintainsTypeIndexes;
+		if (maintainsTypeIndexes) {
+			_eventStoresByEventType = [NSMutableDictionary dictionary];
+			_eventStoresByControllerNumber = [NSMutableDictionary dictionary];
+		}
+	}
+	return self;
+}
+
+- (instancetype)init
+{
+	return [self initWithTypeIndexes:YES];
+}
+
+- (void)dealloc
+{
+	for (NSUInteger i = 0; i < _numberOfChunks; i++) {
+		MIKMIDIEventStoreChunkRelease(_chunks[i]);
+	}
+	free(_chunks);
+	free(_chunkMaximumTree);
+}
+
+- (id)copyWithZone:(NSZone *)zone
+{
+	// Bring everything that is otherwise calculated lazily up to date, so reading from the copy never changes it
+	[self updateLazilyCalculatedValues];
+
+	MIKMIDIEventStore *copy = [[[self class] allocWithZone:zone] initWithTypeIndexes:_maintainsTypeIndexes];
+	if (_numberOfChunks) {
+		copy->_chunks = malloc(_numberOfChunks * sizeof(MIKMIDIEventStoreChunk *));
+		for (NSUInteger i = 0; i < _numberOfChunks; i++) {
+			copy->_chunks[i] = MIKMIDIEventStoreChunkRetain(_chunks[i]);
+		}
+	}
+	copy->_numberOfChunks = _numberOfChunks;
+	copy->_chunksCapacity = _numberOfChunks;
+	copy->_count = _count;
+	copy->_cacheData = _cacheData;
+
+	copy->_payloads = [_payloads copy];
+	copy->_freePayloadIndexes = [_freePayloadIndexes mutableCopy];
+
+	copy->_maximumEndTimeStamp = _maximumEndTimeStamp;
+	copy->_maximumEndTimeStampIsValid = _maximumEndTimeStampIsValid;
+	copy->_chunkMaximumTree = malloc(2 * _chunkMaximumTreeLeafCount * sizeof(MusicTimeStamp));
+	memcpy(copy->_chunkMaximumTree, _chunkMaximumTree, 2 * _chunkMaximumTreeLeafCount * sizeof(MusicTimeStamp));
+	copy->_chunkMaximumTreeLeafCount = _chunkMaximumTreeLeafCount;
+	copy->_chunkMaximumTreeIsValid = YES;
+
+	// The type indexes are shared too, and copied by whichever store changes them first
+	for (NSDictionary *indexes in @[_eventStoresByEventType ?: @{}, _eventStoresByControllerNumber ?: @{}]) {
+		for (MIKMIDIEventStore *eventStore in [indexes objectEnumerator]) {
+			[eventStore updateLazilyCalculatedValues];
+			eventStore->_isSharedIndex = YES;
+		}
+	}
+	if (_maintainsTypeIndexes) {
+		copy->_eventStoresByEventType = [_eventStoresByEventType mutableCopy];
+		copy->_eventStoresByControllerNumber = [_eventStoresByControllerNumber mutableCopy];
+	}
+	return copy;
+}
+
+#pragma mark - Cache Representation
+
+- (instancetype)initWithCacheData:(NSData *)data position:(NSUInteger *)position
+{
+	const UInt8 *bytes = [data bytes];
+	NSUInteger length = [data length];
+	NSUInteger offset = *position;
+	if (((uintptr_t)bytes | offset) % 8 || offset > length || length - offset < sizeof(MIKMIDIEventStoreCacheHeader)) return nil;
+
+	MIKMIDIEventStoreCacheHeader header;
+	memcpy(&header, bytes + offset, sizeof(header));
+	offset += sizeof(header);
+	if (header.recordSize != sizeof(MIKMIDIEventStoreRecord) || header.chunkHeaderSize != MIKMIDIEventStoreChunkHeaderSize) return nil;
+	if (header.numberOfChunks > (length - offset) / MIKMIDIEventStoreChunkHeaderSize) return nil;
+	if (header.numberOfPayloads > (length - offset) / sizeof(MIKMIDIEventStoreCachePayloadHeader)) return nil;
+	if (!header.maintainsTypeIndexes && (header.numberOfEventTypeIndexes || header.numberOfControllerNumberIndexes)) return nil;
+
+	self = [self initWithTypeIndexes:header.maintainsTypeIndexes != 0];
+	if (!self) return nil;
+	_cacheData = data;
+
+	// The chunks are used where they are. Only their structure is checked here, and their records once the payloads are read.
+	if (header.numberOfChunks) {
+		_chunks = malloc((NSUInteger)header.numberOfChunks * sizeof(MIKMIDIEventStoreChunk *));
+		_chunksCapacity = (NSUInteger)header.numberOfChunks;
+	}
+	for (UInt64 i = 0; i < header.numberOfChunks; i++) {
+		if (length - offset < MIKMIDIEventStoreChunkHeaderSize) return nil;
+		MIKMIDIEventStoreChunk *chunk = (void *)(bytes + offset);
+		if (atomic_load_explicit(&chunk->referenceCount, memory_order_relaxed) != MIKMIDIEventStoreChunkUnowned) return nil;
+		if (!chunk->count || chunk->count > MIKMIDIEventStoreChunkCapacity) return nil;
+		NSUInteger chunkLength = MIKMIDIEventStoreChunkHeaderSize + chunk->count * sizeof(MIKMIDIEventStoreRecord);
+		if (length - offset < chunkLength) return nil;
+
+		_chunks[_numberOfChunks++] = chunk;
+		_count += chunk->count;
+		offset += chunkLength;
+	}
+	if (_count != header.count) return nil;
+	_maximumEndTimeStampIsValid = NO;
+
+	for (UInt64 i = 0; i < header.numberOfPayloads; i++) {
+		if (length - offset < sizeof(MIKMIDIEventStoreCachePayloadHeader)) return nil;
+		MIKMIDIEventStoreCachePayloadHeader payloadHeader;
+		memcpy(&payloadHeader, bytes + offset, sizeof(payloadHeader));
+		offset += sizeof(payloadHeader);
+		NSUInteger paddedLength = ((NSUInteger)payloadHeader.length + 7) & ~(NSUInteger)7;
+		if (length - offset < paddedLength) return nil;
+
+		if (payloadHeader.isFree) {
+			[_freePayloadIndexes addIndex:[_payloads count]];
+			[_payloads addObject:[NSNull null]];
+		} else {
+			[_payloads addObject:[NSData dataWithBytes:bytes + offset length:payloadHeader.length]];
+		}
+		offset += paddedLength;
+	}
+	if (!MIKMIDIEventStoreCachedRecordsAreValid(_chunks, _numberOfChunks, [_payloads count], _freePayloadIndexes)) return nil;
+
+	NSUInteger numberOfIndexes = header.numberOfEventTypeIndexes + header.numberOfControllerNumberIndexes;
+	for (NSUInteger i = 0; i < numberOfIndexes; i++) {
+		if (length - offset < sizeof(UInt64)) return nil;
+		UInt64 key;
+		memcpy(&key, bytes + offset, sizeof(key));
+		offset += sizeof(key);
+
+		MIKMIDIEventStore *eventStore = [[MIKMIDIEventStore alloc] initWithCacheData:data position:&offset];
+		if (!eventStore || eventStore->_maintainsTypeIndexes) return nil;
+		NSMutableDictionary *indexes = (i < header.numberOfEventTypeIndexes) ? _eventStoresByEventType : _eventStoresByControllerNumber;
+		indexes[@((NSUInteger)key)] = eventStore;
+	}
+
+	*position = offset;
+	return self;
+}
+
+- (void)appendCacheRepresentationToData:(NSMutableData *)data
+{
+	MIKMIDIEventStoreCacheHeader header = {
+		.recordSize = sizeof(MIKMIDIEventStoreRecord),
+		.chunkHeaderSize = MIKMIDIEventStoreChunkHeaderSize,
+		.count = _count,
+		.numberOfChunks = _numberOfChunks,
+		.numberOfPayloads = [_payloads count],
+		.numberOfEventTypeIndexes = (UInt32)[_eventStoresByEventType count],
+		.numberOfControllerNumberIndexes = (UInt32)[_eventStoresByControllerNumber count],
+		.maintainsTypeIndexes = _maintainsTypeIndexes,
+	};
+	[data appendBytes:&header length:sizeof(header)];
+
+	for (NSUInteger i = 0; i < _numberOfChunks; i++) {
+		MIKMIDIEventStoreChunk *chunk = _chunks[i];
+		NSUInteger chunkOffset = [data length];
+		[data appendBytes:chunk length:MIKMIDIEventStoreChunkHeaderSize + chunk->count * sizeof(MIKMIDIEventStoreRecord)];
+		NSUInteger referenceCount = MIKMIDIEventStoreChunkUnowned;
+		[data replaceBytesInRange:NSMakeRange(chunkOffset + offsetof(MIKMIDIEventStoreChunk, referenceCount), sizeof(referenceCount)) withBytes:&referenceCount];
+	}
+
+	for (NSUInteger i = 0; i < [_payloads count]; i++) {
+		id payload = _payloads[i];
+		BOOL isFree = (payload == [NSNull null]);
+		MIKMIDIEventStoreCachePayloadHeader payloadHeader = { isFree ? 0 : (UInt32)[payload length], isFree };
+		[data appendBytes:&payloadHeader length:sizeof(payloadHeader)];
+		if (isFree) continue;
+		[data appendData:payload];
+		MIKMIDIEventStoreAppendPadding(data);
+	}
+
+	for (NSDictionary *indexes in @[_eventStoresByEventType ?: @{}, _eventStoresByControllerNumber ?: @{}]) {
+		for (NSNumber *key in indexes) {
+			UInt64 rawKey = [key unsignedLongLongValue];
+			[data appendBytes:&rawKey length:sizeof(rawKey)];
+			[indexes[key] appendCacheRepresentationToData:data];
+		}
+	}
+}
+
+#pragma mark - Adding and Removing Events
+
+- (BOOL)addEvent:(MIKMIDIEvent *)event
+{
+	if (!event) return NO;
+	NSData *data = event.data;
+	MIKMIDIEventStoreRecord record = MIKMIDIEventStoreRecordMake(event.timeStamp, event.eventType, [data bytes], [data length]);
+	if ([self positionOfRecord:&record data:data].chunk != NSNotFound) return NO;
+
+	[self addRecord:record data:data];
+	return YES;
+}
+
+- (BOOL)addEventWithTimeStamp:(MusicTimeStamp)timeStamp musicEventType:(MusicEventType)eventType data:(const void *)data length:(NSUInteger)length
+{
+	MIKMIDIEventType midiEventType = MIKMIDIEventTypeNULL;
+	if (eventType == kMusicEventType_MIDINoteMessage) {
+		midiEventType = MIKMIDIEventTypeMIDINoteMessage;
+	} else if (eventType == kMusicEventType_MIDIChannelMessage && length == sizeof(MIDIChannelMessage)) {
+		midiEventType = MIKMIDIEventStoreEventTypeForChannelStatus(((const MIDIChannelMessage *)data)->status);
+	}
+	if (midiEventType == MIKMIDIEventTypeNULL) {
+		// Meta events and the like are rare, and need MIKMIDIEvent to work out their type
+		return [self addEvent:[MIKMIDIEvent midiEventWithTimeStamp:timeStamp eventType:eventType data:[NSData dataWithBytes:data length:length]]];
+	}
+
+	// Only events that don't fit in a record need their data copied into an NSData
+	MIKMIDIEventStoreRecord record = MIKMIDIEventStoreRecordMake(timeStamp, midiEventType, data, length);
+	NSData *payload = (record.eventType & MIKMIDIEventStoreRecordHasPayload) ? [NSData dataWithBytes:data length:length] : nil;
+	if ([self positionOfRecord:&record data:payload].chunk != NSNotFound) return NO;
+
+	[self addRecord:record data:payload];
+	return YES;
+}
+
+- (BOOL)removeEvent:(MIKMIDIEvent *)event
+{
+	if (!event) return NO;
+	NSData *data = event.data;
+	MIKMIDIEventStoreRecord record = MIKMIDIEventStoreRecordMake(event.timeStamp, event.eventType, [data bytes], [data length]);
+	return [self removeRecord:&record data:data];
+}
+
+- (NSUInteger)removeEventsFromTimeStamp:(MusicTimeStamp)startTimeStamp toTimeStamp:(MusicTimeStamp)endTimeStamp
+{
+	if (endTimeStamp < startTimeStamp || !_count) return 0;
+
+	if (_maintainsTypeIndexes) {
+		MIKMIDIEventStoreRemoveEventsFromIndexes(_eventStoresByEventType, startTimeStamp, endTimeStamp);
+		MIKMIDIEventStoreRemoveEventsFromIndexes(_eventStoresByControllerNumber, startTimeStamp, endTimeStamp);
+	}
+	return [self removeRecordsFromTimeStamp:startTimeStamp toTimeStamp:endTimeStamp releasingPayloads:YES];
+}
+
+- (NSArray *)shiftEventsFromTimeStamp:(MusicTimeStamp)startTimeStamp toTimeStamp:(MusicTimeStamp)endTimeStamp byAmount:(MusicTimeStamp)offset
+{
+	NSUInteger numberOfMovedRecords = 0;
+	MIKMIDIEventStoreRecord *movedRecords = [self shiftRecordsFromTimeStamp:startTimeStamp toTimeStamp:endTimeStamp byAmount:offset count:&numberOfMovedRecords];
+	if (!movedRecords) return @[];
+
+	if (_maintainsTypeIndexes) {
+		// The indexes hold subsets of the store's events, so shifting the same range moves exactly the same events in them
+		for (NSMutableDictionary *indexes in @[_eventStoresByEventType, _eventStoresByControllerNumber]) {
+			for (id key in [indexes allKeys]) {
+				NSUInteger count = 0;
+				free([MIKMIDIEventStoreMutableIndex(indexes, key) shiftRecordsFromTimeStamp:startTimeStamp toTimeStamp:endTimeStamp byAmount:offset count:&count]);
+			}
+		}
+	}
+
+	NSMutableArray *movedEvents = [NSMutableArray arrayWithCapacity:numberOfMovedRecords];
+	for (NSUInteger i = 0; i < numberOfMovedRecords; i++) {
+		[movedEvents addObject:MIKMIDIEventStoreEventForRecord(&movedRecords[i], _payloads)];
+	}
+	free(movedRecords);
+	return [movedEvents copy];
+}
+
+- (void)removeAllEvents
+{
+	for (NSUInteger i = 0; i < _numberOfChunks; i++) {
+		MIKMIDIEventStoreChunkRelease(_chunks[i]);
+	}
+	_numberOfChunks = 0;
+	_count = 0;
+	_payloads = [[MIKMIDIEventStorePayloadArena alloc] init];
+	_freePayloadIndexes = [NSMutableIndexSet indexSet];
+	_maximumEndTimeStamp = -DBL_MAX;
+	_maximumEndTimeStampIsValid = YES;
+	_chunkMaximumTreeIsValid = NO;
+	_cacheData = nil;
+
+	[_eventStoresByEventType removeAllObjects];
+	[_eventStoresByControllerNumber removeAllObjects];
+}
+
+#pragma mark - Transforming Notes
+
+- (BOOL)applyNoteTransform:(MIKMIDINoteTransform *)transform trackNumber:(NSInteger)trackNumber startTimeStamp:(MusicTimeStamp *)startTimeStamp endTimeStamp:(MusicTimeStamp *)endTimeStamp
+{
+	if (!transform || !_count) return NO;
+	if (_maintainsTypeIndexes && !_eventStoresByEventType[@(MIKMIDIEventTypeMIDINoteMessage)]) return NO;
+
+	NSUInteger count = _count;
+	MIKMIDIEventStoreRecord *records = malloc(count * sizeof(MIKMIDIEventStoreRecord));
+	MIKMIDIEventStoreCopyRecords(_chunks, _numberOfChunks, (MIKMIDIEventStorePosition){ 0, 0 }, (MIKMIDIEventStorePosition){ _numberOfChunks, 0 }, records);
+
+	// Gather the notes into the form transforms work on, remembering where each one came from
+	NSUInteger *noteIndexes = malloc(count * sizeof(NSUInteger));
+	MIKMIDINoteTransformNote *notes = malloc(count * sizeof(MIKMIDINoteTransformNote));
+	NSUInteger numberOfNotes = 0;
+	for (NSUInteger i = 0; i < count; i++) {
+		const MIKMIDIEventStoreRecord *record = &records[i];
+		if (MIKMIDIEventStoreRecordEventType(record) != MIKMIDIEventTypeMIDINoteMessage) continue;
+
+		MIKMIDINoteTransformNote note = { .timeStamp = record->timeStamp };
+		if (record->eventType & MIKMIDIEventStoreRecordHasPayload) {
+			NSData *data = _payloads[record->payloadIndex];
+			if ([data length] < sizeof(MIDINoteMessage)) continue;
+			const MIDINoteMessage *message = [data bytes];
+			note.channel = message->channel;
+			note.note = message->note;
+			note.velocity = message->velocity;
+			note.duration = message->duration;
+		} else {
+			note.channel = record->bytes[0];
+			note.note = record->bytes[1];
+			note.velocity = record->bytes[2];
+			note.duration = record->duration;
+		}
+		noteIndexes[numberOfNotes] = i;
+		notes[numberOfNotes++] = note;
+	}
+
+	[transform applyToNotes:notes count:numberOfNotes trackNumber:trackNumber];
+
+	// Write the changed notes back into their records
+	MusicTimeStamp start = DBL_MAX, end = -DBL_MAX;
+	for (NSUInteger i = 0; i < numberOfNotes; i++) {
+		MIKMIDIEventStoreRecord *record = &records[noteIndexes[i]];
+		const MIKMIDINoteTransformNote *note = &notes[i];
+		BOOL changed = (record->timeStamp != note->timeStamp);
+
+		if (record->eventType & MIKMIDIEventStoreRecordHasPayload) {
+			NSData *data = _payloads[record->payloadIndex];
+			MIDINoteMessage message = *(const MIDINoteMessage *)[data bytes];
+			MIDINoteMessage transformedMessage = { note->channel, note->note, note->velocity, message.releaseVelocity, note->duration };
+			if (memcmp(&message, &transformedMessage, sizeof(MIDINoteMessage))) {
+				changed = YES;
+				NSMutableData *transformedData = [data mutableCopy];
+				[transformedData replaceBytesInRange:NSMakeRange(0, sizeof(MIDINoteMessage)) withBytes:&transformedMessage];
+				_payloads[record->payloadIndex] = [transformedData copy];
+			}
+		} else {
+			UInt8 bytes[3] = { note->channel, note->note, note->velocity };
+			if (memcmp(record->bytes, bytes, sizeof(bytes)) || record->duration != note->duration) {
+				changed = YES;
+				memcpy(record->bytes, bytes, sizeof(bytes));
+				record->duration = note->duration;
+			}
+		}
+		if (!changed) continue;
+
+		start = MIN(start, MIN(record->timeStamp, note->timeStamp));
+		end = MAX(end, MAX(record->timeStamp, note->timeStamp));
+		record->timeStamp = note->timeStamp;
+	}
+	free(noteIndexes);
+	free(notes);
+
+	if (start > end) {
+		free(records);
+		return NO;
+	}
+
+	// Moved notes may have passed other events
+	mergesort(records, count, sizeof(MIKMIDIEventStoreRecord), MIKMIDIEventStoreCompareRecordTimeStamps);
+
+	NSUInteger numberOfKeptRecords = [self removeDuplicatesFromSortedRecords:records count:count];
+
+	// Repack everything into new chunks in one pass
+	for (NSUInteger i = 0; i < _numberOfChunks; i++) {
+		MIKMIDIEventStoreChunkRelease(_chunks[i]);
+	}
+	_numberOfChunks = 0;
+	_count = 0;
+	[self mergeSortedRecords:records count:numberOfKeptRecords];
+
+	if (_maintainsTypeIndexes) {
+		// The notes index is rebuilt from the transformed records, rather than transformed separately
+		MIKMIDIEventStore *noteEventStore = [[MIKMIDIEventStore alloc] initWithTypeIndexes:NO];
+		NSUInteger numberOfNoteRecords = 0;
+		for (NSUInteger i = 0; i < numberOfKeptRecords; i++) {
+			MIKMIDIEventStoreRecord record = records[i];
+			if (MIKMIDIEventStoreRecordEventType(&record) != MIKMIDIEventTypeMIDINoteMessage) continue;
+			if (record.eventType & MIKMIDIEventStoreRecordHasPayload) record.payloadIndex = [noteEventStore addPayload:_payloads[record.payloadIndex]];
+			records[numberOfNoteRecords++] = record;
+		}
+		[noteEventStore mergeSortedRecords:records count:numberOfNoteRecords];
+		_eventStoresByEventType[@(MIKMIDIEventTypeMIDINoteMessage)] = noteEventStore;
+	}
+	free(records);
+
+	if (startTimeStamp) *startTimeStamp = start;
+	if (endTimeStamp) *endTimeStamp = end;
+	return YES;
+}
+
+#pragma mark - Splitting Channels
+
+- (void)addEventsToChannelEventStores:(NSArray *)channelEventStores
+{
+	// Records are copied across as they are, so no events are created
+	MIKMIDIEventStore *otherEventStore = [channelEventStores lastObject];
+	for (NSUInteger i = 0; i < _numberOfChunks; i++) {
+		MIKMIDIEventStoreChunk *chunk = _chunks[i];
+		for (NSUInteger j = 0; j < chunk->count; j++) {
+			MIKMIDIEventStoreRecord record = chunk->records[j];
+			NSData *payload = (record.eventType & MIKMIDIEventStoreRecordHasPayload) ? _payloads[record.payloadIndex] : nil;
+			NSUInteger channel = MIKMIDIEventStoreRecordChannel(&record, payload);
+			MIKMIDIEventStore *eventStore = (channel < 16) ? channelEventStores[channel] : otherEventStore;
+			if ([eventStore positionOfRecord:&record data:payload].chunk != NSNotFound) continue;
+			[eventStore addRecord:record data:payload];
+		}
+	}
+}
+
+#pragma mark - Merging
+
++ (instancetype)eventStoreByMergingEventStores:(NSArray *)eventStores offsets:(NSArray *)offsets
+{
+	MIKMIDIEventStore *result = [[self alloc] init];
+	NSUInteger totalCount = 0;
+	for (MIKMIDIEventStore *eventStore in eventStores) {
+		totalCount += eventStore->_count;
+	}
+	if (!totalCount) return result;
+
+	// Gather every record, moved by its store's offset, with its payload moved into the new store's arena
+	MIKMIDIEventStoreRecord *records = malloc(totalCount * sizeof(MIKMIDIEventStoreRecord));
+	NSUInteger count = 0;
+	BOOL isSorted = YES;
+	for (NSUInteger i = 0; i < [eventStores count]; i++) {
+		MIKMIDIEventStore *eventStore = eventStores[i];
+		MusicTimeStamp offset = [offsets[i] doubleValue];
+		NSUInteger start = count;
+		count += MIKMIDIEventStoreCopyRecords(eventStore->_chunks, eventStore->_numberOfChunks, (MIKMIDIEventStorePosition){ 0, 0 }, (MIKMIDIEventStorePosition){ eventStore->_numberOfChunks, 0 }, records + count);
+		for (NSUInteger j = start; j < count; j++) {
+			MIKMIDIEventStoreRecord *record = &records[j];
+			record->timeStamp += offset;
+			if (record->eventType & MIKMIDIEventStoreRecordHasPayload) record->payloadIndex = [result addPayload:eventStore->_payloads[record->payloadIndex]];
+		}
+		if (start && start < count && records[start].timeStamp < records[start - 1].timeStamp) isSorted = NO;
+	}
+
+	// Each store's records are already sorted, which mergesort() takes advantage of, and it keeps records
+	// with equal time stamps in the order of their stores
+	if (!isSorted) mergesort(records, count, sizeof(MIKMIDIEventStoreRecord), MIKMIDIEventStoreCompareRecordTimeStamps);
+	count = [result removeDuplicatesFromSortedRecords:records count:count];
+	[result mergeSortedRecords:records count:count];
+	[result rebuildTypeIndexesFromRecords:records count:count];
+	free(records);
+	return result;
+}
+
+#pragma mark - Querying Events
+
+- (BOOL)containsEvent:(MIKMIDIEvent *)event
+{
+	if (!event) return NO;
+	NSData *data = event.data;
+	MIKMIDIEventStoreRecord record = MIKMIDIEventStoreRecordMake(event.timeStamp, event.eventType, [data bytes], [data length]);
+	return [self positionOfRecord:&record data:data].chunk != NSNotFound;
+}
+
+- (NSArray *)eventsOfClass:(Class)eventClass fromTimeStamp:(MusicTimeStamp)startTimeStamp toTimeStamp:(MusicTimeStamp)endTimeStamp
+{
+	if (_maintainsTypeIndexes && eventClass && eventClass != [MIKMIDIEvent class]) {
+		// MIKMIDIEvent always instantiates the subclass registered for an event type, so all events
+		// in a type index are of the same class. If only one type matches eventClass, use its index.
+		MIKMIDIEventStore *matchingEventStore = nil;
+		NSUInteger numberOfMatchingEventStores = 0;
+		for (MIKMIDIEventStore *eventStore in [_eventStoresByEventType objectEnumerator]) {
+			if (![eventStore.firstEvent isKindOfClass:eventClass]) continue;
+			matchingEventStore = eventStore;
+			numberOfMatchingEventStores++;
+		}
+		if (numberOfMatchingEventStores == 0) return @[];
+		if (numberOfMatchingEventStores == 1) {
+			return [matchingEventStore eventsOfClass:Nil fromTimeStamp:startTimeStamp toTimeStamp:endTimeStamp];
+		}
+	}
+
+	NSMutableArray *result = [NSMutableArray array];
+	[self enumerateEventsFromTimeStamp:startTimeStamp toTimeStamp:endTimeStamp usingBlock:^(MIKMIDIEvent *event, BOOL *stop) {
+		if (eventClass && ![event isKindOfClass:eventClass]) return;
+		[result addObject:event];
+	}];
+	return [result copy];
+}
+
+- (NSArray *)eventsOfType:(MIKMIDIEventType)eventType fromTimeStamp:(MusicTimeStamp)startTimeStamp toTimeStamp:(MusicTimeStamp)endTimeStamp
+{
+	if (!_maintainsTypeIndexes) {
+		NSMutableArray *result = [NSMutableArray array];
+		MIKMIDIEventStorePayloadArena *payloads = _payloads;
+		[self enumerateRecordsFromTimeStamp:startTimeStamp toTimeStamp:endTimeStamp usingBlock:^(const MIKMIDIEventStoreRecord *record, BOOL *stop) {
+			if (MIKMIDIEventStoreRecordEventType(record) != eventType) return;
+			[result addObject:MIKMIDIEventStoreEventForRecord(record, payloads)];
+		}];
+		return [result copy];
+	}
+
+	MIKMIDIEventStore *eventStore = _eventStoresByEventType[@(eventType)];
+	return eventStore ? [eventStore eventsOfClass:Nil fromTimeStamp:startTimeStamp toTimeStamp:endTimeStamp] : @[];
+}
+
+- (NSArray *)controlChangeEventsForControllerNumber:(NSUInteger)controllerNumber fromTimeStamp:(MusicTimeStamp)startTimeStamp toTimeStamp:(MusicTimeStamp)endTimeStamp
+{
+	if (!_maintainsTypeIndexes) {
+		NSMutableArray *result = [NSMutableArray array];
+		MIKMIDIEventStorePayloadArena *payloads = _payloads;
+		[self enumerateRecordsFromTimeStamp:startTimeStamp toTimeStamp:endTimeStamp usingBlock:^(const MIKMIDIEventStoreRecord *record, BOOL *stop) {
+			if (MIKMIDIEventStoreRecordEventType(record) != MIKMIDIEventTypeMIDIControlChangeMessage) return;
+			if (MIKMIDIEventStoreRecordControllerNumber(record, payloads) != controllerNumber) return;
+			[result addObject:MIKMIDIEventStoreEventForRecord(record, payloads)];
+		}];
+		return [result copy];
+	}
+
+	MIKMIDIEventStore *eventStore = _eventStoresByControllerNumber[@(controllerNumber)];
+	return eventStore ? [eventStore eventsOfClass:Nil fromTimeStamp:startTimeStamp toTimeStamp:endTimeStamp] : @[];
+}
+
+- (NSArray *)notesSoundingFromTimeStamp:(MusicTimeStamp)startTimeStamp toTimeStamp:(MusicTimeStamp)endTimeStamp
+{
+	if (_maintainsTypeIndexes) {
+		MIKMIDIEventStore *eventStore = _eventStoresByEventType[@(MIKMIDIEventTypeMIDINoteMessage)];
+		return eventStore ? [eventStore notesSoundingFromTimeStamp:startTimeStamp toTimeStamp:endTimeStamp] : @[];
+	}
+	if (endTimeStamp < startTimeStamp || !_count) return @[];
+
+	NSMutableArray *result = [NSMutableArray array];
+	MIKMIDIEventStorePayloadArena *payloads = _payloads;
+
+	// Notes that start before the range can only be in chunks before the range's first record,
+	// and only in those chunks whose maximum end time stamp is after the start of the range.
+	[self updateChunkMaximumTreeIfNeeded];
+	MIKMIDIEventStorePosition start = MIKMIDIEventStorePositionForTimeStamp(_chunks, _numberOfChunks, startTimeStamp, NO);
+	NSUInteger lastChunk = MIN(start.chunk, _numberOfChunks - 1);
+	NSUInteger *chunkIndexes = malloc((lastChunk + 1) * sizeof(NSUInteger));
+	NSUInteger numberOfChunkIndexes = 0;
+	MIKMIDIEventStoreFindChunksEndingAfterTimeStamp(_chunkMaximumTree, 1, 0, _chunkMaximumTreeLeafCount - 1, lastChunk, startTimeStamp, chunkIndexes, &numberOfChunkIndexes);
+	for (NSUInteger i = 0; i < numberOfChunkIndexes; i++) {
+		MIKMIDIEventStoreChunk *chunk = _chunks[chunkIndexes[i]];
+		for (NSUInteger j = 0; j < chunk->count && chunk->records[j].timeStamp < startTimeStamp; j++) {
+			MIKMIDIEventStoreRecord *record = &chunk->records[j];
+			if (MIKMIDIEventStoreRecordEventType(record) != MIKMIDIEventTypeMIDINoteMessage) continue;
+			if (MIKMIDIEventStoreRecordEndTimeStamp(record, payloads) > startTimeStamp) [result addObject:MIKMIDIEventStoreEventForRecord(record, payloads)];
+		}
+	}
+	free(chunkIndexes);
+
+	[self enumerateRecordsFromTimeStamp:startTimeStamp toTimeStamp:endTimeStamp usingBlock:^(const MIKMIDIEventStoreRecord *record, BOOL *stop) {
+		if (MIKMIDIEventStoreRecordEventType(record) == MIKMIDIEventTypeMIDINoteMessage) [result addObject:MIKMIDIEventStoreEventForRecord(record, payloads)];
+	}];
+	return [result copy];
+}
+
+- (void)enumerateEventsFromTimeStamp:(MusicTimeStamp)startTimeStamp toTimeStamp:(MusicTimeStamp)endTimeStamp usingBlock:(void (^)(MIKMIDIEvent *, BOOL *))block
+{
+	if (!block) return;
+
+	MIKMIDIEventStorePayloadArena *payloads = _payloads;
+	[self enumerateRecordsFromTimeStamp:startTimeStamp toTimeStamp:endTimeStamp usingBlock:^(const MIKMIDIEventStoreRecord *record, BOOL *stop) {
+		block(MIKMIDIEventStoreEventForRecord(record, payloads), stop);
+	}];
+}
+
+- (void)enumerateRawEventsFromTimeStamp:(MusicTimeStamp)startTimeStamp toTimeStamp:(MusicTimeStamp)endTimeStamp usingBlock:(void (^)(MusicTimeStamp, MIKMIDIEventType, const void *, UInt32, BOOL *))block
+{
+	if (!block) return;
+
+	MIKMIDIEventStorePayloadArena *payloads = _payloads;
+	[self enumerateRecordsFromTimeStamp:startTimeStamp toTimeStamp:endTimeStamp usingBlock:^(const MIKMIDIEventStoreRecord *record, BOOL *stop) {
+		MIKMIDIEventStoreRecordData buffer;
+		UInt32 length = 0;
+		const void *data = MIKMIDIEventStoreRecordGetData(record, payloads, &buffer, &length);
+		block(record->timeStamp, MIKMIDIEventStoreRecordEventType(record), data, length, stop);
+	}];
+}
+
+- (void)enumerateRawEventsFromTimeStamp:(MusicTimeStamp)startTimeStamp toTimeStamp:(MusicTimeStamp)endTimeStamp usingFunction:(MIKMIDIEventStoreEnumerationFunction)function context:(void *)context
+{
+	if (!function) return;
+
+	[self enumerateRawEventsFromTimeStamp:startTimeStamp toTimeStamp:endTimeStamp usingBlock:^(MusicTimeStamp timeStamp, MIKMIDIEventType eventType, const void *data, UInt32 length, BOOL *stop) {
+		function(timeStamp, eventType, data, length, context, stop);
+	}];
+}
+
+- (BOOL)getTimeStampRangeOfDifferencesFromEventStore:(MIKMIDIEventStore *)eventStore startTimeStamp:(MusicTimeStamp *)startTimeStamp endTimeStamp:(MusicTimeStamp *)endTimeStamp
+{
+	// Shared chunks are never changed, so only the chunks between the shared ones at either end can differ
+	MIKMIDIEventStoreChunk **chunks = eventStore->_chunks;
+	NSUInteger numberOfChunks = eventStore->_numberOfChunks;
+	NSUInteger numberOfSharedChunksAtStart = 0;
+	while (numberOfSharedChunksAtStart < MIN(_numberOfChunks, numberOfChunks) && _chunks[numberOfSharedChunksAtStart] == chunks[numberOfSharedChunksAtStart]) {
+		numberOfSharedChunksAtStart++;
+	}
+	if (numberOfSharedChunksAtStart == _numberOfChunks && numberOfSharedChunksAtStart == numberOfChunks) return NO;
+
+	NSUInteger numberOfSharedChunksAtEnd = 0;
+	while (numberOfSharedChunksAtStart + numberOfSharedChunksAtEnd < MIN(_numberOfChunks, numberOfChunks) &&
+		   _chunks[_numberOfChunks - numberOfSharedChunksAtEnd - 1] == chunks[numberOfChunks - numberOfSharedChunksAtEnd - 1]) {
+		numberOfSharedChunksAtEnd++;
+	}
+
+	MusicTimeStamp start = DBL_MAX, end = -DBL_MAX;
+	if (_numberOfChunks > numberOfSharedChunksAtStart + numberOfSharedChunksAtEnd) {
+		MIKMIDIEventStoreChunk *lastChunk = _chunks[_numberOfChunks - numberOfSharedChunksAtEnd - 1];
+		start = MIN(start, _chunks[numberOfSharedChunksAtStart]->records[0].timeStamp);
+		end = MAX(end, lastChunk->records[lastChunk->count - 1].timeStamp);
+	}
+	if (numberOfChunks > numberOfSharedChunksAtStart + numberOfSharedChunksAtEnd) {
+		MIKMIDIEventStoreChunk *lastChunk = chunks[numberOfChunks - numberOfSharedChunksAtEnd - 1];
+		start = MIN(start, chunks[numberOfSharedChunksAtStart]->records[0].timeStamp);
+		end = MAX(end, lastChunk->records[lastChunk->count - 1].timeStamp);
+	}
+	if (startTimeStamp) *startTimeStamp = start;
+	if (endTimeStamp) *endTimeStamp = end;
+	return YES;
+}
+
+#pragma mark - Private
+
+// Adds record, which must not have a payload index yet, and updates the type indexes, without checking for an existing equal event.
+// data is only used if the record has MIKMIDIEventStoreRecordHasPayload set, and may be nil otherwise.
+- (void)addRecord:(MIKMIDIEventStoreRecord)record data:(NSData *)data
+{
+	MIKMIDIEventStoreRecord indexRecord = record; // The indexes have payload arenas of their own
+	if (record.eventType & MIKMIDIEventStoreRecordHasPayload) record.payloadIndex = [self addPayload:data];
+	[self insertRecord:record];
+	if (!_maintainsTypeIndexes) return;
+
+	NSNumber *eventType = @(MIKMIDIEventStoreRecordEventType(&record));
+	MIKMIDIEventStore *eventStore = MIKMIDIEventStoreMutableIndex(_eventStoresByEventType, eventType);
+	if (!eventStore) {
+		eventStore = [[MIKMIDIEventStore alloc] initWithTypeIndexes:NO];
+		_eventStoresByEventType[eventType] = eventStore;
+	}
+	[eventStore addRecord:indexRecord data:data];
+
+	if (MIKMIDIEventStoreRecordEventType(&record) == MIKMIDIEventTypeMIDIControlChangeMessage) {
+		NSNumber *controllerNumber = @(MIKMIDIEventStoreRecordControllerNumber(&record, _payloads));
+		eventStore = MIKMIDIEventStoreMutableIndex(_eventStoresByControllerNumber, controllerNumber);
+		if (!eventStore) {
+			eventStore = [[MIKMIDIEventStore alloc] initWithTypeIndexes:NO];
+			_eventStoresByControllerNumber[controllerNumber] = eventStore;
+		}
+		[eventStore addRecord:indexRecord data:data];
+	}
+}
+
+// Removes the record matching record and data, and its entries in the type indexes
+- (BOOL)removeRecord:(const MIKMIDIEventStoreRecord *)record data:(NSData *)data
+{
+	MIKMIDIEventStorePosition position = [self positionOfRecord:record data:data];
+	if (position.chunk == NSNotFound) return NO;
+
+	if (_maintainsTypeIndexes) {
+		NSNumber *eventType = @(MIKMIDIEventStoreRecordEventType(record));
+		MIKMIDIEventStore *eventStore = MIKMIDIEventStoreMutableIndex(_eventStoresByEventType, eventType);
+		[eventStore removeRecord:record data:data];
+		if (eventStore && !eventStore.count) [_eventStoresByEventType removeObjectForKey:eventType];
+
+		if (MIKMIDIEventStoreRecordEventType(record) == MIKMIDIEventTypeMIDIControlChangeMessage) {
+			const MIKMIDIEventStoreRecord *storedRecord = &_chunks[position.chunk]->records[position.entry];
+			NSNumber *controllerNumber = @(MIKMIDIEventStoreRecordControllerNumber(storedRecord, _payloads));
+			eventStore = MIKMIDIEventStoreMutableIndex(_eventStoresByControllerNumber, controllerNumber);
+			[eventStore removeRecord:record data:data];
+			if (eventStore && !eventStore.count) [_eventStoresByControllerNumber removeObjectForKey:controllerNumber];
+		}
+	}
+
+	[self removeRecordAtPosition:position];
+	return YES;
+}
+
+// Inserts record without checking for an existing equal event, or updating type indexes. Its payload, if any, must already be in the arena.
+- (void)insertRecord:(MIKMIDIEventStoreRecord)record
+{
+	MusicTimeStamp timeStamp = record.timeStamp;
+	MusicTimeStamp endTimeStamp = MIKMIDIEventStoreRecordEndTimeStamp(&record, _payloads);
+	if (!_numberOfChunks) [self insertChunk:MIKMIDIEventStoreChunkCreate() atIndex:0];
+
+	// Insert after any events with the same time stamp so that events at the same time stay in the order they were added
+	MIKMIDIEventStorePosition position = MIKMIDIEventStorePositionForTimeStamp(_chunks, _numberOfChunks, timeStamp, YES);
+	if (position.chunk == _numberOfChunks) {
+		position.chunk = _numberOfChunks - 1;
+		position.entry = _chunks[position.chunk]->count;
+	}
+
+	MIKMIDIEventStoreChunk *chunk = [self mutableChunkAtIndex:position.chunk];
+	if (chunk->count == MIKMIDIEventStoreChunkCapacity) {
+		MIKMIDIEventStoreChunk *newChunk = MIKMIDIEventStoreChunkCreate();
+		if (position.entry == chunk->count) {
+			// Appending to the end of a full chunk, which is what happens when events are added in order.
+			// Start a new chunk instead of splitting, so loading a track doesn't leave every chunk half full.
+			[self insertChunk:newChunk atIndex:position.chunk + 1];
+			position.chunk++;
+			position.entry = 0;
+			chunk = newChunk;
+		} else {
+			NSUInteger half = chunk->count / 2;
+			newChunk->count = chunk->count - half;
+			memcpy(newChunk->records, chunk->records + half, newChunk->count * sizeof(MIKMIDIEventStoreRecord));
+			chunk->count = half;
+			MIKMIDIEventStoreChunkUpdateMaximumEndTimeStamp(chunk, _payloads);
+			MIKMIDIEventStoreChunkUpdateMaximumEndTimeStamp(newChunk, _payloads);
+			[self insertChunk:newChunk atIndex:position.chunk + 1];
+			if (position.entry > half) {
+				position.chunk++;
+				position.entry -= half;
+				chunk = newChunk;
+			}
+		}
+	}
+
+	memmove(chunk->records + position.entry + 1, chunk->records + position.entry, (chunk->count - position.entry) * sizeof(MIKMIDIEventStoreRecord));
+	chunk->records[position.entry] = record;
+	chunk->count++;
+	_count++;
+
+	if (endTimeStamp > chunk->maximumEndTimeStamp) {
+		chunk->maximumEndTimeStamp = endTimeStamp;
+		[self updateChunkMaximumTreeAtIndex:position.chunk];
+	}
+	if (_maximumEndTimeStampIsValid && endTimeStamp > _maximumEndTimeStamp) _maximumEndTimeStamp = endTimeStamp;
+}
+
+// Merges the store's records with records, which must be sorted by time stamp, in a single pass
+- (void)mergeSortedRecords:(const MIKMIDIEventStoreRecord *)records count:(NSUInteger)numberOfRecords
+{
+	NSUInteger totalCount = _count + numberOfRecords;
+	NSUInteger capacity = MAX((totalCount + MIKMIDIEventStoreChunkCapacity - 1) / MIKMIDIEventStoreChunkCapacity, 8);
+	MIKMIDIEventStoreChunk **mergedChunks = malloc(capacity * sizeof(MIKMIDIEventStoreChunk *));
+	NSUInteger numberOfMergedChunks = 0;
+	MIKMIDIEventStoreChunk *currentChunk = NULL;
+
+	NSUInteger chunkIndex = 0, entryIndex = 0, recordIndex = 0;
+	while (chunkIndex < _numberOfChunks || recordIndex < numberOfRecords) {
+		BOOL takeExistingRecord;
+		if (chunkIndex == _numberOfChunks) {
+			takeExistingRecord = NO;
+		} else if (recordIndex == numberOfRecords) {
+			takeExistingRecord = YES;
+		} else {
+			takeExistingRecord = _chunks[chunkIndex]->records[entryIndex].timeStamp <= records[recordIndex].timeStamp;
+		}
+
+		MIKMIDIEventStoreRecord record;
+		if (takeExistingRecord) {
+			record = _chunks[chunkIndex]->records[entryIndex++];
+			if (entryIndex == _chunks[chunkIndex]->count) {
+				MIKMIDIEventStoreChunkRelease(_chunks[chunkIndex++]);
+				entryIndex = 0;
+			}
+		} else {
+			record = records[recordIndex++];
+		}
+
+		if (!currentChunk || currentChunk->count == MIKMIDIEventStoreChunkCapacity) {
+			currentChunk = MIKMIDIEventStoreChunkCreate();
+			mergedChunks[numberOfMergedChunks++] = currentChunk;
+		}
+		currentChunk->records[currentChunk->count++] = record;
+		MusicTimeStamp endTimeStamp = MIKMIDIEventStoreRecordEndTimeStamp(&record, _payloads);
+		if (endTimeStamp > currentChunk->maximumEndTimeStamp) currentChunk->maximumEndTimeStamp = endTimeStamp;
+	}
+
+	free(_chunks);
+	_chunks = mergedChunks;
+	_numberOfChunks = numberOfMergedChunks;
+	_chunksCapacity = capacity;
+	_count = totalCount;
+	_maximumEndTimeStampIsValid = NO;
+	_chunkMaximumTreeIsValid = NO;
+}
+
+// Removes the records in records, which must be sorted by time stamp and refer to the store's payloads, that equal an earlier one,
+// releasing their payloads. Returns the number of records kept, which are moved to the start of records.
+- (NSUInteger)removeDuplicatesFromSortedRecords:(MIKMIDIEventStoreRecord *)records count:(NSUInteger)count
+{
+	// Equal events always have equal time stamps, so duplicates can only be in the same run of time stamps. Short runs are
+	// searched record by record. Longer ones, like the setup events at the start of a file, are searched using a hash table.
+	NSUInteger numberOfKeptRecords = 0;
+	MIKMIDIEventStoreDuplicateTableEntry *table = NULL;
+	NSUInteger tableCapacity = 0;
+	for (NSUInteger runStart = 0, runEnd = 0; runStart < count; runStart = runEnd) {
+		MusicTimeStamp timeStamp = records[runStart].timeStamp;
+		runEnd = runStart + 1;
+		while (runEnd < count && records[runEnd].timeStamp == timeStamp) runEnd++;
+
+		NSUInteger firstKeptRecord = numberOfKeptRecords;
+		NSUInteger mask = 0;
+		BOOL usesTable = (runEnd - runStart > MIKMIDIEventStoreLinearDuplicateSearchLimit);
+		if (usesTable) {
+			NSUInteger capacity = MIKMIDIEventStoreLinearDuplicateSearchLimit;
+			while (capacity < 2 * (runEnd - runStart)) capacity *= 2;
+			if (capacity > tableCapacity) {
+				table = realloc(table, capacity * sizeof(MIKMIDIEventStoreDuplicateTableEntry));
+				tableCapacity = capacity;
+			}
+			memset(table, 0, capacity * sizeof(MIKMIDIEventStoreDuplicateTableEntry));
+			mask = capacity - 1;
+		}
+
+		for (NSUInteger i = runStart; i < runEnd; i++) {
+			MIKMIDIEventStoreRecord record = records[i];
+			NSData *data = (record.eventType & MIKMIDIEventStoreRecordHasPayload) ? _payloads[record.payloadIndex] : nil;
+			BOOL isDuplicate = NO;
+			if (usesTable) {
+				NSUInteger hash = MIKMIDIEventStoreRecordHash(&record, data);
+				NSUInteger slot = hash & mask;
+				for (; table[slot].keptRecordNumber && !isDuplicate; slot = (slot + 1) & mask) {
+					isDuplicate = (table[slot].hash == hash && MIKMIDIEventStoreRecordMatches(&records[table[slot].keptRecordNumber - 1], _payloads, &record, data));
+				}
+				if (!isDuplicate) table[slot] = (MIKMIDIEventStoreDuplicateTableEntry){ hash, numberOfKeptRecords + 1 };
+			} else {
+				for (NSUInteger j = firstKeptRecord; j < numberOfKeptRecords && !isDuplicate; j++) {
+					isDuplicate = MIKMIDIEventStoreRecordMatches(&records[j], _payloads, &record, data);
+				}
+			}
+			if (isDuplicate) {
+				[self releasePayloadOfRecord:&record];
+				continue;
+			}
+			records[numberOfKeptRecords++] = record;
+		}
+	}
+	free(table);
+	return numberOfKeptRecords;
+}
+
+// Replaces the type indexes with ones built from records, which must be all of the store's records in order, in a single pass
+- (void)rebuildTypeIndexesFromRecords:(const MIKMIDIEventStoreRecord *)records count:(NSUInteger)count
+{
+	if (!_maintainsTypeIndexes) return;
+
+	NSMutableDictionary *recordsByEventType = [NSMutableDictionary dictionary];
+	NSMutableDictionary *recordsByControllerNumber = [NSMutableDictionary dictionary];
+	for (NSUInteger i = 0; i < count; i++) {
+		const MIKMIDIEventStoreRecord *record = &records[i];
+		MIKMIDIEventType eventType = MIKMIDIEventStoreRecordEventType(record);
+		MIKMIDIEventStoreAppendRecordForKey(recordsByEventType, @(eventType), record);
+		if (eventType == MIKMIDIEventTypeMIDIControlChangeMessage) {
+			MIKMIDIEventStoreAppendRecordForKey(recordsByControllerNumber, @(MIKMIDIEventStoreRecordControllerNumber(record, _payloads)), record);
+		}
+	}
+
+	[_eventStoresByEventType removeAllObjects];
+	[_eventStoresByControllerNumber removeAllObjects];
+	for (NSNumber *eventType in recordsByEventType) {
+		_eventStoresByEventType[eventType] = [self indexEventStoreWithRecords:recordsByEventType[eventType]];
+	}
+	for (NSNumber *controllerNumber in recordsByControllerNumber) {
+		_eventStoresByControllerNumber[controllerNumber] = [self indexEventStoreWithRecords:recordsByControllerNumber[controllerNumber]];
+	}
+}
+
+// Creates a type index from recordData, sorted records referring to the store's payloads, giving the index payloads of its own
+- (MIKMIDIEventStore *)indexEventStoreWithRecords:(NSMutableData *)recordData
+{
+	MIKMIDIEventStore *eventStore = [[MIKMIDIEventStore alloc] initWithTypeIndexes:NO];
+	MIKMIDIEventStoreRecord *records = [recordData mutableBytes];
+	NSUInteger count = [recordData length] / sizeof(MIKMIDIEventStoreRecord);
+	for (NSUInteger i = 0; i < count; i++) {
+		if (records[i].eventType & MIKMIDIEventStoreRecordHasPayload) records[i].payloadIndex = [eventStore addPayload:_payloads[records[i].payloadIndex]];
+	}
+	[eventStore mergeSortedRecords:records count:count];
+	return eventStore;
+}
+
+// Removes records without updating type indexes. Pass NO for releasePayloads if the records are going to be reinserted.
+- (NSUInteger)removeRecordsFromTimeStamp:(MusicTimeStamp)startTimeStamp toTimeStamp:(MusicTimeStamp)endTimeStamp releasingPayloads:(BOOL)releasePayloads
+{
+	MIKMIDIEventStorePosition start = MIKMIDIEventStorePositionForTimeStamp(_chunks, _numberOfChunks, startTimeStamp, NO);
+	if (start.chunk == _numberOfChunks) return 0;
+	MIKMIDIEventStorePosition end = MIKMIDIEventStorePositionForTimeStamp(_chunks, _numberOfChunks, endTimeStamp, YES);
+	if (end.chunk == _numberOfChunks) {
+		end.chunk = _numberOfChunks - 1;
+		end.entry = _chunks[end.chunk]->count;
+	}
+
+	// Only the first and last chunks in the range can keep any of their records
+	NSUInteger numberOfRemovedRecords = 0;
+	for (NSUInteger i = start.chunk; i <= end.chunk; i++) {
+		MIKMIDIEventStoreChunk *chunk = _chunks[i];
+		NSUInteger from = (i == start.chunk) ? start.entry : 0;
+		NSUInteger to = (i == end.chunk) ? end.entry : chunk->count;
+		if (to <= from) continue;
+
+		if (releasePayloads) {
+			for (NSUInteger j = from; j < to; j++) {
+				[self releasePayloadOfRecord:&chunk->records[j]];
+			}
+		}
+		if (from == 0 && to == chunk->count) {
+			// No need to copy a shared chunk just to empty it
+			numberOfRemovedRecords += chunk->count;
+			MIKMIDIEventStoreChunkRelease(chunk);
+			_chunks[i] = NULL;
+			continue;
+		}
+
+		chunk = [self mutableChunkAtIndex:i];
+		memmove(chunk->records + from, chunk->records + to, (chunk->count - to) * sizeof(MIKMIDIEventStoreRecord));
+		chunk->count -= to - from;
+		numberOfRemovedRecords += to - from;
+		MIKMIDIEventStoreChunkUpdateMaximumEndTimeStamp(chunk, _payloads);
+	}
+	_count -= numberOfRemovedRecords;
+	if (numberOfRemovedRecords) {
+		_maximumEndTimeStampIsValid = NO;
+		_chunkMaximumTreeIsValid = NO;
+	}
+
+	NSUInteger numberOfKeptChunks = start.chunk;
+	for (NSUInteger i = start.chunk; i < _numberOfChunks; i++) {
+		if (_chunks[i]) _chunks[numberOfKeptChunks++] = _chunks[i];
+	}
+	_numberOfChunks = numberOfKeptChunks;
+
+	return numberOfRemovedRecords;
+}
+
+// Moves records without updating type indexes. Returns a malloc'd copy of the moved records, with their new time stamps,
+// which the caller must free, or NULL if no records were moved. Their payload indexes stay valid, as payloads aren't moved.
+- (MIKMIDIEventStoreRecord *)shiftRecordsFromTimeStamp:(MusicTimeStamp)startTimeStamp toTimeStamp:(MusicTimeStamp)endTimeStamp byAmount:(MusicTimeStamp)offset count:(NSUInteger *)count
+{
+	*count = 0;
+	if (endTimeStamp < startTimeStamp || !_count || offset == 0) return NULL;
+
+	MIKMIDIEventStorePosition start = MIKMIDIEventStorePositionForTimeStamp(_chunks, _numberOfChunks, startTimeStamp, NO);
+	MIKMIDIEventStorePosition end = MIKMIDIEventStorePositionForTimeStamp(_chunks, _numberOfChunks, endTimeStamp, YES);
+	NSUInteger numberOfMovedRecords = MIKMIDIEventStoreCopyRecords(_chunks, _numberOfChunks, start, end, NULL);
+	if (!numberOfMovedRecords) return NULL;
+
+	MIKMIDIEventStoreRecord *movedRecords = malloc(numberOfMovedRecords * sizeof(MIKMIDIEventStoreRecord));
+	MIKMIDIEventStoreCopyRecords(_chunks, _numberOfChunks, start, end, movedRecords);
+	for (NSUInteger i = 0; i < numberOfMovedRecords; i++) {
+		movedRecords[i].timeStamp += offset;
+	}
+
+	MIKMIDIEventStoreRecord *previousRecord = NULL;
+	if (start.entry > 0) {
+		previousRecord = &_chunks[start.chunk]->records[start.entry - 1];
+	} else if (start.chunk > 0) {
+		previousRecord = &_chunks[start.chunk - 1]->records[_chunks[start.chunk - 1]->count - 1];
+	}
+	MIKMIDIEventStoreRecord *nextRecord = (end.chunk < _numberOfChunks) ? &_chunks[end.chunk]->records[end.entry] : NULL;
+
+	if ((!previousRecord || previousRecord->timeStamp <= movedRecords[0].timeStamp) &&
+		(!nextRecord || nextRecord->timeStamp >= movedRecords[numberOfMovedRecords - 1].timeStamp)) {
+		// No other events lie between the old and new positions (e.g. when shifting everything after a
+		// point), so the moved records keep their place and their time stamps can be updated where they are.
+		NSUInteger index = 0;
+		for (MIKMIDIEventStorePosition position = start; index < numberOfMovedRecords; position.chunk++, position.entry = 0) {
+			MIKMIDIEventStoreChunk *chunk = [self mutableChunkAtIndex:position.chunk];
+			for (; position.entry < chunk->count && index < numberOfMovedRecords; position.entry++, index++) {
+				chunk->records[position.entry].timeStamp += offset;
+			}
+			MIKMIDIEventStoreChunkUpdateMaximumEndTimeStamp(chunk, _payloads);
+		}
+		_maximumEndTimeStampIsValid = NO;
+		_chunkMaximumTreeIsValid = NO;
+
+		// Only the first and last moved records can now share a time stamp with events that weren't moved
+		[self removeDuplicatesAtTimeStamp:movedRecords[0].timeStamp];
+		if (movedRecords[numberOfMovedRecords - 1].timeStamp != movedRecords[0].timeStamp) {
+			[self removeDuplicatesAtTimeStamp:movedRecords[numberOfMovedRecords - 1].timeStamp];
+		}
+	} else {
+		[self removeRecordsFromTimeStamp:startTimeStamp toTimeStamp:endTimeStamp releasingPayloads:NO];
+		if (numberOfMovedRecords * 64 < _count) {
+			for (NSUInteger i = 0; i < numberOfMovedRecords; i++) {
+				[self insertRecord:movedRecords[i]];
+			}
+		} else {
+			[self mergeSortedRecords:movedRecords count:numberOfMovedRecords];
+		}
+
+		// The moved records may have landed on events equal to them
+		for (NSUInteger i = 0; i < numberOfMovedRecords; i++) {
+			if (i && movedRecords[i].timeStamp == movedRecords[i - 1].timeStamp) continue;
+			[self removeDuplicatesAtTimeStamp:movedRecords[i].timeStamp];
+		}
+	}
+
+	*count = numberOfMovedRecords;
+	return movedRecords;
+}
+
+// Removes events at timeStamp that equal an earlier event at the same time stamp, without updating type indexes
+- (void)removeDuplicatesAtTimeStamp:(MusicTimeStamp)timeStamp
+{
+	MIKMIDIEventStorePosition start = MIKMIDIEventStorePositionForTimeStamp(_chunks, _numberOfChunks, timeStamp, NO);
+	MIKMIDIEventStorePosition end = MIKMIDIEventStorePositionForTimeStamp(_chunks, _numberOfChunks, timeStamp, YES);
+	NSUInteger count = MIKMIDIEventStoreCopyRecords(_chunks, _numberOfChunks, start, end, NULL);
+	if (count < 2) return;
+
+	MIKMIDIEventStoreRecord *records = malloc(count * sizeof(MIKMIDIEventStoreRecord));
+	MIKMIDIEventStoreCopyRecords(_chunks, _numberOfChunks, start, end, records);
+	NSUInteger numberOfKeptRecords = [self removeDuplicatesFromSortedRecords:records count:count];
+	if (numberOfKeptRecords < count) {
+		[self removeRecordsFromTimeStamp:timeStamp toTimeStamp:timeStamp releasingPayloads:NO];
+		if (numberOfKeptRecords * 64 < _count) {
+			for (NSUInteger i = 0; i < numberOfKeptRecords; i++) {
+				[self insertRecord:records[i]];
+			}
+		} else {
+			[self mergeSortedRecords:records count:numberOfKeptRecords];
+		}
+	}
+	free(records);
+}
+
+- (void)removeRecordAtPosition:(MIKMIDIEventStorePosition)position
+{
+	MIKMIDIEventStoreChunk *chunk = [self mutableChunkAtIndex:position.chunk];
+	MusicTimeStamp removedEndTimeStamp = MIKMIDIEventStoreRecordEndTimeStamp(&chunk->records[position.entry], _payloads);
+	[self releasePayloadOfRecord:&chunk->records[position.entry]];
+	memmove(chunk->records + position.entry, chunk->records + position.entry + 1, (chunk->count - position.entry - 1) * sizeof(MIKMIDIEventStoreRecord));
+	chunk->count--;
+	_count--;
+
+	if (removedEndTimeStamp >= _maximumEndTimeStamp) _maximumEndTimeStampIsValid = NO;
+	if (!chunk->count) {
+		[self removeChunkAtIndex:position.chunk];
+	} else if (removedEndTimeStamp >= chunk->maximumEndTimeStamp) {
+		MIKMIDIEventStoreChunkUpdateMaximumEndTimeStamp(chunk, _payloads);
+		[self updateChunkMaximumTreeAtIndex:position.chunk];
+	}
+}
+
+- (MIKMIDIEventStorePosition)positionOfRecord:(const MIKMIDIEventStoreRecord *)record data:(NSData *)data
+{
+	// Equal events always have equal time stamps, so only the run of records at record's time stamp needs to be checked
+	MusicTimeStamp timeStamp = record->timeStamp;
+	MIKMIDIEventStorePosition position = MIKMIDIEventStorePositionForTimeStamp(_chunks, _numberOfChunks, timeStamp, NO);
+	for (; position.chunk < _numberOfChunks; position.chunk++, position.entry = 0) {
+		MIKMIDIEventStoreChunk *chunk = _chunks[position.chunk];
+		for (; position.entry < chunk->count; position.entry++) {
+			MIKMIDIEventStoreRecord *storedRecord = &chunk->records[position.entry];
+			if (storedRecord->timeStamp != timeStamp) return MIKMIDIEventStorePositionNotFound;
+			if (MIKMIDIEventStoreRecordMatches(storedRecord, _payloads, record, data)) return position;
+		}
+	}
+	return MIKMIDIEventStorePositionNotFound;
+}
+
+- (void)enumerateRecordsFromTimeStamp:(MusicTimeStamp)startTimeStamp toTimeStamp:(MusicTimeStamp)endTimeStamp usingBlock:(void (^)(const MIKMIDIEventStoreRecord *record, BOOL *stop))block
+{
+	MIKMIDIEventStorePosition position = MIKMIDIEventStorePositionForTimeStamp(_chunks, _numberOfChunks, startTimeStamp, NO);
+	BOOL stop = NO;
+	for (NSUInteger i = position.chunk; i < _numberOfChunks; i++) {
+		MIKMIDIEventStoreChunk *chunk = _chunks[i];
+		for (NSUInteger j = (i == position.chunk) ? position.entry : 0; j < chunk->count; j++) {
+			if (chunk->records[j].timeStamp > endTimeStamp) return;
+			block(&chunk->records[j], &stop);
+			if (stop) return;
+		}
+	}
+}
+
+- (UInt32)addPayload:(NSData *)payload
+{
+	NSUInteger index = [_freePayloadIndexes firstIndex];
+	if (index != NSNotFound) {
+		[_freePayloadIndexes removeIndex:index];
+		_payloads[index] = [payload copy];
+	} else {
+		index = [_payloads count];
+		[_payloads addObject:[payload copy]];
+	}
+	return (UInt32)index;
+}
+
+- (void)releasePayloadOfRecord:(const MIKMIDIEventStoreRecord *)record
+{
+	if (!(record->eventType & MIKMIDIEventStoreRecordHasPayload)) return;
+	_payloads[record->payloadIndex] = [NSNull null];
+	[_freePayloadIndexes addIndex:record->payloadIndex];
+}
+
+// Returns the type index for key, first replacing it with a copy of its own if it's shared with a copy of the store
+static MIKMIDIEventStore *MIKMIDIEventStoreMutableIndex(NSMutableDictionary *indexes, id key)
+{
+	MIKMIDIEventStore *eventStore = indexes[key];
+	if (!eventStore || !eventStore->_isSharedIndex) return eventStore;
+	eventStore = [eventStore copy];
+	indexes[key] = eventStore;
+	return eventStore;
+}
+
+// Returns the chunk at index, first replacing it with a copy of its own if it's shared with a copy of the store
+- (MIKMIDIEventStoreChunk *)mutableChunkAtIndex:(NSUInteger)index
+{
+	MIKMIDIEventStoreChunk *chunk = _chunks[index];
+	if (atomic_load_explicit(&chunk->referenceCount, memory_order_acquire) == 1) return chunk;
+
+	MIKMIDIEventStoreChunk *copy = MIKMIDIEventStoreChunkCreate();
+	copy->count = chunk->count;
+	copy->maximumEndTimeStamp = chunk->maximumEndTimeStamp;
+	memcpy(copy->records, chunk->records, chunk->count * sizeof(MIKMIDIEventStoreRecord));
+	MIKMIDIEventStoreChunkRelease(chunk);
+	_chunks[index] = copy;
+	return copy;
+}
+
+- (void)updateLazilyCalculatedValues
+{
+	[self maximumEndTimeStamp];
+	[self updateChunkMaximumTreeIfNeeded];
+}
+
+- (void)updateChunkMaximumTreeIfNeeded
+{
+	if (_chunkMaximumTreeIsValid) return;
+
+	NSUInteger leafCount = 1;
+	while (leafCount < _numberOfChunks) leafCount *= 2;
+	if (leafCount != _chunkMaximumTreeLeafCount) {
+		_chunkMaximumTree = realloc(_chunkMaximumTree, 2 * leafCount * sizeof(MusicTimeStamp));
+		_chunkMaximumTreeLeafCount = leafCount;
+	}
+
+	for (NSUInteger i = 0; i < leafCount; i++) {
+		_chunkMaximumTree[leafCount + i] = (i < _numberOfChunks) ? _chunks[i]->maximumEndTimeStamp : -DBL_MAX;
+	}
+	for (NSUInteger i = leafCount - 1; i > 0; i--) {
+		_chunkMaximumTree[i] = MAX(_chunkMaximumTree[2 * i], _chunkMaximumTree[2 * i + 1]);
+	}
+	_chunkMaximumTreeIsValid = YES;
+}
+
+// Call after the maximum end time stamp of the chunk at index changes, when no chunks were added or removed
+- (void)updateChunkMaximumTreeAtIndex:(NSUInteger)index
+{
+	if (!_chunkMaximumTreeIsValid) return;
+
+	NSUInteger node = _chunkMaximumTreeLeafCount + index;
+	_chunkMaximumTree[node] = _chunks[index]->maximumEndTimeStamp;
+	for (node /= 2; node > 0; node /= 2) {
+		_chunkMaximumTree[node] = MAX(_chunkMaximumTree[2 * node], _chunkMaximumTree[2 * node + 1]);
+	}
+}
+
+- (void)insertChunk:(MIKMIDIEventStoreChunk *)chunk atIndex:(NSUInteger)index
+{
+	_chunkMaximumTreeIsValid = NO;
+	if (_numberOfChunks == _chunksCapacity) {
+		_chunksCapacity = _chunksCapacity ? _chunksCapacity * 2 : 8;
+		_chunks = realloc(_chunks, _chunksCapacity * sizeof(MIKMIDIEventStoreChunk *));
+	}
+	memmove(_chunks + index + 1, _chunks + index, (_numberOfChunks - index) * sizeof(MIKMIDIEventStoreChunk *));
+	_chunks[index] = chunk;
+	_numberOfChunks++;
+}
+
+- (void)removeChunkAtIndex:(NSUInteger)index
+{
+	_chunkMaximumTreeIsValid = NO;
+	MIKMIDIEventStoreChunkRelease(_chunks[index]);
+	memmove(_chunks + index, _chunks + index + 1, (_numberOfChunks - index - 1) * sizeof(MIKMIDIEventStoreChunk *));
+	_numberOfChunks--;
+}
+
+#pragma mark - Properties
+
+- (NSArray *)allEvents
+{
+	if (!_count) return @[];
+
+	NSMutableArray *result = [NSMutableArray arrayWithCapacity:_count];
+	for (NSUInteger i = 0; i < _numberOfChunks; i++) {
+		MIKMIDIEventStoreChunk *chunk = _chunks[i];
+		for (NSUInteger j = 0; j < chunk->count; j++) {
+			[result addObject:MIKMIDIEventStoreEventForRecord(&chunk->records[j], _payloads)];
+		}
+	}
+	return [result copy];
+}
+
+- (NSUInteger)count { return _count; }
+
+- (MusicTimeStamp)maximumEndTimeStamp
+{
+	if (!_count) return 0;
+
+	if (!_maximumEndTimeStampIsValid) {
+		// The root of the chunk maximum tree is the maximum of every chunk's end time stamp
+		[self updateChunkMaximumTreeIfNeeded];
+		_maximumEndTimeStamp = _chunkMaximumTree[1];
+		_maximumEndTimeStampIsValid = YES;
+	}
+	return _maximumEndTimeStamp;
+}
+
+- (MIKMIDIEvent *)firstEvent
+{
+	return _numberOfChunks ? MIKMIDIEventStoreEventForRecord(&_chunks[0]->records[0], _payloads) : nil;
+}
+
+@end
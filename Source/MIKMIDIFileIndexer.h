@@ -0,0 +1,235 @@
+//
+//  MIKMIDIFileIndexer.h
+//  MIKMIDI
+//
+//  Created by Mixed In Key on 10/18/26.
+//  Copyright (c) 2026 Mixed In Key. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import <AudioToolbox/AudioToolbox.h>
+#import "MIKMIDIFileParser.h"
+#import "MIKMIDICompilerCompatibility.h"
+
+@class MIKMIDIFileIndexEntry;
+@class MIKMIDITempoEvent;
+@class MIKMIDIMetaTimeSignatureEvent;
+@class MIKMIDIMetaKeySignatureEvent;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  MIKMIDIFileIndexer keeps an index of the metadata of a library of MIDI files, like their tempos, length,
+ *  track names and programs, so a large library can be searched without opening every file.
+ *
+ *  Files are memory-mapped and summarized with MIKMIDIFileParser, without decoding their events or creating
+ *  MIKMIDISequences, and several files are scanned at once. The index is kept in a compact binary file,
+ *  which is memory-mapped when it's opened, and entries are only decoded when their properties are used.
+ *
+ *  Updating the index only scans files that are new, or whose modification date or size has changed
+ *  since they were last indexed. Changes are only written to the index file by -saveWithError:.
+ *
+ *  An MIKMIDIFileIndexer must only be used from one thread at a time.
+ */
+@interface MIKMIDIFileIndexer : NSObject
+
+/**
+ *  Creates and initializes an indexer using the index file at indexFileURL.
+ *
+ *  @param indexFileURL The URL of the index file. If it doesn't exist, the index starts out empty, and the file is created when the index is saved.
+ *  @param error If an error occurs, upon return contains an NSError object that describes the problem. If you are not interested in possible errors, you may pass in NULL.
+ *
+ *  @return A new MIKMIDIFileIndexer, or nil if the index file exists but couldn't be read.
+ */
++ (nullable instancetype)indexerWithIndexFileAtURL:(NSURL *)indexFileURL error:(NSError **)error;
+
+/**
+ *  Initializes an indexer using the index file at indexFileURL.
+ *
+ *  @param indexFileURL The URL of the index file. If it doesn't exist, the index starts out empty, and the file is created when the index is saved.
+ *  @param error If an error occurs, upon return contains an NSError object that describes the problem. If you are not interested in possible errors, you may pass in NULL.
+ *
+ *  @return An initialized MIKMIDIFileIndexer, or nil if the index file exists but couldn't be read.
+ */
+- (nullable instancetype)initWithIndexFileAtURL:(NSURL *)indexFileURL error:(NSError **)error NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ *  Brings the entries for a list of files up to date. Files that aren't in the index yet, or have
+ *  changed since they were indexed, are scanned. The entries of files that no longer exist, or can't
+ *  be read as MIDI files, are removed.
+ *
+ *  @param fileURLs An array of file URLs of MIDI files.
+ *
+ *  @return The number of entries that were added or updated.
+ */
+- (NSUInteger)updateEntriesForFilesAtURLs:(MIKArrayOf(NSURL *) *)fileURLs;
+
+/**
+ *  Brings the entries for the MIDI files in a directory and its subdirectories up to date, as
+ *  -updateEntriesForFilesAtURLs: does. Files with a mid, midi, kar or smf extension are indexed, and the
+ *  entries of files in the directory that have been deleted are removed.
+ *
+ *  @param directoryURL The URL of a directory. If it can't be read, e.g. because it is on a volume
+ *  that isn't mounted, the index isn't changed.
+ *
+ *  @return The number of entries that were added or updated.
+ */
+- (NSUInteger)updateEntriesForFilesInDirectoryAtURL:(NSURL *)directoryURL;
+
+/**
+ *  Removes a file's entry from the index.
+ *
+ *  @param fileURL The file URL of an indexed file.
+ */
+- (void)removeEntryForFileAtURL:(NSURL *)fileURL;
+
+/**
+ *  Returns the entry for a file.
+ *
+ *  @param fileURL The file URL of a MIDI file.
+ *
+ *  @return The file's entry, or nil if it isn't in the index.
+ */
+- (nullable MIKMIDIFileIndexEntry *)entryForFileAtURL:(NSURL *)fileURL;
+
+/**
+ *  Returns the entries that pass a test.
+ *
+ *  @param predicate The block to call for each entry. Return YES to include the entry in the results.
+ *  Set *stop to YES to stop testing entries.
+ *
+ *  @return An array of MIKMIDIFileIndexEntry instances, in no particular order.
+ */
+- (MIKArrayOf(MIKMIDIFileIndexEntry *) *)entriesPassingTest:(BOOL (^)(MIKMIDIFileIndexEntry *entry, BOOL *stop))predicate;
+
+/**
+ *  Writes the index to its index file, replacing the file atomically.
+ *
+ *  @param error If an error occurs, upon return contains an NSError object that describes the problem. If you are not interested in possible errors, you may pass in NULL.
+ *
+ *  @return YES if the index was written, NO if an error occurred.
+ */
+- (BOOL)saveWithError:(NSError **)error;
+
+/**
+ *  The URL of the index file.
+ */
+@property (nonatomic, readonly) NSURL *indexFileURL;
+
+/**
+ *  All of the index's entries, in no particular order.
+ */
+@property (nonatomic, readonly) MIKArrayOf(MIKMIDIFileIndexEntry *) *entries;
+
+/**
+ *  The number of files in the index.
+ */
+@property (nonatomic, readonly) NSUInteger numberOfEntries;
+
+/**
+ *  The maximum number of files scanned at the same time when the index is updated.
+ *  0 uses as many threads as there are active processor cores. The default is 0.
+ */
+@property (nonatomic) NSUInteger maximumConcurrentFileScans;
+
+@end
+
+/**
+ *  MIKMIDIFileIndexEntry holds the metadata of a file indexed by MIKMIDIFileIndexer.
+ *
+ *  Tempo, time signature and key signature events are collected from all of the file's tracks.
+ *  Track names, programs, notes and length are found as by -[MIKMIDIFileParser summaryOfTrackAtIndex:error:].
+ */
+@interface MIKMIDIFileIndexEntry : NSObject
+
+/**
+ *  The URL of the indexed file.
+ */
+@property (nonatomic, readonly) NSURL *fileURL;
+
+/**
+ *  The modification date of the file when it was indexed.
+ */
+@property (nonatomic, readonly) NSDate *modificationDate;
+
+/**
+ *  The size of the file in bytes when it was indexed.
+ */
+@property (nonatomic, readonly) unsigned long long fileSize;
+
+/**
+ *  The format of the file.
+ */
+@property (nonatomic, readonly) MIKMIDIFileFormat format;
+
+/**
+ *  The number of track (MTrk) chunks in the file.
+ */
+@property (nonatomic, readonly) NSUInteger numberOfTracks;
+
+/**
+ *  The time resolution of the file, in ticks per quarter note.
+ */
+@property (nonatomic, readonly) UInt16 ticksPerQuarterNote;
+
+/**
+ *  The file's tempo events, sorted by time stamp.
+ */
+@property (nonatomic, readonly) MIKArrayOf(MIKMIDITempoEvent *) *tempoEvents;
+
+/**
+ *  The file's time signature events, sorted by time stamp.
+ */
+@property (nonatomic, readonly) MIKArrayOf(MIKMIDIMetaTimeSignatureEvent *) *timeSignatureEvents;
+
+/**
+ *  The file's key signature events, sorted by time stamp.
+ */
+@property (nonatomic, readonly) MIKArrayOf(MIKMIDIMetaKeySignatureEvent *) *keySignatureEvents;
+
+/**
+ *  The length of the file's longest track, in beats.
+ */
+@property (nonatomic, readonly) MusicTimeStamp length;
+
+/**
+ *  The length of the file's longest track, in seconds, following the file's tempo events.
+ *  The tempo before the first tempo event is 120 beats per minute.
+ */
+@property (nonatomic, readonly) Float64 durationInSeconds;
+
+/**
+ *  The names of the file's tracks that have a track name meta event, in track order.
+ */
+@property (nonatomic, readonly) MIKArrayOf(NSString *) *trackNames;
+
+/**
+ *  The programs (0-127) selected by the file's program change events, on any channel.
+ */
+@property (nonatomic, readonly) NSIndexSet *programs;
+
+/**
+ *  The MIDI channels (0-15) used by the file's channel events.
+ */
+@property (nonatomic, readonly) NSIndexSet *channels;
+
+/**
+ *  The number of notes in the file.
+ */
+@property (nonatomic, readonly) NSUInteger numberOfNotes;
+
+/**
+ *  The lowest note in the file, or 0 if it has no notes.
+ */
+@property (nonatomic, readonly) UInt8 lowestNote;
+
+/**
+ *  The highest note in the file, or 0 if it has no notes.
+ */
+@property (nonatomic, readonly) UInt8 highestNote;
+
+@end
+
+NS_ASSUME_NONNULL_END
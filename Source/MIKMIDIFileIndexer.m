@@ -0,0 +1,640 @@
+//
+//  MIKMIDIFileIndexer.m
+//  MIKMIDI
+//
+//  Created by Mixed In Key on 10/18/26.
+//  Copyright (c) 2026 Mixed In Key. All rights reserved.
+//
+
+#import "MIKMIDIFileIndexer.h"
+#import "MIKMIDIFileParser+MIKMIDIPrivate.h"
+#import "MIKMIDIEventStore.h"
+#import "MIKMIDITempoEvent.h"
+#import "MIKMIDIMetaEvent.h"
+#import "MIKMIDIMetaTimeSignatureEvent.h"
+#import "MIKMIDIMetaKeySignatureEvent.h"
+#import "MIKMIDIErrors.h"
+#include <stdatomic.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if !__has_feature(objc_arc)
+#error MIKMIDIFileIndexer.m must be compiled with ARC. Either turn on ARC for the project or set the -fobjc-arc flag for MIKMIDIFileIndexer.m in the Build Phases for this target
+#endif
+
+#define MIKMIDIFileIndexVersion	1
+#define MIKMIDIFileIndexWriteBufferSize	(1024 * 1024)
+
+#pragma mark - Index Format
+
+// An index file is a header followed by a record for each file. Records are in native byte order, and every part
+// of a record is 8 byte aligned, so an entry's metadata can be read straight from the memory-mapped index file.
+typedef struct {
+	char magic[4]; // "MIKI"
+	UInt32 version;
+	UInt64 numberOfRecords;
+} MIKMIDIFileIndexHeader;
+
+// Followed by the tempo events, time signature events and key signature events, the file's path, and the track
+// names, each a UInt32 length followed by UTF-8 text. The record is then padded to a multiple of 8 bytes.
+typedef struct {
+	UInt32 recordSize;
+	UInt32 pathLength;
+	SInt64 modificationTimeSeconds;
+	SInt64 modificationTimeNanoseconds;
+	UInt64 fileSize;
+	Float64 length;
+	Float64 durationInSeconds;
+	UInt64 programs[2]; // One bit per program
+	UInt32 numberOfNotes;
+	UInt32 numberOfTracks;
+	UInt16 format;
+	UInt16 ticksPerQuarterNote;
+	UInt16 channels; // One bit per channel
+	UInt8 lowestNote;
+	UInt8 highestNote;
+	UInt32 numberOfTempoEvents;
+	UInt32 numberOfTimeSignatureEvents;
+	UInt32 numberOfKeySignatureEvents;
+	UInt32 trackNamesSize;
+} MIKMIDIFileIndexRecord;
+
+typedef struct {
+	Float64 timeStamp;
+	Float64 bpm;
+} MIKMIDIFileIndexTempoEvent;
+
+// A time signature or key signature meta event
+typedef struct {
+	Float64 timeStamp;
+	UInt8 data[4];
+	UInt32 dataLength;
+} MIKMIDIFileIndexMetaEvent;
+
+static UInt64 MIKMIDIFileIndexRecordContentSize(const MIKMIDIFileIndexRecord *record)
+{
+	UInt64 numberOfMetaEvents = (UInt64)record->numberOfTimeSignatureEvents + record->numberOfKeySignatureEvents;
+	return sizeof(*record) + record->numberOfTempoEvents * sizeof(MIKMIDIFileIndexTempoEvent) +
+		numberOfMetaEvents * sizeof(MIKMIDIFileIndexMetaEvent) + record->pathLength + record->trackNamesSize;
+}
+
+static const MIKMIDIFileIndexTempoEvent *MIKMIDIFileIndexRecordTempoEvents(const MIKMIDIFileIndexRecord *record)
+{
+	return (const MIKMIDIFileIndexTempoEvent *)(record + 1);
+}
+
+static const MIKMIDIFileIndexMetaEvent *MIKMIDIFileIndexRecordTimeSignatureEvents(const MIKMIDIFileIndexRecord *record)
+{
+	return (const MIKMIDIFileIndexMetaEvent *)(MIKMIDIFileIndexRecordTempoEvents(record) + record->numberOfTempoEvents);
+}
+
+static const MIKMIDIFileIndexMetaEvent *MIKMIDIFileIndexRecordKeySignatureEvents(const MIKMIDIFileIndexRecord *record)
+{
+	return MIKMIDIFileIndexRecordTimeSignatureEvents(record) + record->numberOfTimeSignatureEvents;
+}
+
+static const char *MIKMIDIFileIndexRecordPath(const MIKMIDIFileIndexRecord *record)
+{
+	return (const char *)(MIKMIDIFileIndexRecordKeySignatureEvents(record) + record->numberOfKeySignatureEvents);
+}
+
+static const UInt8 *MIKMIDIFileIndexRecordTrackNames(const MIKMIDIFileIndexRecord *record)
+{
+	return (const UInt8 *)MIKMIDIFileIndexRecordPath(record) + record->pathLength;
+}
+
+#pragma mark - Scanning
+
+// Darwin names the modification time differently from other platforms
+static struct timespec MIKMIDIFileIndexModificationTime(const struct stat *fileStatus)
+{
+#if defined(__APPLE__)
+	return fileStatus->st_mtimespec;
+#else
+	return fileStatus->st_mtim;
+#endif
+}
+
+static void MIKMIDIFileIndexAppendMetaEvent(NSMutableData *events, MusicTimeStamp timeStamp, const void *data, UInt32 length)
+{
+	if (length < MIKMIDIEventMetadataStartOffset) return;
+	const MIDIMetaEvent *metaEvent = data;
+	MIKMIDIFileIndexMetaEvent indexEvent = { .timeStamp = timeStamp };
+	indexEvent.dataLength = MIN(MIN(metaEvent->dataLength, length - (UInt32)MIKMIDIEventMetadataStartOffset), (UInt32)sizeof(indexEvent.data));
+	memcpy(indexEvent.data, metaEvent->data, indexEvent.dataLength);
+	[events appendBytes:&indexEvent length:sizeof(indexEvent)];
+}
+
+static Float64 MIKMIDIFileIndexDurationInSeconds(const MIKMIDIFileIndexTempoEvent *tempoEvents, NSUInteger numberOfTempoEvents, MusicTimeStamp length)
+{
+	Float64 seconds = 0;
+	Float64 bpm = 120;
+	MusicTimeStamp timeStamp = 0;
+	for (NSUInteger i = 0; i < numberOfTempoEvents && tempoEvents[i].timeStamp < length; i++) {
+		seconds += (tempoEvents[i].timeStamp - timeStamp) * 60.0 / bpm;
+		timeStamp = tempoEvents[i].timeStamp;
+		bpm = tempoEvents[i].bpm;
+	}
+	return seconds + (length - timeStamp) * 60.0 / bpm;
+}
+
+// Returns the record for a file, or nil if it can't be read as a MIDI file
+static NSData *MIKMIDIFileIndexRecordForFile(NSURL *fileURL, const struct stat *fileStatus)
+{
+	MIKMIDIFileParser *parser = [MIKMIDIFileParser parserWithFileAtURL:fileURL error:NULL];
+	if (!parser) return nil;
+	parser.maximumConcurrentTrackDecodes = 1; // Files are already scanned concurrently
+
+	MIKMIDIEventStore *tempoTrackEventStore = nil;
+	MIKMIDIEventStore *keySignatureEventStore = nil;
+	NSArray *summaries = [parser summariesOfTracksWithTempoTrackEventStore:&tempoTrackEventStore keySignatureEventStore:&keySignatureEventStore error:NULL];
+	if (!summaries) return nil;
+
+	struct timespec modificationTime = MIKMIDIFileIndexModificationTime(fileStatus);
+	MIKMIDIFileIndexRecord record = {
+		.modificationTimeSeconds = modificationTime.tv_sec,
+		.modificationTimeNanoseconds = modificationTime.tv_nsec,
+		.fileSize = (UInt64)fileStatus->st_size,
+		.numberOfTracks = (UInt32)parser.numberOfTracks,
+		.format = parser.format,
+		.ticksPerQuarterNote = parser.ticksPerQuarterNote,
+	};
+	MIKMIDIFileIndexRecord *recordPointer = &record;
+	NSMutableData *trackNames = [NSMutableData data];
+	for (MIKMIDIFileTrackSummary *summary in summaries) {
+		if (summary.numberOfNotes) {
+			record.lowestNote = record.numberOfNotes ? MIN(record.lowestNote, summary.lowestNote) : summary.lowestNote;
+			record.highestNote = MAX(record.highestNote, summary.highestNote);
+			record.numberOfNotes += (UInt32)summary.numberOfNotes;
+		}
+		record.length = MAX(record.length, summary.length);
+		[summary.channels enumerateIndexesUsingBlock:^(NSUInteger channel, BOOL *stop) {
+			recordPointer->channels |= 1 << channel;
+		}];
+		[summary.programs enumerateIndexesUsingBlock:^(NSUInteger program, BOOL *stop) {
+			recordPointer->programs[program / 64] |= 1ULL << (program % 64);
+		}];
+
+		NSData *name = [summary.name dataUsingEncoding:NSUTF8StringEncoding];
+		if (!name) continue;
+		UInt32 nameLength = (UInt32)[name length];
+		[trackNames appendBytes:&nameLength length:sizeof(nameLength)];
+		[trackNames appendData:name];
+	}
+
+	NSMutableData *tempoEvents = [NSMutableData data];
+	NSMutableData *timeSignatureEvents = [NSMutableData data];
+	NSMutableData *keySignatureEvents = [NSMutableData data];
+	[tempoTrackEventStore enumerateRawEventsFromTimeStamp:-DBL_MAX toTimeStamp:DBL_MAX usingBlock:^(MusicTimeStamp timeStamp, MIKMIDIEventType eventType, const void *data, UInt32 length, BOOL *stop) {
+		if (eventType == MIKMIDIEventTypeExtendedTempo) {
+			MIKMIDIFileIndexTempoEvent tempoEvent = { .timeStamp = timeStamp, .bpm = ((const ExtendedTempoEvent *)data)->bpm };
+			[tempoEvents appendBytes:&tempoEvent length:sizeof(tempoEvent)];
+		} else if (eventType == MIKMIDIEventTypeMetaTimeSignature) {
+			MIKMIDIFileIndexAppendMetaEvent(timeSignatureEvents, timeStamp, data, length);
+		}
+	}];
+	[keySignatureEventStore enumerateRawEventsFromTimeStamp:-DBL_MAX toTimeStamp:DBL_MAX usingBlock:^(MusicTimeStamp timeStamp, MIKMIDIEventType eventType, const void *data, UInt32 length, BOOL *stop) {
+		MIKMIDIFileIndexAppendMetaEvent(keySignatureEvents, timeStamp, data, length);
+	}];
+
+	const char *path = [fileURL fileSystemRepresentation];
+	record.pathLength = (UInt32)strlen(path);
+	record.trackNamesSize = (UInt32)[trackNames length];
+	record.numberOfTempoEvents = (UInt32)([tempoEvents length] / sizeof(MIKMIDIFileIndexTempoEvent));
+	record.numberOfTimeSignatureEvents = (UInt32)([timeSignatureEvents length] / sizeof(MIKMIDIFileIndexMetaEvent));
+	record.numberOfKeySignatureEvents = (UInt32)([keySignatureEvents length] / sizeof(MIKMIDIFileIndexMetaEvent));
+	record.durationInSeconds = MIKMIDIFileIndexDurationInSeconds([tempoEvents bytes], record.numberOfTempoEvents, record.length);
+
+	UInt64 recordSize = (MIKMIDIFileIndexRecordContentSize(&record) + 7) & ~(UInt64)7;
+	if (recordSize > UINT32_MAX) return nil;
+	record.recordSize = (UInt32)recordSize;
+
+	NSMutableData *recordData = [NSMutableData dataWithCapacity:(NSUInteger)recordSize];
+	[recordData appendBytes:&record length:sizeof(record)];
+	[recordData appendData:tempoEvents];
+	[recordData appendData:timeSignatureEvents];
+	[recordData appendData:keySignatureEvents];
+	[recordData appendBytes:path length:record.pathLength];
+	[recordData appendData:trackNames];
+	[recordData setLength:(NSUInteger)recordSize];
+	return recordData;
+}
+
+// Paths are compared the way the file system stores them, so a file is found whatever form its URL's path is in
+static NSString *MIKMIDIFileIndexPathForURL(NSURL *fileURL)
+{
+	if (![fileURL isFileURL]) return nil;
+	const char *path = [fileURL fileSystemRepresentation];
+	return path ? [[NSFileManager defaultManager] stringWithFileSystemRepresentation:path length:strlen(path)] : nil;
+}
+
+static NSError *MIKMIDIFileIndexReadingError(NSString *reason)
+{
+	return [NSError MIKMIDIErrorWithCode:MIKMIDIFileIndexReadingFailedErrorCode userInfo:@{NSLocalizedFailureReasonErrorKey : reason}];
+}
+
+static BOOL MIKMIDIFileIndexWriteData(int fileDescriptor, NSData *data)
+{
+	const UInt8 *bytes = [data bytes];
+	size_t remainingLength = [data length];
+	while (remainingLength) {
+		ssize_t writtenLength = write(fileDescriptor, bytes, remainingLength);
+		if (writtenLength < 0) {
+			if (errno == EINTR) continue;
+			return NO;
+		}
+		bytes += writtenLength;
+		remainingLength -= (size_t)writtenLength;
+	}
+	return YES;
+}
+
+#pragma mark -
+
+@interface MIKMIDIFileIndexEntry ()
+
+- (instancetype)initWithData:(NSData *)data offset:(NSUInteger)offset;
+- (BOOL)isUpToDateWithFileStatus:(const struct stat *)fileStatus;
+
+@property (nonatomic, readonly) const MIKMIDIFileIndexRecord *record;
+@property (nonatomic, copy, readonly) NSString *path;
+
+@end
+
+#pragma mark -
+
+@implementation MIKMIDIFileIndexer
+{
+	NSMutableDictionary *_entriesByPath;
+}
+
+#pragma mark - Lifecycle
+
++ (instancetype)indexerWithIndexFileAtURL:(NSURL *)indexFileURL error:(NSError **)error
+{
+	return [[self alloc] initWithIndexFileAtURL:indexFileURL error:error];
+}
+
+- (instancetype)initWithIndexFileAtURL:(NSURL *)indexFileURL error:(NSError **)error
+{
+	error = error ?: &(NSError *__autoreleasing){ nil };
+
+	self = [super init];
+	if (self) {
+		if (![indexFileURL isFileURL]) {
+			*error = [NSError MIKMIDIErrorWithCode:MIKMIDIInvalidArgumentError userInfo:nil];
+			return nil;
+		}
+		_indexFileURL = [indexFileURL copy];
+		_entriesByPath = [NSMutableDictionary dictionary];
+
+		if ([[NSFileManager defaultManager] fileExistsAtPath:[indexFileURL path]]) {
+			NSData *data = [NSData dataWithContentsOfURL:indexFileURL options:NSDataReadingMappedIfSafe error:error];
+			if (!data || ![self readEntriesFromData:data error:error]) return nil;
+		}
+	}
+	return self;
+}
+
+- (instancetype)init
+{
+	[NSException raise:NSInternalInconsistencyException format:@"Use -initWithIndexFileAtURL:error: to create %@ instances.", NSStringFromClass([self class])];
+	return nil;
+}
+
+// Entries keep using the index file's data, so records are only decoded as they're used
+- (BOOL)readEntriesFromData:(NSData *)data error:(NSError **)error
+{
+	const UInt8 *bytes = [data bytes];
+	NSUInteger length = [data length];
+	const MIKMIDIFileIndexHeader *header = (const MIKMIDIFileIndexHeader *)bytes;
+	if (length < sizeof(*header) || memcmp(header->magic, "MIKI", 4)) {
+		*error = MIKMIDIFileIndexReadingError(@"The file is not a MIDI file index.");
+		return NO;
+	}
+	if (header->version != MIKMIDIFileIndexVersion) {
+		*error = MIKMIDIFileIndexReadingError([NSString stringWithFormat:@"MIDI file index version %u is not supported.", (unsigned)header->version]);
+		return NO;
+	}
+
+	NSUInteger position = sizeof(*header);
+	for (UInt64 i = 0; i < header->numberOfRecords; i++) {
+		const MIKMIDIFileIndexRecord *record = (const MIKMIDIFileIndexRecord *)(bytes + position);
+		if (length - position < sizeof(*record) || record->recordSize % 8 || record->recordSize > length - position ||
+			MIKMIDIFileIndexRecordContentSize(record) > record->recordSize) {
+			*error = MIKMIDIFileIndexReadingError(@"The MIDI file index is malformed.");
+			return NO;
+		}
+
+		MIKMIDIFileIndexEntry *entry = [[MIKMIDIFileIndexEntry alloc] initWithData:data offset:position];
+		_entriesByPath[entry.path] = entry;
+		position += record->recordSize;
+	}
+	return YES;
+}
+
+#pragma mark - Updating
+
+- (NSUInteger)updateEntriesForFilesAtURLs:(NSArray *)fileURLs
+{
+	NSUInteger numberOfFiles = [fileURLs count];
+	if (!numberOfFiles) return 0;
+
+	// Each file's result is a new record, NSNull if its entry is up to date, or an empty data if its entry should be removed
+	NSMutableArray *results = [NSMutableArray arrayWithCapacity:numberOfFiles];
+	for (NSUInteger i = 0; i < numberOfFiles; i++) [results addObject:[NSNull null]];
+	dispatch_queue_t resultsQueue = dispatch_queue_create("com.mixedinkey.MIKMIDIFileIndexer.ResultsQueue", DISPATCH_QUEUE_SERIAL);
+
+	// Files are scanned by up to maximumConcurrentFileScans workers, each taking the next file as it becomes free
+	NSUInteger numberOfWorkers = self.maximumConcurrentFileScans ?: [[NSProcessInfo processInfo] activeProcessorCount];
+	numberOfWorkers = MIN(MAX(numberOfWorkers, 1), numberOfFiles);
+	atomic_size_t nextFileIndex = 0;
+	atomic_size_t *nextFileIndexPointer = &nextFileIndex;
+	void (^scanFiles)(size_t) = ^(size_t worker) {
+		for (size_t i = atomic_fetch_add(nextFileIndexPointer, 1); i < numberOfFiles; i = atomic_fetch_add(nextFileIndexPointer, 1)) {
+			@autoreleasepool {
+				id result = [self updatedRecordForFileAtURL:fileURLs[i]];
+				if (result == [NSNull null]) continue;
+				dispatch_sync(resultsQueue, ^{ results[i] = result; });
+			}
+		}
+	};
+	if (numberOfWorkers > 1) {
+		dispatch_apply(numberOfWorkers, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), scanFiles);
+	} else {
+		scanFiles(0);
+	}
+
+	NSUInteger numberOfUpdatedEntries = 0;
+	for (NSUInteger i = 0; i < numberOfFiles; i++) {
+		NSData *record = results[i];
+		if ((id)record == [NSNull null]) continue;
+		if ([record length]) {
+			MIKMIDIFileIndexEntry *entry = [[MIKMIDIFileIndexEntry alloc] initWithData:record offset:0];
+			_entriesByPath[entry.path] = entry;
+			numberOfUpdatedEntries++;
+		} else {
+			NSString *path = MIKMIDIFileIndexPathForURL(fileURLs[i]);
+			if (path) [_entriesByPath removeObjectForKey:path];
+		}
+	}
+	return numberOfUpdatedEntries;
+}
+
+- (NSUInteger)updateEntriesForFilesInDirectoryAtURL:(NSURL *)directoryURL
+{
+	NSFileManager *fileManager = [NSFileManager defaultManager];
+	NSString *directoryPath = MIKMIDIFileIndexPathForURL(directoryURL);
+	BOOL isDirectory = NO;
+	if (!directoryPath || ![fileManager fileExistsAtPath:directoryPath isDirectory:&isDirectory] || !isDirectory) return 0;
+
+	NSSet *fileExtensions = [NSSet setWithObjects:@"mid", @"midi", @"kar", @"smf", nil];
+	NSMutableArray *fileURLs = [NSMutableArray array];
+	NSMutableSet *paths = [NSMutableSet set];
+	for (NSURL *fileURL in [fileManager enumeratorAtURL:directoryURL includingPropertiesForKeys:@[] options:0 errorHandler:nil]) {
+		if (![fileExtensions containsObject:[[fileURL pathExtension] lowercaseString]]) continue;
+		NSString *path = MIKMIDIFileIndexPathForURL(fileURL);
+		if (!path) continue;
+		[fileURLs addObject:fileURL];
+		[paths addObject:path];
+	}
+
+	// Files that are in the index but weren't found are checked too, which removes their entries
+	NSString *pathPrefix = [directoryPath hasSuffix:@"/"] ? directoryPath : [directoryPath stringByAppendingString:@"/"];
+	for (NSString *path in _entriesByPath) {
+		if ([path hasPrefix:pathPrefix] && ![paths containsObject:path]) [fileURLs addObject:[NSURL fileURLWithPath:path]];
+	}
+	return [self updateEntriesForFilesAtURLs:fileURLs];
+}
+
+// Called concurrently, while the index isn't being changed
+- (id)updatedRecordForFileAtURL:(NSURL *)fileURL
+{
+	const char *path = [fileURL isFileURL] ? [fileURL fileSystemRepresentation] : NULL;
+	struct stat fileStatus;
+	if (!path || stat(path, &fileStatus) || !S_ISREG(fileStatus.st_mode)) return [NSData data];
+
+	MIKMIDIFileIndexEntry *entry = _entriesByPath[MIKMIDIFileIndexPathForURL(fileURL)];
+	if ([entry isUpToDateWithFileStatus:&fileStatus]) return [NSNull null];
+	return MIKMIDIFileIndexRecordForFile(fileURL, &fileStatus) ?: [NSData data];
+}
+
+- (void)removeEntryForFileAtURL:(NSURL *)fileURL
+{
+	NSString *path = MIKMIDIFileIndexPathForURL(fileURL);
+	if (path) [_entriesByPath removeObjectForKey:path];
+}
+
+#pragma mark - Querying
+
+- (MIKMIDIFileIndexEntry *)entryForFileAtURL:(NSURL *)fileURL
+{
+	NSString *path = MIKMIDIFileIndexPathForURL(fileURL);
+	return path ? _entriesByPath[path] : nil;
+}
+
+- (NSArray *)entriesPassingTest:(BOOL (^)(MIKMIDIFileIndexEntry *, BOOL *))predicate
+{
+	NSMutableArray *entries = [NSMutableArray array];
+	BOOL stop = NO;
+	for (MIKMIDIFileIndexEntry *entry in [_entriesByPath objectEnumerator]) {
+		if (predicate(entry, &stop)) [entries addObject:entry];
+		if (stop) break;
+	}
+	return entries;
+}
+
+#pragma mark - Saving
+
+- (BOOL)saveWithError:(NSError **)error
+{
+	error = error ?: &(NSError *__autoreleasing){ nil };
+
+	// Like -[MIKMIDISequence writeToURL:error:], the index is streamed to a temporary file, which then replaces the index file
+	NSString *path = [self.indexFileURL path];
+	NSString *temporaryFileName = [NSString stringWithFormat:@".%@.XXXXXX", [path lastPathComponent]];
+	char *temporaryPath = strdup([[[path stringByDeletingLastPathComponent] stringByAppendingPathComponent:temporaryFileName] fileSystemRepresentation]);
+	int fileDescriptor = mkstemp(temporaryPath);
+	if (fileDescriptor < 0) {
+		*error = [NSError errorWithDomain:NSPOSIXErrorDomain code:errno userInfo:nil];
+		free(temporaryPath);
+		return NO;
+	}
+	fchmod(fileDescriptor, 0644);
+
+	MIKMIDIFileIndexHeader header = { .magic = { 'M', 'I', 'K', 'I' }, .version = MIKMIDIFileIndexVersion, .numberOfRecords = [_entriesByPath count] };
+	NSMutableData *buffer = [NSMutableData dataWithCapacity:MIKMIDIFileIndexWriteBufferSize];
+	[buffer appendBytes:&header length:sizeof(header)];
+	BOOL success = YES;
+	for (MIKMIDIFileIndexEntry *entry in [_entriesByPath objectEnumerator]) {
+		const MIKMIDIFileIndexRecord *record = entry.record;
+		[buffer appendBytes:record length:record->recordSize];
+		if ([buffer length] < MIKMIDIFileIndexWriteBufferSize) continue;
+		if (!(success = MIKMIDIFileIndexWriteData(fileDescriptor, buffer))) break;
+		[buffer setLength:0];
+	}
+	if (success) success = MIKMIDIFileIndexWriteData(fileDescriptor, buffer);
+	if (!success) *error = [NSError errorWithDomain:NSPOSIXErrorDomain code:errno userInfo:nil];
+
+	if (close(fileDescriptor) && success) {
+		*error = [NSError errorWithDomain:NSPOSIXErrorDomain code:errno userInfo:nil];
+		success = NO;
+	}
+	if (success && rename(temporaryPath, [path fileSystemRepresentation])) {
+		*error = [NSError errorWithDomain:NSPOSIXErrorDomain code:errno userInfo:nil];
+		success = NO;
+	}
+	if (!success) unlink(temporaryPath);
+	free(temporaryPath);
+	return success;
+}
+
+#pragma mark - Properties
+
+- (NSArray *)entries
+{
+	return [_entriesByPath allValues];
+}
+
+- (NSUInteger)numberOfEntries
+{
+	return [_entriesByPath count];
+}
+
+@end
+
+#pragma mark -
+
+@implementation MIKMIDIFileIndexEntry
+{
+	NSData *_data; // The whole index file for entries read from it, otherwise just the entry's record
+	NSUInteger _offset;
+}
+
+- (instancetype)initWithData:(NSData *)data offset:(NSUInteger)offset
+{
+	self = [super init];
+	if (self) {
+		_data = data;
+		_offset = offset;
+		const MIKMIDIFileIndexRecord *record = self.record;
+		_path = [[NSFileManager defaultManager] stringWithFileSystemRepresentation:MIKMIDIFileIndexRecordPath(record) length:record->pathLength];
+	}
+	return self;
+}
+
+- (BOOL)isUpToDateWithFileStatus:(const struct stat *)fileStatus
+{
+	const MIKMIDIFileIndexRecord *record = self.record;
+	struct timespec modificationTime = MIKMIDIFileIndexModificationTime(fileStatus);
+	return (record->modificationTimeSeconds == modificationTime.tv_sec &&
+			record->modificationTimeNanoseconds == modificationTime.tv_nsec &&
+			record->fileSize == (UInt64)fileStatus->st_size);
+}
+
+- (NSString *)description
+{
+	return [NSString stringWithFormat:@"%@ %@, %lu tracks, %lu notes, length: %g (%g seconds)", [super description], self.path, (unsigned long)self.numberOfTracks, (unsigned long)self.numberOfNotes, self.length, self.durationInSeconds];
+}
+
+- (NSArray *)metaEventsOfType:(MIKMIDIMetaEventType)metaEventType fromRecordEvents:(const MIKMIDIFileIndexMetaEvent *)indexEvents count:(NSUInteger)count
+{
+	NSMutableArray *events = [NSMutableArray arrayWithCapacity:count];
+	for (NSUInteger i = 0; i < count; i++) {
+		NSMutableData *data = [NSMutableData dataWithLength:MIKMIDIEventMetadataStartOffset + indexEvents[i].dataLength];
+		MIDIMetaEvent *metaEvent = [data mutableBytes];
+		metaEvent->metaEventType = metaEventType;
+		metaEvent->dataLength = indexEvents[i].dataLength;
+		memcpy(metaEvent->data, indexEvents[i].data, indexEvents[i].dataLength);
+		MIKMIDIEvent *event = [MIKMIDIEvent midiEventWithTimeStamp:indexEvents[i].timeStamp eventType:kMusicEventType_Meta data:data];
+		if (event) [events addObject:event];
+	}
+	return events;
+}
+
+#pragma mark - Properties
+
+- (const MIKMIDIFileIndexRecord *)record
+{
+	return (const MIKMIDIFileIndexRecord *)((const UInt8 *)[_data bytes] + _offset);
+}
+
+- (NSURL *)fileURL { return [NSURL fileURLWithPath:self.path]; }
+
+- (NSDate *)modificationDate
+{
+	const MIKMIDIFileIndexRecord *record = self.record;
+	return [NSDate dateWithTimeIntervalSince1970:record->modificationTimeSeconds + record->modificationTimeNanoseconds / 1.0e9];
+}
+
+- (unsigned long long)fileSize { return self.record->fileSize; }
+- (MIKMIDIFileFormat)format { return self.record->format; }
+- (NSUInteger)numberOfTracks { return self.record->numberOfTracks; }
+- (UInt16)ticksPerQuarterNote { return self.record->ticksPerQuarterNote; }
+- (MusicTimeStamp)length { return self.record->length; }
+- (Float64)durationInSeconds { return self.record->durationInSeconds; }
+- (NSUInteger)numberOfNotes { return self.record->numberOfNotes; }
+- (UInt8)lowestNote { return self.record->lowestNote; }
+- (UInt8)highestNote { return self.record->highestNote; }
+
+- (NSArray *)tempoEvents
+{
+	const MIKMIDIFileIndexRecord *record = self.record;
+	const MIKMIDIFileIndexTempoEvent *indexEvents = MIKMIDIFileIndexRecordTempoEvents(record);
+	NSMutableArray *events = [NSMutableArray arrayWithCapacity:record->numberOfTempoEvents];
+	for (NSUInteger i = 0; i < record->numberOfTempoEvents; i++) {
+		[events addObject:[MIKMIDITempoEvent tempoEventWithTimeStamp:indexEvents[i].timeStamp tempo:indexEvents[i].bpm]];
+	}
+	return events;
+}
+
+- (NSArray *)timeSignatureEvents
+{
+	const MIKMIDIFileIndexRecord *record = self.record;
+	return [self metaEventsOfType:MIKMIDIMetaEventTypeTimeSignature fromRecordEvents:MIKMIDIFileIndexRecordTimeSignatureEvents(record) count:record->numberOfTimeSignatureEvents];
+}
+
+- (NSArray *)keySignatureEvents
+{
+	const MIKMIDIFileIndexRecord *record = self.record;
+	return [self metaEventsOfType:MIKMIDIMetaEventTypeKeySignature fromRecordEvents:MIKMIDIFileIndexRecordKeySignatureEvents(record) count:record->numberOfKeySignatureEvents];
+}
+
+- (NSArray *)trackNames
+{
+	const MIKMIDIFileIndexRecord *record = self.record;
+	const UInt8 *trackNames = MIKMIDIFileIndexRecordTrackNames(record);
+	NSMutableArray *names = [NSMutableArray array];
+	for (NSUInteger position = 0; record->trackNamesSize - position >= sizeof(UInt32); ) {
+		UInt32 nameLength = 0;
+		memcpy(&nameLength, trackNames + position, sizeof(nameLength));
+		position += sizeof(nameLength);
+		if (nameLength > record->trackNamesSize - position) break;
+		NSString *name = [[NSString alloc] initWithBytes:trackNames + position length:nameLength encoding:NSUTF8StringEncoding];
+		if (name) [names addObject:name];
+		position += nameLength;
+	}
+	return names;
+}
+
+- (NSIndexSet *)programs
+{
+	const MIKMIDIFileIndexRecord *record = self.record;
+	NSMutableIndexSet *programs = [NSMutableIndexSet indexSet];
+	for (NSUInteger program = 0; program < 128; program++) {
+		if (record->programs[program / 64] & (1ULL << (program % 64))) [programs addIndex:program];
+	}
+	return programs;
+}
+
+- (NSIndexSet *)channels
+{
+	const MIKMIDIFileIndexRecord *record = self.record;
+	NSMutableIndexSet *channels = [NSMutableIndexSet indexSet];
+	for (NSUInteger channel = 0; channel < 16; channel++) {
+		if (record->channels & (1 << channel)) [channels addIndex:channel];
+	}
+	return channels;
+}
+
+@end
@@ -0,0 +1,119 @@
+//
+//  MIKMIDIFileParser+MIKMIDIPrivate.h
+//  MIKMIDI
+//
+//  Created by Mixed In Key on 10/18/26.
+//  Copyright (c) 2026 Mixed In Key. All rights reserved.
+//
+
+#import "MIKMIDIFileParser.h"
+#import "MIKMIDICompilerCompatibility.h"
+
+@class MIKMIDIEventStore;
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface MIKMIDIFileParser ()
+
+/**
+ *  Reads every track in the file into an event store of its own. Like MusicSequenceFileLoadData(),
+ *  tempo and time signature events are put in a separate store for the sequence's tempo track,
+ *  whichever track they appear in. A format 1 file's first track is left out if that leaves it empty.
+ *
+ *  @param tempoTrackEventStore Upon return, contains the events for the tempo track.
+ *  @param error If an error occurs, upon return contains an NSError object that describes the problem.
+ *
+ *  @return An array containing an event store for each of the file's tracks, in order, or nil if a track is malformed.
+ */
+- (nullable MIKArrayOf(MIKMIDIEventStore *) *)eventStoresForTracksWithTempoTrackEventStore:(MIKMIDIEventStore *_Nullable *_Nonnull)tempoTrackEventStore error:(NSError **)error;
+
+/**
+ *  Reads the file's events into an event store for each MIDI channel, as MusicSequenceFileLoadData() does
+ *  with kMusicSequenceLoadSMF_ChannelsToTracks. The events are split by channel in the same pass that decodes
+ *  them. Tempo and time signature events are put in a separate store for the sequence's tempo track, as by
+ *  -eventStoresForTracksWithTempoTrackEventStore:error:.
+ *
+ *  Other meta events, like track names and markers, and system exclusive events aren't moved to the tempo track
+ *  or the first channel's track. They're kept together in a last store, as MusicSequenceFileLoadData() does, so
+ *  a sequence has the track structure MIKMIDISequence documents for convertMIDIChannelsToTracks whether its file
+ *  is split natively or, for files this class can't read, by MusicSequenceFileLoadData().
+ *
+ *  @param tempoTrackEventStore Upon return, contains the events for the tempo track.
+ *  @param error If an error occurs, upon return contains an NSError object that describes the problem.
+ *
+ *  @return An array containing an event store for each channel that is used, in channel order, followed by a store
+ *  for events that don't have a channel, like meta and system exclusive events, or nil if a track is malformed.
+ */
+- (nullable MIKArrayOf(MIKMIDIEventStore *) *)eventStoresForChannelsWithTempoTrackEventStore:(MIKMIDIEventStore *_Nullable *_Nonnull)tempoTrackEventStore error:(NSError **)error;
+
+/**
+ *  Summarizes every track in the file, without decoding their events, for loading a sequence's tracks lazily.
+ *  Tempo and time signature events are read into a store for the tempo track, as by
+ *  -eventStoresForTracksWithTempoTrackEventStore:error:, and the same tracks are left out.
+ *
+ *  @param tempoTrackEventStore Upon return, contains the events for the tempo track.
+ *  @param error If an error occurs, upon return contains an NSError object that describes the problem.
+ *
+ *  @return An array containing a summary of each of the file's tracks, in order, or nil if a track is malformed.
+ */
+- (nullable MIKArrayOf(MIKMIDIFileTrackSummary *) *)summariesOfTracksWithTempoTrackEventStore:(MIKMIDIEventStore *_Nullable *_Nonnull)tempoTrackEventStore error:(NSError **)error;
+
+/**
+ *  Summarizes every track in the file, like -summariesOfTracksWithTempoTrackEventStore:error:, and also
+ *  collects the key signature events of every track. Used by MIKMIDIFileIndexer.
+ *
+ *  @param tempoTrackEventStore Upon return, contains the events for the tempo track.
+ *  @param keySignatureEventStore Upon return, contains the key signature events of all of the tracks. May be NULL.
+ *  @param error If an error occurs, upon return contains an NSError object that describes the problem.
+ *
+ *  @return An array containing a summary of each of the file's tracks, in order, or nil if a track is malformed.
+ */
+- (nullable MIKArrayOf(MIKMIDIFileTrackSummary *) *)summariesOfTracksWithTempoTrackEventStore:(MIKMIDIEventStore *_Nullable *_Nonnull)tempoTrackEventStore keySignatureEventStore:(MIKMIDIEventStore *_Nullable *_Nullable)keySignatureEventStore error:(NSError **)error;
+
+/**
+ *  Summarizes every track in the file, like -summariesOfTracksWithTempoTrackEventStore:error:, and also
+ *  builds a seek index for each track, so parts of it can be read later with
+ *  -eventStoreForTrackAtIndex:fromTimeStamp:toTimeStamp:seekIndex:error: without decoding the events before them.
+ *
+ *  @param tempoTrackEventStore Upon return, contains the events for the tempo track.
+ *  @param seekIndexes Upon return, contains an NSData for each of the returned summaries, holding the track's seek index.
+ *  The index has an entry for each event that is the first at or after a multiple of seekIndexInterval. An event after a
+ *  long gap gets a single entry, however many multiples the gap spans, so an index never has more entries than its track
+ *  has events. Entries also record the notes still waiting to be turned off, so notes read from an entry end at the same
+ *  note offs as when the whole track is read.
+ *  @param seekIndexInterval The time between seek index entries, in beats.
+ *  @param error If an error occurs, upon return contains an NSError object that describes the problem.
+ *
+ *  @return An array containing a summary of each of the file's tracks, in order, or nil if a track is malformed.
+ */
+- (nullable MIKArrayOf(MIKMIDIFileTrackSummary *) *)summariesOfTracksWithTempoTrackEventStore:(MIKMIDIEventStore *_Nullable *_Nonnull)tempoTrackEventStore seekIndexes:(MIKArrayOf(NSData *) *_Nullable *_Nonnull)seekIndexes seekIndexInterval:(MusicTimeStamp)seekIndexInterval error:(NSError **)error;
+
+/**
+ *  Reads a track's events into an event store of its own, leaving out tempo and time signature events.
+ *
+ *  @param trackIndex The index of the track, from 0 to numberOfTracks - 1.
+ *  @param error If an error occurs, upon return contains an NSError object that describes the problem.
+ *
+ *  @return An event store containing the track's events, or nil if the track is malformed.
+ */
+- (nullable MIKMIDIEventStore *)eventStoreForTrackAtIndex:(NSUInteger)trackIndex error:(NSError **)error;
+
+/**
+ *  Reads part of a track's events into an event store, leaving out tempo and time signature events.
+ *  Notes that start in the range keep their full duration, even if they end after it.
+ *
+ *  @param trackIndex The index of the track, from 0 to numberOfTracks - 1.
+ *  @param startTimeStamp Events before this time stamp are left out.
+ *  @param endTimeStamp Events at or after this time stamp are left out.
+ *  @param seekIndex The track's seek index, from -summariesOfTracksWithTempoTrackEventStore:seekIndexes:seekIndexInterval:error:.
+ *  Reading starts at the last entry at or before startTimeStamp, so at most one seek index interval of events is read
+ *  before it. If nil, the track is read from its start.
+ *  @param error If an error occurs, upon return contains an NSError object that describes the problem.
+ *
+ *  @return An event store containing the events, or nil if the track is malformed.
+ */
+- (nullable MIKMIDIEventStore *)eventStoreForTrackAtIndex:(NSUInteger)trackIndex fromTimeStamp:(MusicTimeStamp)startTimeStamp toTimeStamp:(MusicTimeStamp)endTimeStamp seekIndex:(nullable NSData *)seekIndex error:(NSError **)error;
+
+@end
+
+NS_ASSUME_NONNULL_END
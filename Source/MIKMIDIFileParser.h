@@ -0,0 +1,201 @@
+//
+//  MIKMIDIFileParser.h
+//  MIKMIDI
+//
+//  Created by Mixed In Key on 10/18/26.
+//  Copyright (c) 2026 Mixed In Key. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import <AudioToolbox/AudioToolbox.h>
+#import "MIKMIDICompilerCompatibility.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  The format of a Standard MIDI File, as given in its header chunk.
+ */
+typedef NS_ENUM(UInt16, MIKMIDIFileFormat) {
+	/**
+	 *  The file contains a single track.
+	 */
+	MIKMIDIFileFormatSingleTrack = 0,
+	/**
+	 *  The file contains several tracks, which are played simultaneously.
+	 */
+	MIKMIDIFileFormatMultipleTracks = 1,
+	/**
+	 *  The file contains several independent single track patterns.
+	 */
+	MIKMIDIFileFormatMultipleSequences = 2,
+};
+
+@class MIKMIDIFileTrackSummary;
+
+/**
+ *  MIKMIDIFileParser reads Standard MIDI Files (format 0, 1 or 2) without using AudioToolbox's
+ *  MusicSequenceFileLoadData(). MIKMIDISequence uses it to load files, building its tracks' events
+ *  straight from the file rather than loading a MusicSequence and then reading its events back.
+ *
+ *  Creating a parser only reads the file's header and locates its track chunks. Each track is
+ *  decoded when its events are enumerated, in a single pass over the chunk. Different tracks may be
+ *  enumerated on different threads at the same time. The parser doesn't copy
+ *  the file, so a parser created with +parserWithFileAtURL:error: works from a memory-mapped file.
+ *
+ *  Events are reported the way a MusicTrack stores them, so they can be passed straight to e.g.
+ *  MusicTrackNewMIDINoteEvent() or +[MIKMIDIEvent midiEventWithTimeStamp:eventType:data:]:
+ *
+ *  - Note on and note off messages are paired into MIDINoteMessages. Note ons without a matching
+ *    note off last until the end of the track.
+ *  - Other channel messages are MIDIChannelMessages.
+ *  - Tempo meta events become ExtendedTempoEvents. Other meta events, except for end of track,
+ *    are MIDIMetaEvents.
+ *  - System exclusive messages are MIDIRawData, including their leading 0xF0.
+ *
+ *  Time stamps are in beats (quarter notes). Files using SMPTE time division aren't supported.
+ */
+@interface MIKMIDIFileParser : NSObject
+
+/**
+ *  Creates and initializes a parser for a MIDI file's data.
+ *
+ *  @param data The contents of a Standard MIDI File. The data is not copied, and must not be changed while the parser exists.
+ *  @param error If an error occurs, upon return contains an NSError object that describes the problem. If you are not interested in possible errors, you may pass in NULL.
+ *
+ *  @return A new MIKMIDIFileParser, or nil if the data's header is invalid or unsupported.
+ */
++ (nullable instancetype)parserWithData:(NSData *)data error:(NSError **)error;
+
+/**
+ *  Creates and initializes a parser for the MIDI file at fileURL. The file is memory-mapped where possible.
+ *
+ *  @param fileURL The URL of a Standard MIDI File.
+ *  @param error If an error occurs, upon return contains an NSError object that describes the problem. If you are not interested in possible errors, you may pass in NULL.
+ *
+ *  @return A new MIKMIDIFileParser, or nil if the file couldn't be read, or its header is invalid or unsupported.
+ */
++ (nullable instancetype)parserWithFileAtURL:(NSURL *)fileURL error:(NSError **)error;
+
+/**
+ *  Initializes a parser for a MIDI file's data.
+ *
+ *  @param data The contents of a Standard MIDI File. The data is not copied, and must not be changed while the parser exists.
+ *  @param error If an error occurs, upon return contains an NSError object that describes the problem. If you are not interested in possible errors, you may pass in NULL.
+ *
+ *  @return An initialized MIKMIDIFileParser, or nil if the data's header is invalid or unsupported.
+ */
+- (nullable instancetype)initWithData:(NSData *)data error:(NSError **)error NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ *  Calls block for each event in a track, in order, without creating MIKMIDIEvents.
+ *
+ *  @param trackIndex The index of the track, from 0 to numberOfTracks - 1.
+ *  @param block The block to call for each event. data is only valid for the duration of the call.
+ *  Set *stop to YES to end the enumeration early.
+ *  @param error If an error occurs, upon return contains an NSError object that describes the problem. If you are not interested in possible errors, you may pass in NULL.
+ *
+ *  @return YES if the track was read successfully, NO if it is malformed. If the track is malformed, block is not called.
+ */
+- (BOOL)enumerateEventsInTrackAtIndex:(NSUInteger)trackIndex usingBlock:(void (^)(MusicTimeStamp timeStamp, MusicEventType eventType, const void *data, UInt32 dataSize, BOOL *stop))block error:(NSError **)error;
+
+/**
+ *  Summarizes a track without decoding its events. This reads the track in a single pass, like
+ *  -enumerateEventsInTrackAtIndex:usingBlock:error:, but doesn't store anything, so it's considerably faster.
+ *
+ *  @param trackIndex The index of the track, from 0 to numberOfTracks - 1.
+ *  @param error If an error occurs, upon return contains an NSError object that describes the problem. If you are not interested in possible errors, you may pass in NULL.
+ *
+ *  @return A summary of the track, or nil if it is malformed.
+ */
+- (nullable MIKMIDIFileTrackSummary *)summaryOfTrackAtIndex:(NSUInteger)trackIndex error:(NSError **)error;
+
+/**
+ *  The file's format.
+ */
+@property (nonatomic, readonly) MIKMIDIFileFormat format;
+
+/**
+ *  The number of ticks per quarter note the file's event times are expressed in.
+ */
+@property (nonatomic, readonly) UInt16 ticksPerQuarterNote;
+
+/**
+ *  The number of track (MTrk) chunks in the file.
+ */
+@property (nonatomic, readonly) NSUInteger numberOfTracks;
+
+/**
+ *  The maximum number of tracks decoded or summarized at the same time when a sequence is loaded from the
+ *  receiver, e.g. by +[MIKMIDISequence sequenceWithFileParser:error:].
+ *
+ *  Track chunks are independent of each other, so they can be decoded on several cores at once, and
+ *  the resulting tracks are added to the sequence in the file's order. 0 uses as many threads as there
+ *  are active processor cores. 1 decodes the tracks one after another. The default is 0.
+ */
+@property (nonatomic) NSUInteger maximumConcurrentTrackDecodes;
+
+@end
+
+/**
+ *  MIKMIDIFileTrackSummary describes a track of a MIDI file, as found by -[MIKMIDIFileParser summaryOfTrackAtIndex:error:].
+ *
+ *  Events are counted the way MIKMIDIFileParser reports them, so a note on and its note off are one event, and
+ *  tempo and time signature events, which MIKMIDISequence moves to its tempo track, aren't included.
+ */
+@interface MIKMIDIFileTrackSummary : NSObject
+
+/**
+ *  The index of the track in the file.
+ */
+@property (nonatomic, readonly) NSUInteger trackIndex;
+
+/**
+ *  The text of the track's first track name meta event, or nil if it doesn't have one.
+ */
+@property (nonatomic, copy, readonly, nullable) NSString *name;
+
+/**
+ *  The text of the track's first instrument name meta event, or nil if it doesn't have one.
+ */
+@property (nonatomic, copy, readonly, nullable) NSString *instrumentName;
+
+/**
+ *  The MIDI channels (0-15) used by the track's channel events.
+ */
+@property (nonatomic, copy, readonly) NSIndexSet *channels;
+
+/**
+ *  The programs (0-127) selected by the track's program change events.
+ */
+@property (nonatomic, copy, readonly) NSIndexSet *programs;
+
+/**
+ *  The number of events in the track. A track loaded from the file may have fewer, as MIKMIDITrack doesn't keep duplicate events.
+ */
+@property (nonatomic, readonly) NSUInteger numberOfEvents;
+
+/**
+ *  The number of notes in the track.
+ */
+@property (nonatomic, readonly) NSUInteger numberOfNotes;
+
+/**
+ *  The lowest note in the track, or 0 if it has no notes.
+ */
+@property (nonatomic, readonly) UInt8 lowestNote;
+
+/**
+ *  The highest note in the track, or 0 if it has no notes.
+ */
+@property (nonatomic, readonly) UInt8 highestNote;
+
+/**
+ *  The time stamp at which the track's last event, including the end of its last note, ends, in beats.
+ */
+@property (nonatomic, readonly) MusicTimeStamp length;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,917 @@
+//
+//  MIKMIDIFileParser.m
+//  MIKMIDI
+//
+//  Created by Mixed In Key on 10/18/26.
+//  Copyright (c) 2026 Mixed In Key. All rights reserved.
+//
+
+#import "MIKMIDIFileParser.h"
+#import "MIKMIDIFileParser+MIKMIDIPrivate.h"
+#import "MIKMIDIEventStore.h"
+#import "MIKMIDIMetaEvent.h"
+#import "MIKMIDIErrors.h"
+#import <stdatomic.h>
+
+#if !__has_feature(objc_arc)
+#error MIKMIDIFileParser.m must be compiled with ARC. Either turn on ARC for the project or set the -fobjc-arc flag for MIKMIDIFileParser.m in the Build Phases for this target
+#endif
+
+#define MIKMIDIFileParserNumberOfNoteKeys	(16 * 128)
+
+// Splitting channels into tracks uses one store per channel, and a last one for events without a channel
+#define MIKMIDIFileParserNumberOfChannelEventStores	17
+
+// A decoded event. A track is decoded in full before any of its events are reported, because
+// a note's duration isn't known until its note off is reached.
+typedef struct {
+	UInt64 tick;
+	MusicEventType eventType;
+	UInt32 dataSize;
+	NSUInteger dataOffset; // Into the track's data
+	NSUInteger nextPendingNote; // For note ons still waiting for their note off, the index + 1 of the next one with the same channel and note
+} MIKMIDIFileParserEvent;
+
+typedef struct {
+	MIKMIDIFileParserEvent *events;
+	NSUInteger count;
+	NSUInteger capacity;
+	UInt8 *data;
+	NSUInteger dataLength;
+	NSUInteger dataCapacity;
+} MIKMIDIFileParserTrack;
+
+// A point in a track's MTrk chunk that decoding can start from, without reading the events before it
+typedef struct {
+	NSUInteger position;	// The offset of the next event's delta time in the track's data
+	UInt64 tick;			// The time of the previous event, in ticks
+	UInt8 runningStatus;	// The running status before the next event
+} MIKMIDIFileParserTrackPosition;
+
+// A track's seek index starts with this, followed by its entries in order, and then the pending note counts they refer to
+typedef struct {
+	UInt64 numberOfEntries;
+} MIKMIDIFileParserSeekIndexHeader;
+
+// An entry of a track's seek index. The note ons waiting for a note off at position are found by starting with none,
+// and setting the counts from firstPendingNoteCount up to endPendingNoteCount in turn.
+typedef struct {
+	UInt64 tick; // The time of the event at position, in ticks
+	MIKMIDIFileParserTrackPosition position;
+	NSUInteger firstPendingNoteCount;
+	NSUInteger endPendingNoteCount;
+} MIKMIDIFileParserSeekIndexEntry;
+
+// The number of note ons waiting for a note off, for one channel and note
+typedef struct {
+	UInt32 key; // channel * 128 + note
+	UInt32 count;
+} MIKMIDIFileParserPendingNoteCount;
+
+#pragma mark - Decoding
+
+static UInt16 MIKMIDIFileParserReadUInt16(const UInt8 *bytes)
+{
+	return (UInt16)(bytes[0] << 8 | bytes[1]);
+}
+
+static UInt32 MIKMIDIFileParserReadUInt32(const UInt8 *bytes)
+{
+	return (UInt32)bytes[0] << 24 | (UInt32)bytes[1] << 16 | (UInt32)bytes[2] << 8 | bytes[3];
+}
+
+// Reads a variable-length quantity of at most 4 bytes, advancing *position past it
+static BOOL MIKMIDIFileParserReadVariableLengthQuantity(const UInt8 *bytes, NSUInteger length, NSUInteger *position, UInt32 *value)
+{
+	UInt32 result = 0;
+	for (NSUInteger i = 0; i < 4 && *position < length; i++) {
+		UInt8 byte = bytes[(*position)++];
+		result = (result << 7) | (byte & 0x7F);
+		if (!(byte & 0x80)) {
+			*value = result;
+			return YES;
+		}
+	}
+	return NO;
+}
+
+// Appends an event, and returns a pointer to dataSize bytes for its data. The pointer is only valid until the next event is appended.
+static void *MIKMIDIFileParserTrackAppendEvent(MIKMIDIFileParserTrack *track, UInt64 tick, MusicEventType eventType, UInt32 dataSize)
+{
+	if (track->count == track->capacity) {
+		track->capacity = MAX(track->capacity * 2, 256);
+		track->events = realloc(track->events, track->capacity * sizeof(MIKMIDIFileParserEvent));
+	}
+
+	// Event data is kept 8 byte aligned, as it's read as e.g. an ExtendedTempoEvent in place
+	NSUInteger dataOffset = (track->dataLength + 7) & ~(NSUInteger)7;
+	if (dataOffset + dataSize > track->dataCapacity) {
+		track->dataCapacity = MAX(MAX(track->dataCapacity * 2, dataOffset + dataSize), 4096);
+		track->data = realloc(track->data, track->dataCapacity);
+	}
+
+	track->events[track->count++] = (MIKMIDIFileParserEvent){ .tick = tick, .eventType = eventType, .dataSize = dataSize, .dataOffset = dataOffset };
+	track->dataLength = dataOffset + dataSize;
+	return track->data + dataOffset;
+}
+
+static void MIKMIDIFileParserTrackEndNote(MIKMIDIFileParserTrack *track, const MIKMIDIFileParserEvent *noteOn, UInt64 tick, UInt8 releaseVelocity, UInt16 ticksPerQuarterNote)
+{
+	MIDINoteMessage *message = (MIDINoteMessage *)(track->data + noteOn->dataOffset);
+	message->releaseVelocity = releaseVelocity;
+	message->duration = (Float32)((double)(tick - noteOn->tick) / ticksPerQuarterNote);
+}
+
+// Decodes the contents of an MTrk chunk in a single pass. Running status is honored across meta and
+// system exclusive events, which is more lenient than the specification, but matches common practice.
+// Decoding starts at start. Events before startTick or at or after endTick aren't decoded, although the track
+// is read on until the notes that were decoded have been turned off. undecodedPendingNotes holds the number of
+// note ons waiting for a note off at start, for each channel and note. Note ons before startTick are added to it,
+// so that note offs end the same note ons as they would if the whole track were decoded.
+static BOOL MIKMIDIFileParserDecodeTrack(const UInt8 *bytes, NSUInteger length, UInt16 ticksPerQuarterNote, MIKMIDIFileParserTrackPosition start, UInt32 *undecodedPendingNotes, UInt64 startTick, UInt64 endTick, MIKMIDIFileParserTrack *track)
+{
+	// Note ons waiting for their note off, first in first out, for each channel and note. Undecoded ones are
+	// all before the decoded ones, so they're ended first.
+	NSUInteger firstPendingNotes[MIKMIDIFileParserNumberOfNoteKeys] = {0};
+	NSUInteger lastPendingNotes[MIKMIDIFileParserNumberOfNoteKeys] = {0};
+	NSUInteger numberOfPendingNotes = 0;
+
+	UInt64 tick = start.tick;
+	UInt8 runningStatus = start.runningStatus;
+	NSUInteger position = start.position;
+	while (position < length) {
+		UInt32 deltaTime = 0;
+		if (!MIKMIDIFileParserReadVariableLengthQuantity(bytes, length, &position, &deltaTime)) return NO;
+		if (position >= length) return NO;
+		tick += deltaTime;
+		if (tick >= endTick && !numberOfPendingNotes) break;
+		BOOL isDecoded = (tick >= startTick && tick < endTick);
+
+		UInt8 status = bytes[position];
+		if (status == 0xFF) {
+			if (length - position < 2) return NO;
+			UInt8 metaType = bytes[position + 1];
+			position += 2;
+			UInt32 metaLength = 0;
+			if (!MIKMIDIFileParserReadVariableLengthQuantity(bytes, length, &position, &metaLength)) return NO;
+			if (metaLength > length - position) return NO;
+			const UInt8 *metaData = bytes + position;
+			position += metaLength;
+
+			if (metaType == MIKMIDIMetaEventTypeEndOfTrack) break;
+			if (!isDecoded) continue;
+			if (metaType == MIKMIDIMetaEventTypeTempoSetting && metaLength == 3) {
+				UInt32 microsecondsPerQuarterNote = (UInt32)metaData[0] << 16 | (UInt32)metaData[1] << 8 | metaData[2];
+				if (!microsecondsPerQuarterNote) continue;
+				ExtendedTempoEvent *tempoEvent = MIKMIDIFileParserTrackAppendEvent(track, tick, kMusicEventType_ExtendedTempo, sizeof(ExtendedTempoEvent));
+				tempoEvent->bpm = 60000000.0 / microsecondsPerQuarterNote;
+				continue;
+			}
+
+			UInt8 *eventData = MIKMIDIFileParserTrackAppendEvent(track, tick, kMusicEventType_Meta, (UInt32)MIKMIDIEventMetadataStartOffset + metaLength);
+			MIDIMetaEvent *metaEvent = (MIDIMetaEvent *)eventData; // Only its header is written, as short events are smaller than sizeof(MIDIMetaEvent)
+			metaEvent->metaEventType = metaType;
+			metaEvent->unused1 = metaEvent->unused2 = metaEvent->unused3 = 0;
+			metaEvent->dataLength = metaLength;
+			memcpy(eventData + MIKMIDIEventMetadataStartOffset, metaData, metaLength);
+		} else if (status == 0xF0 || status == 0xF7) {
+			position++;
+			UInt32 sysexLength = 0;
+			if (!MIKMIDIFileParserReadVariableLengthQuantity(bytes, length, &position, &sysexLength)) return NO;
+			if (sysexLength > length - position) return NO;
+			if (!isDecoded) {
+				position += sysexLength;
+				continue;
+			}
+
+			// F7 events are escapes for arbitrary data, and don't start with a status byte of their own
+			UInt32 rawLength = sysexLength + (status == 0xF0 ? 1 : 0);
+			MIDIRawData *rawData = MIKMIDIFileParserTrackAppendEvent(track, tick, kMusicEventType_MIDIRawData, (UInt32)offsetof(MIDIRawData, data) + rawLength);
+			rawData->length = rawLength;
+			UInt8 *rawBytes = rawData->data;
+			if (status == 0xF0) *rawBytes++ = 0xF0;
+			memcpy(rawBytes, bytes + position, sysexLength);
+			position += sysexLength;
+		} else {
+			if (status & 0x80) {
+				runningStatus = status;
+				position++;
+			} else if (!runningStatus) {
+				return NO;
+			}
+			status = runningStatus;
+			if (status >= 0xF0) return NO; // System common and real time messages don't belong in MIDI files
+
+			NSUInteger numberOfDataBytes = ((status & 0xE0) == 0xC0) ? 1 : 2; // Program change and channel pressure have one
+			if (numberOfDataBytes > length - position) return NO;
+			UInt8 data1 = bytes[position] & 0x7F;
+			UInt8 data2 = (numberOfDataBytes > 1) ? (bytes[position + 1] & 0x7F) : 0;
+			position += numberOfDataBytes;
+
+			UInt8 eventKind = status & 0xF0;
+			if (eventKind == 0x90 && data2) {
+				NSUInteger key = (status & 0x0F) * 128 + data1;
+				if (!isDecoded) {
+					if (tick < startTick) undecodedPendingNotes[key]++;
+					continue;
+				}
+				MIDINoteMessage *message = MIKMIDIFileParserTrackAppendEvent(track, tick, kMusicEventType_MIDINoteMessage, sizeof(MIDINoteMessage));
+				*message = (MIDINoteMessage){ .channel = status & 0x0F, .note = data1, .velocity = data2 };
+
+				if (lastPendingNotes[key]) {
+					track->events[lastPendingNotes[key] - 1].nextPendingNote = track->count;
+				} else {
+					firstPendingNotes[key] = track->count;
+				}
+				lastPendingNotes[key] = track->count;
+				numberOfPendingNotes++;
+			} else if (eventKind == 0x80 || eventKind == 0x90) {
+				// Note offs without a matching note on are dropped
+				NSUInteger key = (status & 0x0F) * 128 + data1;
+				if (undecodedPendingNotes[key]) {
+					undecodedPendingNotes[key]--;
+					continue;
+				}
+				if (!firstPendingNotes[key]) continue;
+				const MIKMIDIFileParserEvent *noteOn = &track->events[firstPendingNotes[key] - 1];
+				firstPendingNotes[key] = noteOn->nextPendingNote;
+				if (!firstPendingNotes[key]) lastPendingNotes[key] = 0;
+				numberOfPendingNotes--;
+				MIKMIDIFileParserTrackEndNote(track, noteOn, tick, (eventKind == 0x80) ? data2 : 0, ticksPerQuarterNote);
+			} else if (isDecoded) {
+				MIDIChannelMessage *message = MIKMIDIFileParserTrackAppendEvent(track, tick, kMusicEventType_MIDIChannelMessage, sizeof(MIDIChannelMessage));
+				*message = (MIDIChannelMessage){ .status = status, .data1 = data1, .data2 = data2 };
+			}
+		}
+	}
+
+	// Notes that are never turned off last until the end of the track
+	for (NSUInteger key = 0; key < MIKMIDIFileParserNumberOfNoteKeys; key++) {
+		for (NSUInteger index = firstPendingNotes[key]; index; index = track->events[index - 1].nextPendingNote) {
+			MIKMIDIFileParserTrackEndNote(track, &track->events[index - 1], tick, 0, ticksPerQuarterNote);
+		}
+	}
+	return YES;
+}
+
+// Returns the first tick at or after timeStamp
+static UInt64 MIKMIDIFileParserTickForTimeStamp(MusicTimeStamp timeStamp, double ticksPerQuarterNote)
+{
+	double ticks = ceil(MAX(timeStamp, 0) * ticksPerQuarterNote);
+	return (ticks < (double)UINT64_MAX) ? (UInt64)ticks : UINT64_MAX;
+}
+
+// Returns the position of the last seek index entry at or before tick, or the start of the track if there isn't one,
+// and sets pendingNotes to the number of note ons waiting for a note off there, for each channel and note.
+// Every event between that entry and tick is within one seek index interval of it, or the entry would not be the last.
+static MIKMIDIFileParserTrackPosition MIKMIDIFileParserSeekIndexPositionForTick(NSData *seekIndex, UInt64 tick, UInt32 *pendingNotes)
+{
+	if ([seekIndex length] < sizeof(MIKMIDIFileParserSeekIndexHeader)) return (MIKMIDIFileParserTrackPosition){ 0 };
+	const MIKMIDIFileParserSeekIndexHeader *header = [seekIndex bytes];
+	const MIKMIDIFileParserSeekIndexEntry *entries = (const MIKMIDIFileParserSeekIndexEntry *)(header + 1);
+	const MIKMIDIFileParserPendingNoteCount *pendingNoteCounts = (const MIKMIDIFileParserPendingNoteCount *)(entries + header->numberOfEntries);
+	NSUInteger low = 0, high = (NSUInteger)header->numberOfEntries;
+	while (low < high) {
+		NSUInteger middle = low + (high - low) / 2;
+		if (entries[middle].tick <= tick) {
+			low = middle + 1;
+		} else {
+			high = middle;
+		}
+	}
+	if (!low) return (MIKMIDIFileParserTrackPosition){ 0 };
+
+	const MIKMIDIFileParserSeekIndexEntry *entry = &entries[low - 1];
+	for (NSUInteger i = entry->firstPendingNoteCount; i < entry->endPendingNoteCount; i++) {
+		pendingNotes[pendingNoteCounts[i].key] = pendingNoteCounts[i].count;
+	}
+	return entry->position;
+}
+
+// Tempo and time signature events belong in the sequence's tempo track, whichever track they're read from
+static BOOL MIKMIDIFileParserIsTempoTrackEvent(MusicEventType eventType, const void *data)
+{
+	return (eventType == kMusicEventType_ExtendedTempo ||
+			(eventType == kMusicEventType_Meta && ((const MIDIMetaEvent *)data)->metaEventType == MIKMIDIMetaEventTypeTimeSignature));
+}
+
+// Returns the channel of a note or channel message, or 16 for events that don't have one
+static NSUInteger MIKMIDIFileParserChannelOfEvent(MusicEventType eventType, const void *data)
+{
+	if (eventType == kMusicEventType_MIDINoteMessage) return ((const MIDINoteMessage *)data)->channel & 0x0F;
+	if (eventType == kMusicEventType_MIDIChannelMessage) return ((const MIDIChannelMessage *)data)->status & 0x0F;
+	return 16;
+}
+
+#pragma mark - Set Aside Events
+
+// Events held back from a track while it's decoded, each a header followed by its data, padded to keep the next header aligned
+typedef struct {
+	MusicTimeStamp timeStamp;
+	MusicEventType eventType;
+	UInt32 dataSize;
+} MIKMIDIFileParserSetAsideEventHeader;
+
+// The event's data is prefix followed by data, which lets a meta event be set aside straight from the file
+static void MIKMIDIFileParserSetAsideEvent(NSMutableData *events, MusicTimeStamp timeStamp, MusicEventType eventType, const void *prefix, UInt32 prefixSize, const void *data, UInt32 dataSize)
+{
+	UInt32 eventSize = prefixSize + dataSize;
+	MIKMIDIFileParserSetAsideEventHeader header = { .timeStamp = timeStamp, .eventType = eventType, .dataSize = eventSize };
+	[events appendBytes:&header length:sizeof(header)];
+	if (prefixSize) [events appendBytes:prefix length:prefixSize];
+	if (dataSize) [events appendBytes:data length:dataSize];
+	[events increaseLengthBy:((eventSize + 7) & ~(NSUInteger)7) - eventSize];
+}
+
+static void MIKMIDIFileParserAddSetAsideEvents(NSData *events, MIKMIDIEventStore *eventStore)
+{
+	const UInt8 *bytes = [events bytes];
+	NSUInteger length = [events length];
+	for (NSUInteger position = 0; position < length; ) {
+		const MIKMIDIFileParserSetAsideEventHeader *header = (const MIKMIDIFileParserSetAsideEventHeader *)(bytes + position);
+		position += sizeof(*header);
+		[eventStore addEventWithTimeStamp:header->timeStamp musicEventType:header->eventType data:(bytes + position) length:header->dataSize];
+		position += (header->dataSize + 7) & ~(NSUInteger)7;
+	}
+}
+
+#pragma mark - Scanning
+
+typedef struct {
+	NSUInteger numberOfEvents;
+	NSUInteger numberOfNotes;
+	UInt16 channels; // One bit per channel
+	UInt64 programs[2]; // One bit per program
+	UInt8 lowestNote;
+	UInt8 highestNote;
+	UInt64 endTick;
+	NSRange nameRange; // Within the chunk, with a location of NSNotFound if the track has no name
+	NSRange instrumentNameRange;
+} MIKMIDIFileParserTrackScan;
+
+// Reads an MTrk chunk the same way as MIKMIDIFileParserDecodeTrack(), but only summarizes its events, without
+// storing them. Tempo track events are set aside if setAsideEvents isn't nil, and otherwise skipped. Key signature
+// events are also copied to keySignatureEvents if it isn't nil. If seekIndex isn't nil, a seek index is appended to it,
+// with an MIKMIDIFileParserSeekIndexEntry for each event that is the first at or after a multiple of ticksPerSeekIndexEntry.
+static BOOL MIKMIDIFileParserScanTrack(const UInt8 *bytes, NSUInteger length, UInt16 ticksPerQuarterNote, MIKMIDIFileParserTrackScan *scan, NSMutableData *setAsideEvents, NSMutableData *keySignatureEvents, NSMutableData *seekIndex, UInt64 ticksPerSeekIndexEntry)
+{
+	// Only the number of note ons waiting for a note off matters here, not which note on each note off ends
+	UInt32 pendingNotes[MIKMIDIFileParserNumberOfNoteKeys] = {0};
+	NSUInteger numberOfPendingNotes = 0;
+
+	// Each seek index entry gets the counts that changed since the one before it. Once replaying the counts since
+	// the last full set would take longer than writing out every count again, a new full set is written instead,
+	// so the counts written stay within the number of note events, and reading an entry's stays bounded.
+	NSMutableData *seekIndexEntries = seekIndex ? [NSMutableData data] : nil;
+	NSMutableData *pendingNoteCounts = seekIndex ? [NSMutableData data] : nil;
+	NSUInteger firstPendingNoteCount = 0;
+	UInt16 changedKeys[MIKMIDIFileParserNumberOfNoteKeys];
+	BOOL isChangedKey[MIKMIDIFileParserNumberOfNoteKeys] = {NO};
+	NSUInteger numberOfChangedKeys = 0;
+
+	*scan = (MIKMIDIFileParserTrackScan){ .lowestNote = 127, .nameRange = { NSNotFound, 0 }, .instrumentNameRange = { NSNotFound, 0 } };
+	UInt64 tick = 0, nextSeekIndexEntryTick = 0;
+	UInt8 runningStatus = 0;
+	NSUInteger position = 0;
+	while (position < length) {
+		MIKMIDIFileParserTrackPosition eventPosition = { .position = position, .tick = tick, .runningStatus = runningStatus };
+		UInt32 deltaTime = 0;
+		if (!MIKMIDIFileParserReadVariableLengthQuantity(bytes, length, &position, &deltaTime)) return NO;
+		if (position >= length) return NO;
+		tick += deltaTime;
+		if (seekIndex && tick >= nextSeekIndexEntryTick) {
+			// An event after a long gap gets one entry, however many multiples the gap spans, so a crafted
+			// file can't make the index grow by more than an entry per event
+			NSUInteger endPendingNoteCount = [pendingNoteCounts length] / sizeof(MIKMIDIFileParserPendingNoteCount);
+			BOOL writesAllCounts = (endPendingNoteCount - firstPendingNoteCount + numberOfChangedKeys > MIKMIDIFileParserNumberOfNoteKeys);
+			if (writesAllCounts) firstPendingNoteCount = endPendingNoteCount;
+			for (NSUInteger i = 0; i < (writesAllCounts ? MIKMIDIFileParserNumberOfNoteKeys : numberOfChangedKeys); i++) {
+				UInt32 key = writesAllCounts ? (UInt32)i : changedKeys[i];
+				if (writesAllCounts && !pendingNotes[key]) continue;
+				MIKMIDIFileParserPendingNoteCount pendingNoteCount = { .key = key, .count = pendingNotes[key] };
+				[pendingNoteCounts appendBytes:&pendingNoteCount length:sizeof(pendingNoteCount)];
+			}
+			for (NSUInteger i = 0; i < numberOfChangedKeys; i++) isChangedKey[changedKeys[i]] = NO;
+			numberOfChangedKeys = 0;
+
+			MIKMIDIFileParserSeekIndexEntry entry = { .tick = tick, .position = eventPosition, .firstPendingNoteCount = firstPendingNoteCount, .endPendingNoteCount = [pendingNoteCounts length] / sizeof(MIKMIDIFileParserPendingNoteCount) };
+			[seekIndexEntries appendBytes:&entry length:sizeof(entry)];
+			nextSeekIndexEntryTick = (tick / ticksPerSeekIndexEntry + 1) * ticksPerSeekIndexEntry;
+		}
+
+		UInt8 status = bytes[position];
+		if (status == 0xFF) {
+			if (length - position < 2) return NO;
+			UInt8 metaType = bytes[position + 1];
+			position += 2;
+			UInt32 metaLength = 0;
+			if (!MIKMIDIFileParserReadVariableLengthQuantity(bytes, length, &position, &metaLength)) return NO;
+			if (metaLength > length - position) return NO;
+			NSUInteger metaDataPosition = position;
+			position += metaLength;
+
+			if (metaType == MIKMIDIMetaEventTypeEndOfTrack) break;
+			if (metaType == MIKMIDIMetaEventTypeTempoSetting && metaLength == 3) {
+				const UInt8 *metaData = bytes + metaDataPosition;
+				UInt32 microsecondsPerQuarterNote = (UInt32)metaData[0] << 16 | (UInt32)metaData[1] << 8 | metaData[2];
+				if (!microsecondsPerQuarterNote || !setAsideEvents) continue;
+				ExtendedTempoEvent tempoEvent = { .bpm = 60000000.0 / microsecondsPerQuarterNote };
+				MIKMIDIFileParserSetAsideEvent(setAsideEvents, (double)tick / ticksPerQuarterNote, kMusicEventType_ExtendedTempo, NULL, 0, &tempoEvent, sizeof(tempoEvent));
+				continue;
+			}
+			if (metaType == MIKMIDIMetaEventTypeTimeSignature) {
+				if (!setAsideEvents) continue;
+				MIDIMetaEvent metaEvent = { .metaEventType = metaType, .dataLength = metaLength };
+				MIKMIDIFileParserSetAsideEvent(setAsideEvents, (double)tick / ticksPerQuarterNote, kMusicEventType_Meta, &metaEvent, (UInt32)MIKMIDIEventMetadataStartOffset, bytes + metaDataPosition, metaLength);
+				continue;
+			}
+
+			scan->numberOfEvents++;
+			scan->endTick = tick;
+			if (metaType == MIKMIDIMetaEventTypeTrackSequenceName && scan->nameRange.location == NSNotFound) {
+				scan->nameRange = NSMakeRange(metaDataPosition, metaLength);
+			} else if (metaType == MIKMIDIMetaEventTypeInstrumentName && scan->instrumentNameRange.location == NSNotFound) {
+				scan->instrumentNameRange = NSMakeRange(metaDataPosition, metaLength);
+			} else if (metaType == MIKMIDIMetaEventTypeKeySignature && keySignatureEvents) {
+				MIDIMetaEvent metaEvent = { .metaEventType = metaType, .dataLength = metaLength };
+				MIKMIDIFileParserSetAsideEvent(keySignatureEvents, (double)tick / ticksPerQuarterNote, kMusicEventType_Meta, &metaEvent, (UInt32)MIKMIDIEventMetadataStartOffset, bytes + metaDataPosition, metaLength);
+			}
+		} else if (status == 0xF0 || status == 0xF7) {
+			position++;
+			UInt32 sysexLength = 0;
+			if (!MIKMIDIFileParserReadVariableLengthQuantity(bytes, length, &position, &sysexLength)) return NO;
+			if (sysexLength > length - position) return NO;
+			position += sysexLength;
+			scan->numberOfEvents++;
+			scan->endTick = tick;
+		} else {
+			if (status & 0x80) {
+				runningStatus = status;
+				position++;
+			} else if (!runningStatus) {
+				return NO;
+			}
+			status = runningStatus;
+			if (status >= 0xF0) return NO;
+
+			NSUInteger numberOfDataBytes = ((status & 0xE0) == 0xC0) ? 1 : 2;
+			if (numberOfDataBytes > length - position) return NO;
+			UInt8 data1 = bytes[position] & 0x7F;
+			UInt8 data2 = (numberOfDataBytes > 1) ? (bytes[position + 1] & 0x7F) : 0;
+			position += numberOfDataBytes;
+
+			UInt8 eventKind = status & 0xF0;
+			UInt8 channel = status & 0x0F;
+			NSUInteger key = channel * 128 + data1;
+			BOOL changesPendingNotes = (eventKind == 0x90 && data2) || ((eventKind == 0x80 || eventKind == 0x90) && pendingNotes[key]);
+			if (changesPendingNotes && seekIndex && !isChangedKey[key]) {
+				isChangedKey[key] = YES;
+				changedKeys[numberOfChangedKeys++] = (UInt16)key;
+			}
+			if (eventKind == 0x90 && data2) {
+				pendingNotes[key]++;
+				numberOfPendingNotes++;
+				scan->numberOfNotes++;
+				if (data1 < scan->lowestNote) scan->lowestNote = data1;
+				if (data1 > scan->highestNote) scan->highestNote = data1;
+			} else if (eventKind == 0x80 || eventKind == 0x90) {
+				if (!pendingNotes[key]) continue;
+				pendingNotes[key]--;
+				numberOfPendingNotes--;
+				scan->endTick = tick;
+				continue; // Part of its note on's event
+			} else if (eventKind == 0xC0) {
+				scan->programs[data1 / 64] |= 1ULL << (data1 % 64);
+			}
+			scan->numberOfEvents++;
+			scan->channels |= 1 << channel;
+			scan->endTick = tick;
+		}
+	}
+
+	// Notes that are never turned off last until the end of the track
+	if (numberOfPendingNotes) scan->endTick = tick;
+	if (!scan->numberOfNotes) scan->lowestNote = 0;
+
+	if (seekIndex) {
+		MIKMIDIFileParserSeekIndexHeader header = { .numberOfEntries = [seekIndexEntries length] / sizeof(MIKMIDIFileParserSeekIndexEntry) };
+		[seekIndex appendBytes:&header length:sizeof(header)];
+		[seekIndex appendData:seekIndexEntries];
+		[seekIndex appendData:pendingNoteCounts];
+	}
+	return YES;
+}
+
+static NSIndexSet *MIKMIDIFileParserIndexSetWithBits(const UInt64 *bits, NSUInteger numberOfBits)
+{
+	NSMutableIndexSet *indexes = [NSMutableIndexSet indexSet];
+	for (NSUInteger i = 0; i < numberOfBits; i++) {
+		if (bits[i / 64] & (1ULL << (i % 64))) [indexes addIndex:i];
+	}
+	return indexes;
+}
+
+static NSString *MIKMIDIFileParserStringWithRange(const UInt8 *bytes, NSRange range)
+{
+	if (range.location == NSNotFound) return nil;
+	// Text is read like MIKMIDIMetaTextEvent reads it
+	return [[NSString alloc] initWithBytes:bytes + range.location length:range.length encoding:NSUTF8StringEncoding];
+}
+
+static NSError *MIKMIDIFileParserError(NSString *reason)
+{
+	return [NSError MIKMIDIErrorWithCode:MIKMIDIFileParsingFailedErrorCode userInfo:@{NSLocalizedFailureReasonErrorKey : reason}];
+}
+
+static NSError *MIKMIDIFileParserMalformedTrackError(NSUInteger trackIndex)
+{
+	return MIKMIDIFileParserError([NSString stringWithFormat:@"Track %lu of the MIDI file is malformed.", (unsigned long)trackIndex]);
+}
+
+#pragma mark -
+
+@interface MIKMIDIFileTrackSummary ()
+
+@property (nonatomic, readwrite) NSUInteger trackIndex;
+@property (nonatomic, copy, readwrite, nullable) NSString *name;
+@property (nonatomic, copy, readwrite, nullable) NSString *instrumentName;
+@property (nonatomic, copy, readwrite) NSIndexSet *channels;
+@property (nonatomic, copy, readwrite) NSIndexSet *programs;
+@property (nonatomic, readwrite) NSUInteger numberOfEvents;
+@property (nonatomic, readwrite) NSUInteger numberOfNotes;
+@property (nonatomic, readwrite) UInt8 lowestNote;
+@property (nonatomic, readwrite) UInt8 highestNote;
+@property (nonatomic, readwrite) MusicTimeStamp length;
+
+@end
+
+#pragma mark -
+
+@implementation MIKMIDIFileParser
+{
+	NSData *_data;
+	NSData *_trackRanges; // NSRanges of the contents of each MTrk chunk
+}
+
+#pragma mark - Lifecycle
+
++ (instancetype)parserWithData:(NSData *)data error:(NSError **)error
+{
+	return [[self alloc] initWithData:data error:error];
+}
+
++ (instancetype)parserWithFileAtURL:(NSURL *)fileURL error:(NSError **)error
+{
+	NSData *data = [NSData dataWithContentsOfURL:fileURL options:NSDataReadingMappedIfSafe error:error];
+	if (!data) return nil;
+	return [[self alloc] initWithData:data error:error];
+}
+
+- (instancetype)initWithData:(NSData *)data error:(NSError **)error
+{
+	error = error ?: &(NSError *__autoreleasing){ nil };
+
+	self = [super init];
+	if (self) {
+		const UInt8 *bytes = [data bytes];
+		NSUInteger length = [data length];
+		if (length < 14 || memcmp(bytes, "MThd", 4) || MIKMIDIFileParserReadUInt32(bytes + 4) < 6) {
+			*error = MIKMIDIFileParserError(@"The data is not a Standard MIDI File.");
+			return nil;
+		}
+
+		UInt16 format = MIKMIDIFileParserReadUInt16(bytes + 8);
+		UInt16 division = MIKMIDIFileParserReadUInt16(bytes + 12);
+		if (format > MIKMIDIFileFormatMultipleSequences) {
+			*error = MIKMIDIFileParserError([NSString stringWithFormat:@"MIDI file format %u is not supported.", (unsigned)format]);
+			return nil;
+		}
+		if ((division & 0x8000) || !division) {
+			*error = MIKMIDIFileParserError(@"MIDI files using SMPTE time division are not supported.");
+			return nil;
+		}
+
+		// Other chunk types are skipped, as the specification requires. A truncated last chunk is read as far as it goes.
+		NSMutableData *trackRanges = [NSMutableData data];
+		NSUInteger position = 8 + (NSUInteger)MIKMIDIFileParserReadUInt32(bytes + 4);
+		while (position <= length && length - position >= 8) {
+			NSUInteger chunkStart = position + 8;
+			NSRange range = NSMakeRange(chunkStart, MIN((NSUInteger)MIKMIDIFileParserReadUInt32(bytes + position + 4), length - chunkStart));
+			if (!memcmp(bytes + position, "MTrk", 4)) [trackRanges appendBytes:&range length:sizeof(range)];
+			position = NSMaxRange(range);
+		}
+
+		_data = data;
+		_trackRanges = trackRanges;
+		_format = format;
+		_ticksPerQuarterNote = division;
+	}
+	return self;
+}
+
+- (instancetype)init
+{
+	[NSException raise:NSInternalInconsistencyException format:@"Use -initWithData:error: to create %@ instances.", NSStringFromClass([self class])];
+	return nil;
+}
+
+#pragma mark - Reading Tracks
+
+- (BOOL)enumerateEventsInTrackAtIndex:(NSUInteger)trackIndex usingBlock:(void (^)(MusicTimeStamp, MusicEventType, const void *, UInt32, BOOL *))block error:(NSError **)error
+{
+	error = error ?: &(NSError *__autoreleasing){ nil };
+	if (trackIndex >= self.numberOfTracks) {
+		*error = [NSError MIKMIDIErrorWithCode:MIKMIDIInvalidArgumentError userInfo:nil];
+		return NO;
+	}
+
+	if (![self enumerateEventsInTrackAtIndex:trackIndex fromTimeStamp:0 toTimeStamp:DBL_MAX seekIndex:nil usingBlock:block]) {
+		*error = MIKMIDIFileParserMalformedTrackError(trackIndex);
+		return NO;
+	}
+	return YES;
+}
+
+- (MIKMIDIFileTrackSummary *)summaryOfTrackAtIndex:(NSUInteger)trackIndex error:(NSError **)error
+{
+	error = error ?: &(NSError *__autoreleasing){ nil };
+	if (trackIndex >= self.numberOfTracks) {
+		*error = [NSError MIKMIDIErrorWithCode:MIKMIDIInvalidArgumentError userInfo:nil];
+		return nil;
+	}
+
+	MIKMIDIFileTrackSummary *summary = [[MIKMIDIFileTrackSummary alloc] init];
+	if (![self scanTrackAtIndex:trackIndex intoSummary:summary setAsideEvents:nil keySignatureEvents:nil seekIndex:nil ticksPerSeekIndexEntry:0]) {
+		*error = MIKMIDIFileParserMalformedTrackError(trackIndex);
+		return nil;
+	}
+	return summary;
+}
+
+#pragma mark - Loading Sequences
+
+- (NSArray *)eventStoresForTracksWithTempoTrackEventStore:(MIKMIDIEventStore **)tempoTrackEventStore error:(NSError **)error
+{
+	NSUInteger numberOfTracks = self.numberOfTracks;
+	NSMutableArray *eventStores = [NSMutableArray arrayWithCapacity:numberOfTracks];
+	NSMutableArray *setAsideEvents = [NSMutableArray arrayWithCapacity:numberOfTracks];
+	for (NSUInteger i = 0; i < numberOfTracks; i++) {
+		[eventStores addObject:[[MIKMIDIEventStore alloc] init]];
+		[setAsideEvents addObject:[NSMutableData data]];
+	}
+
+	NSUInteger failedTrackIndex = [self concurrentlyPerformForEachTrack:^BOOL(NSUInteger trackIndex) {
+		return [self decodeTrackAtIndex:trackIndex intoEventStore:eventStores[trackIndex] setAsideEvents:setAsideEvents[trackIndex]];
+	}];
+	if (failedTrackIndex != NSNotFound) {
+		if (error) *error = MIKMIDIFileParserMalformedTrackError(failedTrackIndex);
+		return nil;
+	}
+
+	*tempoTrackEventStore = [self eventStoreWithSetAsideEvents:setAsideEvents];
+
+	// Like MusicSequenceFileLoadData(), a format 1 file's first track doesn't become a track of its own if it
+	// only contains tempo track events. MIKMIDIFileWriter and MusicSequenceFileCreateData() write one of those.
+	if (numberOfTracks && self.format == MIKMIDIFileFormatMultipleTracks && ![[eventStores firstObject] count]) {
+		[eventStores removeObjectAtIndex:0];
+	}
+	return eventStores;
+}
+
+- (NSArray *)eventStoresForChannelsWithTempoTrackEventStore:(MIKMIDIEventStore **)tempoTrackEventStore error:(NSError **)error
+{
+	NSMutableArray *channelEventStores = [NSMutableArray arrayWithCapacity:MIKMIDIFileParserNumberOfChannelEventStores];
+	for (NSUInteger i = 0; i < MIKMIDIFileParserNumberOfChannelEventStores; i++) {
+		[channelEventStores addObject:[[MIKMIDIEventStore alloc] init]];
+	}
+	NSMutableData *setAsideEvents = [NSMutableData data];
+
+	// Each event goes straight to its channel's store as it's decoded. Tracks are read in order, rather than
+	// concurrently, as they share the stores. In a format 0 file, every event is appended to the end of its store.
+	for (NSUInteger trackIndex = 0; trackIndex < self.numberOfTracks; trackIndex++) {
+		BOOL success = [self enumerateEventsInTrackAtIndex:trackIndex usingBlock:^(MusicTimeStamp timeStamp, MusicEventType eventType, const void *data, UInt32 dataSize, BOOL *stop) {
+			if (MIKMIDIFileParserIsTempoTrackEvent(eventType, data)) {
+				MIKMIDIFileParserSetAsideEvent(setAsideEvents, timeStamp, eventType, NULL, 0, data, dataSize);
+			} else {
+				MIKMIDIEventStore *eventStore = channelEventStores[MIKMIDIFileParserChannelOfEvent(eventType, data)];
+				[eventStore addEventWithTimeStamp:timeStamp musicEventType:eventType data:data length:dataSize];
+			}
+		} error:NULL];
+		if (!success) {
+			if (error) *error = MIKMIDIFileParserMalformedTrackError(trackIndex);
+			return nil;
+		}
+	}
+
+	*tempoTrackEventStore = [self eventStoreWithSetAsideEvents:@[setAsideEvents]];
+
+	// Like MusicSequenceFileLoadData(), only channels that are used get a track, but there is always a last track for other events
+	NSMutableArray *eventStores = [NSMutableArray array];
+	for (NSUInteger i = 0; i < MIKMIDIFileParserNumberOfChannelEventStores; i++) {
+		MIKMIDIEventStore *eventStore = channelEventStores[i];
+		if (eventStore.count || i == MIKMIDIFileParserNumberOfChannelEventStores - 1) [eventStores addObject:eventStore];
+	}
+	return eventStores;
+}
+
+- (NSArray *)summariesOfTracksWithTempoTrackEventStore:(MIKMIDIEventStore **)tempoTrackEventStore error:(NSError **)error
+{
+	return [self summariesOfTracksWithTempoTrackEventStore:tempoTrackEventStore keySignatureEventStore:NULL error:error];
+}
+
+- (NSArray *)summariesOfTracksWithTempoTrackEventStore:(MIKMIDIEventStore **)tempoTrackEventStore keySignatureEventStore:(MIKMIDIEventStore **)keySignatureEventStore error:(NSError **)error
+{
+	return [self summariesOfTracksWithTempoTrackEventStore:tempoTrackEventStore keySignatureEventStore:keySignatureEventStore seekIndexes:NULL seekIndexInterval:0 error:error];
+}
+
+- (NSArray *)summariesOfTracksWithTempoTrackEventStore:(MIKMIDIEventStore **)tempoTrackEventStore seekIndexes:(NSArray **)seekIndexes seekIndexInterval:(MusicTimeStamp)seekIndexInterval error:(NSError **)error
+{
+	return [self summariesOfTracksWithTempoTrackEventStore:tempoTrackEventStore keySignatureEventStore:NULL seekIndexes:seekIndexes seekIndexInterval:seekIndexInterval error:error];
+}
+
+- (NSArray *)summariesOfTracksWithTempoTrackEventStore:(MIKMIDIEventStore **)tempoTrackEventStore keySignatureEventStore:(MIKMIDIEventStore **)keySignatureEventStore seekIndexes:(NSArray **)seekIndexes seekIndexInterval:(MusicTimeStamp)seekIndexInterval error:(NSError **)error
+{
+	NSUInteger numberOfTracks = self.numberOfTracks;
+	NSMutableArray *summaries = [NSMutableArray arrayWithCapacity:numberOfTracks];
+	NSMutableArray *setAsideEvents = [NSMutableArray arrayWithCapacity:numberOfTracks];
+	NSMutableArray *keySignatureEvents = keySignatureEventStore ? [NSMutableArray arrayWithCapacity:numberOfTracks] : nil;
+	NSMutableArray *trackSeekIndexes = seekIndexes ? [NSMutableArray arrayWithCapacity:numberOfTracks] : nil;
+	for (NSUInteger i = 0; i < numberOfTracks; i++) {
+		[summaries addObject:[[MIKMIDIFileTrackSummary alloc] init]];
+		[setAsideEvents addObject:[NSMutableData data]];
+		[keySignatureEvents addObject:[NSMutableData data]];
+		[trackSeekIndexes addObject:[NSMutableData data]];
+	}
+
+	UInt64 ticksPerSeekIndexEntry = MAX((UInt64)(seekIndexInterval * self.ticksPerQuarterNote), 1);
+	NSUInteger failedTrackIndex = [self concurrentlyPerformForEachTrack:^BOOL(NSUInteger trackIndex) {
+		return [self scanTrackAtIndex:trackIndex intoSummary:summaries[trackIndex] setAsideEvents:setAsideEvents[trackIndex] keySignatureEvents:keySignatureEvents[trackIndex] seekIndex:trackSeekIndexes[trackIndex] ticksPerSeekIndexEntry:ticksPerSeekIndexEntry];
+	}];
+	if (failedTrackIndex != NSNotFound) {
+		if (error) *error = MIKMIDIFileParserMalformedTrackError(failedTrackIndex);
+		return nil;
+	}
+
+	*tempoTrackEventStore = [self eventStoreWithSetAsideEvents:setAsideEvents];
+	if (keySignatureEventStore) *keySignatureEventStore = [self eventStoreWithSetAsideEvents:keySignatureEvents];
+
+	// The same as -eventStoresForTracksWithTempoTrackEventStore:error:
+	if (numberOfTracks && self.format == MIKMIDIFileFormatMultipleTracks && ![[summaries firstObject] numberOfEvents]) {
+		[summaries removeObjectAtIndex:0];
+		[trackSeekIndexes removeObjectAtIndex:0];
+	}
+	if (seekIndexes) *seekIndexes = trackSeekIndexes;
+	return summaries;
+}
+
+- (MIKMIDIEventStore *)eventStoreForTrackAtIndex:(NSUInteger)trackIndex error:(NSError **)error
+{
+	return [self eventStoreForTrackAtIndex:trackIndex fromTimeStamp:0 toTimeStamp:DBL_MAX seekIndex:nil error:error];
+}
+
+- (MIKMIDIEventStore *)eventStoreForTrackAtIndex:(NSUInteger)trackIndex fromTimeStamp:(MusicTimeStamp)startTimeStamp toTimeStamp:(MusicTimeStamp)endTimeStamp seekIndex:(NSData *)seekIndex error:(NSError **)error
+{
+	error = error ?: &(NSError *__autoreleasing){ nil };
+	if (trackIndex >= self.numberOfTracks) {
+		*error = [NSError MIKMIDIErrorWithCode:MIKMIDIInvalidArgumentError userInfo:nil];
+		return nil;
+	}
+
+	MIKMIDIEventStore *eventStore = [[MIKMIDIEventStore alloc] init];
+	BOOL success = [self enumerateEventsInTrackAtIndex:trackIndex fromTimeStamp:startTimeStamp toTimeStamp:endTimeStamp seekIndex:seekIndex usingBlock:^(MusicTimeStamp timeStamp, MusicEventType eventType, const void *data, UInt32 dataSize, BOOL *stop) {
+		if (MIKMIDIFileParserIsTempoTrackEvent(eventType, data)) return;
+		[eventStore addEventWithTimeStamp:timeStamp musicEventType:eventType data:data length:dataSize];
+	}];
+	if (!success) {
+		*error = MIKMIDIFileParserMalformedTrackError(trackIndex);
+		return nil;
+	}
+	return eventStore;
+}
+
+// Tracks don't depend on each other, so several are read at once, by up to maximumConcurrentTrackDecodes workers, each
+// taking the next track as it becomes free. Returns the index of the first track block returned NO for, or NSNotFound.
+- (NSUInteger)concurrentlyPerformForEachTrack:(BOOL (^)(NSUInteger trackIndex))block
+{
+	NSUInteger numberOfTracks = self.numberOfTracks;
+	if (!numberOfTracks) return NSNotFound;
+
+	NSUInteger numberOfWorkers = self.maximumConcurrentTrackDecodes ?: [[NSProcessInfo processInfo] activeProcessorCount];
+	numberOfWorkers = MIN(MAX(numberOfWorkers, 1), numberOfTracks);
+	atomic_size_t nextTrackIndex = 0;
+	atomic_size_t *nextTrackIndexPointer = &nextTrackIndex;
+	BOOL *failedTracks = calloc(numberOfTracks, sizeof(BOOL));
+	void (^performForTracks)(size_t) = ^(size_t worker) {
+		for (size_t i = atomic_fetch_add(nextTrackIndexPointer, 1); i < numberOfTracks; i = atomic_fetch_add(nextTrackIndexPointer, 1)) {
+			failedTracks[i] = !block(i);
+		}
+	};
+	if (numberOfWorkers > 1) {
+		dispatch_apply(numberOfWorkers, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), performForTracks);
+	} else {
+		performForTracks(0);
+	}
+
+	NSUInteger failedTrackIndex = NSNotFound;
+	for (NSUInteger i = 0; i < numberOfTracks && failedTrackIndex == NSNotFound; i++) {
+		if (failedTracks[i]) failedTrackIndex = i;
+	}
+	free(failedTracks);
+	return failedTrackIndex;
+}
+
+// Adds a track's events to eventStore. Tempo track events are set aside, or skipped if setAsideEvents is nil.
+- (BOOL)decodeTrackAtIndex:(NSUInteger)trackIndex intoEventStore:(MIKMIDIEventStore *)eventStore setAsideEvents:(NSMutableData *)setAsideEvents
+{
+	return [self enumerateEventsInTrackAtIndex:trackIndex usingBlock:^(MusicTimeStamp timeStamp, MusicEventType eventType, const void *data, UInt32 dataSize, BOOL *stop) {
+		if (!MIKMIDIFileParserIsTempoTrackEvent(eventType, data)) {
+			[eventStore addEventWithTimeStamp:timeStamp musicEventType:eventType data:data length:dataSize];
+		} else if (setAsideEvents) {
+			MIKMIDIFileParserSetAsideEvent(setAsideEvents, timeStamp, eventType, NULL, 0, data, dataSize);
+		}
+	} error:NULL];
+}
+
+// Decodes the events of a track from startTimeStamp up to, but not including, endTimeStamp, and calls block for each.
+// If seekIndex isn't nil, decoding starts at its last entry at or before startTimeStamp, rather than at the track's start.
+- (BOOL)enumerateEventsInTrackAtIndex:(NSUInteger)trackIndex fromTimeStamp:(MusicTimeStamp)startTimeStamp toTimeStamp:(MusicTimeStamp)endTimeStamp seekIndex:(NSData *)seekIndex usingBlock:(void (^)(MusicTimeStamp, MusicEventType, const void *, UInt32, BOOL *))block
+{
+	NSRange range = [self rangeOfTrackAtIndex:trackIndex];
+	double ticksPerQuarterNote = self.ticksPerQuarterNote;
+	UInt64 startTick = MIKMIDIFileParserTickForTimeStamp(startTimeStamp, ticksPerQuarterNote);
+	UInt64 endTick = MIKMIDIFileParserTickForTimeStamp(endTimeStamp, ticksPerQuarterNote);
+	UInt32 pendingNotes[MIKMIDIFileParserNumberOfNoteKeys] = {0};
+	MIKMIDIFileParserTrackPosition position = MIKMIDIFileParserSeekIndexPositionForTick(seekIndex, startTick, pendingNotes);
+	MIKMIDIFileParserTrack track = {0};
+	if (position.position > range.length || !MIKMIDIFileParserDecodeTrack((const UInt8 *)[_data bytes] + range.location, range.length, self.ticksPerQuarterNote, position, pendingNotes, startTick, endTick, &track)) {
+		free(track.events);
+		free(track.data);
+		return NO;
+	}
+
+	BOOL stop = NO;
+	for (NSUInteger i = 0; block && i < track.count && !stop; i++) {
+		const MIKMIDIFileParserEvent *event = &track.events[i];
+		block(event->tick / ticksPerQuarterNote, event->eventType, track.data + event->dataOffset, event->dataSize, &stop);
+	}
+
+	free(track.events);
+	free(track.data);
+	return YES;
+}
+
+- (BOOL)scanTrackAtIndex:(NSUInteger)trackIndex intoSummary:(MIKMIDIFileTrackSummary *)summary setAsideEvents:(NSMutableData *)setAsideEvents keySignatureEvents:(NSMutableData *)keySignatureEvents seekIndex:(NSMutableData *)seekIndex ticksPerSeekIndexEntry:(UInt64)ticksPerSeekIndexEntry
+{
+	NSRange range = [self rangeOfTrackAtIndex:trackIndex];
+	const UInt8 *bytes = (const UInt8 *)[_data bytes] + range.location;
+	MIKMIDIFileParserTrackScan scan;
+	if (!MIKMIDIFileParserScanTrack(bytes, range.length, self.ticksPerQuarterNote, &scan, setAsideEvents, keySignatureEvents, seekIndex, ticksPerSeekIndexEntry)) return NO;
+
+	summary.trackIndex = trackIndex;
+	summary.name = MIKMIDIFileParserStringWithRange(bytes, scan.nameRange);
+	summary.instrumentName = MIKMIDIFileParserStringWithRange(bytes, scan.instrumentNameRange);
+	UInt64 channels = scan.channels;
+	summary.channels = MIKMIDIFileParserIndexSetWithBits(&channels, 16);
+	summary.programs = MIKMIDIFileParserIndexSetWithBits(scan.programs, 128);
+	summary.numberOfEvents = scan.numberOfEvents;
+	summary.numberOfNotes = scan.numberOfNotes;
+	summary.lowestNote = scan.lowestNote;
+	summary.highestNote = scan.highestNote;
+	summary.length = (double)scan.endTick / self.ticksPerQuarterNote;
+	return YES;
+}
+
+// Tempo track events are added in track order, as they would be by reading the tracks one after another
+- (MIKMIDIEventStore *)eventStoreWithSetAsideEvents:(NSArray *)setAsideEvents
+{
+	MIKMIDIEventStore *eventStore = [[MIKMIDIEventStore alloc] init];
+	for (NSData *trackSetAsideEvents in setAsideEvents) {
+		MIKMIDIFileParserAddSetAsideEvents(trackSetAsideEvents, eventStore);
+	}
+	return eventStore;
+}
+
+#pragma mark - Properties
+
+- (NSUInteger)numberOfTracks
+{
+	return [_trackRanges length] / sizeof(NSRange);
+}
+
+- (NSRange)rangeOfTrackAtIndex:(NSUInteger)trackIndex
+{
+	return ((const NSRange *)[_trackRanges bytes])[trackIndex];
+}
+
+@end
+
+#pragma mark -
+
+@implementation MIKMIDIFileTrackSummary
+
+- (NSString *)description
+{
+	return [NSString stringWithFormat:@"%@ track %lu, name: %@, %lu events, %lu notes, length: %g", [super description], (unsigned long)self.trackIndex, self.name, (unsigned long)self.numberOfEvents, (unsigned long)self.numberOfNotes, self.length];
+}
+
+@end
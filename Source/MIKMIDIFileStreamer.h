@@ -0,0 +1,93 @@
+//
+//  MIKMIDIFileStreamer.h
+//  MIKMIDI
+//
+//  Created by Mixed In Key on 10/18/26.
+//  Copyright (c) 2026 Mixed In Key. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import <AudioToolbox/AudioToolbox.h>
+#import "MIKMIDICompilerCompatibility.h"
+
+@class MIKMIDISequence;
+@class MIKMIDISequencer;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  MIKMIDIFileStreamer plays MIDI files that are too large to load into memory all at once, by only keeping
+ *  the events around the playback position decoded.
+ *
+ *  The file is memory-mapped and scanned once when the streamer is created. The scan reads the file's tempo
+ *  track in full, and records where in each track the events of each window of windowLength beats start, so any
+ *  window can be decoded later without reading more than a window of events before it. The streamer's sequence has a track for each of
+ *  the file's tracks, but each track only holds the events of the window containing the playback position and
+ *  of the window that will be played after it.
+ *
+ *  Assign the sequence to an MIKMIDISequencer and set the streamer's sequencer property. While the sequencer
+ *  plays, the streamer follows its position on a background queue, decoding the next window ahead of time
+ *  (or the window at the loop start, when the sequencer is about to loop), and dropping windows that have been
+ *  played. To start playback somewhere other than the start of the file, call -moveWindowToTimeStamp:error:
+ *  with the starting position first.
+ *
+ *  Notes are decoded with the window they start in, so notes that start before the first window and are
+ *  still sounding aren't chased when playback starts in the middle of the file. The window must last longer
+ *  than the sequencer's maximumLookAheadInterval at the file's fastest tempo.
+ */
+@interface MIKMIDIFileStreamer : NSObject
+
+/**
+ *  Creates and initializes a streamer for a MIDI file, with a window length of 16 beats.
+ *
+ *  @param fileURL The URL of a standard MIDI file.
+ *  @param error If an error occurs, upon return contains an NSError object that describes the problem. If you are not interested in possible errors, you may pass in NULL.
+ *
+ *  @return A new MIKMIDIFileStreamer, or nil if the file couldn't be read.
+ */
++ (nullable instancetype)streamerWithFileAtURL:(NSURL *)fileURL error:(NSError **)error;
+
+/**
+ *  Initializes a streamer for a MIDI file. The first windows of the file are decoded before this method returns.
+ *
+ *  @param fileURL The URL of a standard MIDI file.
+ *  @param windowLength The length of the parts the file's tracks are decoded in, in beats. Must be greater than 0.
+ *  @param error If an error occurs, upon return contains an NSError object that describes the problem. If you are not interested in possible errors, you may pass in NULL.
+ *
+ *  @return An initialized MIKMIDIFileStreamer, or nil if the file couldn't be read.
+ */
+- (nullable instancetype)initWithFileAtURL:(NSURL *)fileURL windowLength:(MusicTimeStamp)windowLength error:(NSError **)error NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ *  Decodes the windows around a time stamp, and replaces the events of the sequence's tracks with them.
+ *  Returns once the events are in place.
+ *
+ *  @param timeStamp The time stamp to decode the events around, in beats.
+ *  @param error If an error occurs, upon return contains an NSError object that describes the problem. If you are not interested in possible errors, you may pass in NULL.
+ *
+ *  @return YES if the events were decoded, NO if an error occurred.
+ */
+- (BOOL)moveWindowToTimeStamp:(MusicTimeStamp)timeStamp error:(NSError **)error;
+
+/**
+ *  The sequence holding the decoded events. Its tempo track contains all of the file's tempo and time signature
+ *  events, and its length is the length of the file, whichever events are decoded.
+ */
+@property (nonatomic, strong, readonly) MIKMIDISequence *sequence;
+
+/**
+ *  The length of the parts the file's tracks are decoded in, in beats.
+ */
+@property (nonatomic, readonly) MusicTimeStamp windowLength;
+
+/**
+ *  The sequencer playing the streamer's sequence. While it plays, the streamer keeps the events around its
+ *  current position decoded.
+ */
+@property (nonatomic, weak, nullable) MIKMIDISequencer *sequencer;
+
+@end
+
+NS_ASSUME_NONNULL_END
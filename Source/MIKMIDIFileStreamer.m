@@ -0,0 +1,210 @@
+//
+//  MIKMIDIFileStreamer.m
+//  MIKMIDI
+//
+//  Created by Mixed In Key on 10/18/26.
+//  Copyright (c) 2026 Mixed In Key. All rights reserved.
+//
+
+#import "MIKMIDIFileStreamer.h"
+#import "MIKMIDIFileParser+MIKMIDIPrivate.h"
+#import "MIKMIDISequence+MIKMIDIPrivate.h"
+#import "MIKMIDISequencer.h"
+#import "MIKMIDITrack_Protected.h"
+#import "MIKMIDIEventStore.h"
+#import "MIKMIDIErrors.h"
+
+#if !__has_feature(objc_arc)
+#error MIKMIDIFileStreamer.m must be compiled with ARC. Either turn on ARC for the project or set the -fobjc-arc flag for MIKMIDIFileStreamer.m in the Build Phases for this target
+#endif
+
+#define MIKMIDIFileStreamerDefaultWindowLength	16
+#define MIKMIDIFileStreamerFollowingInterval	0.1
+
+@interface MIKMIDIFileStreamer ()
+
+@property (nonatomic, strong) MIKMIDIFileParser *parser;
+@property (nonatomic, copy) NSArray *summaries;
+@property (nonatomic, copy) NSArray *seekIndexes;
+@property (nonatomic, strong) MIKMIDISequence *sequence;
+@property (nonatomic) dispatch_queue_t decodingQueue;
+@property (nonatomic) dispatch_source_t followingTimer;
+
+// Only used on decodingQueue
+@property (nonatomic, strong) NSMutableDictionary *eventStoresByWindowIndex; // An array of event stores, one for each track
+@property (nonatomic) NSUInteger windowIndex;
+@property (nonatomic) NSUInteger nextWindowIndex;
+
+@end
+
+@implementation MIKMIDIFileStreamer
+
+#pragma mark - Lifecycle
+
++ (instancetype)streamerWithFileAtURL:(NSURL *)fileURL error:(NSError **)error
+{
+	return [[self alloc] initWithFileAtURL:fileURL windowLength:MIKMIDIFileStreamerDefaultWindowLength error:error];
+}
+
+- (instancetype)initWithFileAtURL:(NSURL *)fileURL windowLength:(MusicTimeStamp)windowLength error:(NSError **)error
+{
+	error = error ?: &(NSError *__autoreleasing){ nil };
+	if (!(windowLength > 0)) {
+		*error = [NSError MIKMIDIErrorWithCode:MIKMIDIInvalidArgumentError userInfo:nil];
+		return nil;
+	}
+
+	self = [super init];
+	if (self) {
+		_windowLength = windowLength;
+		_parser = [MIKMIDIFileParser parserWithFileAtURL:fileURL error:error];
+		if (!_parser) return nil;
+
+		MIKMIDIEventStore *tempoTrackEventStore = nil;
+		NSArray *seekIndexes = nil;
+		_summaries = [_parser summariesOfTracksWithTempoTrackEventStore:&tempoTrackEventStore seekIndexes:&seekIndexes seekIndexInterval:windowLength error:error];
+		if (!_summaries) return nil;
+		_seekIndexes = seekIndexes;
+
+		_sequence = [[MIKMIDISequence alloc] initWithNumberOfTracks:[_summaries count] tempoTrackEventStore:tempoTrackEventStore timeResolution:(SInt16)_parser.ticksPerQuarterNote error:error];
+		if (!_sequence) return nil;
+		_sequence.synchronizesMusicSequenceLazily = YES; // The tracks' events change too often to keep their MusicTracks up to date
+		_sequence.length = [[_summaries valueForKeyPath:@"@max.length"] doubleValue];
+
+		_decodingQueue = dispatch_queue_create("com.mixedinkey.MIKMIDI.MIKMIDIFileStreamer.decodingQueue", DISPATCH_QUEUE_SERIAL);
+		_eventStoresByWindowIndex = [NSMutableDictionary dictionary];
+		_windowIndex = _nextWindowIndex = NSNotFound;
+		if (![self moveWindowToTimeStamp:0 error:error]) return nil;
+	}
+	return self;
+}
+
+- (instancetype)init
+{
+	[NSException raise:NSInternalInconsistencyException format:@"Use -initWithFileAtURL:windowLength:error: to create %@ instances.", NSStringFromClass([self class])];
+	return nil;
+}
+
+- (void)dealloc
+{
+	self.followingTimer = nil;
+}
+
+#pragma mark - Public
+
+- (BOOL)moveWindowToTimeStamp:(MusicTimeStamp)timeStamp error:(NSError **)error
+{
+	__block BOOL success = NO;
+	__block NSError *decodingError = nil;
+	dispatch_sync(self.decodingQueue, ^{
+		NSUInteger windowIndex = [self windowIndexForTimeStamp:timeStamp];
+		success = [self moveWindowToIndex:windowIndex nextWindowIndex:windowIndex + 1 error:&decodingError];
+	});
+	if (!success && error) *error = decodingError;
+	return success;
+}
+
+#pragma mark - Private
+
+- (NSUInteger)windowIndexForTimeStamp:(MusicTimeStamp)timeStamp
+{
+	return (NSUInteger)floor(MAX(timeStamp, 0) / self.windowLength);
+}
+
+// Called on the decoding queue by the following timer while the sequencer plays
+- (void)followSequencer
+{
+	MIKMIDISequencer *sequencer = self.sequencer;
+	if (!sequencer.isPlaying || sequencer.sequence != self.sequence) return;
+
+	NSUInteger windowIndex = [self windowIndexForTimeStamp:sequencer.currentTimeStamp];
+	NSUInteger nextWindowIndex = windowIndex + 1;
+	MusicTimeStamp loopStartTimeStamp = sequencer.loopStartTimeStamp;
+	MusicTimeStamp loopEndTimeStamp = sequencer.effectiveLoopEndTimeStamp;
+	if (sequencer.shouldLoop && loopEndTimeStamp > loopStartTimeStamp && nextWindowIndex * self.windowLength >= loopEndTimeStamp) {
+		nextWindowIndex = [self windowIndexForTimeStamp:loopStartTimeStamp];
+	}
+
+	NSError *error = nil;
+	if (![self moveWindowToIndex:windowIndex nextWindowIndex:nextWindowIndex error:&error]) {
+		NSLog(@"%@ failed to decode the events around time stamp %f with error %@.", self, sequencer.currentTimeStamp, error);
+	}
+}
+
+- (BOOL)moveWindowToIndex:(NSUInteger)windowIndex nextWindowIndex:(NSUInteger)nextWindowIndex error:(NSError **)error
+{
+	if (windowIndex == self.windowIndex && nextWindowIndex == self.nextWindowIndex) return YES;
+
+	NSMutableArray *windowIndexes = [NSMutableArray arrayWithObject:@(windowIndex)];
+	if (nextWindowIndex != windowIndex) [windowIndexes addObject:@(nextWindowIndex)];
+	NSMutableArray *windows = [NSMutableArray arrayWithCapacity:[windowIndexes count]];
+	for (NSNumber *index in windowIndexes) {
+		NSArray *eventStores = self.eventStoresByWindowIndex[index] ?: [self eventStoresForWindowAtIndex:[index unsignedIntegerValue] error:error];
+		if (!eventStores) return NO;
+		[windows addObject:eventStores];
+	}
+
+	// Windows that have been played are dropped, so only the windows being played are kept in memory
+	[self.eventStoresByWindowIndex removeAllObjects];
+	[windowIndexes enumerateObjectsUsingBlock:^(NSNumber *index, NSUInteger idx, BOOL *stop) {
+		self.eventStoresByWindowIndex[index] = windows[idx];
+	}];
+	self.windowIndex = windowIndex;
+	self.nextWindowIndex = nextWindowIndex;
+
+	NSMutableArray *offsets = [NSMutableArray arrayWithCapacity:[windows count]];
+	for (NSUInteger i = 0; i < [windows count]; i++) [offsets addObject:@0];
+	[self.sequence.tracks enumerateObjectsUsingBlock:^(MIKMIDITrack *track, NSUInteger trackIndex, BOOL *stop) {
+		NSMutableArray *trackEventStores = [NSMutableArray arrayWithCapacity:[windows count]];
+		for (NSArray *window in windows) [trackEventStores addObject:window[trackIndex]];
+		[track replaceEventsWithEventStore:[MIKMIDIEventStore eventStoreByMergingEventStores:trackEventStores offsets:offsets]];
+	}];
+	return YES;
+}
+
+// Decodes the events of every track from windowIndex * windowLength up to the start of the next window
+- (NSArray *)eventStoresForWindowAtIndex:(NSUInteger)windowIndex error:(NSError **)error
+{
+	MusicTimeStamp endTimeStamp = (windowIndex + 1) * self.windowLength;
+	NSMutableArray *eventStores = [NSMutableArray arrayWithCapacity:[self.summaries count]];
+	for (NSUInteger i = 0; i < [self.summaries count]; i++) {
+		MIKMIDIFileTrackSummary *summary = self.summaries[i];
+		MIKMIDIEventStore *eventStore = [self.parser eventStoreForTrackAtIndex:summary.trackIndex fromTimeStamp:windowIndex * self.windowLength toTimeStamp:endTimeStamp seekIndex:self.seekIndexes[i] error:error];
+		if (!eventStore) return nil;
+		[eventStores addObject:eventStore];
+	}
+	return eventStores;
+}
+
+#pragma mark - Properties
+
+- (void)setSequencer:(MIKMIDISequencer *)sequencer
+{
+	_sequencer = sequencer;
+	if (!sequencer) {
+		self.followingTimer = nil;
+		return;
+	}
+	if (self.followingTimer) return;
+
+	dispatch_source_t timer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, self.decodingQueue);
+	if (!timer) return (void)NSLog(@"Unable to create following timer for %@.", [self class]);
+	uint64_t interval = MIKMIDIFileStreamerFollowingInterval * NSEC_PER_SEC;
+	dispatch_source_set_timer(timer, DISPATCH_TIME_NOW, interval, interval / 10);
+	__weak typeof(self) weakSelf = self;
+	dispatch_source_set_event_handler(timer, ^{
+		[weakSelf followSequencer];
+	});
+	dispatch_resume(timer);
+	self.followingTimer = timer;
+}
+
+- (void)setFollowingTimer:(dispatch_source_t)followingTimer
+{
+	if (followingTimer != _followingTimer) {
+		if (_followingTimer) dispatch_source_cancel(_followingTimer);
+		_followingTimer = followingTimer;
+	}
+}
+
+@end
@@ -0,0 +1,117 @@
+//
+//  MIKMIDIFileWriter.h
+//  MIKMIDI
+//
+//  Created by Mixed In Key on 10/18/26.
+//  Copyright (c) 2026 Mixed In Key. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import <AudioToolbox/AudioToolbox.h>
+#import "MIKMIDIFileParser.h"
+#import "MIKMIDICompilerCompatibility.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  MIKMIDIFileWriter writes Standard MIDI Files without using AudioToolbox's MusicSequenceFileCreateData().
+ *  MIKMIDISequence uses it for -writeToURL:error: and -dataValue.
+ *
+ *  Tracks are written one at a time, by calling -beginTrackWithError:, then -writeEventWithTimeStamp:eventType:data:dataSize:error:
+ *  for each event in order, then -endTrackWithError:. -finishWithError: must be called once all tracks have been written.
+ *  Output is buffered and written as it goes, and each chunk's length is filled in once the chunk is complete,
+ *  so memory use doesn't depend on the size of the file.
+ *
+ *  Events are passed the way a MusicTrack stores them, which is also the way MIKMIDIFileParser reports them,
+ *  so events read by a parser can be written straight back out. Notes are split into a note on and a note off, with
+ *  note offs written as note ons with a velocity of 0 unless the note has a release velocity. Running status is used
+ *  wherever possible, and every time and length is written as the shortest possible variable-length quantity.
+ *  ExtendedTempoEvents are written as tempo meta events. Other kinds of event, like user events, can't be
+ *  represented in a MIDI file, and are skipped.
+ */
+@interface MIKMIDIFileWriter : NSObject
+
+/**
+ *  Initializes a writer that writes to an open file descriptor, starting at its current offset.
+ *
+ *  @param fileDescriptor The file descriptor to write to. It must be seekable, so that chunk lengths can be filled in.
+ *  The writer doesn't close it.
+ *  @param format The format of the file. This only affects the file's header.
+ *  @param ticksPerQuarterNote The time resolution of the file. Time stamps are rounded to the nearest tick.
+ *  @param error If an error occurs, upon return contains an NSError object that describes the problem. If you are not interested in possible errors, you may pass in NULL.
+ *
+ *  @return An initialized MIKMIDIFileWriter, or nil if the file descriptor can't be written to.
+ */
+- (nullable instancetype)initWithFileDescriptor:(int)fileDescriptor format:(MIKMIDIFileFormat)format ticksPerQuarterNote:(UInt16)ticksPerQuarterNote error:(NSError **)error;
+
+/**
+ *  Initializes a writer that appends the file to a mutable data.
+ *
+ *  @param data The data to append the file to.
+ *  @param format The format of the file. This only affects the file's header.
+ *  @param ticksPerQuarterNote The time resolution of the file. Time stamps are rounded to the nearest tick.
+ *
+ *  @return An initialized MIKMIDIFileWriter.
+ */
+- (instancetype)initWithMutableData:(NSMutableData *)data format:(MIKMIDIFileFormat)format ticksPerQuarterNote:(UInt16)ticksPerQuarterNote;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ *  Starts a new track (MTrk) chunk.
+ *
+ *  @param error If an error occurs, upon return contains an NSError object that describes the problem. If you are not interested in possible errors, you may pass in NULL.
+ *
+ *  @return YES if the track was started, NO if a track is already being written or the writer has failed or finished.
+ */
+- (BOOL)beginTrackWithError:(NSError **)error;
+
+/**
+ *  Writes an event to the current track.
+ *
+ *  @param timeStamp The time stamp of the event, in beats. Must not be earlier than the previous event's time stamp.
+ *  @param eventType The type of the event.
+ *  @param data The event's data, e.g. a MIDINoteMessage or MIDIMetaEvent.
+ *  @param dataSize The length of data.
+ *  @param error If an error occurs, upon return contains an NSError object that describes the problem. If you are not interested in possible errors, you may pass in NULL.
+ *
+ *  @return YES if the event was written or skipped, NO if an error occurred.
+ */
+- (BOOL)writeEventWithTimeStamp:(MusicTimeStamp)timeStamp eventType:(MusicEventType)eventType data:(const void *)data dataSize:(UInt32)dataSize error:(NSError **)error;
+
+/**
+ *  Writes the note offs of any notes still sounding, and ends the current track.
+ *
+ *  @param error If an error occurs, upon return contains an NSError object that describes the problem. If you are not interested in possible errors, you may pass in NULL.
+ *
+ *  @return YES if the track was ended, NO if an error occurred.
+ */
+- (BOOL)endTrackWithError:(NSError **)error;
+
+/**
+ *  Fills in the number of tracks in the file's header, and writes any buffered output.
+ *
+ *  @param error If an error occurs, upon return contains an NSError object that describes the problem. If you are not interested in possible errors, you may pass in NULL.
+ *
+ *  @return YES if the file was completed, NO if an error occurred.
+ */
+- (BOOL)finishWithError:(NSError **)error;
+
+/**
+ *  The format of the file being written.
+ */
+@property (nonatomic, readonly) MIKMIDIFileFormat format;
+
+/**
+ *  The time resolution of the file being written.
+ */
+@property (nonatomic, readonly) UInt16 ticksPerQuarterNote;
+
+/**
+ *  The number of tracks written so far.
+ */
+@property (nonatomic, readonly) NSUInteger numberOfTracks;
+
+@end
+
+NS_ASSUME_NONNULL_END
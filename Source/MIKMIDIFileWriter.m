@@ -0,0 +1,479 @@
+//
+//  MIKMIDIFileWriter.m
+//  MIKMIDI
+//
+//  Created by Mixed In Key on 10/18/26.
+//  Copyright (c) 2026 Mixed In Key. All rights reserved.
+//
+
+#import "MIKMIDIFileWriter.h"
+#import "MIKMIDIMetaEvent.h"
+#import "MIKMIDIErrors.h"
+#include <unistd.h>
+
+#if !__has_feature(objc_arc)
+#error MIKMIDIFileWriter.m must be compiled with ARC. Either turn on ARC for the project or set the -fobjc-arc flag for MIKMIDIFileWriter.m in the Build Phases for this target
+#endif
+
+#define MIKMIDIFileWriterBufferSize	(64 * 1024)
+#define MIKMIDIFileWriterMaximumVariableLengthQuantity	0x0FFFFFFF
+
+// A note off waiting to be written, once every event before it has been
+typedef struct {
+	UInt64 tick;
+	UInt64 order; // Note offs at the same tick are written in the order their note ons were
+	UInt8 status;
+	UInt8 note;
+	UInt8 velocity;
+} MIKMIDIFileWriterNoteOff;
+
+#pragma mark - Encoding
+
+static void MIKMIDIFileWriterWriteUInt16(UInt8 *bytes, UInt16 value)
+{
+	bytes[0] = (UInt8)(value >> 8);
+	bytes[1] = (UInt8)value;
+}
+
+static void MIKMIDIFileWriterWriteUInt32(UInt8 *bytes, UInt32 value)
+{
+	bytes[0] = (UInt8)(value >> 24);
+	bytes[1] = (UInt8)(value >> 16);
+	bytes[2] = (UInt8)(value >> 8);
+	bytes[3] = (UInt8)value;
+}
+
+// Writes value as a variable-length quantity of as few bytes as possible, and returns the number of bytes written (at most 4)
+static NSUInteger MIKMIDIFileWriterWriteVariableLengthQuantity(UInt8 *bytes, UInt32 value)
+{
+	NSUInteger length = 1;
+	for (UInt32 remaining = value >> 7; remaining; remaining >>= 7) length++;
+	for (NSUInteger i = 0; i < length; i++) {
+		UInt8 byte = (UInt8)((value >> (7 * (length - 1 - i))) & 0x7F);
+		bytes[i] = (i < length - 1) ? (byte | 0x80) : byte;
+	}
+	return length;
+}
+
+#pragma mark - Pending Note Offs
+
+static BOOL MIKMIDIFileWriterNoteOffPrecedes(const MIKMIDIFileWriterNoteOff *noteOff, const MIKMIDIFileWriterNoteOff *otherNoteOff)
+{
+	return noteOff->tick < otherNoteOff->tick || (noteOff->tick == otherNoteOff->tick && noteOff->order < otherNoteOff->order);
+}
+
+// Pending note offs are kept in a binary min-heap, so the next one to write is always first
+static void MIKMIDIFileWriterNoteOffHeapPush(MIKMIDIFileWriterNoteOff *heap, NSUInteger count, MIKMIDIFileWriterNoteOff noteOff)
+{
+	NSUInteger index = count;
+	while (index > 0) {
+		NSUInteger parent = (index - 1) / 2;
+		if (!MIKMIDIFileWriterNoteOffPrecedes(&noteOff, &heap[parent])) break;
+		heap[index] = heap[parent];
+		index = parent;
+	}
+	heap[index] = noteOff;
+}
+
+static MIKMIDIFileWriterNoteOff MIKMIDIFileWriterNoteOffHeapPop(MIKMIDIFileWriterNoteOff *heap, NSUInteger count)
+{
+	MIKMIDIFileWriterNoteOff first = heap[0];
+	MIKMIDIFileWriterNoteOff last = heap[--count];
+	NSUInteger index = 0;
+	while (YES) {
+		NSUInteger child = index * 2 + 1;
+		if (child >= count) break;
+		if (child + 1 < count && MIKMIDIFileWriterNoteOffPrecedes(&heap[child + 1], &heap[child])) child++;
+		if (!MIKMIDIFileWriterNoteOffPrecedes(&heap[child], &last)) break;
+		heap[index] = heap[child];
+		index = child;
+	}
+	if (count) heap[index] = last;
+	return first;
+}
+
+#pragma mark -
+
+@implementation MIKMIDIFileWriter
+{
+	int _fileDescriptor;
+	off_t _fileStartOffset;
+	NSMutableData *_data;
+	NSUInteger _dataStartLength;
+
+	UInt8 *_buffer;
+	NSUInteger _bufferLength;
+	UInt64 _flushedLength; // Output written out of the buffer so far
+	NSError *_error; // Once writing fails, every later call fails with the same error
+	BOOL _isFinished;
+
+	BOOL _isWritingTrack;
+	UInt64 _trackLengthOffset; // Output offset of the current chunk's length
+	UInt64 _tick; // Of the last event written
+	UInt8 _runningStatus;
+
+	MIKMIDIFileWriterNoteOff *_noteOffs;
+	NSUInteger _numberOfNoteOffs;
+	NSUInteger _noteOffCapacity;
+	UInt64 _numberOfNotes;
+}
+
+#pragma mark - Lifecycle
+
+- (instancetype)initWithFileDescriptor:(int)fileDescriptor format:(MIKMIDIFileFormat)format ticksPerQuarterNote:(UInt16)ticksPerQuarterNote error:(NSError **)error
+{
+	error = error ?: &(NSError *__autoreleasing){ nil };
+
+	off_t offset = lseek(fileDescriptor, 0, SEEK_CUR);
+	if (offset < 0) {
+		*error = [NSError errorWithDomain:NSPOSIXErrorDomain code:errno userInfo:nil];
+		return nil;
+	}
+
+	self = [self initWithFormat:format ticksPerQuarterNote:ticksPerQuarterNote];
+	if (self) {
+		_fileDescriptor = fileDescriptor;
+		_fileStartOffset = offset;
+		[self writeHeader];
+	}
+	return self;
+}
+
+- (instancetype)initWithMutableData:(NSMutableData *)data format:(MIKMIDIFileFormat)format ticksPerQuarterNote:(UInt16)ticksPerQuarterNote
+{
+	self = [self initWithFormat:format ticksPerQuarterNote:ticksPerQuarterNote];
+	if (self) {
+		_fileDescriptor = -1;
+		_data = data;
+		_dataStartLength = [data length];
+		[self writeHeader];
+	}
+	return self;
+}
+
+- (instancetype)initWithFormat:(MIKMIDIFileFormat)format ticksPerQuarterNote:(UInt16)ticksPerQuarterNote
+{
+	self = [super init];
+	if (self) {
+		_format = format;
+		_ticksPerQuarterNote = ticksPerQuarterNote ?: 480;
+		_buffer = malloc(MIKMIDIFileWriterBufferSize);
+	}
+	return self;
+}
+
+- (instancetype)init
+{
+	[NSException raise:NSInternalInconsistencyException format:@"Use -initWithFileDescriptor:format:ticksPerQuarterNote:error: or -initWithMutableData:format:ticksPerQuarterNote: to create %@ instances.", NSStringFromClass([self class])];
+	return nil;
+}
+
+- (void)dealloc
+{
+	free(_buffer);
+	free(_noteOffs);
+}
+
+#pragma mark - Output
+
+- (UInt64)outputLength
+{
+	return _flushedLength + _bufferLength;
+}
+
+- (void)writeOutBytes:(const UInt8 *)bytes length:(NSUInteger)length
+{
+	if (_error) return;
+
+	if (_data) {
+		[_data appendBytes:bytes length:length];
+		_flushedLength += length;
+		return;
+	}
+
+	NSUInteger written = 0;
+	while (written < length) {
+		ssize_t result = write(_fileDescriptor, bytes + written, length - written);
+		if (result < 0) {
+			if (errno == EINTR) continue;
+			_error = [NSError errorWithDomain:NSPOSIXErrorDomain code:errno userInfo:nil];
+			return;
+		}
+		written += (NSUInteger)result;
+	}
+	_flushedLength += length;
+}
+
+- (void)flushBuffer
+{
+	if (!_bufferLength) return;
+	[self writeOutBytes:_buffer length:_bufferLength];
+	_bufferLength = 0;
+}
+
+- (void)appendBytes:(const void *)bytes length:(NSUInteger)length
+{
+	if (_bufferLength + length > MIKMIDIFileWriterBufferSize) [self flushBuffer];
+	if (length > MIKMIDIFileWriterBufferSize) {
+		// Large system exclusive messages skip the buffer
+		[self writeOutBytes:bytes length:length];
+		return;
+	}
+	memcpy(_buffer + _bufferLength, bytes, length);
+	_bufferLength += length;
+}
+
+// Overwrites output that has already been appended, e.g. to fill in a chunk's length
+- (void)replaceBytesAtOutputOffset:(UInt64)offset withBytes:(const void *)bytes length:(NSUInteger)length
+{
+	if (offset < _flushedLength) [self flushBuffer];
+	if (_error) return;
+
+	if (offset >= _flushedLength) {
+		memcpy(_buffer + (offset - _flushedLength), bytes, length);
+	} else if (_data) {
+		[_data replaceBytesInRange:NSMakeRange(_dataStartLength + (NSUInteger)offset, length) withBytes:bytes];
+	} else {
+		ssize_t result;
+		do {
+			result = pwrite(_fileDescriptor, bytes, length, _fileStartOffset + (off_t)offset);
+		} while (result < 0 && errno == EINTR);
+		if (result != (ssize_t)length) {
+			_error = [NSError errorWithDomain:NSPOSIXErrorDomain code:(result < 0 ? errno : EIO) userInfo:nil];
+		}
+	}
+}
+
+- (void)writeHeader
+{
+	// The number of tracks is filled in by -finishWithError:
+	UInt8 header[14] = { 'M', 'T', 'h', 'd', 0, 0, 0, 6 };
+	MIKMIDIFileWriterWriteUInt16(header + 8, self.format);
+	MIKMIDIFileWriterWriteUInt16(header + 10, 0);
+	MIKMIDIFileWriterWriteUInt16(header + 12, self.ticksPerQuarterNote);
+	[self appendBytes:header length:sizeof(header)];
+}
+
+#pragma mark - Writing Events
+
+- (BOOL)failWithError:(NSError **)error
+{
+	if (error) *error = _error;
+	return NO;
+}
+
+- (BOOL)checkCanWriteWithError:(NSError **)error
+{
+	if (_error) return [self failWithError:error];
+	if (_isFinished) {
+		if (error) *error = [NSError MIKMIDIErrorWithCode:MIKMIDIInvalidArgumentError userInfo:nil];
+		return NO;
+	}
+	return YES;
+}
+
+- (BOOL)beginTrackWithError:(NSError **)error
+{
+	if (![self checkCanWriteWithError:error]) return NO;
+	if (_isWritingTrack) {
+		if (error) *error = [NSError MIKMIDIErrorWithCode:MIKMIDIInvalidArgumentError userInfo:nil];
+		return NO;
+	}
+
+	// The chunk's length is filled in by -endTrackWithError:
+	UInt8 chunkHeader[8] = { 'M', 'T', 'r', 'k', 0, 0, 0, 0 };
+	_trackLengthOffset = [self outputLength] + 4;
+	[self appendBytes:chunkHeader length:sizeof(chunkHeader)];
+
+	_isWritingTrack = YES;
+	_tick = 0;
+	_runningStatus = 0;
+	_numberOfNotes = 0;
+	return YES;
+}
+
+// Appends the delta time to tick, followed by the first few bytes of the event
+- (BOOL)appendEventAtTick:(UInt64)tick bytes:(const UInt8 *)eventBytes length:(NSUInteger)eventLength
+{
+	UInt64 deltaTime = tick - _tick;
+	if (deltaTime > MIKMIDIFileWriterMaximumVariableLengthQuantity) {
+		_error = [NSError MIKMIDIErrorWithCode:MIKMIDIInvalidArgumentError userInfo:@{NSLocalizedFailureReasonErrorKey : @"The time between two events is too long to be written to a MIDI file."}];
+		return NO;
+	}
+
+	UInt8 bytes[16];
+	NSUInteger length = MIKMIDIFileWriterWriteVariableLengthQuantity(bytes, (UInt32)deltaTime);
+	memcpy(bytes + length, eventBytes, eventLength);
+	[self appendBytes:bytes length:length + eventLength];
+	_tick = tick;
+	return YES;
+}
+
+- (BOOL)appendChannelMessageAtTick:(UInt64)tick status:(UInt8)status data1:(UInt8)data1 data2:(UInt8)data2
+{
+	UInt8 bytes[3];
+	NSUInteger length = 0;
+	if (status != _runningStatus) bytes[length++] = status;
+	bytes[length++] = data1 & 0x7F;
+	if ((status & 0xE0) != 0xC0) bytes[length++] = data2 & 0x7F; // Program change and channel pressure have one data byte
+	if (![self appendEventAtTick:tick bytes:bytes length:length]) return NO;
+	_runningStatus = status;
+	return YES;
+}
+
+// Meta and system exclusive events, which cancel running status
+- (BOOL)appendMessageAtTick:(UInt64)tick prefix:(const UInt8 *)prefix prefixLength:(NSUInteger)prefixLength body:(const void *)body bodyLength:(UInt32)bodyLength
+{
+	if (bodyLength > MIKMIDIFileWriterMaximumVariableLengthQuantity) {
+		_error = [NSError MIKMIDIErrorWithCode:MIKMIDIInvalidArgumentError userInfo:@{NSLocalizedFailureReasonErrorKey : @"An event is too long to be written to a MIDI file."}];
+		return NO;
+	}
+
+	UInt8 header[8];
+	memcpy(header, prefix, prefixLength);
+	NSUInteger headerLength = prefixLength + MIKMIDIFileWriterWriteVariableLengthQuantity(header + prefixLength, bodyLength);
+	if (![self appendEventAtTick:tick bytes:header length:headerLength]) return NO;
+	[self appendBytes:body length:bodyLength];
+	_runningStatus = 0;
+	return YES;
+}
+
+- (BOOL)appendNoteOffsUpToTick:(UInt64)tick
+{
+	while (_numberOfNoteOffs && _noteOffs[0].tick <= tick) {
+		MIKMIDIFileWriterNoteOff noteOff = MIKMIDIFileWriterNoteOffHeapPop(_noteOffs, _numberOfNoteOffs--);
+		if (![self appendChannelMessageAtTick:noteOff.tick status:noteOff.status data1:noteOff.note data2:noteOff.velocity]) return NO;
+	}
+	return YES;
+}
+
+- (void)addNoteOff:(MIKMIDIFileWriterNoteOff)noteOff
+{
+	if (_numberOfNoteOffs == _noteOffCapacity) {
+		_noteOffCapacity = MAX(_noteOffCapacity * 2, 64);
+		_noteOffs = realloc(_noteOffs, _noteOffCapacity * sizeof(MIKMIDIFileWriterNoteOff));
+	}
+	MIKMIDIFileWriterNoteOffHeapPush(_noteOffs, _numberOfNoteOffs++, noteOff);
+}
+
+- (BOOL)writeEventWithTimeStamp:(MusicTimeStamp)timeStamp eventType:(MusicEventType)eventType data:(const void *)data dataSize:(UInt32)dataSize error:(NSError **)error
+{
+	if (![self checkCanWriteWithError:error]) return NO;
+	if (!_isWritingTrack) {
+		if (error) *error = [NSError MIKMIDIErrorWithCode:MIKMIDIInvalidArgumentError userInfo:nil];
+		return NO;
+	}
+
+	UInt64 tick = (UInt64)llround(MAX(timeStamp, 0) * self.ticksPerQuarterNote);
+	if (tick < _tick) {
+		if (error) *error = [NSError MIKMIDIErrorWithCode:MIKMIDIInvalidArgumentError userInfo:@{NSLocalizedFailureReasonErrorKey : @"Events must be written in order."}];
+		return NO;
+	}
+	if (![self appendNoteOffsUpToTick:tick]) return [self failWithError:error];
+
+	BOOL success = YES;
+	switch (eventType) {
+		case kMusicEventType_MIDINoteMessage: {
+			if (dataSize < sizeof(MIDINoteMessage)) break;
+			const MIDINoteMessage *message = data;
+			UInt8 channel = message->channel & 0x0F;
+			success = [self appendChannelMessageAtTick:tick status:(0x90 | channel) data1:message->note data2:message->velocity];
+
+			// Without a release velocity, a note on with velocity 0 allows running status to carry on from the note on
+			UInt64 duration = (UInt64)llround(MAX(message->duration, 0) * self.ticksPerQuarterNote);
+			UInt8 releaseVelocity = message->releaseVelocity & 0x7F;
+			[self addNoteOff:(MIKMIDIFileWriterNoteOff){
+				.tick = tick + duration,
+				.order = _numberOfNotes++,
+				.status = (UInt8)((releaseVelocity ? 0x80 : 0x90) | channel),
+				.note = message->note,
+				.velocity = releaseVelocity,
+			}];
+			break;
+		}
+		case kMusicEventType_MIDIChannelMessage: {
+			if (dataSize < sizeof(MIDIChannelMessage)) break;
+			const MIDIChannelMessage *message = data;
+			if (message->status < 0x80 || message->status >= 0xF0) break;
+			success = [self appendChannelMessageAtTick:tick status:message->status data1:message->data1 data2:message->data2];
+			break;
+		}
+		case kMusicEventType_Meta: {
+			if (dataSize < MIKMIDIEventMetadataStartOffset) break;
+			const MIDIMetaEvent *metaEvent = data;
+			if (metaEvent->metaEventType == MIKMIDIMetaEventTypeEndOfTrack) break; // Written by -endTrackWithError:
+			UInt32 metaLength = MIN(metaEvent->dataLength, dataSize - (UInt32)MIKMIDIEventMetadataStartOffset);
+			UInt8 prefix[2] = { 0xFF, metaEvent->metaEventType };
+			success = [self appendMessageAtTick:tick prefix:prefix prefixLength:sizeof(prefix) body:((const UInt8 *)data + MIKMIDIEventMetadataStartOffset) bodyLength:metaLength];
+			break;
+		}
+		case kMusicEventType_ExtendedTempo: {
+			if (dataSize < sizeof(ExtendedTempoEvent)) break;
+			Float64 bpm = ((const ExtendedTempoEvent *)data)->bpm;
+			if (!(bpm > 0)) break;
+			long long microsecondsPerQuarterNote = MIN(MAX(llround(60000000.0 / bpm), 1), 0xFFFFFF);
+			UInt8 prefix[2] = { 0xFF, MIKMIDIMetaEventTypeTempoSetting };
+			UInt8 tempo[3] = { (UInt8)(microsecondsPerQuarterNote >> 16), (UInt8)(microsecondsPerQuarterNote >> 8), (UInt8)microsecondsPerQuarterNote };
+			success = [self appendMessageAtTick:tick prefix:prefix prefixLength:sizeof(prefix) body:tempo bodyLength:sizeof(tempo)];
+			break;
+		}
+		case kMusicEventType_MIDIRawData: {
+			if (dataSize < offsetof(MIDIRawData, data)) break;
+			const MIDIRawData *rawData = data;
+			UInt32 rawLength = MIN(rawData->length, dataSize - (UInt32)offsetof(MIDIRawData, data));
+			if (rawLength && rawData->data[0] == 0xF0) {
+				UInt8 prefix = 0xF0;
+				success = [self appendMessageAtTick:tick prefix:&prefix prefixLength:1 body:(rawData->data + 1) bodyLength:(rawLength - 1)];
+			} else {
+				// Anything else is written as an escape
+				UInt8 prefix = 0xF7;
+				success = [self appendMessageAtTick:tick prefix:&prefix prefixLength:1 body:rawData->data bodyLength:rawLength];
+			}
+			break;
+		}
+		default:
+			break; // Can't be written to a MIDI file
+	}
+
+	if (!success || _error) return [self failWithError:error];
+	return YES;
+}
+
+- (BOOL)endTrackWithError:(NSError **)error
+{
+	if (![self checkCanWriteWithError:error]) return NO;
+	if (!_isWritingTrack) {
+		if (error) *error = [NSError MIKMIDIErrorWithCode:MIKMIDIInvalidArgumentError userInfo:nil];
+		return NO;
+	}
+
+	if (![self appendNoteOffsUpToTick:UINT64_MAX]) return [self failWithError:error];
+	UInt8 endOfTrack[3] = { 0xFF, MIKMIDIMetaEventTypeEndOfTrack, 0 };
+	if (![self appendEventAtTick:_tick bytes:endOfTrack length:sizeof(endOfTrack)]) return [self failWithError:error];
+
+	UInt8 chunkLength[4];
+	MIKMIDIFileWriterWriteUInt32(chunkLength, (UInt32)([self outputLength] - _trackLengthOffset - 4));
+	[self replaceBytesAtOutputOffset:_trackLengthOffset withBytes:chunkLength length:sizeof(chunkLength)];
+	if (_error) return [self failWithError:error];
+
+	_isWritingTrack = NO;
+	_numberOfTracks++;
+	return YES;
+}
+
+- (BOOL)finishWithError:(NSError **)error
+{
+	if (![self checkCanWriteWithError:error]) return NO;
+	if (_isWritingTrack && ![self endTrackWithError:error]) return NO;
+
+	UInt8 numberOfTracks[2];
+	MIKMIDIFileWriterWriteUInt16(numberOfTracks, (UInt16)MIN(self.numberOfTracks, UINT16_MAX));
+	[self replaceBytesAtOutputOffset:10 withBytes:numberOfTracks length:sizeof(numberOfTracks)];
+	[self flushBuffer];
+	if (_error) return [self failWithError:error];
+
+	_isFinished = YES;
+	return YES;
+}
+
+@end
@@ -9,6 +9,7 @@
 #import "MIKMIDIPort.h"
 #import "MIKMIDISourceEndpoint.h"
 #import "MIKMIDICompilerCompatibility.h"
+#import "MIKMIDITimeSource.h"
 
 @class MIKMIDIEndpoint;
 @class MIKMIDICommand;
@@ -36,9 +37,21 @@ NS_ASSUME_NONNULL_BEGIN
  *
  * This takes care of interruption in the data (devices being turned off or unplugged) as well as
  * ill-behaved devices which don't terminate their sysex messages with 0xF7.
+ *
+ * When a message times out, the commands received so far are delivered on the run loop, and in the
+ * run loop mode, of the thread that received the message's first data.
  */
 @property (assign) NSTimeInterval sysexTimeOut;
 
+/**
+ * The time source used to measure the sysex time-out and the window in which a 14-bit
+ * control change LSB is waited for.
+ *
+ * Defaults to the value of MIKMIDIDefaultTimeSource() at the time the port was created.
+ * Setting this to nil restores that default.
+ */
+@property (nonatomic, strong, null_resettable) id<MIKMIDITimeSource> timeSource;
+
 @end
 
 NS_ASSUME_NONNULL_END
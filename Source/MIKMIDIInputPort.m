@@ -15,6 +15,7 @@
 #import "MIKMIDISystemExclusiveCommand.h"
 #import "MIKMIDIControlChangeCommand.h"
 #import "MIKMIDIUtilities.h"
+#import "MIKMIDIClock.h"
 
 #if !__has_feature(objc_arc)
 #error MIKMIDIInputPort.m must be compiled with ARC. Either turn on ARC for the project or set the -fobjc-arc flag for MIKMIDIInputPort.m in the Build Phases for this target
@@ -39,7 +40,8 @@
 @property (nonatomic) dispatch_queue_t bufferedCommandQueue;
 
 @property (atomic, strong) NSMutableData *sysexData;
-@property (atomic, strong) NSTimer *sysexTimeOutTimer;
+@property (assign) MIDITimeStamp sysexTimeOutTimeStamp; // 0 if no time-out is pending
+@property (assign) NSUInteger sysexGeneration; // incremented every time a sysex message is completed
 @property (assign) MIDITimeStamp sysexStartTimeStamp;
 @property (readonly) BOOL isCoalescingSysex;
 
@@ -73,6 +75,7 @@
 		dispatch_sync(_bufferedCommandQueue, ^{ self.bufferedMSBCommands = [[NSMutableArray alloc] init]; });
 		
 		_sysexTimeOut = 1.0; // seconds
+		_timeSource = MIKMIDIDefaultTimeSource();
 	}
 	return self;
 }
@@ -286,9 +289,9 @@
 	self.sysexData = nil;
 	self.sysexStartTimeStamp = 0;
 	
-	// Clear Sysex Timer
-	[self.sysexTimeOutTimer invalidate];
-	self.sysexTimeOutTimer = nil;
+	// Clear Sysex Time-out
+	self.sysexTimeOutTimeStamp = 0;
+	self.sysexGeneration++;
 	
 	return command;
 }
@@ -348,36 +351,19 @@ void MIKMIDIPortReadCallback(const MIDIPacketList *pktList, void *readProcRefCon
 	
 	// Safeguard against sysex time-out
 	if (self.isCoalescingSysex) {
-		// Create or extend time-out timer
-		if (!self.sysexTimeOutTimer) {
-			// Weakify Self
-			__weak typeof(self) weakSelf = self;
-			
-			self.sysexTimeOutTimer = [NSTimer timerWithTimeInterval:self.sysexTimeOut target:[NSBlockOperation blockOperationWithBlock:^{
-				// Strongify Self
-				__strong typeof(self) self = weakSelf;
-				
-				// Force-End Sysex, if necessary
-				if (self.isCoalescingSysex) {
-					completionBlock(@[[self commandByCoalescingSysexData]]);
-				}
-			}] selector:@selector(main) userInfo:nil repeats:NO];
-			
-			// Run Timer
+		// Create or extend time-out
+		NSTimeInterval sysexTimeOut = self.sysexTimeOut;
+		BOOL needsTimeOutCheck = (self.sysexTimeOutTimeStamp == 0);
+		self.sysexTimeOutTimeStamp = [self.timeSource currentMIDITimeStamp] + MIKMIDIClockMIDITimeStampsPerTimeInterval(sysexTimeOut);
+		if (needsTimeOutCheck) {
+			// The forced end of the message is delivered on this thread's run loop, as it was when an NSTimer ended it
 			NSRunLoop *currentRunLoop = [NSRunLoop currentRunLoop];
 			NSRunLoopMode mode = currentRunLoop.currentMode ?: NSDefaultRunLoopMode;
-			
-			[currentRunLoop addTimer:self.sysexTimeOutTimer forMode:mode];
-		} else {
-			self.sysexTimeOutTimer.fireDate = [NSDate dateWithTimeIntervalSinceNow:self.sysexTimeOut];
+			[self scheduleSysexTimeOutCheckAfterTimeInterval:sysexTimeOut forGeneration:self.sysexGeneration runLoop:currentRunLoop mode:mode handleResultingCommands:completionBlock];
 		}
 		return;
 	}
 	
-	// Clear Sysex Timer
-	[self.sysexTimeOutTimer invalidate];
-	self.sysexTimeOutTimer = nil;
-	
 	// Handle Commands
 	if (receivedCommands.count == 0) {
 		return;
@@ -398,12 +384,11 @@ void MIKMIDIPortReadCallback(const MIDIPacketList *pktList, void *readProcRefCon
 			[receivedCommands removeLastObject];
 			
 			// Wait 4ms, then send the buffered command if it hasn't been coalesced (and therefore set to nil)
-			dispatch_time_t popTime = dispatch_time(DISPATCH_TIME_NOW, (int64_t)(4 * NSEC_PER_MSEC));
-			dispatch_after(popTime, self.bufferedCommandQueue, ^(void){
+			[self.timeSource performBlock:^{
 				if (![self.bufferedMSBCommands containsObject:finalCommand]) return;
 				[self.bufferedMSBCommands removeObject:finalCommand];
 				completionBlock(@[finalCommand]);
-			});
+			} afterTimeInterval:0.004 onQueue:self.bufferedCommandQueue];
 		}
 	}
 	
@@ -414,6 +399,37 @@ void MIKMIDIPortReadCallback(const MIDIPacketList *pktList, void *readProcRefCon
 	completionBlock(receivedCommands);
 }
 
+- (void)scheduleSysexTimeOutCheckAfterTimeInterval:(NSTimeInterval)timeInterval forGeneration:(NSUInteger)generation runLoop:(NSRunLoop *)runLoop mode:(NSRunLoopMode)mode handleResultingCommands:(void (^_Nonnull)(NSArray <MIKMIDICommand*> *receivedCommands))completionBlock
+{
+	// Weakify Self
+	__weak typeof(self) weakSelf = self;
+	id<MIKMIDITimeSource> timeSource = self.timeSource;
+	
+	[timeSource performBlock:^{
+		// Strongify Self
+		__strong typeof(self) self = weakSelf;
+		
+		// The sysex message this check was scheduled for has already ended
+		if (!self.isCoalescingSysex || self.sysexGeneration != generation) return;
+		
+		// More data arrived in the meantime, so check again once the extended time-out has passed
+		MIDITimeStamp now = [timeSource currentMIDITimeStamp];
+		MIDITimeStamp timeOutTimeStamp = self.sysexTimeOutTimeStamp;
+		if (now < timeOutTimeStamp) {
+			NSTimeInterval remainingTime = (timeOutTimeStamp - now) * MIKMIDIClockSecondsPerMIDITimeStamp();
+			return [self scheduleSysexTimeOutCheckAfterTimeInterval:remainingTime forGeneration:generation runLoop:runLoop mode:mode handleResultingCommands:completionBlock];
+		}
+		
+		// Force-End Sysex, unless the message ended while waiting for the run loop
+		CFRunLoopRef cfRunLoop = [runLoop getCFRunLoop];
+		CFRunLoopPerformBlock(cfRunLoop, (__bridge CFStringRef)mode, ^{
+			if (!self.isCoalescingSysex || self.sysexGeneration != generation) return;
+			completionBlock(@[[self commandByCoalescingSysexData]]);
+		});
+		CFRunLoopWakeUp(cfRunLoop);
+	} afterTimeInterval:timeInterval onQueue:self.bufferedCommandQueue];
+}
+
 #pragma mark - Properties
 
 + (NSSet *)keyPathsForValuesAffectingConnectedSources { return [NSSet setWithObjects:@"internalSources", nil]; }
@@ -430,6 +446,11 @@ void MIKMIDIPortReadCallback(const MIDIPacketList *pktList, void *readProcRefCon
 	[self.internalSources removeObject:source];
 }
 
+- (void)setTimeSource:(id<MIKMIDITimeSource>)timeSource
+{
+	_timeSource = timeSource ?: MIKMIDIDefaultTimeSource();
+}
+
 @synthesize bufferedCommandQueue = _bufferedCommandQueue;
 
 - (void)setCommandsBufferQueue:(dispatch_queue_t)commandsBufferQueue
@@ -129,6 +129,21 @@ NS_ASSUME_NONNULL_BEGIN
  *  @param clock     An MIKMIDIClock instance used to convert from the note event's sequence timestamp to a realtime MIDI time stamp. If clock is nil, the noteEvent's timestamp is ignored, and its duration is assumed to be a quarter note at the default MIDI tempo of 120 BPM.
  */
 + (MIKArrayOf(MIKMIDICommand *) *)commandsFromNoteEvent:(MIKMIDINoteEvent *)noteEvent clock:(nullable MIKMIDIClock *)clock;
+
+/**
+ *  Creates an MIKMIDINoteOnCommand and MIKMIDINoteOffCommand for each note event in an array.
+ *
+ *  All of the note on and note off time stamps are converted in a single batch using
+ *  -[MIKMIDIClock getMIDITimeStamps:forMusicTimeStamps:count:], so this is much faster
+ *  than calling +commandsFromNoteEvent:clock: in a loop.
+ *
+ *  @param noteEvents An array of MIKMIDINoteEvent instances.
+ *  @param clock      An MIKMIDIClock instance used to convert from the note events' sequence timestamps to realtime MIDI time stamps. If clock is nil, a clock syncing the first note event's timestamp to the current time at 120 BPM is used.
+ *
+ *  @return An array containing the note on command followed by the note off command for each note event, in the same order as noteEvents.
+ */
++ (MIKArrayOf(MIKMIDICommand *) *)commandsFromNoteEvents:(MIKArrayOf(MIKMIDINoteEvent *) *)noteEvents clock:(nullable MIKMIDIClock *)clock;
+
 + (MIKMIDINoteOnCommand *)noteOnCommandFromNoteEvent:(MIKMIDINoteEvent *)noteEvent clock:(nullable MIKMIDIClock *)clock;
 + (MIKMIDINoteOffCommand *)noteOffCommandFromNoteEvent:(MIKMIDINoteEvent *)noteEvent clock:(nullable MIKMIDIClock *)clock;
 
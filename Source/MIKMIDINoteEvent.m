@@ -180,18 +180,57 @@
 
 + (NSArray *)commandsFromNoteEvent:(MIKMIDINoteEvent *)noteEvent clock:(MIKMIDIClock *)clock
 {
+	if (!noteEvent) return @[];
+	return [self commandsFromNoteEvents:@[noteEvent] clock:clock];
+}
+
++ (NSArray *)commandsFromNoteEvents:(NSArray *)noteEvents clock:(MIKMIDIClock *)clock
+{
+	NSUInteger count = [noteEvents count];
+	if (!count) return @[];
+
 	if (!clock) {
 		clock = [MIKMIDIClock clock];
-		[clock syncMusicTimeStamp:noteEvent.timeStamp withMIDITimeStamp:MIKMIDIGetCurrentTimeStamp() tempo:120];
+		[clock syncMusicTimeStamp:[(MIKMIDINoteEvent *)noteEvents[0] timeStamp] withMIDITimeStamp:[MIKMIDIDefaultTimeSource() currentMIDITimeStamp] tempo:120];
+	}
+
+	// Convert every note on and note off time stamp in a single pass against the clock
+	MusicTimeStamp *musicTimeStamps = malloc(2 * count * sizeof(MusicTimeStamp));
+	MIDITimeStamp *midiTimeStamps = malloc(2 * count * sizeof(MIDITimeStamp));
+	for (NSUInteger i = 0; i < count; i++) {
+		MIKMIDINoteEvent *noteEvent = noteEvents[i];
+		musicTimeStamps[2 * i] = noteEvent.timeStamp;
+		musicTimeStamps[2 * i + 1] = noteEvent.endTimeStamp;
+	}
+	[clock getMIDITimeStamps:midiTimeStamps forMusicTimeStamps:musicTimeStamps count:2 * count];
+
+	NSMutableArray *commands = [NSMutableArray arrayWithCapacity:2 * count];
+	for (NSUInteger i = 0; i < count; i++) {
+		MIKMIDINoteEvent *noteEvent = noteEvents[i];
+		[commands addObject:MIKMIDINoteOnCommandFromNoteEvent(noteEvent, midiTimeStamps[2 * i])];
+		[commands addObject:MIKMIDINoteOffCommandFromNoteEvent(noteEvent, midiTimeStamps[2 * i + 1])];
 	}
 
-	return @[[self noteOnCommandFromNoteEvent:noteEvent clock:clock], [self noteOffCommandFromNoteEvent:noteEvent clock:clock]];
+	free(musicTimeStamps);
+	free(midiTimeStamps);
+	return commands;
 }
 
 + (MIKMIDINoteOnCommand *)noteOnCommandFromNoteEvent:(MIKMIDINoteEvent *)noteEvent clock:(MIKMIDIClock *)clock
+{
+	MIDITimeStamp timestamp = clock ? [clock midiTimeStampForMusicTimeStamp:noteEvent.timeStamp] : [MIKMIDIDefaultTimeSource() currentMIDITimeStamp];
+	return MIKMIDINoteOnCommandFromNoteEvent(noteEvent, timestamp);
+}
+
++ (MIKMIDINoteOffCommand *)noteOffCommandFromNoteEvent:(MIKMIDINoteEvent *)noteEvent clock:(MIKMIDIClock *)clock
+{
+	MIDITimeStamp timestamp = clock ? [clock midiTimeStampForMusicTimeStamp:noteEvent.endTimeStamp] : [MIKMIDIDefaultTimeSource() currentMIDITimeStamp];
+	return MIKMIDINoteOffCommandFromNoteEvent(noteEvent, timestamp);
+}
+
+static MIKMIDINoteOnCommand *MIKMIDINoteOnCommandFromNoteEvent(MIKMIDINoteEvent *noteEvent, MIDITimeStamp timestamp)
 {
 	MIKMutableMIDINoteOnCommand *noteOn = [[MIKMutableMIDINoteOnCommand alloc] init];
-	MIDITimeStamp timestamp = clock ? [clock midiTimeStampForMusicTimeStamp:noteEvent.timeStamp] : MIKMIDIGetCurrentTimeStamp();
 	noteOn.midiTimestamp = timestamp;
 	noteOn.channel = noteEvent.channel;
 	noteOn.note = noteEvent.note;
@@ -199,10 +238,9 @@
 	return [noteOn copy];
 }
 
-+ (MIKMIDINoteOffCommand *)noteOffCommandFromNoteEvent:(MIKMIDINoteEvent *)noteEvent clock:(MIKMIDIClock *)clock
+static MIKMIDINoteOffCommand *MIKMIDINoteOffCommandFromNoteEvent(MIKMIDINoteEvent *noteEvent, MIDITimeStamp timestamp)
 {
 	MIKMutableMIDINoteOffCommand *noteOff = [[MIKMutableMIDINoteOffCommand alloc] init];
-	MIDITimeStamp timestamp = clock ? [clock midiTimeStampForMusicTimeStamp:noteEvent.endTimeStamp] : MIKMIDIGetCurrentTimeStamp();
 	noteOff.midiTimestamp = timestamp;
 	noteOff.channel = noteEvent.channel;
 	noteOff.note = noteEvent.note;
@@ -0,0 +1,39 @@
+//
+//  MIKMIDINoteTransform+MIKMIDIPrivate.h
+//  MIKMIDI
+//
+//  Created by Mixed In Key on 10/18/26.
+//  Copyright (c) 2026 Mixed In Key. All rights reserved.
+//
+
+#import "MIKMIDINoteTransform.h"
+#import "MIKMIDICompilerCompatibility.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  The parts of a note a transform can change. MIKMIDIEventStore copies its notes into an array
+ *  of these, applies the transform to the whole array, and writes back the notes that changed.
+ */
+typedef struct {
+	MusicTimeStamp timeStamp;
+	Float32 duration;
+	UInt8 channel;
+	UInt8 note;
+	UInt8 velocity;
+} MIKMIDINoteTransformNote;
+
+@interface MIKMIDINoteTransform ()
+
+/**
+ *  Applies the transform to an array of notes, in place.
+ *
+ *  @param notes The notes to transform.
+ *  @param count The number of notes.
+ *  @param trackNumber The number of the track the notes are in, which humanizing mixes into its random amounts.
+ */
+- (void)applyToNotes:(MIKMIDINoteTransformNote *)notes count:(NSUInteger)count trackNumber:(NSInteger)trackNumber;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,110 @@
+//
+//  MIKMIDINoteTransform.h
+//  MIKMIDI
+//
+//  Created by Mixed In Key on 10/18/26.
+//  Copyright (c) 2026 Mixed In Key. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import <AudioToolbox/AudioToolbox.h>
+#import "MIKMIDICompilerCompatibility.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  An MIKMIDINoteTransform describes an edit to apply to every note in a track, such as quantizing
+ *  or transposing it.
+ *
+ *  Transforms are applied using -[MIKMIDITrack applyNoteTransform:] or -[MIKMIDISequence applyNoteTransform:].
+ *  Rather than removing and re-adding each note as an MIKMIDINoteEvent, the notes are rewritten directly
+ *  in the track's storage, and the changes are committed in a single batch, so transforming a track of
+ *  any size produces one KVO notification and one update of the underlying MusicTrack.
+ *
+ *  Transforms can be combined using +transformWithTransforms:. A combined transform makes one pass over
+ *  the track's notes for each of its transforms, in order, and commits the result once.
+ *
+ *  Transforms only change notes. Other events are left where they are. Transforms are immutable, and may
+ *  be shared between threads.
+ */
+@interface MIKMIDINoteTransform : NSObject
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ *  Creates a transform that moves the start of each note towards the nearest line of a grid.
+ *
+ *  @param gridInterval The distance between grid lines, in beats, e.g. 0.25 for sixteenth notes. Must be greater than 0.
+ *  @param strength How far to move each note towards its grid line, from 0 (not at all) to 1 (all the way).
+ *  @param swing How far to delay every other grid line, as a fraction of gridInterval, from 0 (straight)
+ *  to just under 1. 1/3 gives a triplet feel.
+ *
+ *  @return A new MIKMIDINoteTransform.
+ */
++ (instancetype)quantizeTransformWithGridInterval:(MusicTimeStamp)gridInterval strength:(double)strength swing:(double)swing;
+
+/**
+ *  Creates a transform that moves each note and changes its velocity by a random amount.
+ *
+ *  The random amounts are derived from the seed, the note itself and the number of the track it's in, so applying
+ *  the same transform to the same track always gives the same result, regardless of the order in which tracks are
+ *  processed, while doubled parts on different tracks are humanized differently.
+ *  Notes are never moved before time stamp 0, and velocities are kept between 1 and 127.
+ *
+ *  @param timingRange The largest amount, in beats, to move a note earlier or later.
+ *  @param velocityRange The largest amount to raise or lower a note's velocity.
+ *  @param seed The seed for the random amounts. Use a different seed to get a different result.
+ *
+ *  @return A new MIKMIDINoteTransform.
+ */
++ (instancetype)humanizeTransformWithTimingRange:(MusicTimeStamp)timingRange velocityRange:(UInt8)velocityRange seed:(UInt64)seed;
+
+/**
+ *  Creates a transform that transposes each note by a number of semitones.
+ *
+ *  Notes that would end up outside of the range from lowestNote to highestNote are clamped to the range.
+ *
+ *  @param interval The number of semitones to transpose by. May be negative.
+ *  @param lowestNote The lowest note the transform may produce.
+ *  @param highestNote The highest note the transform may produce. Must be greater than or equal to lowestNote, and at most 127.
+ *
+ *  @return A new MIKMIDINoteTransform.
+ */
++ (instancetype)transposeTransformWithInterval:(NSInteger)interval lowestNote:(UInt8)lowestNote highestNote:(UInt8)highestNote;
+
+/**
+ *  Creates a transform that maps each note's velocity through a curve.
+ *
+ *  The curve is evaluated once for each of the 128 possible velocities when the transform is created,
+ *  and notes are then mapped through the resulting table.
+ *
+ *  @param curve A block that returns the new velocity for a velocity from 0 to 127. Results above 127 are clamped.
+ *
+ *  @return A new MIKMIDINoteTransform.
+ */
++ (instancetype)velocityCurveTransformWithBlock:(UInt8 (^)(UInt8 velocity))curve;
+
+/**
+ *  Creates a transform that maps each note's velocity through an exponential curve.
+ *
+ *  Exponents greater than 1 make soft notes softer, while exponents less than 1 make them louder.
+ *  Notes with a non-zero velocity keep a velocity of at least 1.
+ *
+ *  @param exponent The exponent to raise velocities, scaled to the range 0 to 1, to. Must be greater than 0.
+ *
+ *  @return A new MIKMIDINoteTransform.
+ */
++ (instancetype)velocityCurveTransformWithExponent:(double)exponent;
+
+/**
+ *  Creates a transform that applies several transforms, one after the other.
+ *
+ *  @param transforms An array of MIKMIDINoteTransform instances, in the order they should be applied.
+ *
+ *  @return A new MIKMIDINoteTransform.
+ */
++ (instancetype)transformWithTransforms:(MIKArrayOf(MIKMIDINoteTransform *) *)transforms;
+
+@end
+
+NS_ASSUME_NONNULL_END
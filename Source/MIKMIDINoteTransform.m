@@ -0,0 +1,169 @@
+//
+//  MIKMIDINoteTransform.m
+//  MIKMIDI
+//
+//  Created by Mixed In Key on 10/18/26.
+//  Copyright (c) 2026 Mixed In Key. All rights reserved.
+//
+
+#import "MIKMIDINoteTransform.h"
+#import "MIKMIDINoteTransform+MIKMIDIPrivate.h"
+
+#if !__has_feature(objc_arc)
+#error MIKMIDINoteTransform.m must be compiled with ARC. Either turn on ARC for the project or set the -fobjc-arc flag for MIKMIDINoteTransform.m in the Build Phases for this target
+#endif
+
+typedef void (^MIKMIDINoteTransformApplier)(MIKMIDINoteTransformNote *notes, NSUInteger count, NSInteger trackNumber);
+
+// The splitmix64 finalizer. Humanizing hashes each note and its track number rather than drawing from a sequence,
+// so the result doesn't depend on the order in which notes (or tracks) are processed, but doubled parts differ.
+static UInt64 MIKMIDINoteTransformMix(UInt64 x)
+{
+	x += 0x9E3779B97F4A7C15ULL;
+	x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+	return x ^ (x >> 31);
+}
+
+// Returns a value between -1 and 1
+static double MIKMIDINoteTransformRandomAmount(UInt64 random)
+{
+	return (double)(random >> 11) * 0x1.0p-52 - 1.0;
+}
+
+@interface MIKMIDINoteTransform ()
+
+@property (nonatomic, copy, readonly) NSArray *appliers;
+
+@end
+
+@implementation MIKMIDINoteTransform
+
+- (instancetype)initWithAppliers:(NSArray *)appliers
+{
+	self = [super init];
+	if (self) {
+		_appliers = [appliers copy];
+	}
+	return self;
+}
+
+- (instancetype)init
+{
+	[NSException raise:NSInternalInconsistencyException format:@"Use one of the factory methods to create %@ instances.", NSStringFromClass([self class])];
+	return nil;
+}
+
++ (instancetype)transformWithApplier:(MIKMIDINoteTransformApplier)applier
+{
+	return [[self alloc] initWithAppliers:@[[applier copy]]];
+}
+
+#pragma mark - Creating Transforms
+
++ (instancetype)quantizeTransformWithGridInterval:(MusicTimeStamp)gridInterval strength:(double)strength swing:(double)swing
+{
+	if (gridInterval <= 0) return [self transformWithTransforms:@[]];
+	strength = MIN(MAX(strength, 0), 1);
+	swing = MIN(MAX(swing, 0), 1);
+
+	return [self transformWithApplier:^(MIKMIDINoteTransformNote *notes, NSUInteger count, NSInteger trackNumber) {
+		// Grid lines come in pairs, the second of which is delayed by the swing amount
+		MusicTimeStamp pairInterval = 2 * gridInterval;
+		MusicTimeStamp swungLineOffset = gridInterval + swing * gridInterval;
+		for (NSUInteger i = 0; i < count; i++) {
+			MusicTimeStamp timeStamp = notes[i].timeStamp;
+			MusicTimeStamp pairStart = floor(timeStamp / pairInterval) * pairInterval;
+			MusicTimeStamp gridLine = pairStart;
+			if (fabs(pairStart + swungLineOffset - timeStamp) < fabs(gridLine - timeStamp)) gridLine = pairStart + swungLineOffset;
+			if (fabs(pairStart + pairInterval - timeStamp) < fabs(gridLine - timeStamp)) gridLine = pairStart + pairInterval;
+			notes[i].timeStamp = timeStamp + strength * (gridLine - timeStamp);
+		}
+	}];
+}
+
++ (instancetype)humanizeTransformWithTimingRange:(MusicTimeStamp)timingRange velocityRange:(UInt8)velocityRange seed:(UInt64)seed
+{
+	timingRange = MAX(timingRange, 0);
+
+	return [self transformWithApplier:^(MIKMIDINoteTransformNote *notes, NSUInteger count, NSInteger trackNumber) {
+		UInt64 trackSeed = MIKMIDINoteTransformMix(seed ^ MIKMIDINoteTransformMix((UInt64)trackNumber));
+		for (NSUInteger i = 0; i < count; i++) {
+			MIKMIDINoteTransformNote *note = &notes[i];
+			UInt64 timeStampBits;
+			memcpy(&timeStampBits, &note->timeStamp, sizeof(timeStampBits));
+			UInt64 timingRandom = MIKMIDINoteTransformMix(trackSeed ^ MIKMIDINoteTransformMix(timeStampBits ^ ((UInt64)note->channel << 8 | note->note)));
+			UInt64 velocityRandom = MIKMIDINoteTransformMix(timingRandom);
+
+			note->timeStamp = MAX(note->timeStamp + timingRange * MIKMIDINoteTransformRandomAmount(timingRandom), 0);
+			if (note->velocity) {
+				long velocity = note->velocity + lround(velocityRange * MIKMIDINoteTransformRandomAmount(velocityRandom));
+				note->velocity = (UInt8)MIN(MAX(velocity, 1), 127);
+			}
+		}
+	}];
+}
+
++ (instancetype)transposeTransformWithInterval:(NSInteger)interval lowestNote:(UInt8)lowestNote highestNote:(UInt8)highestNote
+{
+	highestNote = MIN(highestNote, 127);
+	lowestNote = MIN(lowestNote, highestNote);
+
+	return [self transformWithApplier:^(MIKMIDINoteTransformNote *notes, NSUInteger count, NSInteger trackNumber) {
+		for (NSUInteger i = 0; i < count; i++) {
+			NSInteger note = notes[i].note + interval;
+			notes[i].note = (UInt8)MIN(MAX(note, (NSInteger)lowestNote), (NSInteger)highestNote);
+		}
+	}];
+}
+
++ (instancetype)velocityCurveTransformWithBlock:(UInt8 (^)(UInt8))curve
+{
+	if (!curve) return [self transformWithTransforms:@[]];
+
+	// Blocks can't capture C arrays, so the table lives in an NSData
+	NSMutableData *tableData = [NSMutableData dataWithLength:128];
+	UInt8 *table = [tableData mutableBytes];
+	for (UInt8 velocity = 0; velocity < 128; velocity++) {
+		UInt8 curvedVelocity = curve(velocity);
+		table[velocity] = MIN(curvedVelocity, 127);
+	}
+
+	return [self transformWithApplier:^(MIKMIDINoteTransformNote *notes, NSUInteger count, NSInteger trackNumber) {
+		const UInt8 *lookupTable = [tableData bytes];
+		for (NSUInteger i = 0; i < count; i++) {
+			notes[i].velocity = lookupTable[notes[i].velocity & 0x7F];
+		}
+	}];
+}
+
++ (instancetype)velocityCurveTransformWithExponent:(double)exponent
+{
+	if (exponent <= 0) return [self transformWithTransforms:@[]];
+
+	return [self velocityCurveTransformWithBlock:^UInt8(UInt8 velocity) {
+		if (!velocity) return 0;
+		long curvedVelocity = lround(127.0 * pow(velocity / 127.0, exponent));
+		return (UInt8)MIN(MAX(curvedVelocity, 1), 127);
+	}];
+}
+
++ (instancetype)transformWithTransforms:(NSArray *)transforms
+{
+	NSMutableArray *appliers = [NSMutableArray array];
+	for (MIKMIDINoteTransform *transform in transforms) {
+		[appliers addObjectsFromArray:transform.appliers];
+	}
+	return [[self alloc] initWithAppliers:appliers];
+}
+
+#pragma mark - Private
+
+- (void)applyToNotes:(MIKMIDINoteTransformNote *)notes count:(NSUInteger)count trackNumber:(NSInteger)trackNumber
+{
+	for (MIKMIDINoteTransformApplier applier in self.appliers) {
+		applier(notes, count, trackNumber);
+	}
+}
+
+@end
@@ -10,6 +10,7 @@
 #import "MIKMIDICompilerCompatibility.h"
 
 @class MIKMIDISequencer;
+@class MIKMIDIEventStore;
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -17,6 +18,24 @@ NS_ASSUME_NONNULL_BEGIN
 
 @property (nonatomic, weak, readwrite, nullable) MIKMIDISequencer *sequencer;
 
+/**
+ *  The time resolution of the MIDI file the sequence was read from, if it was read by MIKMIDIFileParser,
+ *  otherwise 0. Its MusicSequence was never loaded from the file, so it doesn't know the file's resolution.
+ */
+@property (nonatomic) SInt16 fileTimeResolution;
+
+/**
+ *  Initializes a sequence with empty tracks, which the caller fills with events.
+ *
+ *  @param numberOfTracks The number of tracks, not counting the tempo track.
+ *  @param tempoTrackEventStore The events for the tempo track, or nil to leave it empty.
+ *  @param timeResolution The time resolution of the file the events were read from, in ticks per quarter note.
+ *  @param error If an error occurs, upon return contains an NSError object that describes the problem.
+ *
+ *  @return An initialized MIKMIDISequence, or nil if an error occurred.
+ */
+- (nullable instancetype)initWithNumberOfTracks:(NSUInteger)numberOfTracks tempoTrackEventStore:(nullable MIKMIDIEventStore *)tempoTrackEventStore timeResolution:(SInt16)timeResolution error:(NSError **)error;
+
 @end
 
 NS_ASSUME_NONNULL_END
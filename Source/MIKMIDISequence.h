@@ -16,6 +16,24 @@
 @class MIKMIDIDestinationEndpoint;
 @class MIKMIDIMetaTimeSignatureEvent;
 @class MIKMIDITempoEvent;
+@class MIKMIDINoteTransform;
+@class MIKMIDIFileParser;
+
+/**
+ *  Ways tracks of different sequences can be matched up when they're merged by
+ *  +sequenceByConcatenatingSequences:matchingTracksBy:error: or +sequenceByOverlayingSequences:matchingTracksBy:error:.
+ *  Matched tracks are combined into a single track of the merged sequence.
+ */
+typedef NS_ENUM(NSInteger, MIKMIDISequenceTrackMatching) {
+	/** Tracks are never matched, so each track of each sequence gets a track of its own. */
+	MIKMIDISequenceTrackMatchingNone,
+	/** Tracks at the same index in their sequences are matched. */
+	MIKMIDISequenceTrackMatchingIndex,
+	/** Tracks with the same name are matched. Tracks without a name are not matched with any other track. */
+	MIKMIDISequenceTrackMatchingName,
+	/** Tracks with events on the same set of MIDI channels are matched. Tracks without channel events are not matched with any other track. */
+	MIKMIDISequenceTrackMatchingChannels
+};
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -53,7 +71,8 @@ NS_ASSUME_NONNULL_BEGIN
  *  @param fileURL The URL of the MIDI file.
  *  @param convertMIDIChannelsToTracks Determines whether or not the track structure should be altered. When YES, the resulting sequence will
  *  contain a tempo track, 1 track for each MIDI Channel that is found in the MIDI file, and 1 track for SysEx or MetaEvents as the last track in
- *  the sequence. When NO, the track structure of the original MIDI file is left unaltered.
+ *  the sequence. When NO, the track structure of the original MIDI file is left unaltered. Files that MIKMIDIFileParser can read are
+ *  split natively, in the same pass that decodes them.
  *  @param error If an error occurs, upon returns contains an NSError object that describes the problem. If you are not interested in possible errors,
  *  you may pass in NULL.
  *
@@ -78,7 +97,8 @@ NS_ASSUME_NONNULL_BEGIN
  *  @param fileURL The URL of the MIDI file.
  *  @param convertMIDIChannelsToTracks Determines whether or not the track structure should be altered. When YES, the resulting sequence will
  *  contain a tempo track, 1 track for each MIDI Channel that is found in the MIDI file, and 1 track for SysEx or MetaEvents as the last track in
- *  the sequence. When NO, the track structure of the original MIDI file is left unaltered.
+ *  the sequence. When NO, the track structure of the original MIDI file is left unaltered. Files that MIKMIDIFileParser can read are
+ *  split natively, in the same pass that decodes them.
  *  @param error If an error occurs, upon return contains an NSError object that describes the problem. If you are not interested in possible errors,
  *  you may pass in NULL.
  *
@@ -103,7 +123,8 @@ NS_ASSUME_NONNULL_BEGIN
  *  @param data  An NSData instance containing the data for the MIDI sequence/file.
  *  @param convertMIDIChannelsToTracks Determines whether or not the track structure should be altered. When YES, the resulting sequence will
  *  contain a tempo track, 1 track for each MIDI Channel that is found in the MIDI file, and 1 track for SysEx or MetaEvents as the last track in
- *  the sequence. When NO, the track structure of the original MIDI file is left unaltered.
+ *  the sequence. When NO, the track structure of the original MIDI file is left unaltered. Files that MIKMIDIFileParser can read are
+ *  split natively, in the same pass that decodes them.
  *  @param error If an error occurs, upon return contains an NSError object that describes the problem. If you are not interested in possible errors,
  *
  *  @return If an error occurs, upon return contains an NSError object that describes the problem. If you are not interested in possible errors,
@@ -125,10 +146,14 @@ NS_ASSUME_NONNULL_BEGIN
 /**
  *  Initializes a new instance of MIKMIDISequence from MIDI data.
  *
+ *  The data is read using MIKMIDIFileParser, if it can read it, and the tracks' events are only
+ *  written to the sequence's MusicSequence when it is first needed.
+ *
  *  @param data  An NSData instance containing the data for the MIDI sequence/file.
  *  @param convertMIDIChannelsToTracks Determines whether or not the track structure should be altered. When YES, the resulting sequence will
  *  contain a tempo track, 1 track for each MIDI Channel that is found in the MIDI file, and 1 track for SysEx or MetaEvents as the last track in
- *  the sequence. When NO, the track structure of the original MIDI file is left unaltered.
+ *  the sequence. When NO, the track structure of the original MIDI file is left unaltered. Files that MIKMIDIFileParser can read are
+ *  split natively, in the same pass that decodes them.
  *  @param error If an error occurs, upon return contains an NSError object that describes the problem. If you are not interested in possible errors,
  *
  *  @return If an error occurs, upon return contains an NSError object that describes the problem. If you are not interested in possible errors,
@@ -136,8 +161,68 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (nullable instancetype)initWithData:(NSData *)data convertMIDIChannelsToTracks:(BOOL)convertMIDIChannelsToTracks error:(NSError **)error;
 
+/**
+ *  Creates and initializes a new instance of MIKMIDISequence from the MIDI file read by a parser.
+ *
+ *  This can be used to control how the file is loaded, e.g. by setting the parser's maximumConcurrentTrackDecodes.
+ *
+ *  @param parser An MIKMIDIFileParser for the MIDI file.
+ *  @param error If an error occurs, upon return contains an NSError object that describes the problem. If you are not interested in possible errors,
+ *  you may pass in NULL.
+ *
+ *  @return A new instance of MIKMIDISequence containing the file's MIDI sequence, or nil if an error occured.
+ */
++ (nullable instancetype)sequenceWithFileParser:(MIKMIDIFileParser *)parser error:(NSError **)error;
+
+/**
+ *  Initializes a new instance of MIKMIDISequence from the MIDI file read by a parser.
+ *
+ *  The parser's tracks are decoded concurrently, as allowed by its maximumConcurrentTrackDecodes property,
+ *  and the sequence's tracks are created in the order they appear in the file.
+ *
+ *  @param parser An MIKMIDIFileParser for the MIDI file.
+ *  @param error If an error occurs, upon return contains an NSError object that describes the problem. If you are not interested in possible errors,
+ *  you may pass in NULL.
+ *
+ *  @return An initialized instance of MIKMIDISequence containing the file's MIDI sequence, or nil if an error occured.
+ */
+- (nullable instancetype)initWithFileParser:(MIKMIDIFileParser *)parser error:(NSError **)error;
+
+/**
+ *  Creates and initializes a new instance of MIKMIDISequence from the MIDI file read by a parser.
+ *
+ *  @param parser An MIKMIDIFileParser for the MIDI file.
+ *  @param loadsTracksLazily Whether the tracks' events are only read from the file when they're first needed.
+ *  @param error If an error occurs, upon return contains an NSError object that describes the problem. If you are not interested in possible errors,
+ *  you may pass in NULL.
+ *
+ *  @return A new instance of MIKMIDISequence containing the file's MIDI sequence, or nil if an error occured.
+ *
+ *  @see -initWithFileParser:loadingTracksLazily:error:
+ */
++ (nullable instancetype)sequenceWithFileParser:(MIKMIDIFileParser *)parser loadingTracksLazily:(BOOL)loadsTracksLazily error:(NSError **)error;
+
+/**
+ *  Initializes a new instance of MIKMIDISequence from the MIDI file read by a parser, optionally loading its tracks lazily.
+ *
+ *  When loadsTracksLazily is YES, each track is only summarized when the sequence is created, which is
+ *  considerably faster for large files. The tempo track is loaded in full, and each track's name,
+ *  instrumentName, channels, numberOfEvents and length are available straight away. A track's events are
+ *  read from the file the first time they're needed, e.g. when its events or notes are requested, or it's
+ *  played by an MIKMIDISequencer. The parser, and the file it reads, are kept until then.
+ *
+ *  @param parser An MIKMIDIFileParser for the MIDI file.
+ *  @param loadsTracksLazily Whether the tracks' events are only read from the file when they're first needed.
+ *  @param error If an error occurs, upon return contains an NSError object that describes the problem. If you are not interested in possible errors,
+ *  you may pass in NULL.
+ *
+ *  @return An initialized instance of MIKMIDISequence containing the file's MIDI sequence, or nil if an error occured.
+ */
+- (nullable instancetype)initWithFileParser:(MIKMIDIFileParser *)parser loadingTracksLazily:(BOOL)loadsTracksLazily error:(NSError **)error;
+
 /**
  *  Writes the MIDI sequence in Standard MIDI File format to a file at the specified URL.
+ *  The file is streamed to disk as it's written, and replaces any existing file only once it's complete.
  *
  *  @param fileURL The URL to write the MIDI file to.
  *  @param error If an error occurs, upon return contains an NSError object that describes the problem. If you are not interested in possible errors,
@@ -147,6 +232,105 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (BOOL)writeToURL:(NSURL *)fileURL error:(NSError **)error;
 
+#pragma mark - Caching
+
+/**
+ *  Creates and initializes a new instance of MIKMIDISequence from a cache written by -writeCacheToURL:error:.
+ *
+ *  @param cacheURL The URL of the cache.
+ *  @param error If an error occurs, upon return contains an NSError object that describes the problem. If you are not interested in possible errors,
+ *  you may pass in NULL.
+ *
+ *  @return A new instance of MIKMIDISequence containing the cached sequence, or nil if an error occured.
+ *
+ *  @see -initWithCacheAtURL:error:
+ */
++ (nullable instancetype)sequenceWithCacheAtURL:(NSURL *)cacheURL error:(NSError **)error;
+
+/**
+ *  Initializes a new instance of MIKMIDISequence from a cache written by -writeCacheToURL:error:.
+ *
+ *  The cache is memory-mapped, and the tracks' events are used where they are in it, without being decoded
+ *  or copied, so loading a cached sequence takes about the same time however many events it has. Pages of
+ *  the cache are only read from disk as the events on them are used, and an event is only copied out of the
+ *  cache if it is edited. The tracks' events are written to the sequence's MusicSequence when it is next needed.
+ *
+ *  Only the cache's structure is checked when it's read, not each of its events, so a cache should only
+ *  be read from a location the app wrote it to itself. A cache that was written by a different version of
+ *  MIKMIDI, or on a platform with a different memory layout, can't be read, and should be written again
+ *  from the original MIDI file.
+ *
+ *  @param cacheURL The URL of the cache.
+ *  @param error If an error occurs, upon return contains an NSError object that describes the problem. If you are not interested in possible errors,
+ *  you may pass in NULL.
+ *
+ *  @return An initialized instance of MIKMIDISequence containing the cached sequence, or nil if an error occured.
+ */
+- (nullable instancetype)initWithCacheAtURL:(NSURL *)cacheURL error:(NSError **)error;
+
+/**
+ *  Writes a snapshot of the sequence to a cache file, which can be loaded considerably faster than a MIDI
+ *  file by +sequenceWithCacheAtURL:error:. The cache holds the events of every track, including the tempo
+ *  track, each track's offset, muted and solo properties, and the sequence's length and time resolution.
+ *
+ *  The cache is a binary format specific to MIKMIDI and the platform it was written on, so it is not
+ *  a replacement for saving the sequence as a MIDI file with -writeToURL:error:.
+ *
+ *  @param cacheURL The URL to write the cache to. Any existing file is replaced atomically.
+ *  @param error If an error occurs, upon return contains an NSError object that describes the problem. If you are not interested in possible errors,
+ *  you may pass in NULL.
+ *
+ *  @return Whether or not the cache was written successfully.
+ */
+- (BOOL)writeCacheToURL:(NSURL *)cacheURL error:(NSError **)error;
+
+#pragma mark - Merging
+
+/**
+ *  Creates a sequence by playing several sequences one after the other, e.g. to build a medley.
+ *
+ *  Each sequence starts at the end of the one before it, as given by its length property. The tempo
+ *  tracks are stitched together the same way, so each part keeps its own tempo and time signature changes.
+ *  Where a sequence doesn't set its tempo or time signature at its start, 120 bpm and 4/4 are set there,
+ *  so it doesn't play at the tempo or meter the previous sequence ended with.
+ *
+ *  Tracks are combined as specified by trackMatching, and the merged sequence's tracks are in the order their
+ *  first track appears in sequences. The offset of each track is applied to its events as they're combined,
+ *  so the merged tracks have an offset of 0. Each combined track takes its muted and solo properties from the
+ *  first track combined into it.
+ *
+ *  The events are merged from the tracks' internal storage in a single pass, without creating MIKMIDIEvents,
+ *  so merging takes time proportional to the total number of events. Time stamps are in beats, so sequences
+ *  with different time resolutions need no conversion. The merged sequence takes the least common multiple
+ *  of their resolutions, or the highest of them if that would be more than a MIDI file can hold, as its own.
+ *
+ *  @param sequences An array of MIKMIDISequences to concatenate, in the order they should play.
+ *  @param trackMatching How tracks of the sequences are matched up.
+ *  @param error If an error occurs, upon return contains an NSError object that describes the problem. If you are not interested in possible errors,
+ *  you may pass in NULL.
+ *
+ *  @return A new instance of MIKMIDISequence, or nil if an error occured.
+ */
++ (nullable instancetype)sequenceByConcatenatingSequences:(MIKArrayOf(MIKMIDISequence *) *)sequences matchingTracksBy:(MIKMIDISequenceTrackMatching)trackMatching error:(NSError **)error;
+
+/**
+ *  Creates a sequence by playing several sequences at the same time, e.g. to combine stems.
+ *
+ *  Every sequence starts at the beginning. The merged sequence uses the tempo track of the first sequence, and the
+ *  tempo tracks of the others are ignored. Events that are the same in more than one sequence are only included once.
+ *  Otherwise, tracks are combined, and resolutions reconciled, as by +sequenceByConcatenatingSequences:matchingTracksBy:error:.
+ *  Merging takes time proportional to the total number of events times the logarithm of the number of tracks
+ *  combined into each track.
+ *
+ *  @param sequences An array of MIKMIDISequences to overlay.
+ *  @param trackMatching How tracks of the sequences are matched up.
+ *  @param error If an error occurs, upon return contains an NSError object that describes the problem. If you are not interested in possible errors,
+ *  you may pass in NULL.
+ *
+ *  @return A new instance of MIKMIDISequence, or nil if an error occured.
+ */
++ (nullable instancetype)sequenceByOverlayingSequences:(MIKArrayOf(MIKMIDISequence *) *)sequences matchingTracksBy:(MIKMIDISequenceTrackMatching)trackMatching error:(NSError **)error;
+
 #pragma mark - Track Management
 
 /**
@@ -175,6 +359,56 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (BOOL)removeTrack:(MIKMIDITrack *)track;
 
+/**
+ *  Replaces the sequence's tracks with a track for each MIDI channel used by their events, and a last track
+ *  for their other events, like meta and system exclusive events. This is the same track structure as loading
+ *  a file with convertMIDIChannelsToTracks set to YES. The tempo track is left unchanged, so meta events other
+ *  than tempo and time signature events stay with the other events on the last track, rather than moving to the
+ *  tempo track, as MusicSequenceFileLoadData() does when splitting a file by channel.
+ *
+ *  The events are split in a single pass over each track, without creating an MIKMIDIEvent for each one.
+ *  The new tracks have the default offset, muted and solo properties, and events that are equal to an event
+ *  on the same channel in an earlier track are dropped.
+ *
+ *  @param error If an error occurs, upon return contains an NSError object that describes the problem. If you are not interested in possible errors,
+ *  you may pass in NULL.
+ *
+ *  @return YES if the tracks were converted, NO if an error occurred.
+ */
+- (BOOL)convertMIDIChannelsToTracksWithError:(NSError **)error;
+
+#pragma mark - Batch Editing
+
+/**
+ *  Performs a group of edits to the sequence and its tracks as a single batch.
+ *
+ *  Every track in the sequence, including the tempo track, is put into batch editing mode
+ *  for the duration of the block, as with -[MIKMIDITrack performBatchEdits:]. Updating the
+ *  underlying MusicTracks, posting change notifications for the tracks' events, and
+ *  recalculating the length of the sequence all happen once, after the block returns.
+ *
+ *  If the sequence is being played by an MIKMIDISequencer, the whole block runs on the
+ *  sequencer's processing queue, so the sequencer never plays a partially edited sequence.
+ *
+ *  @param edits A block that edits the sequence and/or its tracks.
+ *
+ *  @see -[MIKMIDITrack performBatchEdits:]
+ */
+- (void)performBatchEdits:(void (^)(void))edits;
+
+/**
+ *  Applies a transform, such as quantizing or transposing, to every note in every track of the sequence.
+ *
+ *  The tracks are transformed concurrently, spread across the available processor cores, and the result is
+ *  committed as a single batch, as with -performBatchEdits:. The tempo track is not transformed.
+ *
+ *  @param transform The transform to apply.
+ *
+ *  @see MIKMIDINoteTransform
+ *  @see -[MIKMIDITrack applyNoteTransform:]
+ */
+- (void)applyNoteTransform:(MIKMIDINoteTransform *)transform;
+
 #pragma mark - Tempo & Time Signature
 
 /**
@@ -294,9 +528,31 @@ NS_ASSUME_NONNULL_BEGIN
 
 /**
  *  The underlying MusicSequence that backs the instance of MIKMIDISequence.
+ *
+ *  If synchronizesMusicSequenceLazily is YES, pending edits to the sequence's tracks are
+ *  written to the MusicSequence before it is returned.
  */
 @property (nonatomic, readonly) MusicSequence musicSequence;
 
+/**
+ *  Whether edits to the sequence's tracks are written to the underlying MusicSequence lazily.
+ *
+ *  By default, every edit to a track's events is immediately mirrored in the track's MusicTrack.
+ *  When this is YES, the events stored by MIKMIDITrack are authoritative, and edits only update
+ *  them. The MusicSequence and its MusicTracks are brought up to date in a single pass when they
+ *  are next needed, e.g. when the musicSequence property of the sequence, or the musicTrack
+ *  property of one of its tracks, is accessed. This makes editing considerably cheaper.
+ *  MIKMIDISequencer plays a sequence's events directly, and dataValue and -writeToURL:error: write
+ *  them directly, so neither requires the MusicSequence to be brought up to date.
+ *
+ *  Because events are not added to the MusicTrack immediately, errors adding events, e.g. for an
+ *  unsupported event type, are only detected when the MusicSequence is brought up to date. As when
+ *  adding events normally, the track's events are then reloaded from its MusicTrack.
+ *
+ *  Setting this to NO brings the MusicSequence up to date immediately. The default is NO.
+ */
+@property (nonatomic) BOOL synchronizesMusicSequenceLazily;
+
 /**
  *  The length of the sequence as a MusicTimeStamp.
  *
@@ -315,6 +571,8 @@ NS_ASSUME_NONNULL_BEGIN
 
 /**
  *  The MIDI data that composes the sequence. This data is equivalent to an NSData representation of a standard MIDI file.
+ *
+ *  The file is written by MIKMIDIFileWriter, with the tempo track as its first track.
  */
 @property (nonatomic, readonly, nullable) NSData *dataValue;
 
@@ -16,21 +16,181 @@
 #import "MIKMIDISequence+MIKMIDIPrivate.h"
 #import "MIKMIDISequencer+MIKMIDIPrivate.h"
 #import "MIKMIDIErrors.h"
+#import "MIKMIDIEventStore.h"
+#import "MIKMIDIFileParser.h"
+#import "MIKMIDIFileParser+MIKMIDIPrivate.h"
+#import "MIKMIDIFileWriter.h"
+#include <unistd.h>
+#include <sys/stat.h>
 
 #if !__has_feature(objc_arc)
 #error MIKMIDISequence.m must be compiled with ARC. Either turn on ARC for the project or set the -fobjc-arc flag for MIKMIDISequence.m in the Build Phases for this target
 #endif
 
+#define MIKMIDISequenceCacheVersion	1
+
 void * MIKMIDISequenceKVOContext = &MIKMIDISequenceKVOContext;
 
 const MusicTimeStamp MIKMIDISequenceLongestTrackLength = -1;
 
+#pragma mark - Cache Format
+
+// A sequence cache is this header, followed by the tempo track and then each of the other tracks, as written by
+// -[MIKMIDITrack appendCacheRepresentationToData:]. Like a file index, it is in native layout and 8 byte aligned
+// throughout, so the tracks' events can be used straight from the memory-mapped cache.
+typedef struct {
+	char magic[4]; // "MIKC"
+	UInt32 version;
+	UInt64 cacheLength;
+	Float64 length; // MIKMIDISequenceLongestTrackLength if the length is defined by the tracks
+	SInt16 timeResolution;
+	UInt16 reserved;
+	UInt32 numberOfTracks;
+} MIKMIDISequenceCacheHeader;
+
+#pragma mark - Track Length Heap
+
+// A max-heap of tracks keyed by the time at which each track ends (its length plus its offset),
+// so that a change to one track's length updates the length of the sequence in O(log n).
+@interface MIKMIDISequenceTrackLengthHeap : NSObject
+- (void)addTrack:(MIKMIDITrack *)track;
+- (void)removeTrack:(MIKMIDITrack *)track;
+- (void)removeAllTracks;
+- (BOOL)updateLengthOfTrack:(MIKMIDITrack *)track; // Returns NO if track isn't in the heap
+@property (nonatomic, readonly) MusicTimeStamp maximumLength;
+@end
+
+@implementation MIKMIDISequenceTrackLengthHeap
+{
+	NSMutableArray *_tracks;
+	MusicTimeStamp *_lengths;
+	NSUInteger _capacity;
+	NSMapTable *_indexesByTrack;
+}
+
+- (instancetype)init
+{
+	self = [super init];
+	if (self) {
+		_tracks = [NSMutableArray array];
+		_indexesByTrack = [NSMapTable mapTableWithKeyOptions:NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality
+												valueOptions:NSPointerFunctionsStrongMemory];
+	}
+	return self;
+}
+
+- (void)dealloc
+{
+	free(_lengths);
+}
+
+- (void)addTrack:(MIKMIDITrack *)track
+{
+	if (!track || [_indexesByTrack objectForKey:track]) return;
+
+	NSUInteger index = [_tracks count];
+	if (index == _capacity) {
+		_capacity = _capacity ? _capacity * 2 : 16;
+		_lengths = realloc(_lengths, _capacity * sizeof(MusicTimeStamp));
+	}
+	[_tracks addObject:track];
+	_lengths[index] = track.length + track.offset;
+	[_indexesByTrack setObject:@(index) forKey:track];
+	[self siftUpFromIndex:index];
+}
+
+- (void)removeTrack:(MIKMIDITrack *)track
+{
+	NSNumber *indexNumber = track ? [_indexesByTrack objectForKey:track] : nil;
+	if (!indexNumber) return;
+
+	NSUInteger index = [indexNumber unsignedIntegerValue];
+	NSUInteger lastIndex = [_tracks count] - 1;
+	[self swapIndex:index withIndex:lastIndex];
+	[_tracks removeLastObject];
+	[_indexesByTrack removeObjectForKey:track];
+	if (index < lastIndex) {
+		[self siftUpFromIndex:index];
+		[self siftDownFromIndex:index];
+	}
+}
+
+- (void)removeAllTracks
+{
+	[_tracks removeAllObjects];
+	[_indexesByTrack removeAllObjects];
+}
+
+- (BOOL)updateLengthOfTrack:(MIKMIDITrack *)track
+{
+	NSNumber *indexNumber = track ? [_indexesByTrack objectForKey:track] : nil;
+	if (!indexNumber) return NO;
+
+	NSUInteger index = [indexNumber unsignedIntegerValue];
+	MusicTimeStamp oldLength = _lengths[index];
+	_lengths[index] = track.length + track.offset;
+	if (_lengths[index] > oldLength) {
+		[self siftUpFromIndex:index];
+	} else {
+		[self siftDownFromIndex:index];
+	}
+	return YES;
+}
+
+- (MusicTimeStamp)maximumLength
+{
+	return [_tracks count] ? MAX(_lengths[0], 0) : 0;
+}
+
+- (void)siftUpFromIndex:(NSUInteger)index
+{
+	while (index > 0) {
+		NSUInteger parent = (index - 1) / 2;
+		if (_lengths[parent] >= _lengths[index]) break;
+		[self swapIndex:index withIndex:parent];
+		index = parent;
+	}
+}
+
+- (void)siftDownFromIndex:(NSUInteger)index
+{
+	NSUInteger count = [_tracks count];
+	while (YES) {
+		NSUInteger largest = index;
+		NSUInteger left = 2 * index + 1, right = left + 1;
+		if (left < count && _lengths[left] > _lengths[largest]) largest = left;
+		if (right < count && _lengths[right] > _lengths[largest]) largest = right;
+		if (largest == index) break;
+		[self swapIndex:index withIndex:largest];
+		index = largest;
+	}
+}
+
+- (void)swapIndex:(NSUInteger)index1 withIndex:(NSUInteger)index2
+{
+	if (index1 == index2) return;
+	[_tracks exchangeObjectAtIndex:index1 withObjectAtIndex:index2];
+	MusicTimeStamp length = _lengths[index1];
+	_lengths[index1] = _lengths[index2];
+	_lengths[index2] = length;
+	[_indexesByTrack setObject:@(index1) forKey:_tracks[index1]];
+	[_indexesByTrack setObject:@(index2) forKey:_tracks[index2]];
+}
+
+@end
+
+#pragma mark -
+
 @interface MIKMIDISequence ()
 
 @property (nonatomic) MusicSequence musicSequence;
 @property (nonatomic, strong) MIKMIDITrack *tempoTrack;
 @property (nonatomic, strong) NSMutableArray *internalTracks;
 @property (nonatomic) MusicTimeStamp lengthDefinedByTracks;
+@property (nonatomic, strong) MIKMIDISequenceTrackLengthHeap *trackLengthHeap;
+
+@property (nonatomic) NSUInteger batchEditDepth;
+@property (nonatomic) BOOL needsLengthUpdate;
 
 @end
 
@@ -73,7 +233,7 @@ const MusicTimeStamp MIKMIDISequenceLongestTrackLength = -1;
 
 - (instancetype)initWithFileAtURL:(NSURL *)fileURL convertMIDIChannelsToTracks:(BOOL)convertMIDIChannelsToTracks error:(NSError **)error
 {
-	NSData *data = [NSData dataWithContentsOfURL:fileURL options:0 error:error];
+	NSData *data = [NSData dataWithContentsOfURL:fileURL options:NSDataReadingMappedIfSafe error:error];
 	if (!data) return nil;
 	return [self initWithData:data convertMIDIChannelsToTracks:convertMIDIChannelsToTracks error:error];
 }
@@ -97,6 +257,17 @@ const MusicTimeStamp MIKMIDISequenceLongestTrackLength = -1;
 {
 	error = error ?: &(NSError *__autoreleasing){ nil };
 	
+	// Files are read natively where possible. Files MIKMIDIFileParser can't read are left to MusicSequenceFileLoadData().
+	MIKMIDIFileParser *parser = [MIKMIDIFileParser parserWithData:data error:NULL];
+	MIKMIDIEventStore *tempoTrackEventStore = nil;
+	NSArray *eventStores = nil;
+	if (convertMIDIChannelsToTracks) {
+		eventStores = [parser eventStoresForChannelsWithTempoTrackEventStore:&tempoTrackEventStore error:NULL];
+	} else {
+		eventStores = [parser eventStoresForTracksWithTempoTrackEventStore:&tempoTrackEventStore error:NULL];
+	}
+	if (eventStores) return [self initWithFileParser:parser eventStores:eventStores tempoTrackEventStore:tempoTrackEventStore error:error];
+	
 	MusicSequence sequence;
 	OSStatus err = NewMusicSequence(&sequence);
 	if (err) {
@@ -116,6 +287,118 @@ const MusicTimeStamp MIKMIDISequenceLongestTrackLength = -1;
 	return [self initWithMusicSequence:sequence error:error];
 }
 
++ (instancetype)sequenceWithFileParser:(MIKMIDIFileParser *)parser error:(NSError **)error
+{
+	return [[self alloc] initWithFileParser:parser loadingTracksLazily:NO error:error];
+}
+
++ (instancetype)sequenceWithFileParser:(MIKMIDIFileParser *)parser loadingTracksLazily:(BOOL)loadsTracksLazily error:(NSError **)error
+{
+	return [[self alloc] initWithFileParser:parser loadingTracksLazily:loadsTracksLazily error:error];
+}
+
+- (instancetype)initWithFileParser:(MIKMIDIFileParser *)parser error:(NSError **)error
+{
+	return [self initWithFileParser:parser loadingTracksLazily:NO error:error];
+}
+
+- (instancetype)initWithFileParser:(MIKMIDIFileParser *)parser loadingTracksLazily:(BOOL)loadsTracksLazily error:(NSError **)error
+{
+	MIKMIDIEventStore *tempoTrackEventStore = nil;
+	if (loadsTracksLazily) {
+		NSArray *summaries = [parser summariesOfTracksWithTempoTrackEventStore:&tempoTrackEventStore error:error];
+		if (!summaries) return nil;
+
+		self = [self initWithNumberOfTracks:[summaries count] tempoTrackEventStore:tempoTrackEventStore timeResolution:(SInt16)parser.ticksPerQuarterNote error:error];
+		[self.internalTracks enumerateObjectsUsingBlock:^(MIKMIDITrack *track, NSUInteger idx, BOOL *stop) {
+			[track replaceEventsWithTrackOfFileParser:parser summary:summaries[idx]];
+		}];
+		return self;
+	}
+
+	NSArray *eventStores = [parser eventStoresForTracksWithTempoTrackEventStore:&tempoTrackEventStore error:error];
+	if (!eventStores) return nil;
+	return [self initWithFileParser:parser eventStores:eventStores tempoTrackEventStore:tempoTrackEventStore error:error];
+}
+
+- (instancetype)initWithFileParser:(MIKMIDIFileParser *)parser eventStores:(NSArray *)eventStores tempoTrackEventStore:(MIKMIDIEventStore *)tempoTrackEventStore error:(NSError **)error
+{
+	self = [self initWithNumberOfTracks:[eventStores count] tempoTrackEventStore:tempoTrackEventStore timeResolution:(SInt16)parser.ticksPerQuarterNote error:error];
+	[self.internalTracks enumerateObjectsUsingBlock:^(MIKMIDITrack *track, NSUInteger idx, BOOL *stop) {
+		[track replaceEventsWithEventStore:eventStores[idx]];
+	}];
+	return self;
+}
+
++ (instancetype)sequenceWithCacheAtURL:(NSURL *)cacheURL error:(NSError **)error
+{
+	return [[self alloc] initWithCacheAtURL:cacheURL error:error];
+}
+
+- (instancetype)initWithCacheAtURL:(NSURL *)cacheURL error:(NSError **)error
+{
+	error = error ?: &(NSError *__autoreleasing){ nil };
+	NSData *data = [NSData dataWithContentsOfURL:cacheURL options:NSDataReadingMappedIfSafe error:error];
+	if (!data) return nil;
+
+	const MIKMIDISequenceCacheHeader *header = [data bytes];
+	if ([data length] < sizeof(*header) || memcmp(header->magic, "MIKC", 4) || header->version != MIKMIDISequenceCacheVersion ||
+		header->cacheLength != [data length] || header->numberOfTracks > [data length] / sizeof(MIKMIDISequenceCacheHeader)) {
+		*error = [NSError MIKMIDIErrorWithCode:MIKMIDISequenceCacheReadingFailedErrorCode userInfo:nil];
+		return nil;
+	}
+
+	self = [self initWithNumberOfTracks:header->numberOfTracks tempoTrackEventStore:nil timeResolution:header->timeResolution error:error];
+	if (!self) return nil;
+
+	// Each track keeps the data, so the cache stays mapped for as long as its events are used
+	NSUInteger position = sizeof(*header);
+	BOOL success = [self.tempoTrack replaceEventsWithCacheData:data position:&position];
+	for (MIKMIDITrack *track in self.internalTracks) {
+		if (!success) break;
+		success = [track replaceEventsWithCacheData:data position:&position];
+	}
+	if (!success || position != [data length]) {
+		*error = [NSError MIKMIDIErrorWithCode:MIKMIDISequenceCacheReadingFailedErrorCode userInfo:nil];
+		return nil;
+	}
+	self.length = header->length;
+	return self;
+}
+
+// Creates a sequence with empty tracks, which the caller fills with events
+- (instancetype)initWithNumberOfTracks:(NSUInteger)numberOfTracks tempoTrackEventStore:(MIKMIDIEventStore *)tempoTrackEventStore timeResolution:(SInt16)timeResolution error:(NSError **)error
+{
+	error = error ?: &(NSError *__autoreleasing){ nil };
+	
+	MusicSequence sequence;
+	OSStatus err = NewMusicSequence(&sequence);
+	if (err) {
+		NSLog(@"NewMusicSequence() failed with error %@ in %s.", @(err), __PRETTY_FUNCTION__);
+		*error = [NSError errorWithDomain:NSOSStatusErrorDomain code:err userInfo:nil];
+		return nil;
+	}
+	
+	for (NSUInteger i = 0; i < numberOfTracks; i++) {
+		MusicTrack musicTrack;
+		err = MusicSequenceNewTrack(sequence, &musicTrack);
+		if (err) {
+			NSLog(@"MusicSequenceNewTrack() failed with error %@ in %s.", @(err), __PRETTY_FUNCTION__);
+			*error = [NSError errorWithDomain:NSOSStatusErrorDomain code:err userInfo:nil];
+			DisposeMusicSequence(sequence);
+			return nil;
+		}
+	}
+	
+	self = [self initWithMusicSequence:sequence error:error];
+	if (self) {
+		// The events are only written to the MusicSequence when it's needed
+		if (tempoTrackEventStore) [self.tempoTrack replaceEventsWithEventStore:tempoTrackEventStore];
+		self.fileTimeResolution = timeResolution;
+	}
+	return self;
+}
+
 + (instancetype)sequenceWithMusicSequence:(MusicSequence)musicSequence error:(NSError **)error
 {
 	return [[self alloc] initWithMusicSequence:musicSequence error:error];
@@ -133,6 +416,7 @@ const MusicTimeStamp MIKMIDISequenceLongestTrackLength = -1;
 			return nil;
 		}
 		self.musicSequence = musicSequence;
+		self.trackLengthHeap = [[MIKMIDISequenceTrackLengthHeap alloc] init];
 		
 		MusicTrack tempoTrack;
 		err = MusicSequenceGetTempoTrack(musicSequence, &tempoTrack);
@@ -176,7 +460,7 @@ const MusicTimeStamp MIKMIDISequenceLongestTrackLength = -1;
 	[self setCallBackBlock:^(MIKMIDITrack *t, MusicTimeStamp ts, const MusicEventUserData *ud, MusicTimeStamp ts2, MusicTimeStamp ts3) {}];
 	
 	for (MIKMIDITrack *track in tracks) {
-		OSStatus err = MusicSequenceDisposeTrack(_musicSequence, track.musicTrack);
+		OSStatus err = MusicSequenceDisposeTrack(_musicSequence, track.underlyingMusicTrack);
 		if (err) NSLog(@"MusicSequenceDisposeTrack() failed with error %@ in %s.", @(err), __PRETTY_FUNCTION__);
 	}
 	
@@ -207,7 +491,7 @@ const MusicTimeStamp MIKMIDISequenceLongestTrackLength = -1;
 	
 	[self dispatchSyncToSequencerProcessingQueueAsNeeded:^{
 		MusicTrack musicTrack;
-		OSStatus err = MusicSequenceNewTrack(self.musicSequence, &musicTrack);
+		OSStatus err = MusicSequenceNewTrack(self->_musicSequence, &musicTrack);
 		if (err) {
 			NSLog(@"MusicSequenceNewTrack() failed with error %@ in %s.", @(err), __PRETTY_FUNCTION__);
 			NSError *underlyingError = [NSError errorWithDomain:NSOSStatusErrorDomain code:err userInfo:nil];
@@ -235,7 +519,10 @@ const MusicTimeStamp MIKMIDISequenceLongestTrackLength = -1;
 	__block BOOL success = NO;
 	
 	[self dispatchSyncToSequencerProcessingQueueAsNeeded:^{
-		OSStatus err = MusicSequenceDisposeTrack(self.musicSequence, track.musicTrack);
+		// Commit pending edits while the track's MusicTrack still exists
+		for (NSUInteger i = 0; i < self.batchEditDepth; i++) [track endBatchEdits];
+
+		OSStatus err = MusicSequenceDisposeTrack(self->_musicSequence, track.underlyingMusicTrack);
 		if (err) return NSLog(@"MusicSequenceDisposeTrack() failed with error %@ in %s.", @(err), __PRETTY_FUNCTION__);
 		
 		NSInteger index = [self.internalTracks indexOfObject:track];
@@ -246,11 +533,302 @@ const MusicTimeStamp MIKMIDISequenceLongestTrackLength = -1;
 	return success;
 }
 
+- (BOOL)convertMIDIChannelsToTracksWithError:(NSError **)error
+{
+	error = error ?: &(NSError *__autoreleasing){ nil };
+	__block BOOL success = YES;
+	[self dispatchSyncToSequencerProcessingQueueAsNeeded:^{
+		NSMutableArray *channelEventStores = [NSMutableArray arrayWithCapacity:17];
+		for (NSUInteger i = 0; i < 17; i++) {
+			[channelEventStores addObject:[[MIKMIDIEventStore alloc] init]];
+		}
+		NSArray *tracks = [self.internalTracks copy];
+		for (MIKMIDITrack *track in tracks) {
+			[track addEventsToChannelEventStores:channelEventStores];
+		}
+
+		// The same tracks as when a file is loaded with convertMIDIChannelsToTracks
+		[self performBatchEdits:^{
+			for (MIKMIDITrack *track in tracks) {
+				[self removeTrack:track];
+			}
+			for (NSUInteger i = 0; i < 17 && success; i++) {
+				MIKMIDIEventStore *eventStore = channelEventStores[i];
+				if (!eventStore.count && i < 16) continue;
+				MIKMIDITrack *track = [self addTrackWithError:error];
+				[track replaceEventsWithEventStore:eventStore];
+				success = (track != nil);
+			}
+		}];
+	}];
+	return success;
+}
+
+#pragma mark - Merging
+
+static id MIKMIDISequenceTrackMatchingKey(MIKMIDITrack *track, NSUInteger index, MIKMIDISequenceTrackMatching trackMatching)
+{
+	switch (trackMatching) {
+		case MIKMIDISequenceTrackMatchingNone: return nil;
+		case MIKMIDISequenceTrackMatchingIndex: return @(index);
+		case MIKMIDISequenceTrackMatchingName: return track.name;
+		case MIKMIDISequenceTrackMatchingChannels: return [track.channels count] ? track.channels : nil;
+	}
+	return nil;
+}
+
+static NSUInteger MIKMIDISequenceGreatestCommonDivisor(NSUInteger a, NSUInteger b)
+{
+	while (b) {
+		NSUInteger remainder = a % b;
+		a = b;
+		b = remainder;
+	}
+	return a;
+}
+
++ (instancetype)sequenceByConcatenatingSequences:(NSArray *)sequences matchingTracksBy:(MIKMIDISequenceTrackMatching)trackMatching error:(NSError **)error
+{
+	return [self sequenceByMergingSequences:sequences concatenating:YES matchingTracksBy:trackMatching error:error];
+}
+
++ (instancetype)sequenceByOverlayingSequences:(NSArray *)sequences matchingTracksBy:(MIKMIDISequenceTrackMatching)trackMatching error:(NSError **)error
+{
+	return [self sequenceByMergingSequences:sequences concatenating:NO matchingTracksBy:trackMatching error:error];
+}
+
++ (instancetype)sequenceByMergingSequences:(NSArray *)sequences concatenating:(BOOL)concatenates matchingTracksBy:(MIKMIDISequenceTrackMatching)trackMatching error:(NSError **)error
+{
+	// For each track of the merged sequence, the event stores of the tracks combined into it, and the offset of each
+	NSMutableArray *eventStoresByTrack = [NSMutableArray array];
+	NSMutableArray *offsetsByTrack = [NSMutableArray array];
+	NSMutableArray *firstTracks = [NSMutableArray array];
+	NSMutableDictionary *trackIndexesByKey = [NSMutableDictionary dictionary];
+
+	NSMutableArray *tempoTrackEventStores = [NSMutableArray array];
+	NSMutableArray *tempoTrackOffsets = [NSMutableArray array];
+	NSMutableArray *stitchingEvents = [NSMutableArray array];
+	MusicTimeStamp offset = 0, length = 0;
+	BOOL hasFixedLength = NO;
+	NSUInteger timeResolution = 0, maximumTimeResolution = 0;
+
+	for (NSUInteger sequenceIndex = 0; sequenceIndex < [sequences count]; sequenceIndex++) {
+		MIKMIDISequence *sequence = sequences[sequenceIndex];
+		NSArray *tracks = sequence.tracks;
+		for (NSUInteger i = 0; i < [tracks count]; i++) {
+			MIKMIDITrack *track = tracks[i];
+			id key = MIKMIDISequenceTrackMatchingKey(track, i, trackMatching);
+			NSNumber *trackIndex = key ? trackIndexesByKey[key] : nil;
+			if (!trackIndex) {
+				trackIndex = @([firstTracks count]);
+				if (key) trackIndexesByKey[key] = trackIndex;
+				[eventStoresByTrack addObject:[NSMutableArray array]];
+				[offsetsByTrack addObject:[NSMutableArray array]];
+				[firstTracks addObject:track];
+			}
+			// Copies share the tracks' storage, so no events are copied until they're merged. Each track's own
+			// offset is applied to its events, as the tracks combined into a merged track may have different offsets.
+			[eventStoresByTrack[[trackIndex unsignedIntegerValue]] addObject:[track copyEventStore]];
+			[offsetsByTrack[[trackIndex unsignedIntegerValue]] addObject:@(offset + track.offset)];
+		}
+
+		if (concatenates || !sequenceIndex) {
+			[tempoTrackEventStores addObject:[sequence.tempoTrack copyEventStore]];
+			[tempoTrackOffsets addObject:@(offset)];
+			if (offset > 0) [stitchingEvents addObjectsFromArray:[sequence tempoTrackEventsForStartingAtTimeStamp:offset]];
+		}
+
+		// Time stamps are in beats, so only the resolution they're written to a file with has to be reconciled
+		NSUInteger sequenceTimeResolution = [sequence timeResolutionForWriting];
+		maximumTimeResolution = MAX(maximumTimeResolution, sequenceTimeResolution);
+		if (!timeResolution) {
+			timeResolution = sequenceTimeResolution;
+		} else if (timeResolution <= INT16_MAX) {
+			timeResolution = timeResolution / MIKMIDISequenceGreatestCommonDivisor(timeResolution, sequenceTimeResolution) * sequenceTimeResolution;
+		}
+
+		MusicTimeStamp sequenceLength = sequence.length;
+		hasFixedLength = hasFixedLength || (sequence->_length != MIKMIDISequenceLongestTrackLength);
+		if (concatenates) {
+			offset += sequenceLength;
+			length = offset;
+		} else {
+			length = MAX(length, sequenceLength);
+		}
+	}
+	if (timeResolution > INT16_MAX) timeResolution = maximumTimeResolution;
+
+	MIKMIDIEventStore *tempoTrackEventStore = [MIKMIDIEventStore eventStoreByMergingEventStores:tempoTrackEventStores offsets:tempoTrackOffsets];
+	for (MIKMIDIEvent *event in stitchingEvents) {
+		[tempoTrackEventStore addEvent:event];
+	}
+
+	MIKMIDISequence *result = [[self alloc] initWithNumberOfTracks:[firstTracks count] tempoTrackEventStore:tempoTrackEventStore timeResolution:(SInt16)timeResolution error:error];
+	if (!result) return nil;
+
+	[result.internalTracks enumerateObjectsUsingBlock:^(MIKMIDITrack *track, NSUInteger idx, BOOL *stop) {
+		[track replaceEventsWithEventStore:[MIKMIDIEventStore eventStoreByMergingEventStores:eventStoresByTrack[idx] offsets:offsetsByTrack[idx]]];
+		MIKMIDITrack *firstTrack = firstTracks[idx];
+		if (firstTrack.isMuted) track.muted = YES;
+		if (firstTrack.isSolo) track.solo = YES;
+	}];
+	if (hasFixedLength) result.length = length;
+	return result;
+}
+
+// The events that keep the sequence's start from playing at the tempo or time signature the sequence before it
+// ends with, when it's concatenated at timeStamp, for the tempo or time signature the sequence doesn't set at its start
+- (NSArray *)tempoTrackEventsForStartingAtTimeStamp:(MusicTimeStamp)timeStamp
+{
+	NSMutableArray *events = [NSMutableArray array];
+	if (![[self.tempoTrack eventsOfClass:[MIKMIDITempoEvent class] fromTimeStamp:0 toTimeStamp:0] count]) {
+		[events addObject:[MIKMIDITempoEvent tempoEventWithTimeStamp:timeStamp tempo:120]];
+	}
+	if (![[self.tempoTrack eventsOfClass:[MIKMIDIMetaTimeSignatureEvent class] fromTimeStamp:0 toTimeStamp:0] count]) {
+		MIKMutableMIDIMetaTimeSignatureEvent *event = [[MIKMutableMIDIMetaTimeSignatureEvent alloc] init];
+		event.timeStamp = timeStamp;
+		event.numerator = 4;
+		event.denominator = 4;
+		event.metronomePulse = 24;
+		event.thirtySecondsPerQuarterNote = 8;
+		[events addObject:event];
+	}
+	return events;
+}
+
+#pragma mark - Batch Editing
+
+- (void)performBatchEdits:(void (^)(void))edits
+{
+	if (!edits) return;
+
+	[self dispatchSyncToSequencerProcessingQueueAsNeeded:^{
+		NSMutableArray *tracks = [NSMutableArray arrayWithArray:self.internalTracks];
+		if (self.tempoTrack) [tracks addObject:self.tempoTrack];
+
+		self.batchEditDepth++;
+		for (MIKMIDITrack *track in tracks) [track beginBatchEdits];
+
+		edits();
+
+		// Tracks removed during the batch have already been committed by -removeTrack:
+		for (MIKMIDITrack *track in tracks) {
+			if (track == self.tempoTrack || [self.internalTracks containsObject:track]) [track endBatchEdits];
+		}
+		self.batchEditDepth--;
+
+		if (!self.batchEditDepth && self.needsLengthUpdate) {
+			self.needsLengthUpdate = NO;
+			[self updateLengthDefinedByTracks];
+		}
+	}];
+}
+
+- (void)applyNoteTransform:(MIKMIDINoteTransform *)transform
+{
+	if (!transform) return;
+
+	[self performBatchEdits:^{
+		[MIKMIDITrack applyNoteTransform:transform toTracks:[self.internalTracks copy]];
+	}];
+}
+
+#pragma mark - MusicSequence Synchronization
+
+- (void)synchronizeMusicSequence
+{
+	[self dispatchSyncToSequencerProcessingQueueAsNeeded:^{
+		[self.tempoTrack synchronizeMusicTrackIfNeeded];
+		for (MIKMIDITrack *track in self.internalTracks) {
+			[track synchronizeMusicTrackIfNeeded];
+		}
+	}];
+}
+
 #pragma mark - File Saving
 
 - (BOOL)writeToURL:(NSURL *)fileURL error:(NSError *__autoreleasing *)error
 {
-	return [self.dataValue writeToURL:fileURL options:NSDataWritingAtomic error:error];
+	error = error ?: &(NSError *__autoreleasing){ nil };
+	if (![fileURL isFileURL]) {
+		*error = [NSError MIKMIDIErrorWithCode:MIKMIDIInvalidArgumentError userInfo:nil];
+		return NO;
+	}
+
+	// Like NSDataWritingAtomic, the file is streamed to a temporary file, which then replaces the destination
+	NSString *path = [fileURL path];
+	NSString *temporaryFileName = [NSString stringWithFormat:@".%@.XXXXXX", [path lastPathComponent]];
+	char *temporaryPath = strdup([[[path stringByDeletingLastPathComponent] stringByAppendingPathComponent:temporaryFileName] fileSystemRepresentation]);
+	int fileDescriptor = mkstemp(temporaryPath);
+	if (fileDescriptor < 0) {
+		*error = [NSError errorWithDomain:NSPOSIXErrorDomain code:errno userInfo:nil];
+		free(temporaryPath);
+		return NO;
+	}
+	fchmod(fileDescriptor, 0644);
+
+	MIKMIDIFileWriter *writer = [[MIKMIDIFileWriter alloc] initWithFileDescriptor:fileDescriptor format:MIKMIDIFileFormatMultipleTracks ticksPerQuarterNote:[self timeResolutionForWriting] error:error];
+	BOOL success = writer && [self writeToFileWriter:writer error:error];
+	if (close(fileDescriptor) && success) {
+		*error = [NSError errorWithDomain:NSPOSIXErrorDomain code:errno userInfo:nil];
+		success = NO;
+	}
+	if (success && rename(temporaryPath, [path fileSystemRepresentation])) {
+		*error = [NSError errorWithDomain:NSPOSIXErrorDomain code:errno userInfo:nil];
+		success = NO;
+	}
+	if (!success) unlink(temporaryPath);
+	free(temporaryPath);
+	return success;
+}
+
+- (BOOL)writeToFileWriter:(MIKMIDIFileWriter *)writer error:(NSError **)error
+{
+	__block BOOL success = NO;
+	[self dispatchSyncToSequencerProcessingQueueAsNeeded:^{
+		// Like MusicSequenceFileCreateData(), the tempo track is written first
+		if (![self.tempoTrack writeEventsToFileWriter:writer error:error]) return;
+		for (MIKMIDITrack *track in self.internalTracks) {
+			if (![track writeEventsToFileWriter:writer error:error]) return;
+		}
+		success = [writer finishWithError:error];
+	}];
+	return success;
+}
+
+- (BOOL)writeCacheToURL:(NSURL *)cacheURL error:(NSError **)error
+{
+	error = error ?: &(NSError *__autoreleasing){ nil };
+	if (![cacheURL isFileURL]) {
+		*error = [NSError MIKMIDIErrorWithCode:MIKMIDIInvalidArgumentError userInfo:nil];
+		return NO;
+	}
+
+	NSMutableData *data = [NSMutableData dataWithLength:sizeof(MIKMIDISequenceCacheHeader)];
+	[self dispatchSyncToSequencerProcessingQueueAsNeeded:^{
+		NSArray *tracks = self.internalTracks;
+		[self.tempoTrack appendCacheRepresentationToData:data];
+		for (MIKMIDITrack *track in tracks) {
+			[track appendCacheRepresentationToData:data];
+		}
+
+		MIKMIDISequenceCacheHeader header = {
+			.magic = { 'M', 'I', 'K', 'C' },
+			.version = MIKMIDISequenceCacheVersion,
+			.cacheLength = [data length],
+			.length = self->_length,
+			.timeResolution = (SInt16)[self timeResolutionForWriting],
+			.numberOfTracks = (UInt32)[tracks count],
+		};
+		[data replaceBytesInRange:NSMakeRange(0, sizeof(header)) withBytes:&header];
+	}];
+	return [data writeToURL:cacheURL options:NSDataWritingAtomic error:error];
+}
+
+- (UInt16)timeResolutionForWriting
+{
+	SInt16 timeResolution = self.tempoTrack.timeResolution;
+	return (timeResolution > 0) ? (UInt16)timeResolution : 480;
 }
 
 #pragma mark - Callback
@@ -377,21 +955,19 @@ static void MIKSequenceCallback(void *inClientData, MusicSequence inSequence, Mu
 		return;
 	}
 	
-	if ([self.internalTracks containsObject:object] &&
-		([keyPath isEqualToString:@"length"] || [keyPath isEqualToString:@"offset"])) {
+	if (([keyPath isEqualToString:@"length"] || [keyPath isEqualToString:@"offset"]) &&
+		[self.trackLengthHeap updateLengthOfTrack:object]) {
+		if (self.batchEditDepth) {
+			self.needsLengthUpdate = YES; // Recalculated once, when the batch ends
+			return;
+		}
 		[self updateLengthDefinedByTracks];
 	}
 }
 
 - (void)updateLengthDefinedByTracks
 {
-	MusicTimeStamp length = 0;
-	for (MIKMIDITrack *track in self.tracks) {
-		MusicTimeStamp trackLength = track.length + track.offset;
-		if (trackLength > length) length = trackLength;
-	}
-	
-	self.lengthDefinedByTracks = length;
+	self.lengthDefinedByTracks = self.trackLengthHeap.maximumLength;
 }
 
 #pragma mark - Properties
@@ -405,8 +981,10 @@ static void MIKSequenceCallback(void *inClientData, MusicSequence inSequence, Mu
 		}
 		
 		_internalTracks = internalTracks;
+		[self.trackLengthHeap removeAllTracks];
 		
 		for (MIKMIDITrack *track in _internalTracks) {
+			[self.trackLengthHeap addTrack:track];
 			[track addObserver:self forKeyPath:@"length" options:NSKeyValueObservingOptionInitial context:MIKMIDISequenceKVOContext];
 			[track addObserver:self forKeyPath:@"offset" options:NSKeyValueObservingOptionInitial context:MIKMIDISequenceKVOContext];
 		}
@@ -420,6 +998,7 @@ static void MIKSequenceCallback(void *inClientData, MusicSequence inSequence, Mu
 	[self willChange:NSKeyValueChangeInsertion valuesAtIndexes:[NSIndexSet indexSetWithIndex:index] forKey:@"tracks"];
 	[self.internalTracks insertObject:track atIndex:index];
 	[self didChange:NSKeyValueChangeInsertion valuesAtIndexes:[NSIndexSet indexSetWithIndex:index] forKey:@"tracks"];
+	[self.trackLengthHeap addTrack:track];
 	[track addObserver:self forKeyPath:@"length" options:NSKeyValueObservingOptionInitial context:MIKMIDISequenceKVOContext];
 	[track addObserver:self forKeyPath:@"offset" options:NSKeyValueObservingOptionInitial context:MIKMIDISequenceKVOContext];
 }
@@ -433,11 +1012,30 @@ static void MIKSequenceCallback(void *inClientData, MusicSequence inSequence, Mu
 	[self didChange:NSKeyValueChangeRemoval valuesAtIndexes:[NSIndexSet indexSetWithIndex:index] forKey:@"tracks"];
 	[track removeObserver:self forKeyPath:@"length"];
 	[track removeObserver:self forKeyPath:@"offset"];
-	[self updateLengthDefinedByTracks];
+	[self.trackLengthHeap removeTrack:track];
+	if (self.batchEditDepth) {
+		self.needsLengthUpdate = YES;
+	} else {
+		[self updateLengthDefinedByTracks];
+	}
 }
 
 + (BOOL)automaticallyNotifiesObserversOfTracks { return NO; }
 
+- (MusicSequence)musicSequence
+{
+	[self synchronizeMusicSequence];
+	return _musicSequence;
+}
+
+- (void)setSynchronizesMusicSequenceLazily:(BOOL)synchronizesMusicSequenceLazily
+{
+	[self dispatchSyncToSequencerProcessingQueueAsNeeded:^{
+		self->_synchronizesMusicSequenceLazily = synchronizesMusicSequenceLazily;
+	}];
+	if (!synchronizesMusicSequenceLazily) [self synchronizeMusicSequence];
+}
+
 - (NSArray *)tracks
 {
 	__block NSArray *tracks;
@@ -480,22 +1078,28 @@ static void MIKSequenceCallback(void *inClientData, MusicSequence inSequence, Mu
 
 - (Float64)durationInSeconds
 {
+	// Only the tempo track affects the conversion, so there's no need to synchronize the other tracks
+	[self dispatchSyncToSequencerProcessingQueueAsNeeded:^{
+		[self.tempoTrack synchronizeMusicTrackIfNeeded];
+	}];
+
 	Float64 duration = 0;
-	OSStatus err = MusicSequenceGetSecondsForBeats(self.musicSequence, self.length, &duration);
+	OSStatus err = MusicSequenceGetSecondsForBeats(_musicSequence, self.length, &duration);
 	if (err) NSLog(@"MusicSequenceGetSecondsForBeats() failed with error %@ in %s.", @(err), __PRETTY_FUNCTION__);
 	return duration;
 }
 
 - (NSData *)dataValue
 {
-	CFDataRef data;
-	OSStatus err = MusicSequenceFileCreateData(self.musicSequence, kMusicSequenceFile_MIDIType, 0, 0, &data);
-	if (err) {
-		NSLog(@"MusicSequenceFileCreateData() failed with error %@ in %s.", @(err), __PRETTY_FUNCTION__);
+	NSMutableData *data = [NSMutableData data];
+	MIKMIDIFileWriter *writer = [[MIKMIDIFileWriter alloc] initWithMutableData:data format:MIKMIDIFileFormatMultipleTracks ticksPerQuarterNote:[self timeResolutionForWriting]];
+	NSError *error = nil;
+	if (![self writeToFileWriter:writer error:&error]) {
+		NSLog(@"Writing %@ as a MIDI file failed with error %@ in %s.", self, error, __PRETTY_FUNCTION__);
 		return nil;
 	}
 	
-	return (__bridge_transfer NSData *)data;
+	return data;
 }
 
 #pragma mark - Deprecated
@@ -9,6 +9,7 @@
 #import <Foundation/Foundation.h>
 #import <AudioToolbox/AudioToolbox.h>
 #import "MIKMIDICompilerCompatibility.h"
+#import "MIKMIDITimeSource.h"
 
 @class MIKMIDISequence;
 @class MIKMIDITrack;
@@ -18,6 +19,7 @@
 @class MIKMIDISynthesizer;
 @class MIKMIDIClock;
 @protocol MIKMIDICommandScheduler;
+@protocol MIKMIDIEventSource;
 
 /**
  *  Types of click track statuses, that determine when the click track will be audible.
@@ -119,6 +121,20 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (void)stopAllPlayingNotesForCommandScheduler:(id<MIKMIDICommandScheduler>)scheduler;
 
+#pragma mark - Gapless Playback
+
+/**
+ *  Reads a MIDI file on a background queue, using MIKMIDIFileParser, and sets the sequence read from it
+ *  as the sequence to play after the current one, as setting nextSequence does.
+ *
+ *  @param fileURL The URL of a standard MIDI file.
+ *  @param completionHandler A block called on a background queue once the sequence has been set as the next sequence,
+ *  or the file couldn't be read. May be nil.
+ *
+ *  @see nextSequence
+ */
+- (void)setNextSequenceWithFileAtURL:(NSURL *)fileURL completionHandler:(nullable void (^)(MIKMIDISequence *_Nullable sequence, NSError *_Nullable error))completionHandler;
+
 /**
  *	Allows subclasses to modify the MIDI commands that are about to be
  *	scheduled with a command scheduler.
@@ -255,6 +271,33 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (nullable MIKMIDISynthesizer *)builtinSynthesizerForTrack:(MIKMIDITrack *)track;
 
+/**
+ *  Sets the command scheduler for an event source, adding the event source to the sources
+ *  the receiver plays if it isn't one of them yet.
+ *
+ *  While the receiver plays, it asks each of its event sources for events in the same way as
+ *  it reads events from the tracks of its sequence, and schedules them with the source's command
+ *  scheduler. Event sources aren't affected by the muted and solo properties of tracks.
+ *
+ *  @param commandScheduler An object that conforms to MIKMIDICommandScheduler with which events
+ *	from eventSource should be scheduled during playback. Pass nil to remove eventSource from the receiver.
+ *  @param eventSource An object that conforms to MIKMIDIEventSource. The receiver keeps a strong reference to it.
+ *
+ *  @see eventSources
+ */
+- (void)setCommandScheduler:(nullable id<MIKMIDICommandScheduler>)commandScheduler forEventSource:(id<MIKMIDIEventSource>)eventSource;
+
+/**
+ *  Returns the command scheduler for an event source.
+ *
+ *  @param eventSource An object that conforms to MIKMIDIEventSource.
+ *
+ *  @return The command scheduler associated with eventSource, or nil if eventSource isn't one of the receiver's event sources.
+ *
+ *  @see -setCommandScheduler:forEventSource:
+ */
+- (nullable id<MIKMIDICommandScheduler>)commandSchedulerForEventSource:(id<MIKMIDIEventSource>)eventSource;
+
 #pragma mark - Properties
 
 /**
@@ -262,6 +305,30 @@ NS_ASSUME_NONNULL_BEGIN
  */
 @property (nonatomic, strong) MIKMIDISequence *sequence;
 
+/**
+ *  The sequence to play straight after the current sequence ends, without stopping. This can be observed with KVO.
+ *
+ *  When it is set, command schedulers are found for the tracks of the sequence that have events, creating
+ *  synthesizers for them if createSynthsIfNeeded is YES, and tracks that are loaded lazily have their events
+ *  loaded. As that can take a while, set it on a background thread while the current sequence plays.
+ *
+ *  When playback reaches the end of the current sequence, as given by its length or by overriddenSequenceLength,
+ *  the sequencer sends the pending note offs, makes nextSequence its sequence, and carries on from its start at the
+ *  exact time the previous sequence ended, without stopping or restarting its clock. This happens up to
+ *  maximumLookAheadInterval before the end is heard, and MIKMIDISequencerWillStartNextSequenceNotification is
+ *  posted when it does. The next sequence isn't started while looping or recording.
+ *
+ *  @see -setNextSequenceWithFileAtURL:completionHandler:
+ */
+@property (nonatomic, strong, nullable) MIKMIDISequence *nextSequence;
+
+/**
+ *  The event sources played by the receiver, in the order they were added.
+ *
+ *  @see -setCommandScheduler:forEventSource:
+ */
+@property (nonatomic, readonly) MIKArrayOf(id<MIKMIDIEventSource>) *eventSources;
+
 /**
  *	Whether or not the sequencer is currently playing. This can be observed with KVO.
  *
@@ -318,6 +385,18 @@ NS_ASSUME_NONNULL_BEGIN
  */
 @property (nonatomic) MusicTimeStamp preRoll;
 
+/**
+ *  Whether notes that started before the position playback starts from, and are still sounding
+ *  there, should be played when playback starts. For example, when playback starts in the middle
+ *  of a held chord, the chord is heard right away, instead of only from the next note on.
+ *
+ *  Chased notes are re-triggered at the start of playback, and end when they would have if
+ *  playback had started before them. The default is NO.
+ *
+ *  @see -[MIKMIDITrack notesSoundingAtTimeStamp:]
+ */
+@property (nonatomic, getter=shouldChaseNotes) BOOL chaseNotes;
+
 /**
  *  Whether or not playback should loop when between loopStartTimeStamp and loopEndTimeStamp.
  *
@@ -428,6 +507,20 @@ NS_ASSUME_NONNULL_BEGIN
  */
 @property (nonatomic) NSTimeInterval maximumLookAheadInterval;
 
+/**
+ *  The time source the sequencer uses to determine the current time when scheduling
+ *  and stopping playback. The sequencer's clock uses the same time source.
+ *
+ *  Defaults to the value of MIKMIDIDefaultTimeSource() at the time the sequencer was
+ *  created. Setting this to nil restores that default. Sources with a rate other than 1
+ *  also scale how often the sequencer processes upcoming events, so an
+ *  MIKMIDIAcceleratedTimeSource can be used to play a sequence faster than real time.
+ *  Changing this while the sequencer is playing is not supported.
+ *
+ *  @see MIKMIDITimeSource
+ */
+@property (nonatomic, strong, null_resettable) id<MIKMIDITimeSource> timeSource;
+
 #pragma mark - Deprecated
 
 /**
@@ -474,6 +567,13 @@ NS_ASSUME_NONNULL_BEGIN
  */
 FOUNDATION_EXPORT NSString * const MIKMIDISequencerWillLoopNotification;
 
+/**
+ *  Sent out shortly before playback moves on to the next sequence.
+ *
+ *  @see nextSequence
+ */
+FOUNDATION_EXPORT NSString * const MIKMIDISequencerWillStartNextSequenceNotification;
+
 /**
  *	Set loopEndTimeStamp to this to have the loop end at the end of the
  *	sequence regardless of sequence length.
@@ -24,6 +24,8 @@
 #import "MIKMIDISequencer+MIKMIDIPrivate.h"
 #import "MIKMIDISequence+MIKMIDIPrivate.h"
 #import "MIKMIDICommandScheduler.h"
+#import "MIKMIDIEventSource.h"
+#import "MIKMIDIFileParser.h"
 #import "MIKMIDIDestinationEndpoint.h"
 #import "MIKMIDIControlChangeCommand.h"
 #import "MIKMIDIControlChangeEvent.h"
@@ -36,6 +38,7 @@
 #define kDefaultTempo	120
 
 NSString * const MIKMIDISequencerWillLoopNotification = @"MIKMIDISequencerWillLoopNotification";
+NSString * const MIKMIDISequencerWillStartNextSequenceNotification = @"MIKMIDISequencerWillStartNextSequenceNotification";
 const MusicTimeStamp MIKMIDISequencerEndOfSequenceLoopEndTimeStamp = -1;
 
 
@@ -90,6 +93,12 @@ const MusicTimeStamp MIKMIDISequencerEndOfSequenceLoopEndTimeStamp = -1;
 @property (nonatomic, strong) NSMapTable *tracksToDestinationsMap;
 @property (nonatomic, strong) NSMapTable *tracksToDefaultSynthsMap;
 
+@property (nonatomic, strong) NSMutableArray *internalEventSources;
+@property (nonatomic, strong) NSMapTable *eventSourcesToDestinationsMap;
+@property (nonatomic) MusicTimeStamp eventSourcesTimeStamp; // Where the next range of events from event sources starts
+
+@property (nonatomic, strong) MIKMIDISequence *previousSequence; // Its tracks' synthesizers may still have notes to play
+
 @property (nonatomic) BOOL needsCurrentTempoUpdate;
 
 @property (readonly, nonatomic) MusicTimeStamp sequenceLength;
@@ -109,12 +118,15 @@ const MusicTimeStamp MIKMIDISequencerEndOfSequenceLoopEndTimeStamp = -1;
     if (self = [super init]) {
         self.sequence = sequence;
         _clock = [MIKMIDIClock clock];
+        _timeSource = _clock.timeSource;
         _syncedClock = [_clock syncedClock];
         _loopEndTimeStamp = MIKMIDISequencerEndOfSequenceLoopEndTimeStamp;
         _preRoll = 4;
         _clickTrackStatus = MIKMIDISequencerClickTrackStatusEnabledInRecord;
         _tracksToDestinationsMap = [NSMapTable mapTableWithKeyOptions:NSPointerFunctionsStrongMemory valueOptions:NSPointerFunctionsStrongMemory];
         _tracksToDefaultSynthsMap = [NSMapTable mapTableWithKeyOptions:NSPointerFunctionsStrongMemory valueOptions:NSPointerFunctionsStrongMemory];
+        _internalEventSources = [NSMutableArray array];
+        _eventSourcesToDestinationsMap = [NSMapTable mapTableWithKeyOptions:NSPointerFunctionsStrongMemory valueOptions:NSPointerFunctionsStrongMemory];
         _createSynthsIfNeeded = YES;
         _processingQueueKey = &_processingQueueKey;
         _processingQueueContext = &_processingQueueContext;
@@ -158,7 +170,7 @@ const MusicTimeStamp MIKMIDISequencerEndOfSequenceLoopEndTimeStamp = -1;
 
 - (void)startPlaybackAtTimeStamp:(MusicTimeStamp)timeStamp adjustForPreRollWhenRecording:(BOOL)adjustForPreRoll
 {
-    MIDITimeStamp midiTimeStamp = MIKMIDIGetCurrentTimeStamp() + MIKMIDIClockMIDITimeStampsPerTimeInterval(0.001);
+    MIDITimeStamp midiTimeStamp = [self.timeSource currentMIDITimeStamp] + MIKMIDIClockMIDITimeStampsPerTimeInterval(0.001);
     [self startPlaybackAtTimeStamp:timeStamp MIDITimeStamp:midiTimeStamp];
 }
 
@@ -190,6 +202,7 @@ const MusicTimeStamp MIKMIDISequencerEndOfSequenceLoopEndTimeStamp = -1;
     dispatch_sync(queue, ^{
         self.startingTimeStamp = timeStamp;
         self.initialStartingTimeStamp = timeStamp;
+        self.eventSourcesTimeStamp = MAX(timeStamp, 0);
 
         Float64 startingTempo = [self.sequence tempoAtTimeStamp:timeStamp];
         if (!startingTempo) startingTempo = kDefaultTempo;
@@ -201,11 +214,15 @@ const MusicTimeStamp MIKMIDISequencerEndOfSequenceLoopEndTimeStamp = -1;
     dispatch_sync(queue, ^{
         self.pendingNoteOffs = [NSMutableDictionary dictionary];
         self.latestScheduledMIDITimeStamp = midiTimeStamp;
+        if (self.shouldChaseNotes) [self scheduleNotesSoundingAtTimeStamp:timeStamp];
         dispatch_source_t timer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, self.processingQueue);
         if (!timer) return NSLog(@"Unable to create processing timer for %@.", [self class]);
         self.processingTimer = timer;
 
-        dispatch_source_set_timer(timer, DISPATCH_TIME_NOW, 0.05 * NSEC_PER_SEC, 0.05 * NSEC_PER_SEC);
+        // Process more often when the time source runs faster than real time
+        Float64 timeSourceRate = self.timeSource.rate;
+        NSTimeInterval processingInterval = (timeSourceRate > 1.0) ? (0.05 / timeSourceRate) : 0.05;
+        dispatch_source_set_timer(timer, DISPATCH_TIME_NOW, processingInterval * NSEC_PER_SEC, processingInterval * NSEC_PER_SEC);
         dispatch_source_set_event_handler(timer, ^{
             [self processSequenceStartingFromMIDITimeStamp:self.latestScheduledMIDITimeStamp];
         });
@@ -228,7 +245,7 @@ const MusicTimeStamp MIKMIDISequencerEndOfSequenceLoopEndTimeStamp = -1;
 {
     [self dispatchSyncToProcessingQueueAsNeeded:^{
         NSMutableArray *commandsToSendNow = [NSMutableArray array];
-        MIDITimeStamp offTimeStamp = MIKMIDIGetCurrentTimeStamp() + MIKMIDIClockMIDITimeStampsPerTimeInterval(self.maximumLookAheadInterval);
+        MIDITimeStamp offTimeStamp = [self.timeSource currentMIDITimeStamp] + MIKMIDIClockMIDITimeStampsPerTimeInterval(self.maximumLookAheadInterval);
 
         for (MIKMIDIPendingNoteOffsForTimeStamp *pendingNoteOffsForTimeStamp in self.pendingNoteOffs.allValues) {
             NSMutableArray *noteEvents = pendingNoteOffsForTimeStamp.noteEventsWithEndTimeStamp;
@@ -254,7 +271,8 @@ const MusicTimeStamp MIKMIDISequencerEndOfSequenceLoopEndTimeStamp = -1;
 
 - (void)stopWithDispatchToProcessingQueue:(BOOL)dispatchToProcessingQueue
 {
-    MIDITimeStamp stopTimeStamp = MIKMIDIGetCurrentTimeStamp();
+    id<MIKMIDITimeSource> timeSource = self.timeSource;
+    MIDITimeStamp stopTimeStamp = [timeSource currentMIDITimeStamp];
     if (!self.isPlaying) return;
 
     void (^stopPlayback)(void) = ^{
@@ -262,10 +280,11 @@ const MusicTimeStamp MIKMIDISequencerEndOfSequenceLoopEndTimeStamp = -1;
 
         MIKMIDIClock *clock = self.clock;
         [self recordAllPendingNoteEventsWithOffTimeStamp:[clock musicTimeStampForMIDITimeStamp:stopTimeStamp]];
-        MusicTimeStamp allPendingNotesOffTimeStamp = MAX(self.latestScheduledMIDITimeStamp + 1, MIKMIDIGetCurrentTimeStamp() + MIKMIDIClockMIDITimeStampsPerTimeInterval(0.001));
+        MusicTimeStamp allPendingNotesOffTimeStamp = MAX(self.latestScheduledMIDITimeStamp + 1, [timeSource currentMIDITimeStamp] + MIKMIDIClockMIDITimeStampsPerTimeInterval(0.001));
         [self sendAllPendingNoteOffsWithMIDITimeStamp:allPendingNotesOffTimeStamp];
         self.pendingRecordedNoteEvents = nil;
         self.looping = NO;
+        self.previousSequence = nil;
 
         MusicTimeStamp stopMusicTimeStamp = [clock musicTimeStampForMIDITimeStamp:stopTimeStamp];
         self->_currentTimeStamp = (stopMusicTimeStamp <= self.sequenceLength) ? stopMusicTimeStamp : self.sequenceLength;
@@ -282,7 +301,9 @@ const MusicTimeStamp MIKMIDISequencerEndOfSequenceLoopEndTimeStamp = -1;
 
 - (void)processSequenceStartingFromMIDITimeStamp:(MIDITimeStamp)fromMIDITimeStamp
 {
-    MIDITimeStamp toMIDITimeStamp = MIKMIDIGetCurrentTimeStamp() + MIKMIDIClockMIDITimeStampsPerTimeInterval(self.maximumLookAheadInterval);
+    id<MIKMIDITimeSource> timeSource = self.timeSource;
+    MIDITimeStamp currentMIDITimeStamp = [timeSource currentMIDITimeStamp]; // Read once for the whole pass, not for every time stamp
+    MIDITimeStamp toMIDITimeStamp = currentMIDITimeStamp + MIKMIDIClockMIDITimeStampsPerTimeInterval(self.maximumLookAheadInterval);
     if (toMIDITimeStamp < fromMIDITimeStamp) return;
     MIKMIDIClock *clock = self.clock;
 
@@ -340,19 +361,7 @@ const MusicTimeStamp MIKMIDISequencerEndOfSequenceLoopEndTimeStamp = -1;
     }
 
     // Get other events
-    NSMutableArray *nonMutedTracks = [[NSMutableArray alloc] init];
-    NSMutableArray *soloTracks = [[NSMutableArray alloc] init];
-    for (MIKMIDITrack *track in sequence.tracks) {
-        if (track.isMuted) continue;
-
-        [nonMutedTracks addObject:track];
-        if (track.solo) { [soloTracks addObject:track]; }
-    }
-
-    // Never play muted tracks. If any non-muted tracks are soloed, only play those. Matches MusicPlayer behavior
-    NSArray *tracksToPlay = soloTracks.count != 0 ? soloTracks : nonMutedTracks;
-
-    for (MIKMIDITrack *track in tracksToPlay) {
+    for (MIKMIDITrack *track in [self tracksToPlay]) {
         MusicTimeStamp startTimeStamp = MAX(fromMusicTimeStamp - track.offset, 0);
         MusicTimeStamp endTimeStamp = toMusicTimeStamp - track.offset;
         NSArray *events = [track eventsFromTimeStamp:startTimeStamp toTimeStamp:endTimeStamp];
@@ -377,6 +386,23 @@ const MusicTimeStamp MIKMIDISequencerEndOfSequenceLoopEndTimeStamp = -1;
         }
     }
 
+    // Get events from event sources, which are asked for each range of time only once
+    MusicTimeStamp eventSourcesFromTimeStamp = self.eventSourcesTimeStamp;
+    if (toMusicTimeStamp > eventSourcesFromTimeStamp) {
+        NSMapTable *eventSourcesToDestinationsMap = self.eventSourcesToDestinationsMap;
+        for (id<MIKMIDIEventSource> eventSource in self.internalEventSources) {
+            id<MIKMIDICommandScheduler> destination = [eventSourcesToDestinationsMap objectForKey:eventSource];
+            for (MIKMIDIEvent *event in [eventSource eventsFromTimeStamp:eventSourcesFromTimeStamp toTimeStamp:toMusicTimeStamp]) {
+                if ([event isKindOfClass:[MIKMIDINoteEvent class]] && [(MIKMIDINoteEvent *)event duration] <= 0) continue;
+                NSNumber *timeStampKey = @(event.timeStamp);
+                NSMutableArray *eventsAtTimeStamp = allEventsByTimeStamp[timeStampKey] ? allEventsByTimeStamp[timeStampKey] : [NSMutableArray array];
+                [eventsAtTimeStamp addObject:[MIKMIDIEventWithDestination eventWithDestination:destination event:event]];
+                allEventsByTimeStamp[timeStampKey] = eventsAtTimeStamp;
+            }
+        }
+        self.eventSourcesTimeStamp = toMusicTimeStamp;
+    }
+
     // Get click track events
     for (MIKMIDIEventWithDestination *destinationEvent in [self clickTrackEventsFromTimeStamp:fromMusicTimeStamp toTimeStamp:toMusicTimeStamp]) {
         NSNumber *timeStampKey = @(destinationEvent.event.timeStamp);
@@ -386,11 +412,29 @@ const MusicTimeStamp MIKMIDISequencerEndOfSequenceLoopEndTimeStamp = -1;
     }
 
     // Schedule events
-    for (NSNumber *timeStampKey in [allEventsByTimeStamp.allKeys sortedArrayUsingSelector:@selector(compare:)]) {
-        MusicTimeStamp musicTimeStamp = timeStampKey.doubleValue;
+    NSArray *sortedTimeStampKeys = [allEventsByTimeStamp.allKeys sortedArrayUsingSelector:@selector(compare:)];
+    NSUInteger timeStampCount = sortedTimeStampKeys.count;
+    MusicTimeStamp *musicTimeStamps = malloc(MAX(timeStampCount, 1) * sizeof(MusicTimeStamp));
+    MIDITimeStamp *midiTimeStamps = malloc(MAX(timeStampCount, 1) * sizeof(MIDITimeStamp));
+    for (NSUInteger i = 0; i < timeStampCount; i++) {
+        musicTimeStamps[i] = [sortedTimeStampKeys[i] doubleValue];
+    }
+
+    NSUInteger convertedTimeStampCount = 0;
+    for (NSUInteger i = 0; i < timeStampCount; i++) {
+        if (i == convertedTimeStampCount) {
+            // The clock only changes at tempo events, so convert everything up to and including the next one in a single batch
+            NSUInteger lastIndexToConvert = i;
+            while (lastIndexToConvert < (timeStampCount - 1) && !tempoEventsByTimeStamp[sortedTimeStampKeys[lastIndexToConvert]]) lastIndexToConvert++;
+            [clock getMIDITimeStamps:midiTimeStamps + i forMusicTimeStamps:musicTimeStamps + i count:(lastIndexToConvert - i + 1)];
+            convertedTimeStampCount = lastIndexToConvert + 1;
+        }
+
+        NSNumber *timeStampKey = sortedTimeStampKeys[i];
+        MusicTimeStamp musicTimeStamp = musicTimeStamps[i];
         if (isLooping && (musicTimeStamp < loopStartTimeStamp || musicTimeStamp >= loopEndTimeStamp)) continue;
-        MIDITimeStamp midiTimeStamp = [clock midiTimeStampForMusicTimeStamp:musicTimeStamp];
-        if (midiTimeStamp < MIKMIDIGetCurrentTimeStamp() && midiTimeStamp > fromMIDITimeStamp) continue;	// prevents events that were just recorded from being scheduled
+        MIDITimeStamp midiTimeStamp = midiTimeStamps[i];
+        if (midiTimeStamp < currentMIDITimeStamp && midiTimeStamp > fromMIDITimeStamp) continue;	// prevents events that were just recorded from being scheduled
 
         MIKMIDITempoEvent *tempoEventAtTimeStamp = tempoEventsByTimeStamp[timeStampKey];
         if (tempoEventAtTimeStamp) [self updateClockWithMusicTimeStamp:musicTimeStamp tempo:tempoEventAtTimeStamp.bpm * self.timeSpeed atMIDITimeStamp:midiTimeStamp];
@@ -406,6 +450,8 @@ const MusicTimeStamp MIKMIDISequencerEndOfSequenceLoopEndTimeStamp = -1;
             }
         }
     }
+    free(musicTimeStamps);
+    free(midiTimeStamps);
 
     self.latestScheduledMIDITimeStamp = actualToMIDITimeStamp;
 
@@ -422,17 +468,75 @@ const MusicTimeStamp MIKMIDISequencerEndOfSequenceLoopEndTimeStamp = -1;
             [self updateClockWithMusicTimeStamp:loopStartTimeStamp tempo:tempo atMIDITimeStamp:loopStartMIDITimeStamp];
 
             self.startingTimeStamp = loopStartTimeStamp;
+            self.eventSourcesTimeStamp = loopStartTimeStamp;
             [[NSNotificationCenter defaultCenter] postNotificationName:MIKMIDISequencerWillLoopNotification object:self userInfo:nil];
             [self processSequenceStartingFromMIDITimeStamp:loopStartMIDITimeStamp];
         }
+    } else if (self.nextSequence && !self.isRecording) {
+        if (calculatedToMusicTimeStamp > toMusicTimeStamp) {
+            // Carry on with the next sequence from the exact time this one ends, keeping the clock running
+            MIKMIDISequence *nextSequence = self.nextSequence;
+            Float64 tempo = [nextSequence tempoAtTimeStamp:0];
+            if (!tempo) tempo = kDefaultTempo;
+
+            MIDITimeStamp nextSequenceStartMIDITimeStamp = [clock midiTimeStampForMusicTimeStamp:toMusicTimeStamp];
+            [self sendAllPendingNoteOffsWithMIDITimeStamp:nextSequenceStartMIDITimeStamp];
+            self.previousSequence = sequence;
+            self.sequence = nextSequence;
+            self.nextSequence = nil;
+            [self updateClockWithMusicTimeStamp:0 tempo:tempo atMIDITimeStamp:nextSequenceStartMIDITimeStamp];
+
+            self.startingTimeStamp = 0;
+            self.eventSourcesTimeStamp = 0;
+            [[NSNotificationCenter defaultCenter] postNotificationName:MIKMIDISequencerWillStartNextSequenceNotification object:self userInfo:nil];
+            [self processSequenceStartingFromMIDITimeStamp:nextSequenceStartMIDITimeStamp];
+        }
     } else if (!self.isRecording) { // Don't stop automatically during recording
-        MIDITimeStamp systemTimeStamp = MIKMIDIGetCurrentTimeStamp();
+        MIDITimeStamp systemTimeStamp = [timeSource currentMIDITimeStamp];
         if ((systemTimeStamp > actualToMIDITimeStamp) && ([clock musicTimeStampForMIDITimeStamp:systemTimeStamp] >= self.sequenceLength)) {
             [self stopWithDispatchToProcessingQueue:NO];
         }
     }
 }
 
+- (NSArray *)tracksToPlay
+{
+    NSMutableArray *nonMutedTracks = [[NSMutableArray alloc] init];
+    NSMutableArray *soloTracks = [[NSMutableArray alloc] init];
+    for (MIKMIDITrack *track in self.sequence.tracks) {
+        if (track.isMuted) continue;
+
+        [nonMutedTracks addObject:track];
+        if (track.solo) { [soloTracks addObject:track]; }
+    }
+
+    // Never play muted tracks. If any non-muted tracks are soloed, only play those. Matches MusicPlayer behavior
+    return soloTracks.count != 0 ? soloTracks : nonMutedTracks;
+}
+
+- (void)scheduleNotesSoundingAtTimeStamp:(MusicTimeStamp)timeStamp
+{
+    for (MIKMIDITrack *track in [self tracksToPlay]) {
+        MusicTimeStamp offset = track.offset;
+        NSMutableArray *chasedNotes = [NSMutableArray array];
+        for (MIKMIDINoteEvent *note in [track notesSoundingAtTimeStamp:timeStamp - offset]) {
+            if (note.timeStamp >= timeStamp - offset) continue; // Will be scheduled normally
+
+            // Play the rest of the note, so it still ends when it would have
+            MIKMutableMIDINoteEvent *chasedNote = [note mutableCopy];
+            chasedNote.timeStamp = timeStamp;
+            chasedNote.duration = note.endTimeStamp + offset - timeStamp;
+            [chasedNotes addObject:chasedNote];
+        }
+        if (!chasedNotes.count) continue;
+
+        id<MIKMIDICommandScheduler> destination = [self commandSchedulerForTrack:track];
+        for (MIKMIDINoteEvent *chasedNote in chasedNotes) {
+            [self scheduleEventWithDestination:[MIKMIDIEventWithDestination eventWithDestination:destination event:chasedNote]];
+        }
+    }
+}
+
 - (void)scheduleEventWithDestination:(MIKMIDIEventWithDestination *)destinationEvent
 {
     MIKMIDIEvent *event = destinationEvent.event;
@@ -645,6 +749,7 @@ const MusicTimeStamp MIKMIDISequencerEndOfSequenceLoopEndTimeStamp = -1;
             NSLog(@"Error creating default synthesizer for %@: %@", track, error);
             return nil;
         }
+        result.timeSource = self.timeSource;
         [self setCommandScheduler:result forTrack:track];
         [self.tracksToDefaultSynthsMap setObject:result forKey:track];
     }
@@ -657,6 +762,43 @@ const MusicTimeStamp MIKMIDISequencerEndOfSequenceLoopEndTimeStamp = -1;
     return [self.tracksToDefaultSynthsMap objectForKey:track];
 }
 
+- (void)setCommandScheduler:(id<MIKMIDICommandScheduler>)commandScheduler forEventSource:(id<MIKMIDIEventSource>)eventSource
+{
+    if (!eventSource) return;
+
+    [self dispatchSyncToProcessingQueueAsNeeded:^{
+        [self willChangeValueForKey:@"eventSources"];
+        if (!commandScheduler) {
+            [self.eventSourcesToDestinationsMap removeObjectForKey:eventSource];
+            [self.internalEventSources removeObjectIdenticalTo:eventSource];
+        } else {
+            if (![self.eventSourcesToDestinationsMap objectForKey:eventSource]) [self.internalEventSources addObject:eventSource];
+            [self.eventSourcesToDestinationsMap setObject:commandScheduler forKey:eventSource];
+        }
+        [self didChangeValueForKey:@"eventSources"];
+    }];
+}
+
+- (id<MIKMIDICommandScheduler>)commandSchedulerForEventSource:(id<MIKMIDIEventSource>)eventSource
+{
+    __block id<MIKMIDICommandScheduler> result = nil;
+    [self dispatchSyncToProcessingQueueAsNeeded:^{
+        result = [self.eventSourcesToDestinationsMap objectForKey:eventSource];
+    }];
+    return result;
+}
+
+- (void)setNextSequenceWithFileAtURL:(NSURL *)fileURL completionHandler:(void (^)(MIKMIDISequence *, NSError *))completionHandler
+{
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        NSError *error = nil;
+        MIKMIDIFileParser *parser = [MIKMIDIFileParser parserWithFileAtURL:fileURL error:&error];
+        MIKMIDISequence *sequence = parser ? [MIKMIDISequence sequenceWithFileParser:parser error:&error] : nil;
+        if (sequence) self.nextSequence = sequence;
+        if (completionHandler) completionHandler(sequence, sequence ? nil : error);
+    });
+}
+
 #pragma mark - Click Track
 
 - (NSMutableArray *)clickTrackEventsFromTimeStamp:(MusicTimeStamp)fromTimeStamp toTimeStamp:(MusicTimeStamp)toTimeStamp
@@ -730,11 +872,17 @@ const MusicTimeStamp MIKMIDISequencerEndOfSequenceLoopEndTimeStamp = -1;
 #pragma mark - KVO
 
 + (BOOL)automaticallyNotifiesObserversOfSequence { return NO; }
++ (BOOL)automaticallyNotifiesObserversOfEventSources { return NO; }
++ (BOOL)automaticallyNotifiesObserversOfNextSequence { return NO; }
 + (NSSet *)keyPathsForValuesAffectingEffectiveLoopEndTimeStamp { return [NSSet setWithObjects:@"loopEndTimeStamp", @"sequence.length", nil]; }
 
 - (void)observeValueForKeyPath:(NSString *)keyPath ofObject:(id)object change:(NSDictionary *)change context:(void *)context
 {
-    NSSet *currentTracks = [NSSet setWithArray:self.sequence.tracks];
+    // The command schedulers of the next sequence's tracks are kept until it is played, and those of the
+    // previous sequence's tracks until the one after it starts, as they may still have note offs to send
+    NSMutableSet *currentTracks = [NSMutableSet setWithArray:self.sequence.tracks];
+    [currentTracks addObjectsFromArray:self.nextSequence.tracks];
+    [currentTracks addObjectsFromArray:self.previousSequence.tracks];
 
     NSMapTable *tracksToDestinationMap = self.tracksToDestinationsMap;
     NSMutableSet *tracksToRemoveFromDestinationMap = [NSMutableSet setWithArray:[[tracksToDestinationMap keyEnumerator] allObjects]];
@@ -760,7 +908,7 @@ const MusicTimeStamp MIKMIDISequencerEndOfSequenceLoopEndTimeStamp = -1;
 {
     MIKMIDIClock *clock = self.clock;
     if (clock.isReady) {
-        MusicTimeStamp timeStamp = [clock musicTimeStampForMIDITimeStamp:MIKMIDIGetCurrentTimeStamp()];
+        MusicTimeStamp timeStamp = [clock musicTimeStampForMIDITimeStamp:[self.timeSource currentMIDITimeStamp]];
         _currentTimeStamp = MAX(((timeStamp <= self.sequenceLength) ? timeStamp : self.sequenceLength), self.startingTimeStamp);
     }
     return _currentTimeStamp;
@@ -834,6 +982,15 @@ const MusicTimeStamp MIKMIDISequencerEndOfSequenceLoopEndTimeStamp = -1;
     return length ? length : self.sequence.length;
 }
 
+- (NSArray *)eventSources
+{
+    __block NSArray *result = nil;
+    [self dispatchSyncToProcessingQueueAsNeeded:^{
+        result = [self.internalEventSources copy];
+    }];
+    return result;
+}
+
 - (void)setSequence:(MIKMIDISequence *)sequence
 {
     if (_sequence != sequence) {
@@ -851,11 +1008,62 @@ const MusicTimeStamp MIKMIDISequencerEndOfSequenceLoopEndTimeStamp = -1;
     }
 }
 
+- (void)setNextSequence:(MIKMIDISequence *)nextSequence
+{
+    // Load events and create synthesizers ahead of time, so starting the next sequence doesn't hold up scheduling
+    NSMutableArray *tracksWithoutCommandSchedulers = [NSMutableArray array];
+    [self dispatchSyncToProcessingQueueAsNeeded:^{
+        for (MIKMIDITrack *track in nextSequence.tracks) {
+            if (track.numberOfEvents && ![self.tracksToDestinationsMap objectForKey:track]) [tracksWithoutCommandSchedulers addObject:track];
+        }
+    }];
+    for (MIKMIDITrack *track in nextSequence.tracks) {
+        if (!track.areEventsLoaded) [track eventsFromTimeStamp:0 toTimeStamp:0];
+    }
+
+    NSMapTable *tracksToSynths = [NSMapTable mapTableWithKeyOptions:NSPointerFunctionsStrongMemory valueOptions:NSPointerFunctionsStrongMemory];
+    for (MIKMIDITrack *track in (self.shouldCreateSynthsIfNeeded ? tracksWithoutCommandSchedulers : nil)) {
+        NSError *error = nil;
+        MIKMIDISynthesizer *synth = [[MIKMIDISynthesizer alloc] initWithError:&error];
+        if (!synth) {
+            NSLog(@"Error creating default synthesizer for %@: %@", track, error);
+            continue;
+        }
+        synth.timeSource = self.timeSource;
+        [tracksToSynths setObject:synth forKey:track];
+    }
+
+    [self dispatchSyncToProcessingQueueAsNeeded:^{
+        [self willChangeValueForKey:@"nextSequence"];
+        self->_nextSequence = nextSequence;
+        for (MIKMIDITrack *track in [[tracksToSynths keyEnumerator] allObjects]) {
+            if ([self.tracksToDestinationsMap objectForKey:track]) continue;
+            [self.tracksToDestinationsMap setObject:[tracksToSynths objectForKey:track] forKey:track];
+            [self.tracksToDefaultSynthsMap setObject:[tracksToSynths objectForKey:track] forKey:track];
+        }
+        [self didChangeValueForKey:@"nextSequence"];
+    }];
+}
+
 - (void)setMaximumLookAheadInterval:(NSTimeInterval)maximumLookAheadInterval
 {
     _maximumLookAheadInterval = MIN(MAX(maximumLookAheadInterval, 0.05), 1.0);
 }
 
+- (void)setTimeSource:(id<MIKMIDITimeSource>)timeSource
+{
+    if (!timeSource) timeSource = MIKMIDIDefaultTimeSource();
+    if (timeSource == _timeSource) return;
+
+    [self dispatchSyncToProcessingQueueAsNeeded:^{
+        self->_timeSource = timeSource;
+        self.clock.timeSource = timeSource;
+        for (MIKMIDISynthesizer *synth in [self.tracksToDefaultSynthsMap objectEnumerator]) {
+            synth.timeSource = timeSource;
+        }
+    }];
+}
+
 #pragma mark - Deprecated
 
 - (void)setDestinationEndpoint:(MIKMIDIDestinationEndpoint *)endpoint forTrack:(MIKMIDITrack *)track
@@ -11,6 +11,7 @@
 #import "MIKMIDISynthesizerInstrument.h"
 #import "MIKMIDICommandScheduler.h"
 #import "MIKMIDICompilerCompatibility.h"
+#import "MIKMIDITimeSource.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -149,6 +150,20 @@ NS_ASSUME_NONNULL_BEGIN
  */
 @property (nonatomic, nullable) AUGraph graph;
 
+/**
+ *  The time source that the MIDITimeStamps of commands passed to -scheduleMIDICommands:
+ *  are relative to.
+ *
+ *  Commands are rendered at the host time reported by the audio hardware, converted to the
+ *  time source's time. The render callback never messages the time source, so it can be
+ *  changed at any time, including while audio is rendering. A time source other than the
+ *  built in ones is assumed to advance at its rate from the time it reports when it is set.
+ *
+ *  Defaults to the value of MIKMIDIDefaultTimeSource() at the time the synthesizer was
+ *  created. Setting this to nil restores that default.
+ */
+@property (nonatomic, strong, null_resettable) id<MIKMIDITimeSource> timeSource;
+
 @end
 
 @interface MIKMIDISynthesizer (Deprecated)
@@ -12,6 +12,16 @@
 #import "MIKMIDIErrors.h"
 #import "MIKMIDIClock.h"
 #import "MIKMIDIPrivate.h"
+#import "MIKMIDITimeSource+MIKMIDIPrivate.h"
+
+// An immutable snapshot of the synthesizer's time source, so the render callback can read it without locking.
+// Replaced snapshots are kept, linked from the one that replaced them, until the synthesizer is deallocated,
+// as the render callback may still be reading them.
+typedef struct MIKMIDISynthesizerTimeSourceState {
+	CFTypeRef timeSource;
+	MIKMIDITimeSourceHostTimeMapping hostTimeMapping;
+	struct MIKMIDISynthesizerTimeSourceState *replacedState;
+} MIKMIDISynthesizerTimeSourceState;
 
 @interface MIKMIDISynthesizer ()
 {
@@ -20,6 +30,8 @@
 	CFMutableArrayRef _scheduledCommandTimeStampsArray;
 
 	dispatch_queue_t _scheduledCommandQueue;
+
+	_Atomic(MIKMIDISynthesizerTimeSourceState *) _timeSourceState;
 }
 
 @end
@@ -48,6 +60,7 @@
 #endif
 		_scheduledCommandQueue = dispatch_queue_create(queueLabel.UTF8String, attr);
 
+		self.timeSource = nil;
 		_componentDescription = componentDescription;
 		if (![self setupAUGraphWithError:error]) { return nil; }
 
@@ -77,6 +90,14 @@
 		CFRelease(_scheduledCommandTimeStampsArray);
 		_scheduledCommandTimeStampsArray = NULL;
 	}
+
+	MIKMIDISynthesizerTimeSourceState *timeSourceState = atomic_load_explicit(&_timeSourceState, memory_order_acquire);
+	while (timeSourceState) {
+		MIKMIDISynthesizerTimeSourceState *replacedState = timeSourceState->replacedState;
+		CFRelease(timeSourceState->timeSource);
+		free(timeSourceState);
+		timeSourceState = replacedState;
+	}
 }
 
 #pragma mark - Public
@@ -431,7 +452,15 @@ OSStatus MIKMIDISynthesizerScheduleUpcomingMIDICommands(MIKMIDISynthesizer *synt
 		lastMIDITimeStampsUntilNextCallback = midiTimeStampsUntilNextCallback;
 	}
 
-	MIDITimeStamp toTimeStamp = inTimeStamp->mHostTime + midiTimeStampsUntilNextCallback;
+	// Commands are stamped relative to the synth's time source, so convert the render host time to its time.
+	// This runs on the audio thread, so it only reads the published state, without messaging the time source.
+	MIKMIDISynthesizerTimeSourceState *timeSourceState = atomic_load_explicit(&synth->_timeSourceState, memory_order_acquire);
+	const MIKMIDITimeSourceHostTimeMapping *hostTimeMapping = &timeSourceState->hostTimeMapping;
+	MIDITimeStamp renderTimeStamp = MIKMIDITimeSourceMIDITimeStampForHostTimeStamp(hostTimeMapping, inTimeStamp->mHostTime);
+	Float64 timeSourceRate = (hostTimeMapping->rate > 0) ? hostTimeMapping->rate : 1.0;
+	midiTimeStampsUntilNextCallback *= timeSourceRate;
+
+	MIDITimeStamp toTimeStamp = renderTimeStamp + midiTimeStampsUntilNextCallback;
 	CFMutableArrayRef commandsToSend = CFArrayCreateMutable(NULL, 0, &kCFTypeArrayCallBacks);;
 
 	dispatch_sync(queue, ^{
@@ -460,15 +489,15 @@ OSStatus MIKMIDISynthesizerScheduleUpcomingMIDICommands(MIKMIDISynthesizer *synt
 		CFRelease(commandTimeStampsArrayCopy);
 	});
 
-	NSTimeInterval secondsPerMIDITimeStamp = MIKMIDIClockSecondsPerMIDITimeStamp();
+	NSTimeInterval secondsPerMIDITimeStamp = MIKMIDIClockSecondsPerMIDITimeStamp() / timeSourceRate;
 
 	CFIndex commandCount = CFArrayGetCount(commandsToSend);
 	for (CFIndex i = 0; i < commandCount; i++) {
 		MIKMIDICommand *command = (__bridge MIKMIDICommand *)CFArrayGetValueAtIndex(commandsToSend, i);
 
 		MIDITimeStamp sendTimeStamp = command.midiTimestamp;
-		if (sendTimeStamp < inTimeStamp->mHostTime) sendTimeStamp = inTimeStamp->mHostTime;
-		MIDITimeStamp timeStampOffset = sendTimeStamp - inTimeStamp->mHostTime;
+		if (sendTimeStamp < renderTimeStamp) sendTimeStamp = renderTimeStamp;
+		MIDITimeStamp timeStampOffset = sendTimeStamp - renderTimeStamp;
 		Float64 sampleOffset = secondsPerMIDITimeStamp * timeStampOffset * sampleRate;
 
 		OSStatus err = synth->_sendMIDICommand(synth, instrumentUnit, command.statusByte, command.dataByte1, command.dataByte2, sampleOffset);
@@ -510,6 +539,25 @@ static OSStatus MIKMIDISynthesizerInstrumentUnitRenderCallback(void *						inRef
 
 #pragma mark - Properties
 
+- (id<MIKMIDITimeSource>)timeSource
+{
+	MIKMIDISynthesizerTimeSourceState *timeSourceState = atomic_load_explicit(&_timeSourceState, memory_order_acquire);
+	return (__bridge id<MIKMIDITimeSource>)timeSourceState->timeSource;
+}
+
+- (void)setTimeSource:(id<MIKMIDITimeSource>)timeSource
+{
+	if (!timeSource) timeSource = MIKMIDIDefaultTimeSource();
+	MIKMIDISynthesizerTimeSourceState *timeSourceState = calloc(1, sizeof(*timeSourceState));
+	timeSourceState->timeSource = CFBridgingRetain(timeSource);
+	timeSourceState->hostTimeMapping = MIKMIDITimeSourceGetHostTimeMapping(timeSource);
+
+	@synchronized(self) {
+		timeSourceState->replacedState = atomic_load_explicit(&_timeSourceState, memory_order_relaxed);
+		atomic_store_explicit(&_timeSourceState, timeSourceState, memory_order_release);
+	}
+}
+
 - (void)setGraph:(AUGraph)graph
 {
 	if (graph != _graph) {
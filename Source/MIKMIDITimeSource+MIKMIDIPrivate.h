@@ -0,0 +1,54 @@
+//
+//  MIKMIDITimeSource+MIKMIDIPrivate.h
+//  MIKMIDI
+//
+//  Created by Mixed In Key on 10/18/26.
+//  Copyright (c) 2026 Mixed In Key. All rights reserved.
+//
+
+#import "MIKMIDITimeSource.h"
+#import "MIKMIDICompilerCompatibility.h"
+#include <stdatomic.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  How a time source's time relates to the host clock, so that it can be worked out from a host time
+ *  stamp without messaging the time source, e.g. on a real time audio thread.
+ */
+typedef struct {
+	MIDITimeStamp hostTimeStampZero;	// A host time stamp
+	MIDITimeStamp timeStampZero;		// The time source's time at hostTimeStampZero
+	Float64 rate;						// How fast the time source advances relative to the host clock
+	const _Atomic(MIDITimeStamp) * _Nullable currentTimeStamp; // For time sources that don't follow the host clock, their current time
+} MIKMIDITimeSourceHostTimeMapping;
+
+/**
+ *  Returns the mapping from host time to a time source's time.
+ *
+ *  The built in time sources are mapped exactly. Other time sources are assumed to advance at their rate
+ *  from the time they report when this function is called. The mapping of a manual time source refers to
+ *  its storage, so the time source must be kept alive for as long as the mapping is used.
+ *
+ *  @param timeSource The time source to map.
+ *
+ *  @return The mapping for timeSource.
+ */
+MIKMIDITimeSourceHostTimeMapping MIKMIDITimeSourceGetHostTimeMapping(id<MIKMIDITimeSource> timeSource);
+
+/**
+ *  Returns a time source's time at a host time stamp, without messaging the time source or taking any locks.
+ *
+ *  @param mapping A mapping from MIKMIDITimeSourceGetHostTimeMapping().
+ *  @param hostTimeStamp A host time stamp.
+ *
+ *  @return The time source's time at hostTimeStamp.
+ */
+static inline MIDITimeStamp MIKMIDITimeSourceMIDITimeStampForHostTimeStamp(const MIKMIDITimeSourceHostTimeMapping *mapping, MIDITimeStamp hostTimeStamp)
+{
+	if (mapping->currentTimeStamp) return atomic_load_explicit(mapping->currentTimeStamp, memory_order_acquire);
+	Float64 elapsed = (Float64)(SInt64)(hostTimeStamp - mapping->hostTimeStampZero) * mapping->rate;
+	return mapping->timeStampZero + (MIDITimeStamp)(SInt64)elapsed;
+}
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,151 @@
+//
+//  MIKMIDITimeSource.h
+//  MIKMIDI
+//
+//  Created by Mixed In Key on 10/18/26.
+//  Copyright (c) 2026 Mixed In Key. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import <CoreMIDI/CoreMIDI.h>
+#import "MIKMIDICompilerCompatibility.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Objects that conform to this protocol provide the notion of "now" used by MIKMIDIClock,
+ *  MIKMIDISequencer, MIKMIDIInputPort and MIKMIDISynthesizer, along with a way to run
+ *  code after a given amount of that time has passed.
+ *
+ *  MIKMIDI normally uses the shared MIKMIDIHostTimeSource, which is backed by
+ *  mach_absolute_time(). Substituting an MIKMIDIManualTimeSource or an
+ *  MIKMIDIAcceleratedTimeSource makes timing dependent code deterministic and lets it run
+ *  faster than real time, which is primarily useful for tests and benchmarks.
+ *
+ *  @see MIKMIDISetDefaultTimeSource()
+ */
+@protocol MIKMIDITimeSource <NSObject>
+
+/**
+ *  Returns the current time, expressed in host time units.
+ *
+ *  @return The current MIDITimeStamp according to the receiver.
+ */
+- (MIDITimeStamp)currentMIDITimeStamp;
+
+/**
+ *  Submits a block to a dispatch queue once the specified amount of the receiver's
+ *  time has elapsed.
+ *
+ *  @param block The block to submit. Must not be nil.
+ *  @param timeInterval The number of seconds, as measured by the receiver, to wait before submitting block.
+ *  @param queue The queue to submit block to. Must not be nil.
+ */
+- (void)performBlock:(dispatch_block_t)block afterTimeInterval:(NSTimeInterval)timeInterval onQueue:(dispatch_queue_t)queue;
+
+/**
+ *  How fast the receiver advances relative to the host clock. 1.0 means real time.
+ *  Time sources that do not advance on their own (e.g. MIKMIDIManualTimeSource) return 0.
+ */
+@property (nonatomic, readonly) Float64 rate;
+
+@end
+
+/**
+ *  Returns the time source used by newly created MIKMIDIClock, MIKMIDISequencer,
+ *  MIKMIDIInputPort and MIKMIDISynthesizer instances.
+ *
+ *  MIKMIDICommand's timestamp and midiTimestamp always use the host clock, as CoreMIDI
+ *  packet time stamps do, whatever the default time source is.
+ *
+ *  @return The default time source. The shared MIKMIDIHostTimeSource unless changed with MIKMIDISetDefaultTimeSource().
+ */
+id<MIKMIDITimeSource> MIKMIDIDefaultTimeSource(void);
+
+/**
+ *  Sets the default time source.
+ *
+ *  Existing objects keep the time source they were created with. So that MIKMIDIDefaultTimeSource()
+ *  can be called from any thread without locking, a time source that is replaced as the default
+ *  stays alive for the rest of the process.
+ *
+ *  @param timeSource The new default time source. Pass nil to restore the shared MIKMIDIHostTimeSource.
+ */
+void MIKMIDISetDefaultTimeSource(id<MIKMIDITimeSource> _Nullable timeSource);
+
+#pragma mark -
+
+/**
+ *  A time source backed by the host clock (mach_absolute_time()). This is the default.
+ */
+@interface MIKMIDIHostTimeSource : NSObject <MIKMIDITimeSource>
+
+/**
+ *  Returns the shared host time source.
+ *
+ *  @return The shared MIKMIDIHostTimeSource instance.
+ */
++ (instancetype)sharedTimeSource;
+
+@end
+
+#pragma mark -
+
+/**
+ *  A virtual time source that only advances when told to.
+ *
+ *  Blocks scheduled with -performBlock:afterTimeInterval:onQueue: are submitted to their
+ *  queues, in order, as soon as the time source is advanced past their due time.
+ *  MIKMIDIManualTimeSource is thread safe.
+ */
+@interface MIKMIDIManualTimeSource : NSObject <MIKMIDITimeSource>
+
+/**
+ *  Creates and initializes a manual time source starting at the specified time.
+ *
+ *  @param midiTimeStamp The initial value of currentMIDITimeStamp.
+ *
+ *  @return An initialized MIKMIDIManualTimeSource.
+ */
+- (instancetype)initWithMIDITimeStamp:(MIDITimeStamp)midiTimeStamp NS_DESIGNATED_INITIALIZER;
+
+/**
+ *  Advances the time source by the specified number of seconds.
+ *
+ *  @param timeInterval The number of seconds to advance by. Negative values are ignored.
+ */
+- (void)advanceByTimeInterval:(NSTimeInterval)timeInterval;
+
+/**
+ *  The current time of the time source. Setting a value earlier than the current
+ *  value is allowed, but never causes previously submitted blocks to be submitted again.
+ */
+@property (nonatomic) MIDITimeStamp currentMIDITimeStamp;
+
+@end
+
+#pragma mark -
+
+/**
+ *  A time source that follows the host clock, scaled by a constant rate.
+ *
+ *  An accelerated time source with a rate of 10 reports ten seconds passing for
+ *  every second of real time, which makes it possible to run timing sensitive code,
+ *  including MIKMIDISequencer playback, faster than real time.
+ */
+@interface MIKMIDIAcceleratedTimeSource : NSObject <MIKMIDITimeSource>
+
+/**
+ *  Creates and initializes an accelerated time source.
+ *
+ *  The time source starts at the current host time.
+ *
+ *  @param rate How fast the time source should advance relative to real time. Must be greater than 0.
+ *
+ *  @return An initialized MIKMIDIAcceleratedTimeSource.
+ */
+- (instancetype)initWithRate:(Float64)rate NS_DESIGNATED_INITIALIZER;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,288 @@
+//
+//  MIKMIDITimeSource.m
+//  MIKMIDI
+//
+//  Created by Mixed In Key on 10/18/26.
+//  Copyright (c) 2026 Mixed In Key. All rights reserved.
+//
+
+#import "MIKMIDITimeSource.h"
+#import "MIKMIDITimeSource+MIKMIDIPrivate.h"
+#import "MIKMIDIClock.h"
+#import "MIKMIDIUtilities.h"
+#import "MIKMIDIPrivate.h"
+#include <stdatomic.h>
+
+#if !__has_feature(objc_arc)
+#error MIKMIDITimeSource.m must be compiled with ARC. Either turn on ARC for the project or set the -fobjc-arc flag for MIKMIDITimeSource.m in the Build Phases for this target
+#endif
+
+#pragma mark - Default Time Source
+
+// Read whenever a clock, sequencer, input port or synthesizer is created, from any thread, so it's an atomic pointer rather than being guarded by a queue
+static _Atomic(void *) MIKMIDIDefaultTimeSourceStorage = NULL;
+
+id<MIKMIDITimeSource> MIKMIDIDefaultTimeSource(void)
+{
+	void *timeSource = atomic_load_explicit(&MIKMIDIDefaultTimeSourceStorage, memory_order_acquire);
+	return timeSource ? (__bridge id<MIKMIDITimeSource>)timeSource : [MIKMIDIHostTimeSource sharedTimeSource];
+}
+
+void MIKMIDISetDefaultTimeSource(id<MIKMIDITimeSource> timeSource)
+{
+	static NSMutableArray *replacedTimeSources;
+	static dispatch_once_t onceToken;
+	dispatch_once(&onceToken, ^{
+		replacedTimeSources = [NSMutableArray array];
+	});
+
+	void *oldTimeSource = atomic_exchange_explicit(&MIKMIDIDefaultTimeSourceStorage, (void *)CFBridgingRetain(timeSource), memory_order_acq_rel);
+	if (!oldTimeSource) return;
+
+	// A reader may have just loaded the old time source without retaining it yet, so it's kept alive rather than released
+	id replacedTimeSource = CFBridgingRelease(oldTimeSource);
+	@synchronized(replacedTimeSources) {
+		if (![replacedTimeSources containsObject:replacedTimeSource]) [replacedTimeSources addObject:replacedTimeSource];
+	}
+}
+
+#pragma mark - Host Time Mapping
+
+@interface MIKMIDIHostTimeSource ()
+- (MIKMIDITimeSourceHostTimeMapping)hostTimeMapping;
+@end
+
+@interface MIKMIDIManualTimeSource ()
+- (MIKMIDITimeSourceHostTimeMapping)hostTimeMapping;
+@end
+
+@interface MIKMIDIAcceleratedTimeSource ()
+- (MIKMIDITimeSourceHostTimeMapping)hostTimeMapping;
+@end
+
+MIKMIDITimeSourceHostTimeMapping MIKMIDITimeSourceGetHostTimeMapping(id<MIKMIDITimeSource> timeSource)
+{
+	if ([timeSource isKindOfClass:[MIKMIDIHostTimeSource class]] ||
+		[timeSource isKindOfClass:[MIKMIDIManualTimeSource class]] ||
+		[timeSource isKindOfClass:[MIKMIDIAcceleratedTimeSource class]]) {
+		return [(MIKMIDIHostTimeSource *)timeSource hostTimeMapping];
+	}
+
+	// Other time sources can only be sampled now and assumed to advance at their rate
+	MIDITimeStamp hostTimeStamp = MIKMIDIGetCurrentTimeStamp();
+	return (MIKMIDITimeSourceHostTimeMapping){ .hostTimeStampZero = hostTimeStamp, .timeStampZero = [timeSource currentMIDITimeStamp], .rate = timeSource.rate };
+}
+
+#pragma mark - Host Time Source
+
+@implementation MIKMIDIHostTimeSource
+
++ (instancetype)sharedTimeSource
+{
+	static MIKMIDIHostTimeSource *sharedTimeSource;
+	static dispatch_once_t onceToken;
+	dispatch_once(&onceToken, ^{
+		sharedTimeSource = [[self alloc] init];
+	});
+	return sharedTimeSource;
+}
+
+- (MIDITimeStamp)currentMIDITimeStamp
+{
+	return MIKMIDIGetCurrentTimeStamp();
+}
+
+- (void)performBlock:(dispatch_block_t)block afterTimeInterval:(NSTimeInterval)timeInterval onQueue:(dispatch_queue_t)queue
+{
+	if (!block || !queue) return;
+	dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(MAX(timeInterval, 0) * NSEC_PER_SEC)), queue, block);
+}
+
+- (Float64)rate { return 1.0; }
+
+- (MIKMIDITimeSourceHostTimeMapping)hostTimeMapping
+{
+	return (MIKMIDITimeSourceHostTimeMapping){ .rate = 1.0 };
+}
+
+@end
+
+#pragma mark - Manual Time Source
+
+@interface MIKMIDIManualTimeSourceScheduledBlock : NSObject
+@property (nonatomic) MIDITimeStamp dueTimeStamp;
+@property (nonatomic, copy) dispatch_block_t block;
+@property (nonatomic) dispatch_queue_t queue;
+@end
+
+@implementation MIKMIDIManualTimeSourceScheduledBlock
+
+- (void)dealloc
+{
+	MIKMIDI_GCD_RELEASE(_queue);
+}
+
+@synthesize queue = _queue;
+
+- (void)setQueue:(dispatch_queue_t)queue
+{
+	MIKMIDI_GCD_RETAIN(queue);
+	MIKMIDI_GCD_RELEASE(_queue);
+	_queue = queue;
+}
+
+@end
+
+@interface MIKMIDIManualTimeSource ()
+{
+	_Atomic(MIDITimeStamp) _currentMIDITimeStamp; // Only changed on _timeSourceQueue, but read from any thread without locking
+	NSMutableArray *_scheduledBlocks;
+	dispatch_queue_t _timeSourceQueue;
+}
+@end
+
+@implementation MIKMIDIManualTimeSource
+
+- (instancetype)initWithMIDITimeStamp:(MIDITimeStamp)midiTimeStamp
+{
+	self = [super init];
+	if (self) {
+		atomic_init(&_currentMIDITimeStamp, midiTimeStamp);
+		_scheduledBlocks = [NSMutableArray array];
+		_timeSourceQueue = dispatch_queue_create("com.mixedinkey.MIKMIDI.MIKMIDIManualTimeSource.timeSourceQueue", DISPATCH_QUEUE_SERIAL);
+	}
+	return self;
+}
+
+- (instancetype)init
+{
+	return [self initWithMIDITimeStamp:MIKMIDIGetCurrentTimeStamp()];
+}
+
+- (void)dealloc
+{
+	MIKMIDI_GCD_RELEASE(_timeSourceQueue);
+}
+
+- (void)advanceByTimeInterval:(NSTimeInterval)timeInterval
+{
+	if (timeInterval <= 0) return;
+	MIDITimeStamp midiTimeStampDelta = (MIDITimeStamp)MIKMIDIClockMIDITimeStampsPerTimeInterval(timeInterval);
+	[self updateCurrentMIDITimeStampUsingBlock:^MIDITimeStamp(MIDITimeStamp currentMIDITimeStamp) {
+		return currentMIDITimeStamp + midiTimeStampDelta;
+	}];
+}
+
+- (void)performBlock:(dispatch_block_t)block afterTimeInterval:(NSTimeInterval)timeInterval onQueue:(dispatch_queue_t)queue
+{
+	if (!block || !queue) return;
+	if (timeInterval <= 0) return dispatch_async(queue, block);
+
+	MIKMIDIManualTimeSourceScheduledBlock *scheduledBlock = [[MIKMIDIManualTimeSourceScheduledBlock alloc] init];
+	scheduledBlock.block = block;
+	scheduledBlock.queue = queue;
+
+	dispatch_sync(_timeSourceQueue, ^{
+		scheduledBlock.dueTimeStamp = atomic_load_explicit(&self->_currentMIDITimeStamp, memory_order_relaxed) + (MIDITimeStamp)MIKMIDIClockMIDITimeStampsPerTimeInterval(timeInterval);
+
+		// Keep the blocks sorted by due time, preserving submission order for equal due times
+		NSMutableArray *scheduledBlocks = self->_scheduledBlocks;
+		NSUInteger index = scheduledBlocks.count;
+		while (index > 0 && [scheduledBlocks[index - 1] dueTimeStamp] > scheduledBlock.dueTimeStamp) index--;
+		[scheduledBlocks insertObject:scheduledBlock atIndex:index];
+	});
+}
+
+- (Float64)rate { return 0; }
+
+- (MIKMIDITimeSourceHostTimeMapping)hostTimeMapping
+{
+	return (MIKMIDITimeSourceHostTimeMapping){ .currentTimeStamp = &_currentMIDITimeStamp };
+}
+
+#pragma mark - Properties
+
+- (MIDITimeStamp)currentMIDITimeStamp
+{
+	return atomic_load_explicit(&_currentMIDITimeStamp, memory_order_acquire);
+}
+
+- (void)setCurrentMIDITimeStamp:(MIDITimeStamp)currentMIDITimeStamp
+{
+	[self updateCurrentMIDITimeStampUsingBlock:^MIDITimeStamp(MIDITimeStamp oldMIDITimeStamp) {
+		return currentMIDITimeStamp;
+	}];
+}
+
+#pragma mark - Private
+
+// Reads and replaces the current time in one step on the time source queue, so concurrent changes aren't lost
+- (void)updateCurrentMIDITimeStampUsingBlock:(MIDITimeStamp (^)(MIDITimeStamp currentMIDITimeStamp))updateBlock
+{
+	__block NSArray *dueBlocks = nil;
+	dispatch_sync(_timeSourceQueue, ^{
+		MIDITimeStamp currentMIDITimeStamp = updateBlock(atomic_load_explicit(&self->_currentMIDITimeStamp, memory_order_relaxed));
+		atomic_store_explicit(&self->_currentMIDITimeStamp, currentMIDITimeStamp, memory_order_release);
+
+		NSMutableArray *scheduledBlocks = self->_scheduledBlocks;
+		NSUInteger dueCount = 0;
+		while (dueCount < scheduledBlocks.count && [scheduledBlocks[dueCount] dueTimeStamp] <= currentMIDITimeStamp) dueCount++;
+		if (!dueCount) return;
+
+		NSRange dueRange = NSMakeRange(0, dueCount);
+		dueBlocks = [scheduledBlocks subarrayWithRange:dueRange];
+		[scheduledBlocks removeObjectsInRange:dueRange];
+	});
+
+	for (MIKMIDIManualTimeSourceScheduledBlock *scheduledBlock in dueBlocks) {
+		dispatch_async(scheduledBlock.queue, scheduledBlock.block);
+	}
+}
+
+@end
+
+#pragma mark - Accelerated Time Source
+
+@interface MIKMIDIAcceleratedTimeSource ()
+{
+	MIDITimeStamp _hostTimeStampZero;
+}
+@end
+
+@implementation MIKMIDIAcceleratedTimeSource
+
+@synthesize rate = _rate;
+
+- (instancetype)initWithRate:(Float64)rate
+{
+	self = [super init];
+	if (self) {
+		_rate = (rate > 0) ? rate : 1.0;
+		_hostTimeStampZero = MIKMIDIGetCurrentTimeStamp();
+	}
+	return self;
+}
+
+- (instancetype)init
+{
+	return [self initWithRate:1.0];
+}
+
+- (MIKMIDITimeSourceHostTimeMapping)hostTimeMapping
+{
+	return (MIKMIDITimeSourceHostTimeMapping){ .hostTimeStampZero = _hostTimeStampZero, .timeStampZero = _hostTimeStampZero, .rate = _rate };
+}
+
+- (MIDITimeStamp)currentMIDITimeStamp
+{
+	MIDITimeStamp elapsed = MIKMIDIGetCurrentTimeStamp() - _hostTimeStampZero;
+	return _hostTimeStampZero + (MIDITimeStamp)(elapsed * _rate);
+}
+
+- (void)performBlock:(dispatch_block_t)block afterTimeInterval:(NSTimeInterval)timeInterval onQueue:(dispatch_queue_t)queue
+{
+	if (!block || !queue) return;
+	dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(MAX(timeInterval, 0) / _rate * NSEC_PER_SEC)), queue, block);
+}
+
+@end
@@ -8,15 +8,30 @@
 
 #import <Foundation/Foundation.h>
 #import <AudioToolbox/AudioToolbox.h>
+#import "MIKMIDIEvent.h"
 #import "MIKMIDICompilerCompatibility.h"
 
 @class MIKMIDISequence;
-@class MIKMIDIEvent;
 @class MIKMIDINoteEvent;
+@class MIKMIDIControlChangeEvent;
 @class MIKMIDIDestinationEndpoint;
+@class MIKMIDITrackSnapshot;
+@class MIKMIDINoteTransform;
 
 NS_ASSUME_NONNULL_BEGIN
 
+/**
+ *  A function called for each event by -[MIKMIDITrack enumerateRawEventsFromTimeStamp:toTimeStamp:usingFunction:context:].
+ *
+ *  @param timeStamp The time stamp of the event.
+ *  @param eventType The type of the event.
+ *  @param data The event's raw data, in the same format as MIKMIDIEvent's data property. Only valid for the duration of the call.
+ *  @param length The length of data, in bytes.
+ *  @param context The context pointer passed to -enumerateRawEventsFromTimeStamp:toTimeStamp:usingFunction:context:.
+ *  @param stop Set *stop to YES to end the enumeration early.
+ */
+typedef void (*MIKMIDITrackEventEnumerationFunction)(MusicTimeStamp timeStamp, MIKMIDIEventType eventType, const void *data, UInt32 length, void *_Nullable context, BOOL *stop);
+
 /**
  *  Instances of MIKMIDITrack contain sequences of MIDI events. Commonly,
  *  these will be MIDI notes. Multiple MIKMIDITracks can be contained in a
@@ -95,6 +110,101 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (MIKArrayOf(MIKMIDINoteEvent *) *)notesFromTimeStamp:(MusicTimeStamp)startTimeStamp toTimeStamp:(MusicTimeStamp)endTimeStamp;
 
+/**
+ *  Gets all of the MIDI events of a specific type in the track starting from startTimeStamp and ending at endTimeStamp inclusively.
+ *
+ *  The track keeps an index of its events by type, so the cost of this method depends on the number of
+ *  events of the specified type in the range, not on the total number of events in the track.
+ *
+ *  @param eventType The type of MIDI events you would like to retrieve. Meta events have a type per subtype, so
+ *  e.g. MIKMIDIEventTypeMetaTimeSignature only returns time signature events.
+ *  @param startTimeStamp The starting time stamp for the range to get MIDI events for.
+ *  @param endTimeStamp The ending time stamp for the range to get MIDI events for. Use kMusicTimeStamp_EndOfTrack to get events up to the
+ *  end of the track.
+ *
+ *  @return An array of MIDI events of the specified type.
+ */
+- (MIKArrayOf(MIKMIDIEvent *) *)eventsOfType:(MIKMIDIEventType)eventType fromTimeStamp:(MusicTimeStamp)startTimeStamp toTimeStamp:(MusicTimeStamp)endTimeStamp;
+
+/**
+ *  Gets all of the control change events for a specific controller in the track starting from startTimeStamp and
+ *  ending at endTimeStamp inclusively.
+ *
+ *  This is useful for displaying a single controller lane (e.g. CC 1, modulation) without filtering every event in the track.
+ *
+ *  @param controllerNumber The controller number of the events you would like to retrieve. Only values from 0-127 are valid.
+ *  @param startTimeStamp The starting time stamp for the range to get MIDI events for.
+ *  @param endTimeStamp The ending time stamp for the range to get MIDI events for. Use kMusicTimeStamp_EndOfTrack to get events up to the
+ *  end of the track.
+ *
+ *  @return An array of MIKMIDIControlChangeEvent instances.
+ */
+- (MIKArrayOf(MIKMIDIControlChangeEvent *) *)controlChangeEventsForControllerNumber:(NSUInteger)controllerNumber fromTimeStamp:(MusicTimeStamp)startTimeStamp toTimeStamp:(MusicTimeStamp)endTimeStamp;
+
+/**
+ *  Gets all of the MIDI notes in the track that sound at any time between startTimeStamp and endTimeStamp inclusively.
+ *
+ *  Unlike -notesFromTimeStamp:toTimeStamp:, this includes notes that start before startTimeStamp, but
+ *  are still sounding at startTimeStamp. This is useful for e.g. drawing the visible part of a piano roll,
+ *  or finding the notes that should be heard when playback starts in the middle of a track.
+ *
+ *  The track keeps an index of the end time stamps of its notes, so notes that started before the range are
+ *  found without scanning the track from its beginning.
+ *
+ *  @param startTimeStamp The starting time stamp for the range to get sounding MIDI notes for.
+ *  @param endTimeStamp The ending time stamp for the range to get sounding MIDI notes for. Use kMusicTimeStamp_EndOfTrack to get notes up to the
+ *  end of the track.
+ *
+ *  @return An array of MIKMIDINoteEvent instances, sorted by time stamp.
+ *
+ *  @see -notesSoundingAtTimeStamp:
+ */
+- (MIKArrayOf(MIKMIDINoteEvent *) *)notesSoundingFromTimeStamp:(MusicTimeStamp)startTimeStamp toTimeStamp:(MusicTimeStamp)endTimeStamp;
+
+/**
+ *  Gets all of the MIDI notes in the track that are sounding at the specified time stamp. That is, notes that start
+ *  at or before timeStamp and end after it.
+ *
+ *  @param timeStamp The time stamp to get sounding MIDI notes for.
+ *
+ *  @return An array of MIKMIDINoteEvent instances, sorted by time stamp.
+ *
+ *  @see -notesSoundingFromTimeStamp:toTimeStamp:
+ */
+- (MIKArrayOf(MIKMIDINoteEvent *) *)notesSoundingAtTimeStamp:(MusicTimeStamp)timeStamp;
+
+/**
+ *  Enumerates the raw data of the events in the track starting from startTimeStamp and ending at endTimeStamp inclusively,
+ *  in order.
+ *
+ *  Unlike the methods above, this doesn't create an MIKMIDIEvent for each event, or an array to return them in. Each event's
+ *  data is passed to the block in the same format as MIKMIDIEvent's data property, and is only valid for the duration of the
+ *  call, so the block must copy anything it needs to keep. This makes enumerating large tracks, e.g. to draw or analyze them,
+ *  considerably faster.
+ *
+ *  If the track belongs to a sequence that is being played by an MIKMIDISequencer, the block is called on the sequencer's
+ *  processing queue. The track must not be edited from the block.
+ *
+ *  @param startTimeStamp The starting time stamp for the range to enumerate.
+ *  @param endTimeStamp The ending time stamp for the range to enumerate. Use kMusicTimeStamp_EndOfTrack to enumerate
+ *  events up to the end of the track.
+ *  @param block The block to call for each event. Set *stop to YES to end the enumeration early.
+ *
+ *  @see -enumerateRawEventsFromTimeStamp:toTimeStamp:usingFunction:context:
+ */
+- (void)enumerateRawEventsFromTimeStamp:(MusicTimeStamp)startTimeStamp toTimeStamp:(MusicTimeStamp)endTimeStamp usingBlock:(void (^)(MusicTimeStamp timeStamp, MIKMIDIEventType eventType, const void *data, UInt32 length, BOOL *stop))block;
+
+/**
+ *  Enumerates the raw data of the events in the track, calling a C function for each one. Otherwise identical to
+ *  -enumerateRawEventsFromTimeStamp:toTimeStamp:usingBlock:.
+ *
+ *  @param startTimeStamp The starting time stamp for the range to enumerate.
+ *  @param endTimeStamp The ending time stamp for the range to enumerate.
+ *  @param function The function to call for each event.
+ *  @param context A pointer that is passed to function.
+ */
+- (void)enumerateRawEventsFromTimeStamp:(MusicTimeStamp)startTimeStamp toTimeStamp:(MusicTimeStamp)endTimeStamp usingFunction:(MIKMIDITrackEventEnumerationFunction)function context:(nullable void *)context;
+
 #pragma mark - Event Manipulation
 
 /**
@@ -153,6 +263,78 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (BOOL)mergeEventsFromMIDITrack:(MIKMIDITrack *)origTrack fromTimeStamp:(MusicTimeStamp)startTimeStamp toTimeStamp:(MusicTimeStamp)endTimeStamp atTimeStamp:(MusicTimeStamp)destTimeStamp;
 
+/**
+ *  Performs a group of edits to the track as a single batch.
+ *
+ *  Edits made inside the block are applied to the track's events immediately, so the block
+ *  can read back its own changes, but updating the underlying MusicTrack and posting KVO
+ *  change notifications for events, notes, and length are deferred until the block returns.
+ *  At that point, the MusicTrack is updated in a single pass over the range of time stamps
+ *  that was edited, and observers receive one change notification for the whole batch.
+ *
+ *  If the track belongs to a sequence that is being played by an MIKMIDISequencer, the whole
+ *  block runs on the sequencer's processing queue, so the sequencer never plays a partially
+ *  edited track. Batches may be nested, in which case changes are committed when the
+ *  outermost batch ends.
+ *
+ *  This is considerably faster than making the same edits outside of a batch when making
+ *  large numbers of edits, e.g. when quantizing or transposing every note in a track.
+ *
+ *  @param edits A block that edits the track.
+ *
+ *  @see -[MIKMIDISequence performBatchEdits:]
+ */
+- (void)performBatchEdits:(void (^)(void))edits;
+
+/**
+ *  Applies a transform, such as quantizing or transposing, to every note in the track.
+ *
+ *  The notes are rewritten directly in the track's storage in a single pass, instead of each note being
+ *  removed and re-added, and the change is committed as a single batch, as with -performBatchEdits:.
+ *  Notes that end up equal to another event in the track are removed.
+ *
+ *  @param transform The transform to apply.
+ *
+ *  @see MIKMIDINoteTransform
+ *  @see -[MIKMIDISequence applyNoteTransform:]
+ */
+- (void)applyNoteTransform:(MIKMIDINoteTransform *)transform;
+
+#pragma mark - Snapshots
+
+/**
+ *  Replaces the track's events with the events in a snapshot of the track, e.g. to undo or redo edits.
+ *
+ *  The track takes over the snapshot's storage instead of adding its events one at a time, so
+ *  restoring a snapshot doesn't depend on the number of events in the track. Only the range of
+ *  time stamps in which the snapshot differs from the track's current events is rewritten in the
+ *  track's MusicTrack. Observers receive a single change notification.
+ *
+ *  @param snapshot A snapshot previously obtained from the track's snapshot property.
+ *
+ *  @see snapshot
+ */
+- (void)restoreSnapshot:(MIKMIDITrackSnapshot *)snapshot;
+
+/**
+ *  An immutable snapshot of the track's events.
+ *
+ *  Unlike the track's other properties, getting the snapshot never waits for an MIKMIDISequencer
+ *  that is playing the track, and the returned snapshot can be read from any thread. This makes it
+ *  suitable for e.g. drawing the track on the main thread during playback.
+ *
+ *  The first time this property is read, a snapshot is taken. From then on, the track publishes a new
+ *  snapshot after each edit, or after each batch of edits made using -performBatchEdits:. Snapshots share
+ *  their storage with the track and each other, so keeping snapshots, e.g. for undo, costs memory in
+ *  proportion to the edits made between them.
+ *
+ *  @see MIKMIDITrackSnapshot
+ *  @see -restoreSnapshot:
+ */
+@property (atomic, strong, readonly) MIKMIDITrackSnapshot *snapshot;
+
+#pragma mark - Properties
+
 /**
  *  The MIDI sequence the track belongs to.
  */
@@ -160,6 +342,11 @@ NS_ASSUME_NONNULL_BEGIN
 
 /**
  *  The underlying MusicTrack that backs the instance of MIKMIDITrack.
+ *
+ *  If the track's sequence synchronizes its MusicSequence lazily, pending edits to the
+ *  track's events are written to the MusicTrack before it is returned.
+ *
+ *  @see -[MIKMIDISequence synchronizesMusicSequenceLazily]
  */
 @property (nonatomic, readonly) MusicTrack musicTrack;
 
@@ -182,6 +369,43 @@ NS_ASSUME_NONNULL_BEGIN
  */
 @property (nonatomic, readonly) NSInteger trackNumber;
 
+/**
+ *  The text of the track's first track name meta event, or nil if it doesn't have one.
+ *
+ *  This property can be observed using Key Value Observing.
+ */
+@property (nonatomic, readonly, nullable) NSString *name;
+
+/**
+ *  The text of the track's first instrument name meta event, or nil if it doesn't have one.
+ *
+ *  This property can be observed using Key Value Observing.
+ */
+@property (nonatomic, readonly, nullable) NSString *instrumentName;
+
+/**
+ *  The MIDI channels (0-15) used by the track's notes and other channel events.
+ *
+ *  This property can be observed using Key Value Observing.
+ */
+@property (nonatomic, readonly) NSIndexSet *channels;
+
+/**
+ *  The number of events in the track.
+ *
+ *  This property can be observed using Key Value Observing.
+ */
+@property (nonatomic, readonly) NSUInteger numberOfEvents;
+
+/**
+ *  Whether the track's events have been loaded. This is only NO for tracks of a sequence loaded lazily,
+ *  whose events haven't been needed yet. The name, instrumentName, channels, numberOfEvents and length
+ *  of such a track are read from a summary of the track made when the file was opened.
+ *
+ *  @see -[MIKMIDISequence initWithFileParser:loadingTracksLazily:error:]
+ */
+@property (nonatomic, readonly, getter=areEventsLoaded) BOOL eventsLoaded;
+
 /**
  *  A MIDI track’s start time in terms of beat number. By default this value is 0.
  *
@@ -12,25 +12,56 @@
 #import "MIKMIDINoteEvent.h"
 #import "MIKMIDITempoEvent.h"
 #import "MIKMIDIEventIterator.h"
+#import "MIKMIDIEventStore.h"
+#import "MIKMIDITrackSnapshot.h"
+#import "MIKMIDITrackSnapshot+MIKMIDIPrivate.h"
+#import "MIKMIDINoteTransform.h"
 #import "MIKMIDIDestinationEndpoint.h"
 #import "MIKMIDIErrors.h"
 #import "MIKMIDISequencer+MIKMIDIPrivate.h"
+#import "MIKMIDISequence+MIKMIDIPrivate.h"
+#import "MIKMIDIFileWriter.h"
+#import "MIKMIDIFileParser.h"
+#import "MIKMIDIFileParser+MIKMIDIPrivate.h"
+#import "MIKMIDIMetaTrackSequenceNameEvent.h"
+#import "MIKMIDIMetaInstrumentNameEvent.h"
 
 
 #if !__has_feature(objc_arc)
 #error MIKMIDITrack.m must be compiled with ARC. Either turn on ARC for the project or set the -fobjc-arc flag for MIKMIDITrack.m in the Build Phases for this target
 #endif
 
+// Precedes the track's event store in a sequence cache
+typedef struct {
+	Float64 offset;
+	UInt8 muted;
+	UInt8 solo;
+	UInt8 reserved[6];
+} MIKMIDITrackCacheHeader;
+
 @interface MIKMIDITrack ()
 
 @property (weak, nonatomic, nullable) MIKMIDISequence *sequence;
-@property (nonatomic, strong) NSMutableSet *internalEvents;
+@property (nonatomic, strong) MIKMIDIEventStore *eventStore;
 @property (nonatomic, strong) NSArray *sortedEventsCache;
 
 @property (nonatomic) MusicTimeStamp restoredLength;
 @property (nonatomic) MusicTrackLoopInfo restoredLoopInfo;
 @property (nonatomic) BOOL hasTemporaryLengthAndLoopInfo;
 
+@property (nonatomic) NSUInteger batchEditDepth;
+@property (nonatomic, getter=isSynchronizingMusicTrack) BOOL synchronizingMusicTrack;
+@property (nonatomic) BOOL needsEventsChangeNotification;
+@property (nonatomic) BOOL hasUnsyncedMusicTrackEvents;
+@property (nonatomic) MusicTimeStamp unsyncedStartTimeStamp;
+@property (nonatomic) MusicTimeStamp unsyncedEndTimeStamp;
+
+@property (atomic, strong) MIKMIDITrackSnapshot *latestSnapshot;
+
+// For tracks loaded lazily, until their events are first needed
+@property (nonatomic, strong, nullable) MIKMIDIFileParser *unloadedFileParser;
+@property (nonatomic, strong, nullable) MIKMIDIFileTrackSummary *unloadedTrackSummary;
+
 @end
 
 
@@ -50,7 +81,7 @@
             return nil;
         }
 
-		_internalEvents = [[NSMutableSet alloc] init];
+		_eventStore = [[MIKMIDIEventStore alloc] init];
         _musicTrack = musicTrack;
         _sequence = sequence;
 		[self reloadAllEventsFromMusicTrack];
@@ -86,6 +117,203 @@
 	}
 }
 
+#pragma mark - Batch Editing
+
+- (void)performBatchEdits:(void (^)(void))edits
+{
+	if (!edits) return;
+
+	[self dispatchSyncToSequencerProcessingQueueAsNeeded:^{
+		[self beginBatchEdits];
+		edits();
+		[self endBatchEdits];
+	}];
+}
+
+- (void)applyNoteTransform:(MIKMIDINoteTransform *)transform
+{
+	if (!transform) return;
+
+	[self dispatchSyncToSequencerProcessingQueueAsNeeded:^{
+		[[self class] applyNoteTransform:transform toTracks:@[self]];
+	}];
+}
+
++ (void)applyNoteTransform:(MIKMIDINoteTransform *)transform toTracks:(NSArray *)tracks
+{
+	NSUInteger numberOfTracks = [tracks count];
+	if (!transform || !numberOfTracks) return;
+
+	// Each track has its own event store, so the stores can be transformed at the same time.
+	// dispatch_apply() hands tracks out to worker threads as they become free, so one long track
+	// doesn't hold up the rest. Committing touches the MusicTracks and KVO, so that stays serial.
+	// Track numbers come from the MusicSequence, so they're looked up before going concurrent
+	NSInteger *trackNumbers = calloc(numberOfTracks, sizeof(NSInteger));
+	for (NSUInteger i = 0; i < numberOfTracks; i++) {
+		trackNumbers[i] = [tracks[i] trackNumber];
+	}
+	BOOL *changed = calloc(numberOfTracks, sizeof(BOOL));
+	MusicTimeStamp *startTimeStamps = calloc(numberOfTracks, sizeof(MusicTimeStamp));
+	MusicTimeStamp *endTimeStamps = calloc(numberOfTracks, sizeof(MusicTimeStamp));
+	dispatch_apply(numberOfTracks, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t i) {
+		MIKMIDITrack *track = tracks[i];
+		changed[i] = [track.eventStore applyNoteTransform:transform trackNumber:trackNumbers[i] startTimeStamp:&startTimeStamps[i] endTimeStamp:&endTimeStamps[i]];
+	});
+
+	for (NSUInteger i = 0; i < numberOfTracks; i++) {
+		if (!changed[i]) continue;
+
+		MIKMIDITrack *track = tracks[i];
+		[track beginBatchEdits];
+		[track markMusicTrackUnsyncedFromTimeStamp:startTimeStamps[i] toTimeStamp:endTimeStamps[i]];
+		[track invalidateSortedEventsCache];
+		[track endBatchEdits];
+	}
+	free(trackNumbers);
+	free(changed);
+	free(startTimeStamps);
+	free(endTimeStamps);
+}
+
+- (void)beginBatchEdits
+{
+	self.batchEditDepth++;
+}
+
+- (void)endBatchEdits
+{
+	if (!self.batchEditDepth) return;
+	if (--self.batchEditDepth) return;
+
+	if (![self.sequence synchronizesMusicSequenceLazily]) {
+		[self synchronizeMusicTrackIfNeeded];
+	}
+
+	if (self.needsEventsChangeNotification) {
+		self.needsEventsChangeNotification = NO;
+		self.sortedEventsCache = nil;
+	}
+}
+
+- (void)invalidateSortedEventsCache
+{
+	if (self.batchEditDepth) {
+		// Observers are notified once, when the batch is committed
+		_sortedEventsCache = nil;
+		_length = -1;
+		self.needsEventsChangeNotification = YES;
+		return;
+	}
+
+	self.sortedEventsCache = nil;
+}
+
+#pragma mark - Snapshots
+
+- (void)restoreSnapshot:(MIKMIDITrackSnapshot *)snapshot
+{
+	if (!snapshot) return;
+
+	[self dispatchSyncToSequencerProcessingQueueAsNeeded:^{
+		MIKMIDIEventStore *eventStore = [snapshot.eventStore copy];
+		MusicTimeStamp startTimeStamp, endTimeStamp;
+		if (![self.eventStore getTimeStampRangeOfDifferencesFromEventStore:eventStore startTimeStamp:&startTimeStamp endTimeStamp:&endTimeStamp]) return;
+
+		[self beginBatchEdits];
+		self.eventStore = eventStore;
+		[self markMusicTrackUnsyncedFromTimeStamp:startTimeStamp toTimeStamp:endTimeStamp];
+		[self endBatchEdits];
+	}];
+}
+
+- (MIKMIDITrackSnapshot *)snapshot
+{
+	// Once the first snapshot has been taken, there's always a current one, which never has to wait for the sequencer
+	MIKMIDITrackSnapshot *snapshot = self.latestSnapshot;
+	if (snapshot) return snapshot;
+
+	[self dispatchSyncToSequencerProcessingQueueAsNeeded:^{
+		if (!self.latestSnapshot) [self publishSnapshot];
+	}];
+	return self.latestSnapshot;
+}
+
+- (void)publishSnapshot
+{
+	self.latestSnapshot = [[MIKMIDITrackSnapshot alloc] initWithEventStore:[self.eventStore copy]];
+}
+
+#pragma mark - MusicTrack Synchronization
+
+- (BOOL)defersMusicTrackUpdates
+{
+	if (self.isSynchronizingMusicTrack) return NO;
+	// Once the MusicTrack is out of date, e.g. after the track is loaded by -replaceEventsWithEventStore:, edits
+	// are left for the next synchronization too, as the MusicTrack may not have the events they apply to
+	return self.batchEditDepth || self.hasUnsyncedMusicTrackEvents || [self.sequence synchronizesMusicSequenceLazily];
+}
+
+- (void)synchronizeMusicTrackIfNeeded
+{
+	if (!self.hasUnsyncedMusicTrackEvents) return;
+	self.hasUnsyncedMusicTrackEvents = NO;
+
+	// Bring the MusicTrack back in sync by replacing everything in the edited range with
+	// the events now in the store. Outside of that range, the two were never out of sync.
+	self.synchronizingMusicTrack = YES;
+	NSError *error = nil;
+	BOOL success = [self syncMusicTrackFromTimeStamp:self.unsyncedStartTimeStamp toTimeStamp:self.unsyncedEndTimeStamp error:&error];
+	self.synchronizingMusicTrack = NO;
+
+	if (!success) {
+		[self musicTrackUpdateFailedWithError:error fromTimeStamp:self.unsyncedStartTimeStamp toTimeStamp:self.unsyncedEndTimeStamp];
+	}
+}
+
+// The event store holds the track's events, and the MusicTrack may only have some of them, so the MusicTrack
+// is never reloaded from when writing to it fails. Instead, the range is left for the next synchronization to retry.
+- (void)musicTrackUpdateFailedWithError:(NSError *)error fromTimeStamp:(MusicTimeStamp)startTimeStamp toTimeStamp:(MusicTimeStamp)endTimeStamp
+{
+	NSLog(@"Error writing events to the MusicTrack of %@: %@", self, error);
+	[self markMusicTrackUnsyncedFromTimeStamp:startTimeStamp toTimeStamp:endTimeStamp];
+}
+
+- (void)markMusicTrackUnsyncedFromTimeStamp:(MusicTimeStamp)startTimeStamp toTimeStamp:(MusicTimeStamp)endTimeStamp
+{
+	if (!self.hasUnsyncedMusicTrackEvents) {
+		self.hasUnsyncedMusicTrackEvents = YES;
+		self.unsyncedStartTimeStamp = startTimeStamp;
+		self.unsyncedEndTimeStamp = endTimeStamp;
+		return;
+	}
+
+	if (startTimeStamp < self.unsyncedStartTimeStamp) self.unsyncedStartTimeStamp = startTimeStamp;
+	if (endTimeStamp > self.unsyncedEndTimeStamp) self.unsyncedEndTimeStamp = endTimeStamp;
+}
+
+- (BOOL)syncMusicTrackFromTimeStamp:(MusicTimeStamp)startTimeStamp toTimeStamp:(MusicTimeStamp)endTimeStamp error:(NSError **)error
+{
+	error = error ? error : &(NSError *__autoreleasing){ nil };
+
+	NSUInteger numberOfDeletedEvents = 0;
+	if (![self deleteEventsInMusicTrackFromTimeStamp:startTimeStamp toTimeStamp:endTimeStamp numberOfDeletedEvents:&numberOfDeletedEvents error:error passingTest:nil]) return NO;
+
+	__block NSError *insertError = nil;
+	[self.eventStore enumerateRawEventsFromTimeStamp:startTimeStamp toTimeStamp:endTimeStamp usingBlock:^(MusicTimeStamp timeStamp, MIKMIDIEventType eventType, const void *data, UInt32 length, BOOL *stop) {
+		NSError *eventError = nil;
+		if (![self insertEventInMusicTrackWithTimeStamp:timeStamp eventType:eventType data:data error:&eventError]) {
+			insertError = eventError;
+			*stop = YES;
+		}
+	}];
+
+	if (insertError) {
+		*error = insertError;
+		return NO;
+	}
+	return YES;
+}
+
 #pragma mark - Adding and Removing Events
 
 #pragma mark Public
@@ -94,13 +322,11 @@
 {
 	[self dispatchSyncToSequencerProcessingQueueAsNeeded:^{
 		if (!event) return;
-		if ([self.internalEvents containsObject:event]) return; // Don't allow duplicates
+		if ([self.eventStore containsEvent:event]) return; // Don't allow duplicates
 
 		NSError *error = nil;
 		if (![self insertMIDIEventInMusicTrack:event error:&error]) {
-			NSLog(@"Error adding %@ to %@: %@", event, self, error);
-			[self reloadAllEventsFromMusicTrack];
-			return;
+			[self musicTrackUpdateFailedWithError:error fromTimeStamp:event.timeStamp toTimeStamp:event.timeStamp];
 		}
 
 		[self addInternalEventsObject:event];
@@ -110,16 +336,16 @@
 - (void)addEvents:(NSArray *)events
 {
 	[self dispatchSyncToSequencerProcessingQueueAsNeeded:^{
-		NSMutableSet *scratch = [NSMutableSet setWithArray:events];
-		[scratch minusSet:self.internalEvents]; // Don't allow duplicates
+		NSMutableSet *scratch = [NSMutableSet setWithCapacity:[events count]];
+		for (MIKMIDIEvent *event in events) {
+			if (![self.eventStore containsEvent:event]) [scratch addObject:event]; // Don't allow duplicates
+		}
 		if (![scratch count]) return;
 
 		NSError *error = nil;
 		for (MIKMIDIEvent *event in scratch) {
 			if (![self insertMIDIEventInMusicTrack:event error:&error]) {
-				NSLog(@"Error adding %@ to %@: %@", event, self, error);
-				[self reloadAllEventsFromMusicTrack];
-				return;
+				[self musicTrackUpdateFailedWithError:error fromTimeStamp:event.timeStamp toTimeStamp:event.timeStamp];
 			}
 		}
 
@@ -131,13 +357,11 @@
 {
 	[self dispatchSyncToSequencerProcessingQueueAsNeeded:^{
 		if (!event) return;
-		if (![self.internalEvents containsObject:event]) return;
+		if (![self.eventStore containsEvent:event]) return;
 
 		NSError *error = nil;
 		if (![self removeMIDIEventsFromMusicTrack:[NSSet setWithObject:event] error:&error]) {
-			NSLog(@"Error removing %@ from %@: %@", event, self, error);
-			[self reloadAllEventsFromMusicTrack];
-			return;
+			[self musicTrackUpdateFailedWithError:error fromTimeStamp:event.timeStamp toTimeStamp:event.timeStamp];
 		}
 
 		[self removeInternalEventsObject:event];
@@ -148,14 +372,14 @@
 {
 	[self dispatchSyncToSequencerProcessingQueueAsNeeded:^{
 		if (![events count]) return;
-		NSMutableSet *scratch = [NSMutableSet setWithArray:events];
-		[scratch intersectSet:self.internalEvents];
+		NSMutableSet *scratch = [NSMutableSet setWithCapacity:[events count]];
+		for (MIKMIDIEvent *event in events) {
+			if ([self.eventStore containsEvent:event]) [scratch addObject:event];
+		}
 
 		NSError *error = nil;
 		if (![self removeMIDIEventsFromMusicTrack:scratch error:&error]) {
-			NSLog(@"Error removing %@ from %@: %@", events, self, error);
-			[self reloadAllEventsFromMusicTrack];
-			return;
+			[self musicTrackUpdateFailedWithError:error fromTimeStamp:[[scratch valueForKeyPath:@"@min.timeStamp"] doubleValue] toTimeStamp:[[scratch valueForKeyPath:@"@max.timeStamp"] doubleValue]];
 		}
 
 		[self removeInternalEvents:scratch];
@@ -169,16 +393,59 @@
 
 #pragma mark Private
 
+static MusicEventType MIKMIDITrackMusicEventTypeForEventType(MIKMIDIEventType eventType)
+{
+	switch (eventType) {
+		case MIKMIDIEventTypeMIDIChannelMessage:
+		case MIKMIDIEventTypeMIDIPolyphonicKeyPressureMessage:
+		case MIKMIDIEventTypeMIDIControlChangeMessage:
+		case MIKMIDIEventTypeMIDIProgramChangeMessage:
+		case MIKMIDIEventTypeMIDIChannelPressureMessage:
+		case MIKMIDIEventTypeMIDIPitchBendChangeMessage:
+			return kMusicEventType_MIDIChannelMessage;
+
+		case MIKMIDIEventTypeMeta:
+		case MIKMIDIEventTypeMetaSequence:
+		case MIKMIDIEventTypeMetaText:
+		case MIKMIDIEventTypeMetaCopyright:
+		case MIKMIDIEventTypeMetaTrackSequenceName:
+		case MIKMIDIEventTypeMetaInstrumentName:
+		case MIKMIDIEventTypeMetaLyricText:
+		case MIKMIDIEventTypeMetaMarkerText:
+		case MIKMIDIEventTypeMetaCuePoint:
+		case MIKMIDIEventTypeMetaMIDIChannelPrefix:
+		case MIKMIDIEventTypeMetaEndOfTrack:
+		case MIKMIDIEventTypeMetaTempoSetting:
+		case MIKMIDIEventTypeMetaSMPTEOffset:
+		case MIKMIDIEventTypeMetaTimeSignature:
+		case MIKMIDIEventTypeMetaKeySignature:
+		case MIKMIDIEventTypeMetaSequenceSpecificEvent:
+			return kMusicEventType_Meta;
+
+		default:
+			return (MusicEventType)eventType;
+	}
+}
+
 - (BOOL)insertMIDIEventInMusicTrack:(MIKMIDIEvent *)event error:(NSError **)error
+{
+	NSData *data = event.data;
+	return [self insertEventInMusicTrackWithTimeStamp:event.timeStamp eventType:event.eventType data:[data bytes] error:error];
+}
+
+- (BOOL)insertEventInMusicTrackWithTimeStamp:(MusicTimeStamp)timeStamp eventType:(MIKMIDIEventType)eventType data:(const void *)data error:(NSError **)error
 {
 	error = error ? error : &(NSError *__autoreleasing){ nil };
+
+	if ([self defersMusicTrackUpdates]) {
+		[self markMusicTrackUnsyncedFromTimeStamp:timeStamp toTimeStamp:timeStamp];
+		return YES;
+	}
 	
     OSStatus err = noErr;
-    MusicTrack track = self.musicTrack;
-    MusicTimeStamp timeStamp = event.timeStamp;
-    const void *data = [event.data bytes];
+    MusicTrack track = _musicTrack;
 
-    switch (event.eventType) {
+    switch (eventType) {
 		case MIKMIDIEventTypeNULL:
 			NSLog(@"Warning: %s attempted to insert NULL event.", __PRETTY_FUNCTION__);
             break;
@@ -255,7 +522,7 @@
 			break;
 		default:
 			err = -1;
-			NSLog(@"Warning: %s attempted to insert unknown event type %@.", __PRETTY_FUNCTION__, @(event.eventType));
+			NSLog(@"Warning: %s attempted to insert unknown event type %@.", __PRETTY_FUNCTION__, @(eventType));
 			break;
 }
 
@@ -270,24 +537,73 @@
 {
 	error = error ? error : &(NSError *__autoreleasing){ nil };
 	if (![events count]) return YES;
-	
-	// MusicTrackClear() doesn't reliably clear events that fall on its boundaries,
-	// so we iterate the track and delete that way instead
-	BOOL success = NO;
-	MIKMIDIEventIterator *iterator = [MIKMIDIEventIterator iteratorForTrack:self];
-	while (iterator.hasCurrentEvent) {
-		MIKMIDIEvent *currentEvent = iterator.currentEvent;
-		if ([events containsObject:currentEvent]) {
-			if (![iterator deleteCurrentEventWithError:error]) return NO;
-			success = YES;
-			continue; // Move to next event is done by delete.
-    }
 
-		[iterator moveToNextEvent];
-    }
+	if ([self defersMusicTrackUpdates]) {
+		for (MIKMIDIEvent *event in events) {
+			[self markMusicTrackUnsyncedFromTimeStamp:event.timeStamp toTimeStamp:event.timeStamp];
+		}
+		return YES;
+	}
 
-	*error = [NSError MIKMIDIErrorWithCode:MIKMIDITrackEventNotFoundErrorCode userInfo:nil];
-	return success;
+	// Comparing raw event data against the events being removed avoids creating an MIKMIDIEvent
+	// for every event in the track. Both arrays are sorted, so they're walked together.
+	NSSortDescriptor *sortDescriptor = [NSSortDescriptor sortDescriptorWithKey:@"timeStamp" ascending:YES];
+	NSArray *sortedEvents = [[events allObjects] sortedArrayUsingDescriptors:@[sortDescriptor]];
+	NSArray *sortedEventData = [sortedEvents valueForKey:@"data"];
+	NSUInteger count = [sortedEvents count];
+	MusicTimeStamp *timeStamps = malloc(count * sizeof(MusicTimeStamp));
+	MusicEventType *eventTypes = malloc(count * sizeof(MusicEventType));
+	for (NSUInteger i = 0; i < count; i++) {
+		MIKMIDIEvent *event = sortedEvents[i];
+		timeStamps[i] = event.timeStamp;
+		eventTypes[i] = MIKMIDITrackMusicEventTypeForEventType(event.eventType);
+	}
+
+	__block NSUInteger firstCandidate = 0;
+	NSUInteger numberOfDeletedEvents = 0;
+	BOOL success = [self deleteEventsInMusicTrackFromTimeStamp:timeStamps[0] toTimeStamp:timeStamps[count - 1] numberOfDeletedEvents:&numberOfDeletedEvents error:error passingTest:^BOOL(MusicTimeStamp timeStamp, MusicEventType eventType, const void *data, UInt32 dataSize) {
+		while (firstCandidate < count && timeStamps[firstCandidate] < timeStamp) firstCandidate++;
+		for (NSUInteger i = firstCandidate; i < count && timeStamps[i] == timeStamp; i++) {
+			if (eventTypes[i] != eventType) continue;
+			NSData *eventData = sortedEventData[i];
+			if ([eventData length] == dataSize && memcmp([eventData bytes], data, dataSize) == 0) return YES;
+		}
+		return NO;
+	}];
+
+	free(timeStamps);
+	free(eventTypes);
+
+	if (!success) return NO;
+	if (!numberOfDeletedEvents) {
+		*error = [NSError MIKMIDIErrorWithCode:MIKMIDITrackEventNotFoundErrorCode userInfo:nil];
+		return NO;
+	}
+	return YES;
+}
+
+// MusicTrackClear() doesn't reliably clear events that fall on its boundaries,
+// so we iterate the track and delete that way instead
+- (BOOL)deleteEventsInMusicTrackFromTimeStamp:(MusicTimeStamp)startTimeStamp
+								  toTimeStamp:(MusicTimeStamp)endTimeStamp
+						numberOfDeletedEvents:(NSUInteger *)numberOfDeletedEvents
+										error:(NSError **)error
+								  passingTest:(BOOL (^)(MusicTimeStamp timeStamp, MusicEventType eventType, const void *data, UInt32 dataSize))test
+{
+	error = error ? error : &(NSError *__autoreleasing){ nil };
+	*numberOfDeletedEvents = 0;
+
+	if ([self defersMusicTrackUpdates]) {
+		[self markMusicTrackUnsyncedFromTimeStamp:startTimeStamp toTimeStamp:endTimeStamp];
+		return YES;
+	}
+
+	MIKMIDIEventIterator *iterator = [[MIKMIDIEventIterator alloc] initWithMusicTrack:_musicTrack];
+	if (!iterator) {
+		*error = [NSError MIKMIDIErrorWithCode:MIKMIDIUnknownErrorCode userInfo:nil];
+		return NO;
+	}
+	return [iterator deleteEventsFromTimeStamp:startTimeStamp toTimeStamp:endTimeStamp passingTest:test numberOfDeletedEvents:numberOfDeletedEvents error:error];
 }
 
 #pragma mark - Getting Events
@@ -297,14 +613,11 @@
 // All public event getters pass through this method
 - (NSArray *)eventsOfClass:(Class)eventClass fromTimeStamp:(MusicTimeStamp)startTimeStamp toTimeStamp:(MusicTimeStamp)endTimeStamp
 {
-	NSMutableArray *result = [NSMutableArray array];
-	for (MIKMIDIEvent *event in self.events) {
-		if (event.timeStamp < startTimeStamp) { continue; }
-		if (event.timeStamp > endTimeStamp) { break; }
-		if (eventClass && ![event isKindOfClass:eventClass]) { continue; }
-		[result addObject:event];
-	}
-	return [result copy];
+	__block NSArray *result;
+	[self dispatchSyncToSequencerProcessingQueueAsNeeded:^{
+		result = [self.eventStore eventsOfClass:eventClass fromTimeStamp:startTimeStamp toTimeStamp:endTimeStamp];
+	}];
+	return result ?: @[];
 }
 
 - (NSArray *)eventsFromTimeStamp:(MusicTimeStamp)startTimeStamp toTimeStamp:(MusicTimeStamp)endTimeStamp
@@ -317,24 +630,192 @@
 	return [self eventsOfClass:[MIKMIDINoteEvent class] fromTimeStamp:startTimeStamp toTimeStamp:endTimeStamp];
 }
 
+- (NSArray *)eventsOfType:(MIKMIDIEventType)eventType fromTimeStamp:(MusicTimeStamp)startTimeStamp toTimeStamp:(MusicTimeStamp)endTimeStamp
+{
+	__block NSArray *result;
+	[self dispatchSyncToSequencerProcessingQueueAsNeeded:^{
+		result = [self.eventStore eventsOfType:eventType fromTimeStamp:startTimeStamp toTimeStamp:endTimeStamp];
+	}];
+	return result ?: @[];
+}
+
+- (NSArray *)controlChangeEventsForControllerNumber:(NSUInteger)controllerNumber fromTimeStamp:(MusicTimeStamp)startTimeStamp toTimeStamp:(MusicTimeStamp)endTimeStamp
+{
+	__block NSArray *result;
+	[self dispatchSyncToSequencerProcessingQueueAsNeeded:^{
+		result = [self.eventStore controlChangeEventsForControllerNumber:controllerNumber fromTimeStamp:startTimeStamp toTimeStamp:endTimeStamp];
+	}];
+	return result ?: @[];
+}
+
+- (NSArray *)notesSoundingFromTimeStamp:(MusicTimeStamp)startTimeStamp toTimeStamp:(MusicTimeStamp)endTimeStamp
+{
+	__block NSArray *result;
+	[self dispatchSyncToSequencerProcessingQueueAsNeeded:^{
+		result = [self.eventStore notesSoundingFromTimeStamp:startTimeStamp toTimeStamp:endTimeStamp];
+	}];
+	return result ?: @[];
+}
+
+- (NSArray *)notesSoundingAtTimeStamp:(MusicTimeStamp)timeStamp
+{
+	NSArray *notes = [self notesSoundingFromTimeStamp:timeStamp toTimeStamp:timeStamp];
+	NSIndexSet *indexes = [notes indexesOfObjectsPassingTest:^BOOL(MIKMIDINoteEvent *note, NSUInteger idx, BOOL *stop) {
+		return note.endTimeStamp > timeStamp;
+	}];
+	return [indexes count] == [notes count] ? notes : [notes objectsAtIndexes:indexes];
+}
+
+- (void)enumerateRawEventsFromTimeStamp:(MusicTimeStamp)startTimeStamp toTimeStamp:(MusicTimeStamp)endTimeStamp usingBlock:(void (^)(MusicTimeStamp, MIKMIDIEventType, const void *, UInt32, BOOL *))block
+{
+	if (!block) return;
+
+	[self dispatchSyncToSequencerProcessingQueueAsNeeded:^{
+		[self.eventStore enumerateRawEventsFromTimeStamp:startTimeStamp toTimeStamp:endTimeStamp usingBlock:block];
+	}];
+}
+
+- (void)enumerateRawEventsFromTimeStamp:(MusicTimeStamp)startTimeStamp toTimeStamp:(MusicTimeStamp)endTimeStamp usingFunction:(MIKMIDITrackEventEnumerationFunction)function context:(void *)context
+{
+	if (!function) return;
+
+	[self dispatchSyncToSequencerProcessingQueueAsNeeded:^{
+		[self.eventStore enumerateRawEventsFromTimeStamp:startTimeStamp toTimeStamp:endTimeStamp usingFunction:function context:context];
+	}];
+}
+
 #pragma mark Private
 
-- (void)reloadAllEventsFromMusicTrack
+- (void)replaceEventsWithEventStore:(MIKMIDIEventStore *)eventStore
+{
+	[self dispatchSyncToSequencerProcessingQueueAsNeeded:^{
+		self.eventStore = eventStore;
+		// Everything in the MusicTrack is replaced when it's next needed
+		[self markMusicTrackUnsyncedFromTimeStamp:0 toTimeStamp:kMusicTimeStamp_EndOfTrack];
+	}];
+}
+
+- (BOOL)writeEventsToFileWriter:(MIKMIDIFileWriter *)writer error:(NSError **)error
+{
+	error = error ?: &(NSError *__autoreleasing){ nil };
+	__block BOOL success = NO;
+	[self dispatchSyncToSequencerProcessingQueueAsNeeded:^{
+		if (![writer beginTrackWithError:error]) return;
+
+		// Events are written straight from the store, so the MusicTrack doesn't need to be up to date
+		__block NSError *writeError = nil;
+		[self.eventStore enumerateRawEventsFromTimeStamp:-DBL_MAX toTimeStamp:DBL_MAX usingBlock:^(MusicTimeStamp timeStamp, MIKMIDIEventType eventType, const void *data, UInt32 length, BOOL *stop) {
+			NSError *eventError = nil;
+			if (![writer writeEventWithTimeStamp:timeStamp eventType:MIKMIDITrackMusicEventTypeForEventType(eventType) data:data dataSize:length error:&eventError]) {
+				writeError = eventError;
+				*stop = YES;
+			}
+		}];
+		if (writeError) {
+			*error = writeError;
+			return;
+		}
+
+		success = [writer endTrackWithError:error];
+	}];
+	return success;
+}
+
+- (void)replaceEventsWithTrackOfFileParser:(MIKMIDIFileParser *)parser summary:(MIKMIDIFileTrackSummary *)summary
 {
-	MIKMIDIEventIterator *iterator = [MIKMIDIEventIterator iteratorForTrack:self];
-	NSMutableSet *allEvents = [NSMutableSet set];
-	while (iterator.hasCurrentEvent) {
-		MIKMIDIEvent *event = iterator.currentEvent;
-		[allEvents addObject:event];
-		[iterator moveToNextEvent];
+	[self dispatchSyncToSequencerProcessingQueueAsNeeded:^{
+		// The summary is in place before observers are notified, so they see the track's length
+		self.unloadedFileParser = parser;
+		self.unloadedTrackSummary = summary;
+		self->_eventStore = [[MIKMIDIEventStore alloc] init];
+		[self invalidateSortedEventsCache];
+		[self markMusicTrackUnsyncedFromTimeStamp:0 toTimeStamp:kMusicTimeStamp_EndOfTrack];
+	}];
+}
+
+- (void)loadEventsFromFileParser
+{
+	MIKMIDIFileParser *parser = self.unloadedFileParser;
+	NSUInteger trackIndex = self.unloadedTrackSummary.trackIndex;
+	self.unloadedFileParser = nil;
+	self.unloadedTrackSummary = nil;
+
+	NSError *error = nil;
+	MIKMIDIEventStore *eventStore = [parser eventStoreForTrackAtIndex:trackIndex error:&error];
+	if (!eventStore) {
+		// The track was read successfully when it was summarized, so this is unexpected
+		NSLog(@"Error loading the events of %@: %@", self, error);
+		eventStore = [[MIKMIDIEventStore alloc] init];
 	}
 
-	[self willChangeValueForKey:@"internalEvents"];
-	[self.internalEvents intersectSet:allEvents];
-	[self.internalEvents unionSet:allEvents];
-	[self didChangeValueForKey:@"internalEvents"];
-	
-	self.sortedEventsCache = nil;
+	// Observers aren't notified, as the track's events haven't changed, only been loaded
+	_eventStore = eventStore;
+}
+
+- (void)addEventsToChannelEventStores:(NSArray *)channelEventStores
+{
+	[self dispatchSyncToSequencerProcessingQueueAsNeeded:^{
+		[self.eventStore addEventsToChannelEventStores:channelEventStores];
+	}];
+}
+
+- (MIKMIDIEventStore *)copyEventStore
+{
+	__block MIKMIDIEventStore *eventStore = nil;
+	[self dispatchSyncToSequencerProcessingQueueAsNeeded:^{
+		eventStore = [self.eventStore copy];
+	}];
+	return eventStore;
+}
+
+- (void)appendCacheRepresentationToData:(NSMutableData *)data
+{
+	[self dispatchSyncToSequencerProcessingQueueAsNeeded:^{
+		MIKMIDITrackCacheHeader header = { 0 };
+		if (self != self.sequence.tempoTrack) {
+			header.offset = self.offset;
+			header.muted = self.isMuted;
+			header.solo = self.isSolo;
+		}
+		[data appendBytes:&header length:sizeof(header)];
+		[self.eventStore appendCacheRepresentationToData:data];
+	}];
+}
+
+- (BOOL)replaceEventsWithCacheData:(NSData *)data position:(NSUInteger *)position
+{
+	NSUInteger offset = *position;
+	if (offset > [data length] || [data length] - offset < sizeof(MIKMIDITrackCacheHeader)) return NO;
+	MIKMIDITrackCacheHeader header;
+	memcpy(&header, (const UInt8 *)[data bytes] + offset, sizeof(header));
+	offset += sizeof(header);
+
+	MIKMIDIEventStore *eventStore = [[MIKMIDIEventStore alloc] initWithCacheData:data position:&offset];
+	if (!eventStore) return NO;
+	[self replaceEventsWithEventStore:eventStore];
+
+	// Only properties that differ from a new track's are set, so the tempo track's are left alone
+	if (header.offset != 0) self.offset = header.offset;
+	if (header.muted) self.muted = YES;
+	if (header.solo) self.solo = YES;
+	*position = offset;
+	return YES;
+}
+
+- (void)reloadAllEventsFromMusicTrack
+{
+	// Edits that haven't been written to the MusicTrack are discarded
+	self.hasUnsyncedMusicTrackEvents = NO;
+
+	// The iterator returns events in order, so each of these is appended to the end of the store. Their
+	// data is stored straight from the MusicTrack, without creating an MIKMIDIEvent for each one.
+	MIKMIDIEventIterator *iterator = [[MIKMIDIEventIterator alloc] initWithMusicTrack:_musicTrack];
+	MIKMIDIEventStore *eventStore = [[MIKMIDIEventStore alloc] init];
+	[iterator enumerateRawEventsFromTimeStamp:0 toTimeStamp:kMusicTimeStamp_EndOfTrack usingBlock:^(MusicTimeStamp timeStamp, MusicEventType eventType, const void *data, UInt32 dataSize, BOOL *stop) {
+		[eventStore addEventWithTimeStamp:timeStamp musicEventType:eventType data:data length:dataSize];
+	}];
+
+	self.eventStore = eventStore;
 }
 
 #pragma mark - Editing Events (Public)
@@ -352,40 +833,30 @@
 
 - (BOOL)private_moveEventsFromStartingTimeStamp:(MusicTimeStamp)startTimeStamp toEndingTimeStamp:(MusicTimeStamp)endTimeStamp byAmount:(MusicTimeStamp)timestampOffset
 {
-	// MusicTrackMoveEvents() fails in common edge cases, so iterate the track and move that way instead
-
 	if (timestampOffset == 0) return YES; // Nothing needs to be done
 	MusicTimeStamp length = self.length;
-	if (!length || (startTimeStamp > length) || ![self.internalEvents count]) return YES;
+	if (!length || (startTimeStamp > length) || ![self.eventStore count]) return YES;
 	if (endTimeStamp > length) endTimeStamp = length;
 
-	NSMutableSet *eventsToMove = [NSMutableSet setWithArray:[self eventsFromTimeStamp:startTimeStamp toTimeStamp:endTimeStamp]];
-	NSSet *eventsBeforeMoving = [eventsToMove copy];
-	NSMutableSet *eventsAfterMoving = [NSMutableSet set];
-
-	MIKMIDIEventIterator *iterator = [MIKMIDIEventIterator iteratorForTrack:self];
-	while (iterator.hasCurrentEvent && [eventsToMove count] > 0) {
-		MIKMIDIEvent *currentEvent = iterator.currentEvent;
-		if (![eventsToMove containsObject:currentEvent]) {
-			[iterator moveToNextEvent];
-			continue;
-		}
+	// MusicTrackMoveEvents() fails in common edge cases, and moving events one at a time with an iterator
+	// means seeking back after every move. Instead, shift the events in the event store in one pass, then
+	// clear the range from the MusicTrack and reinsert the moved events.
+	NSUInteger numberOfDeletedEvents = 0;
+	NSError *error = nil;
+	if (![self deleteEventsInMusicTrackFromTimeStamp:startTimeStamp toTimeStamp:endTimeStamp numberOfDeletedEvents:&numberOfDeletedEvents error:&error passingTest:nil]) {
+		[self musicTrackUpdateFailedWithError:error fromTimeStamp:startTimeStamp toTimeStamp:endTimeStamp];
+	}
+	if (!numberOfDeletedEvents && ![self defersMusicTrackUpdates]) return YES;
 
-		MusicTimeStamp timestamp = currentEvent.timeStamp;
-		if (![iterator moveCurrentEventTo:timestamp+timestampOffset error:NULL]) {
-			[self reloadAllEventsFromMusicTrack];
-			return NO;
+	NSArray *movedEvents = [self.eventStore shiftEventsFromTimeStamp:startTimeStamp toTimeStamp:endTimeStamp byAmount:timestampOffset];
+	if (![movedEvents count]) return YES;
+	[self invalidateSortedEventsCache];
+	for (MIKMIDIEvent *event in movedEvents) {
+		if (![self insertMIDIEventInMusicTrack:event error:&error]) {
+			[self musicTrackUpdateFailedWithError:error fromTimeStamp:event.timeStamp toTimeStamp:event.timeStamp];
 		}
-		MIKMutableMIDIEvent *movedEvent = [currentEvent mutableCopy];
-		movedEvent.timeStamp += timestampOffset;
-		[eventsAfterMoving addObject:[movedEvent copy]];
-		[eventsToMove removeObject:currentEvent];
-		[iterator seek:timestamp]; // Move back to previous position
 	}
 
-	[self removeInternalEvents:eventsBeforeMoving];
-	[self addInternalEvents:eventsAfterMoving];
-
 	return YES;
 }
 
@@ -402,10 +873,16 @@
 
 - (BOOL)private_clearEventsFromStartingTimeStamp:(MusicTimeStamp)startTimeStamp toEndingTimeStamp:(MusicTimeStamp)endTimeStamp
 {
-	NSSet *events = [NSSet setWithArray:[self eventsFromTimeStamp:startTimeStamp toTimeStamp:endTimeStamp]];
-	BOOL success = [self removeMIDIEventsFromMusicTrack:events error:NULL];
-	[self reloadAllEventsFromMusicTrack];
-	return success;
+	NSUInteger numberOfDeletedEvents = 0;
+	NSError *error = nil;
+	if (![self deleteEventsInMusicTrackFromTimeStamp:startTimeStamp toTimeStamp:endTimeStamp numberOfDeletedEvents:&numberOfDeletedEvents error:&error passingTest:nil]) {
+		[self musicTrackUpdateFailedWithError:error fromTimeStamp:startTimeStamp toTimeStamp:endTimeStamp];
+	}
+
+	if ([self.eventStore removeEventsFromTimeStamp:startTimeStamp toTimeStamp:endTimeStamp]) {
+		[self invalidateSortedEventsCache];
+	}
+	return YES;
 }
 
 - (BOOL)cutEventsFromStartingTimeStamp:(MusicTimeStamp)startTimeStamp toEndingTimeStamp:(MusicTimeStamp)endTimeStamp
@@ -414,7 +891,7 @@
 
 	[self dispatchSyncToSequencerProcessingQueueAsNeeded:^{
 		MusicTimeStamp length = self.length;
-		if (!length || (startTimeStamp > length) || ![self.internalEvents count]) { success = YES; return; }
+		if (!length || (startTimeStamp > length) || ![self.eventStore count]) { success = YES; return; }
 
 		MusicTimeStamp actualEndTimeStamp = endTimeStamp;
 		if (actualEndTimeStamp > length) actualEndTimeStamp = length;
@@ -465,9 +942,9 @@
 	for (MIKMIDIEvent *event in sourceEvents) {
 		MIKMutableMIDIEvent *mutableEvent = [event mutableCopy];
 		mutableEvent.timeStamp = destTimeStamp + (event.timeStamp - firstSourceTimeStamp);
-		if (![self insertMIDIEventInMusicTrack:mutableEvent error:NULL]) {
-			[self reloadAllEventsFromMusicTrack];
-			return NO;
+		NSError *error = nil;
+		if (![self insertMIDIEventInMusicTrack:mutableEvent error:&error]) {
+			[self musicTrackUpdateFailedWithError:error fromTimeStamp:mutableEvent.timeStamp toTimeStamp:mutableEvent.timeStamp];
 		}
 		[destinationEvents addObject:mutableEvent];
 	}
@@ -515,8 +992,7 @@
 
 	[self dispatchSyncToSequencerProcessingQueueAsNeeded:^{
 		if (!self.sortedEventsCache) {
-			NSSortDescriptor *sortDescriptor = [NSSortDescriptor sortDescriptorWithKey:@"timeStamp" ascending:YES];
-			self->_sortedEventsCache = [self.internalEvents sortedArrayUsingDescriptors:@[sortDescriptor]];
+			self->_sortedEventsCache = self.eventStore.allEvents;
 		}
 		events = self.sortedEventsCache;
 	}];
@@ -531,47 +1007,62 @@
 		for (MIKMIDIEvent *event in events) {
 			NSError *error = nil;
 			if (![self insertMIDIEventInMusicTrack:event error:&error]) {
-				NSLog(@"Error adding %@ to %@: %@", event, self, error);
-				[self reloadAllEventsFromMusicTrack];
-				return;
+				[self musicTrackUpdateFailedWithError:error fromTimeStamp:event.timeStamp toTimeStamp:event.timeStamp];
 			}
 		}
 
-		self.internalEvents = [NSMutableSet setWithArray:events];
+		MIKMIDIEventStore *eventStore = [[MIKMIDIEventStore alloc] init];
+		for (MIKMIDIEvent *event in events) {
+			[eventStore addEvent:event];
+		}
+		self.eventStore = eventStore;
 	}];
 }
 
-- (void)setInternalEvents:(NSMutableSet *)internalEvents
+@synthesize eventStore = _eventStore;
+
+- (MIKMIDIEventStore *)eventStore
 {
-	if (internalEvents != _internalEvents) {
-		_internalEvents = internalEvents;
-		self.sortedEventsCache = nil;
+	// Every use of a lazily loaded track's events goes through here, so this is where they're loaded
+	if (self.unloadedFileParser) [self loadEventsFromFileParser];
+	return _eventStore;
+}
+
+- (void)setEventStore:(MIKMIDIEventStore *)eventStore
+{
+	self.unloadedFileParser = nil;
+	self.unloadedTrackSummary = nil;
+	if (eventStore != _eventStore) {
+		_eventStore = eventStore;
+		[self invalidateSortedEventsCache];
 	}
 }
 
 - (void)addInternalEventsObject:(MIKMIDIEvent *)event
 {
-	[self.internalEvents addObject:[event copy]];
-	self.sortedEventsCache = nil;
+	[self.eventStore addEvent:event];
+	[self invalidateSortedEventsCache];
 }
 
 - (void)addInternalEvents:(NSSet *)events
 {
 	for (MIKMIDIEvent *event in events) {
-		[self addInternalEventsObject:[event copy]];
+		[self addInternalEventsObject:event];
 	}
 }
 
 - (void)removeInternalEventsObject:(MIKMIDIEvent *)event
 {
-	[self.internalEvents removeObject:event];
-	self.sortedEventsCache = nil;
+	[self.eventStore removeEvent:event];
+	[self invalidateSortedEventsCache];
 }
 
 - (void)removeInternalEvents:(NSSet *)events
 {
-	[self.internalEvents minusSet:events];
-	self.sortedEventsCache = nil;
+	for (MIKMIDIEvent *event in events) {
+		[self.eventStore removeEvent:event];
+	}
+	[self invalidateSortedEventsCache];
 }
 
 + (NSSet *)keyPathsForValuesAffectingNotes
@@ -581,18 +1072,123 @@
 
 - (NSArray *)notes
 {
-	NSPredicate *predicate = [NSPredicate predicateWithBlock:^BOOL(id obj, NSDictionary *b) {
-		return [(MIKMIDIEvent *)obj eventType] == MIKMIDIEventTypeMIDINoteMessage;
+	return [self eventsOfType:MIKMIDIEventTypeMIDINoteMessage fromTimeStamp:-DBL_MAX toTimeStamp:DBL_MAX];
+}
+
++ (NSSet *)keyPathsForValuesAffectingName
+{
+	return [NSSet setWithObjects:@"sortedEventsCache", nil];
+}
+
+- (NSString *)name
+{
+	__block NSString *name = nil;
+	[self dispatchSyncToSequencerProcessingQueueAsNeeded:^{
+		if (self.unloadedTrackSummary) {
+			name = self.unloadedTrackSummary.name;
+		} else {
+			name = [[[self eventsOfClass:[MIKMIDIMetaTrackSequenceNameEvent class] fromTimeStamp:-DBL_MAX toTimeStamp:DBL_MAX] firstObject] string];
+		}
+	}];
+	return name;
+}
+
++ (NSSet *)keyPathsForValuesAffectingInstrumentName
+{
+	return [NSSet setWithObjects:@"sortedEventsCache", nil];
+}
+
+- (NSString *)instrumentName
+{
+	__block NSString *instrumentName = nil;
+	[self dispatchSyncToSequencerProcessingQueueAsNeeded:^{
+		if (self.unloadedTrackSummary) {
+			instrumentName = self.unloadedTrackSummary.instrumentName;
+		} else {
+			instrumentName = [[[self eventsOfClass:[MIKMIDIMetaInstrumentNameEvent class] fromTimeStamp:-DBL_MAX toTimeStamp:DBL_MAX] firstObject] string];
+		}
 	}];
-	return [self.events filteredArrayUsingPredicate:predicate];
+	return instrumentName;
+}
+
++ (NSSet *)keyPathsForValuesAffectingChannels
+{
+	return [NSSet setWithObjects:@"sortedEventsCache", nil];
+}
+
+- (NSIndexSet *)channels
+{
+	__block NSIndexSet *channels = nil;
+	[self dispatchSyncToSequencerProcessingQueueAsNeeded:^{
+		if (self.unloadedTrackSummary) {
+			channels = self.unloadedTrackSummary.channels;
+			return;
+		}
+
+		NSMutableIndexSet *usedChannels = [NSMutableIndexSet indexSet];
+		[self.eventStore enumerateRawEventsFromTimeStamp:-DBL_MAX toTimeStamp:DBL_MAX usingBlock:^(MusicTimeStamp timeStamp, MIKMIDIEventType eventType, const void *data, UInt32 length, BOOL *stop) {
+			MusicEventType musicEventType = MIKMIDITrackMusicEventTypeForEventType(eventType);
+			if (musicEventType == kMusicEventType_MIDINoteMessage) {
+				[usedChannels addIndex:((const MIDINoteMessage *)data)->channel & 0x0F];
+			} else if (musicEventType == kMusicEventType_MIDIChannelMessage) {
+				[usedChannels addIndex:((const MIDIChannelMessage *)data)->status & 0x0F];
+			}
+		}];
+		channels = usedChannels;
+	}];
+	return channels;
+}
+
++ (NSSet *)keyPathsForValuesAffectingNumberOfEvents
+{
+	return [NSSet setWithObjects:@"sortedEventsCache", nil];
+}
+
+- (NSUInteger)numberOfEvents
+{
+	__block NSUInteger numberOfEvents = 0;
+	[self dispatchSyncToSequencerProcessingQueueAsNeeded:^{
+		numberOfEvents = self.unloadedTrackSummary ? self.unloadedTrackSummary.numberOfEvents : self.eventStore.count;
+	}];
+	return numberOfEvents;
+}
+
+- (BOOL)areEventsLoaded
+{
+	__block BOOL eventsLoaded = NO;
+	[self dispatchSyncToSequencerProcessingQueueAsNeeded:^{
+		eventsLoaded = (self.unloadedFileParser == nil);
+	}];
+	return eventsLoaded;
+}
+
+@synthesize musicTrack = _musicTrack;
+
+- (MusicTrack)musicTrack
+{
+	[self dispatchSyncToSequencerProcessingQueueAsNeeded:^{
+		[self synchronizeMusicTrackIfNeeded];
+	}];
+	return _musicTrack;
+}
+
+- (MusicTrack)underlyingMusicTrack
+{
+	return _musicTrack;
 }
 
 - (NSInteger)trackNumber
 {
     __strong MIKMIDISequence *sequence = self.sequence;
 	if (!sequence) return -1;
+	MusicSequence musicSequence = NULL; // Avoids -[MIKMIDISequence musicSequence] writing pending edits to every track
+	OSStatus err = MusicTrackGetSequence(_musicTrack, &musicSequence);
+	if (err) {
+		NSLog(@"MusicTrackGetSequence() failed with error %@ in %s.", @(err), __PRETTY_FUNCTION__);
+		return -1;
+	}
 	UInt32 trackNumber = 0;
-	OSStatus err = MusicSequenceGetTrackIndex(sequence.musicSequence, self.musicTrack, &trackNumber);
+	err = MusicSequenceGetTrackIndex(musicSequence, _musicTrack, &trackNumber);
 	if (err) {
 		NSLog(@"MusicSequenceGetTrackIndex() failed with error %@ in %s.", @(err), __PRETTY_FUNCTION__);
 		return -1;
@@ -606,10 +1202,10 @@
 {
 	if (_offset != 0) return _offset;
 	
-	if (self.musicTrack) {
+	if (_musicTrack) {
 		MusicTimeStamp offset = 0;
 		UInt32 offsetLength = sizeof(offset);
-		OSStatus err = MusicTrackGetProperty(self.musicTrack, kSequenceTrackProperty_OffsetTime, &offset, &offsetLength);
+		OSStatus err = MusicTrackGetProperty(_musicTrack, kSequenceTrackProperty_OffsetTime, &offset, &offsetLength);
 		if (err) NSLog(@"MusicTrackGetProperty() failed with error %@ in %s.", @(err), __PRETTY_FUNCTION__);
 		return offset;
 	} else {
@@ -621,8 +1217,8 @@
 {
 	_offset = offset;
 	
-	if (self.musicTrack) {
-		OSStatus err = MusicTrackSetProperty(self.musicTrack, kSequenceTrackProperty_OffsetTime, &offset, sizeof(offset));
+	if (_musicTrack) {
+		OSStatus err = MusicTrackSetProperty(_musicTrack, kSequenceTrackProperty_OffsetTime, &offset, sizeof(offset));
 		if (err) NSLog(@"MusicTrackSetProperty() failed with error %@ in %s.", @(err), __PRETTY_FUNCTION__);
 	}
 }
@@ -633,10 +1229,10 @@
 {
 	if (_muted) return YES;
 	
-	if (self.musicTrack) {
+	if (_musicTrack) {
 		Boolean isMuted = FALSE;
 		UInt32 isMutedLength = sizeof(isMuted);
-		OSStatus err = MusicTrackGetProperty(self.musicTrack, kSequenceTrackProperty_MuteStatus, &isMuted, &isMutedLength);
+		OSStatus err = MusicTrackGetProperty(_musicTrack, kSequenceTrackProperty_MuteStatus, &isMuted, &isMutedLength);
 		if (err) NSLog(@"MusicTrackGetProperty() failed with error %@ in %s.", @(err), __PRETTY_FUNCTION__);
 		return isMuted ? YES : NO;
 	} else {
@@ -648,9 +1244,9 @@
 {
 	_muted = muted;
 	
-	if (self.musicTrack) {
+	if (_musicTrack) {
 		Boolean mutedBoolean = muted ? TRUE : FALSE;
-		OSStatus err = MusicTrackSetProperty(self.musicTrack, kSequenceTrackProperty_MuteStatus, &mutedBoolean, sizeof(mutedBoolean));
+		OSStatus err = MusicTrackSetProperty(_musicTrack, kSequenceTrackProperty_MuteStatus, &mutedBoolean, sizeof(mutedBoolean));
 		if (err) NSLog(@"MusicTrackSetProperty() failed with error %@ in %s.", @(err), __PRETTY_FUNCTION__);
 	}
 }
@@ -661,10 +1257,10 @@
 {
 	if (_solo) return YES;
 	
-	if (self.musicTrack) {
+	if (_musicTrack) {
 		Boolean isSolo = FALSE;
 		UInt32 isSoloLength = sizeof(isSolo);
-		OSStatus err = MusicTrackGetProperty(self.musicTrack, kSequenceTrackProperty_SoloStatus, &isSolo, &isSoloLength);
+		OSStatus err = MusicTrackGetProperty(_musicTrack, kSequenceTrackProperty_SoloStatus, &isSolo, &isSoloLength);
 		if (err) NSLog(@"MusicTrackGetProperty() failed with error %@ in %s.", @(err), __PRETTY_FUNCTION__);
 		return isSolo ? YES : NO;
 	} else {
@@ -676,9 +1272,9 @@
 {
 	_solo = solo;
 	
-	if (self.musicTrack) {
+	if (_musicTrack) {
 		Boolean soloBoolean = solo ? TRUE : FALSE;
-		OSStatus err = MusicTrackSetProperty(self.musicTrack, kSequenceTrackProperty_SoloStatus, &soloBoolean, sizeof(soloBoolean));
+		OSStatus err = MusicTrackSetProperty(_musicTrack, kSequenceTrackProperty_SoloStatus, &soloBoolean, sizeof(soloBoolean));
 		if (err) NSLog(@"MusicTrackSetProperty() failed with error %@ in %s.", @(err), __PRETTY_FUNCTION__);
 	}
 }
@@ -690,31 +1286,39 @@
 
 - (MusicTimeStamp)length
 {
-	if (_length == -1) {
-		MusicTimeStamp lastStamp = 0;
+	__block MusicTimeStamp length = 0;
 
-		for (MIKMIDIEvent *event in self.events) {
-			MusicTimeStamp endStamp = [event respondsToSelector:@selector(endTimeStamp)] ? [(MIKMIDINoteEvent *)event endTimeStamp] : event.timeStamp;
-			if (endStamp > lastStamp) lastStamp = endStamp;
+	[self dispatchSyncToSequencerProcessingQueueAsNeeded:^{
+		// -1 means the length is defined by the track's events, in which case the event store keeps it up to date
+		if (self->_length != -1) {
+			length = self->_length;
+		} else {
+			MusicTimeStamp endTimeStamp = self.unloadedTrackSummary ? self.unloadedTrackSummary.length : self.eventStore.maximumEndTimeStamp;
+			length = MAX(endTimeStamp, 0);
 		}
+	}];
 
-		_length = lastStamp;
-	}
-
-	return _length;
+	return length;
 }
 
 - (void)setSortedEventsCache:(NSArray *)sortedEventsCache
 {
 	_sortedEventsCache = sortedEventsCache;
 	_length = -1;
+
+	// Edits are committed here, so this is where a new snapshot is published, if anyone has taken one
+	if (self.latestSnapshot) [self publishSnapshot];
 }
 
 - (SInt16)timeResolution
 {
+	// The MusicSequence of a sequence read by MIKMIDIFileParser was never given the file's resolution
+	SInt16 fileTimeResolution = self.sequence.fileTimeResolution;
+	if (fileTimeResolution) return fileTimeResolution;
+
     SInt16 resolution = 0;
     UInt32 resolutionLength = sizeof(resolution);
-    OSStatus err = MusicTrackGetProperty(self.musicTrack, kSequenceTrackProperty_TimeResolution, &resolution, &resolutionLength);
+    OSStatus err = MusicTrackGetProperty(_musicTrack, kSequenceTrackProperty_TimeResolution, &resolution, &resolutionLength);
     if (err) NSLog(@"MusicTrackGetProperty() failed with error %@ in %s.", @(err), __PRETTY_FUNCTION__);
     return resolution;
 }
@@ -775,14 +1379,14 @@
 {
 	MusicTrackLoopInfo info;
 	UInt32 infoSize = sizeof(info);
-	OSStatus err = MusicTrackGetProperty(self.musicTrack, kSequenceTrackProperty_LoopInfo, &info, &infoSize);
+	OSStatus err = MusicTrackGetProperty(_musicTrack, kSequenceTrackProperty_LoopInfo, &info, &infoSize);
 	if (err) NSLog(@"MusicTrackGetProperty() failed with error %@ in %s.", @(err), __PRETTY_FUNCTION__);
 	return info;
 }
 
 - (void)setLoopInfo:(MusicTrackLoopInfo)loopInfo
 {
-	OSStatus err = MusicTrackSetProperty(self.musicTrack, kSequenceTrackProperty_LoopInfo, &loopInfo, sizeof(loopInfo));
+	OSStatus err = MusicTrackSetProperty(_musicTrack, kSequenceTrackProperty_LoopInfo, &loopInfo, sizeof(loopInfo));
 	if (err) NSLog(@"MusicTrackSetProperty() failed with error %@ in %s.", @(err), __PRETTY_FUNCTION__);
 }
 
@@ -811,7 +1415,7 @@
 	NSLog(@"%s is deprecated. You should update your code to avoid calling this method. Use MIKMIDISequencer's API instead.", __PRETTY_FUNCTION__);
 
     if (destinationEndpoint != _destinationEndpoint) {
-        OSStatus err = MusicTrackSetDestMIDIEndpoint(self.musicTrack, (MIDIEndpointRef)destinationEndpoint.objectRef);
+        OSStatus err = MusicTrackSetDestMIDIEndpoint(_musicTrack, (MIDIEndpointRef)destinationEndpoint.objectRef);
         if (err) NSLog(@"MusicTrackGetProperty() failed with error %@ in %s.", @(err), __PRETTY_FUNCTION__);
         _destinationEndpoint = destinationEndpoint;
     }
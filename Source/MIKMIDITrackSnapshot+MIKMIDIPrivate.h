@@ -0,0 +1,31 @@
+//
+//  MIKMIDITrackSnapshot+MIKMIDIPrivate.h
+//  MIKMIDI
+//
+//  Created by Mixed In Key on 10/18/26.
+//  Copyright (c) 2026 Mixed In Key. All rights reserved.
+//
+
+#import "MIKMIDITrackSnapshot.h"
+#import "MIKMIDICompilerCompatibility.h"
+
+@class MIKMIDIEventStore;
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface MIKMIDITrackSnapshot ()
+
+/**
+ *  Creates a snapshot of the events in an event store.
+ *
+ *  @param eventStore The event store to take a snapshot of. It must not be changed afterwards, so this should be a copy of the track's store.
+ *
+ *  @return An initialized MIKMIDITrackSnapshot.
+ */
+- (instancetype)initWithEventStore:(MIKMIDIEventStore *)eventStore NS_DESIGNATED_INITIALIZER;
+
+@property (nonatomic, strong, readonly) MIKMIDIEventStore *eventStore;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,97 @@
+//
+//  MIKMIDITrackSnapshot.h
+//  MIKMIDI
+//
+//  Created by Mixed In Key on 10/18/26.
+//  Copyright (c) 2026 Mixed In Key. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import <AudioToolbox/AudioToolbox.h>
+#import "MIKMIDICompilerCompatibility.h"
+
+@class MIKMIDIEvent;
+@class MIKMIDINoteEvent;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  An MIKMIDITrackSnapshot is an immutable copy of the events in an MIKMIDITrack at a point in time.
+ *
+ *  Snapshots are obtained using -[MIKMIDITrack snapshot], and can be restored using -[MIKMIDITrack restoreSnapshot:],
+ *  e.g. to implement undo and redo. Because a snapshot never changes, it can be read from any thread, without
+ *  waiting for an MIKMIDISequencer that may be playing the track.
+ *
+ *  Snapshots share their storage with the track they were taken from, and with each other. Storage is only
+ *  copied, a block of events at a time, as the track is edited, so keeping many snapshots of a large track
+ *  costs memory in proportion to the edits made between them, not to the size of the track.
+ */
+@interface MIKMIDITrackSnapshot : NSObject
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ *  Gets the events in the snapshot of a specific class starting from startTimeStamp and ending at endTimeStamp inclusively.
+ *
+ *  @param eventClass The class of events to get, or nil to get events of any class.
+ *  @param startTimeStamp The starting time stamp for the range to get events for.
+ *  @param endTimeStamp The ending time stamp for the range to get events for. Use kMusicTimeStamp_EndOfTrack to get events up to the
+ *  end of the track.
+ *
+ *  @return An array of events, sorted by time stamp.
+ */
+- (MIKArrayOfKindOf(MIKMIDIEvent *) *)eventsOfClass:(nullable Class)eventClass fromTimeStamp:(MusicTimeStamp)startTimeStamp toTimeStamp:(MusicTimeStamp)endTimeStamp;
+
+/**
+ *  Gets the events in the snapshot starting from startTimeStamp and ending at endTimeStamp inclusively.
+ *
+ *  @param startTimeStamp The starting time stamp for the range to get events for.
+ *  @param endTimeStamp The ending time stamp for the range to get events for. Use kMusicTimeStamp_EndOfTrack to get events up to the
+ *  end of the track.
+ *
+ *  @return An array of events, sorted by time stamp.
+ */
+- (MIKArrayOf(MIKMIDIEvent *) *)eventsFromTimeStamp:(MusicTimeStamp)startTimeStamp toTimeStamp:(MusicTimeStamp)endTimeStamp;
+
+/**
+ *  Gets the notes in the snapshot starting from startTimeStamp and ending at endTimeStamp inclusively.
+ *
+ *  @param startTimeStamp The starting time stamp for the range to get notes for.
+ *  @param endTimeStamp The ending time stamp for the range to get notes for. Use kMusicTimeStamp_EndOfTrack to get notes up to the
+ *  end of the track.
+ *
+ *  @return An array of MIKMIDINoteEvent instances, sorted by time stamp.
+ */
+- (MIKArrayOf(MIKMIDINoteEvent *) *)notesFromTimeStamp:(MusicTimeStamp)startTimeStamp toTimeStamp:(MusicTimeStamp)endTimeStamp;
+
+/**
+ *  Gets the notes in the snapshot that sound at any time between startTimeStamp and endTimeStamp inclusively,
+ *  including notes that start before startTimeStamp.
+ *
+ *  @param startTimeStamp The starting time stamp for the range to get sounding notes for.
+ *  @param endTimeStamp The ending time stamp for the range to get sounding notes for.
+ *
+ *  @return An array of MIKMIDINoteEvent instances, sorted by time stamp.
+ *
+ *  @see -[MIKMIDITrack notesSoundingFromTimeStamp:toTimeStamp:]
+ */
+- (MIKArrayOf(MIKMIDINoteEvent *) *)notesSoundingFromTimeStamp:(MusicTimeStamp)startTimeStamp toTimeStamp:(MusicTimeStamp)endTimeStamp;
+
+/**
+ *  All of the events in the snapshot, sorted by time stamp.
+ */
+@property (nonatomic, readonly) MIKArrayOf(MIKMIDIEvent *) *events;
+
+/**
+ *  All of the notes in the snapshot, sorted by time stamp.
+ */
+@property (nonatomic, readonly) MIKArrayOf(MIKMIDINoteEvent *) *notes;
+
+/**
+ *  The number of events in the snapshot.
+ */
+@property (nonatomic, readonly) NSUInteger numberOfEvents;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,81 @@
+//
+//  MIKMIDITrackSnapshot.m
+//  MIKMIDI
+//
+//  Created by Mixed In Key on 10/18/26.
+//  Copyright (c) 2026 Mixed In Key. All rights reserved.
+//
+
+#import "MIKMIDITrackSnapshot.h"
+#import "MIKMIDITrackSnapshot+MIKMIDIPrivate.h"
+#import "MIKMIDIEvent.h"
+#import "MIKMIDINoteEvent.h"
+#import "MIKMIDIEventStore.h"
+
+#if !__has_feature(objc_arc)
+#error MIKMIDITrackSnapshot.m must be compiled with ARC. Either turn on ARC for the project or set the -fobjc-arc flag for MIKMIDITrackSnapshot.m in the Build Phases for this target
+#endif
+
+@implementation MIKMIDITrackSnapshot
+
+- (instancetype)initWithEventStore:(MIKMIDIEventStore *)eventStore
+{
+	self = [super init];
+	if (self) {
+		_eventStore = eventStore;
+	}
+	return self;
+}
+
+- (instancetype)init
+{
+	[NSException raise:NSInternalInconsistencyException format:@"%@ instances are obtained using -[MIKMIDITrack snapshot]", NSStringFromClass([self class])];
+	return nil;
+}
+
+- (NSString *)description
+{
+	return [NSString stringWithFormat:@"%@ %lu events", [super description], (unsigned long)self.numberOfEvents];
+}
+
+#pragma mark - Getting Events
+
+// The event store is never changed after the snapshot is created, so it can be read from any thread
+- (NSArray *)eventsOfClass:(Class)eventClass fromTimeStamp:(MusicTimeStamp)startTimeStamp toTimeStamp:(MusicTimeStamp)endTimeStamp
+{
+	return [self.eventStore eventsOfClass:eventClass fromTimeStamp:startTimeStamp toTimeStamp:endTimeStamp];
+}
+
+- (NSArray *)eventsFromTimeStamp:(MusicTimeStamp)startTimeStamp toTimeStamp:(MusicTimeStamp)endTimeStamp
+{
+	return [self eventsOfClass:[MIKMIDIEvent class] fromTimeStamp:startTimeStamp toTimeStamp:endTimeStamp];
+}
+
+- (NSArray *)notesFromTimeStamp:(MusicTimeStamp)startTimeStamp toTimeStamp:(MusicTimeStamp)endTimeStamp
+{
+	return [self eventsOfClass:[MIKMIDINoteEvent class] fromTimeStamp:startTimeStamp toTimeStamp:endTimeStamp];
+}
+
+- (NSArray *)notesSoundingFromTimeStamp:(MusicTimeStamp)startTimeStamp toTimeStamp:(MusicTimeStamp)endTimeStamp
+{
+	return [self.eventStore notesSoundingFromTimeStamp:startTimeStamp toTimeStamp:endTimeStamp];
+}
+
+#pragma mark - Properties
+
+- (NSArray *)events
+{
+	return self.eventStore.allEvents;
+}
+
+- (NSArray *)notes
+{
+	return [self.eventStore eventsOfType:MIKMIDIEventTypeMIDINoteMessage fromTimeStamp:-DBL_MAX toTimeStamp:DBL_MAX];
+}
+
+- (NSUInteger)numberOfEvents
+{
+	return self.eventStore.count;
+}
+
+@end
@@ -9,6 +9,11 @@
 #import "MIKMIDITrack.h"
 #import "MIKMIDICompilerCompatibility.h"
 
+@class MIKMIDIEventStore;
+@class MIKMIDIFileWriter;
+@class MIKMIDIFileParser;
+@class MIKMIDIFileTrackSummary;
+
 NS_ASSUME_NONNULL_BEGIN
 
 @interface MIKMIDITrack ()
@@ -41,6 +46,125 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (void)restoreLengthAndLoopInfo;
 
+/**
+ *  Begins a batch of edits to the track. Calls to this method may be nested, and must
+ *  be balanced by calls to -endBatchEdits.
+ *
+ *  @note You should not call this method. It is used by MIKMIDISequence to include the track
+ *  in a sequence-wide batch. Use -performBatchEdits: instead.
+ */
+- (void)beginBatchEdits;
+
+/**
+ *  Ends a batch of edits to the track. When the outermost batch ends, the underlying
+ *  MusicTrack is updated and observers are notified of the changes made during the batch.
+ *
+ *  @note You should not call this method. It is used by MIKMIDISequence to include the track
+ *  in a sequence-wide batch. Use -performBatchEdits: instead.
+ */
+- (void)endBatchEdits;
+
+/**
+ *  Writes any edits to the track's events that have not yet been written to its MusicTrack.
+ *
+ *  @note You should not call this method. It is used by MIKMIDISequence to bring its
+ *  MusicSequence up to date when it is synchronized lazily.
+ */
+- (void)synchronizeMusicTrackIfNeeded;
+
+/**
+ *  Replaces the track's events with the events in an event store, without writing them to the track's
+ *  MusicTrack. The MusicTrack is brought up to date the next time it is needed, e.g. when -musicTrack is called.
+ *
+ *  @param eventStore The event store to use. The track takes ownership of it, so it must not be changed afterwards.
+ *
+ *  @note You should not call this method. It is used by MIKMIDISequence to fill its tracks with
+ *  events read by MIKMIDIFileParser.
+ */
+- (void)replaceEventsWithEventStore:(MIKMIDIEventStore *)eventStore;
+
+/**
+ *  Replaces the track's events with the events of a track in a MIDI file, which are only read
+ *  from the file the first time they're needed. Until then, summary describes the track.
+ *
+ *  @param parser The parser to read the track's events with.
+ *  @param summary The summary of the track in the file, from parser.
+ *
+ *  @note You should not call this method. It is used by MIKMIDISequence to load files lazily.
+ */
+- (void)replaceEventsWithTrackOfFileParser:(MIKMIDIFileParser *)parser summary:(MIKMIDIFileTrackSummary *)summary;
+
+/**
+ *  Writes the receiver's events to writer, as a track of their own.
+ *
+ *  @param writer The MIKMIDIFileWriter to write to.
+ *  @param error If an error occurs, upon return contains an NSError object that describes the problem.
+ *
+ *  @return YES if the track was written, NO if an error occurred.
+ *
+ *  @note You should not call this method. It is used by MIKMIDISequence to save itself as a MIDI file.
+ */
+- (BOOL)writeEventsToFileWriter:(MIKMIDIFileWriter *)writer error:(NSError **)error;
+
+/**
+ *  Adds the track's events to the event store for their MIDI channel, as by -[MIKMIDIEventStore addEventsToChannelEventStores:].
+ *
+ *  @param channelEventStores An array of 17 event stores, one for each channel and a last one for events without a channel.
+ *
+ *  @note You should not call this method. It is used by MIKMIDISequence to split its tracks by channel.
+ */
+- (void)addEventsToChannelEventStores:(MIKArrayOf(MIKMIDIEventStore *) *)channelEventStores;
+
+/**
+ *  Returns a copy of the track's event store. The copy shares the track's storage until either is changed,
+ *  so this doesn't copy any events.
+ *
+ *  @note You should not call this method. It is used by MIKMIDISequence to merge sequences.
+ */
+- (MIKMIDIEventStore *)copyEventStore;
+
+/**
+ *  Appends the track's events, offset, muted and solo properties to a sequence cache.
+ *
+ *  @param data The cache to append to. Its length must be a multiple of 8.
+ *
+ *  @note You should not call this method. It is used by MIKMIDISequence to write its cache.
+ */
+- (void)appendCacheRepresentationToData:(NSMutableData *)data;
+
+/**
+ *  Replaces the track's events, offset, muted and solo properties with those written to a sequence cache by
+ *  -appendCacheRepresentationToData:. The events are used in place in data, without being decoded, and are
+ *  only written to the track's MusicTrack when it's next needed.
+ *
+ *  @param data The cache to read from.
+ *  @param position The offset of the track in data. On return, the offset of the first byte after it.
+ *
+ *  @return YES if the track was read, NO if the cache is malformed.
+ *
+ *  @note You should not call this method. It is used by MIKMIDISequence to read its cache.
+ */
+- (BOOL)replaceEventsWithCacheData:(NSData *)data position:(NSUInteger *)position;
+
+/**
+ *  Applies a transform to the notes in several tracks at once. The tracks' events are transformed
+ *  concurrently, and the changes are then committed to each track in turn.
+ *
+ *  @param transform The transform to apply.
+ *  @param tracks The tracks to transform. Must not contain the same track twice.
+ *
+ *  @note You should not call this method. It is used by MIKMIDISequence to transform all of its
+ *  tracks at once, and must be called on the sequencer's processing queue, if there is one.
+ *  Use -applyNoteTransform: or -[MIKMIDISequence applyNoteTransform:] instead.
+ */
++ (void)applyNoteTransform:(MIKMIDINoteTransform *)transform toTracks:(MIKArrayOf(MIKMIDITrack *) *)tracks;
+
+/**
+ *  The track's MusicTrack. Unlike -musicTrack, accessing this property does not first write
+ *  pending edits to the MusicTrack, so it is suitable for e.g. disposing of the MusicTrack.
+ */
+@property (nonatomic, readonly) MusicTrack underlyingMusicTrack;
+
 @end
 
 NS_ASSUME_NONNULL_END
\ No newline at end of file